@@ -0,0 +1,458 @@
+set(current_dir ${CMAKE_CURRENT_LIST_DIR})
+
+set(_cd_hex "[0-9a-fA-F]")
+set(_cd_hex2 "${_cd_hex}${_cd_hex}")
+set(_cd_hex4 "${_cd_hex2}${_cd_hex2}")
+set(_cd_hex8 "${_cd_hex4}${_cd_hex4}")
+
+set(_cd_type_0001 "DirectSpeakers")
+set(_cd_type_0002 "Matrix")
+set(_cd_type_0003 "Objects")
+set(_cd_type_0004 "HOA")
+set(_cd_type_0005 "Binaural")
+
+# Report something in the common definitions that the generator does not
+# understand. Only the subset of the ADM used by the common definitions is
+# supported; anything else is an error rather than being silently dropped.
+macro(_cd_error message)
+  message(FATAL_ERROR
+          "compile_common_definitions: ${message} in ${COMPILE_INPUT}:\n"
+          "  ${line}")
+endmacro()
+
+# Split the attributes of a tag into `<prefix>_<name>` variables in the
+# calling scope; every attribute must be one of those listed after `prefix`.
+function(_cd_parse_attributes attributes prefix)
+  foreach(name IN LISTS ARGN)
+    set(${prefix}_${name} "" PARENT_SCOPE)
+  endforeach()
+  string(REGEX MATCHALL "[A-Za-z:]+=\"[^\"]*\"" pairs "${attributes}")
+  foreach(pair IN LISTS pairs)
+    string(REGEX MATCH "^([A-Za-z:]+)=\"([^\"]*)\"$" _ "${pair}")
+    list(FIND ARGN "${CMAKE_MATCH_1}" index)
+    if(index EQUAL -1)
+      _cd_error("unsupported attribute '${CMAKE_MATCH_1}'")
+    endif()
+    set(${prefix}_${CMAKE_MATCH_1} "${CMAKE_MATCH_2}" PARENT_SCOPE)
+  endforeach()
+  string(REGEX REPLACE "[A-Za-z:]+=\"[^\"]*\"" "" rest "${attributes}")
+  string(STRIP "${rest}" rest)
+  if(NOT rest STREQUAL "")
+    _cd_error("malformed attributes")
+  endif()
+endfunction()
+
+# Check that typeLabel and typeDefinition (if present) agree with the type
+# taken from an ID.
+function(_cd_check_type type label definition)
+  if(NOT DEFINED _cd_type_${type})
+    _cd_error("unsupported type '${type}'")
+  endif()
+  if(NOT label STREQUAL "" AND NOT label STREQUAL "${type}")
+    _cd_error("typeLabel does not match ID")
+  endif()
+  if(NOT definition STREQUAL "" AND NOT definition STREQUAL "${_cd_type_${type}}")
+    _cd_error("typeDefinition does not match ID")
+  endif()
+endfunction()
+
+function(_cd_check_format label definition)
+  if(NOT label STREQUAL "0001" OR NOT definition STREQUAL "PCM")
+    _cd_error("unsupported format")
+  endif()
+endfunction()
+
+# C++ string literal for an XML attribute or text value
+function(_cd_string value out)
+  if(value MATCHES "&")
+    _cd_error("entities are not supported")
+  endif()
+  string(REPLACE "\\" "\\\\" value "${value}")
+  string(REPLACE "\"" "\\\"" value "${value}")
+  set(${out} "\"${value}\"" PARENT_SCOPE)
+endfunction()
+
+# C++ float literal for an XML decimal value
+function(_cd_float value out)
+  if(NOT value MATCHES "^-?[0-9]+(\\.[0-9]*)?$")
+    _cd_error("unsupported number '${value}'")
+  endif()
+  if(NOT value MATCHES "\\.")
+    string(APPEND value ".")
+  endif()
+  set(${out} "${value}f" PARENT_SCOPE)
+endfunction()
+
+function(_cd_int value out)
+  if(NOT value MATCHES "^-?[0-9]+$")
+    _cd_error("unsupported integer '${value}'")
+  endif()
+  set(${out} "${value}" PARENT_SCOPE)
+endfunction()
+
+# Table index of the element with the given ID
+function(_cd_index id out)
+  string(TOUPPER "${id}" key)
+  if(NOT DEFINED _cd_index_${key})
+    _cd_error("unresolved reference '${id}'")
+  endif()
+  set(${out} ${_cd_index_${key}} PARENT_SCOPE)
+endfunction()
+
+# Generate C++ tables describing the common definitions (see
+# include/adm/private/common_definitions_tables.hpp) from an ADM XML file, so
+# that they can be loaded without any XML or ID parsing at runtime.
+#
+#   compile_common_definitions(INPUT <xml file> OUTPUT <cpp file>)
+function(compile_common_definitions)
+  set(options "")
+  set(oneValueArguments INPUT OUTPUT)
+  set(multiValueArguments "")
+  cmake_parse_arguments(COMPILE "${options}" "${oneValueArguments}"
+                        "${multiValueArguments}" ${ARGN})
+  foreach(arg ${oneValueArguments})
+    if(NOT COMPILE_${arg})
+      message(FATAL_ERROR
+              "Argument ${arg} not defined in call to compile_common_definitions")
+    endif()
+  endforeach()
+
+  set_property(
+    DIRECTORY
+    APPEND
+    PROPERTY CMAKE_CONFIGURE_DEPENDS ${COMPILE_INPUT})
+
+  # first pass: number the elements of each type in document order, so that
+  # references can be written as table indices
+  file(READ ${COMPILE_INPUT} content)
+  foreach(element audioPackFormat audioChannelFormat audioStreamFormat
+                  audioTrackFormat)
+    string(REGEX MATCHALL "<${element} [^>]*${element}ID=\"[^\"]*\"" tags
+                 "${content}")
+    set(index 0)
+    foreach(tag IN LISTS tags)
+      string(REGEX MATCH "${element}ID=\"([^\"]*)\"" _ "${tag}")
+      string(TOUPPER "${CMAKE_MATCH_1}" key)
+      if(DEFINED _cd_index_${key})
+        set(line "${tag}")
+        _cd_error("duplicate ID '${CMAKE_MATCH_1}'")
+      endif()
+      set(_cd_index_${key} ${index})
+      math(EXPR index "${index} + 1")
+    endforeach()
+  endforeach()
+
+  # second pass: walk the file line by line (it has one element per line) and
+  # emit a table row for each element
+  set(pack_formats "")
+  set(pack_channel_refs "")
+  set(pack_pack_refs "")
+  set(channel_formats "")
+  set(direct_speakers_blocks "")
+  set(hoa_blocks "")
+  set(binaural_blocks "")
+  set(stream_formats "")
+  set(stream_track_refs "")
+  set(track_formats "")
+  set(pack_channel_ref_count 0)
+  set(pack_pack_ref_count 0)
+  set(direct_speakers_block_count 0)
+  set(hoa_block_count 0)
+  set(binaural_block_count 0)
+  set(stream_track_ref_count 0)
+  set(context "")
+
+  file(STRINGS ${COMPILE_INPUT} lines)
+  foreach(line IN LISTS lines)
+    string(STRIP "${line}" line)
+    if(line STREQUAL "" OR line MATCHES "^<\\?xml .*\\?>$")
+      continue()
+    elseif(line MATCHES "^</([A-Za-z]+)>$")
+      set(kind close)
+      set(tag "${CMAKE_MATCH_1}")
+    elseif(line MATCHES "^<([A-Za-z]+)(( [^>]*)?)/>$")
+      set(kind empty)
+      set(tag "${CMAKE_MATCH_1}")
+      set(attributes "${CMAKE_MATCH_2}")
+    elseif(line MATCHES "^<([A-Za-z]+)(( [^>]*)?)>([^<]*)</([A-Za-z]+)>$")
+      set(kind text)
+      set(tag "${CMAKE_MATCH_1}")
+      set(attributes "${CMAKE_MATCH_2}")
+      set(text "${CMAKE_MATCH_4}")
+      if(NOT CMAKE_MATCH_5 STREQUAL "${tag}")
+        _cd_error("mismatched closing tag")
+      endif()
+    elseif(line MATCHES "^<([A-Za-z]+)(( [^>]*)?)>$")
+      set(kind open)
+      set(tag "${CMAKE_MATCH_1}")
+      set(attributes "${CMAKE_MATCH_2}")
+    else()
+      _cd_error("unsupported line")
+    endif()
+
+    if(context STREQUAL "")
+      if(tag MATCHES "^(ituADM|ebuCoreMain|coreMetadata|format|audioFormatExtended)$"
+         AND (kind STREQUAL "open" OR kind STREQUAL "close"))
+        # containers, nothing to record
+      elseif(tag STREQUAL "audioPackFormat" AND kind STREQUAL "open")
+        _cd_parse_attributes("${attributes}" attr audioPackFormatID
+                             audioPackFormatName typeLabel typeDefinition)
+        if(NOT attr_audioPackFormatID MATCHES "^AP_(${_cd_hex4})(${_cd_hex4})$")
+          _cd_error("invalid audioPackFormatID")
+        endif()
+        set(type ${CMAKE_MATCH_1})
+        set(value ${CMAKE_MATCH_2})
+        _cd_check_type(${type} "${attr_typeLabel}" "${attr_typeDefinition}")
+        _cd_string("${attr_audioPackFormatName}" name)
+        set(channel_refs_begin ${pack_channel_ref_count})
+        set(pack_refs_begin ${pack_pack_ref_count})
+        set(context pack)
+      elseif(tag STREQUAL "audioChannelFormat" AND kind STREQUAL "open")
+        _cd_parse_attributes("${attributes}" attr audioChannelFormatID
+                             audioChannelFormatName typeLabel typeDefinition)
+        if(NOT attr_audioChannelFormatID MATCHES
+           "^AC_(${_cd_hex4})(${_cd_hex4})$")
+          _cd_error("invalid audioChannelFormatID")
+        endif()
+        set(type ${CMAKE_MATCH_1})
+        set(value ${CMAKE_MATCH_2})
+        _cd_check_type(${type} "${attr_typeLabel}" "${attr_typeDefinition}")
+        if(type STREQUAL "0001")
+          set(block_table direct_speakers)
+        elseif(type STREQUAL "0004")
+          set(block_table hoa)
+        elseif(type STREQUAL "0005")
+          set(block_table binaural)
+        else()
+          _cd_error("unsupported audioChannelFormat type")
+        endif()
+        _cd_string("${attr_audioChannelFormatName}" name)
+        set(low_pass "")
+        set(high_pass "")
+        set(blocks_begin ${${block_table}_block_count})
+        set(context channel)
+      elseif(tag STREQUAL "audioStreamFormat" AND kind STREQUAL "open")
+        _cd_parse_attributes("${attributes}" attr audioStreamFormatID
+                             audioStreamFormatName formatLabel formatDefinition)
+        if(NOT attr_audioStreamFormatID MATCHES
+           "^AS_(${_cd_hex4})(${_cd_hex4})$")
+          _cd_error("invalid audioStreamFormatID")
+        endif()
+        set(type ${CMAKE_MATCH_1})
+        set(value ${CMAKE_MATCH_2})
+        _cd_check_format("${attr_formatLabel}" "${attr_formatDefinition}")
+        _cd_string("${attr_audioStreamFormatName}" name)
+        set(channel_ref -1)
+        set(pack_ref -1)
+        set(track_refs_begin ${stream_track_ref_count})
+        set(context stream)
+      elseif(tag STREQUAL "audioTrackFormat" AND kind STREQUAL "open")
+        _cd_parse_attributes("${attributes}" attr audioTrackFormatID
+                             audioTrackFormatName formatLabel formatDefinition)
+        if(NOT attr_audioTrackFormatID MATCHES
+           "^AT_(${_cd_hex4})(${_cd_hex4})_(${_cd_hex2})$")
+          _cd_error("invalid audioTrackFormatID")
+        endif()
+        set(type ${CMAKE_MATCH_1})
+        set(value ${CMAKE_MATCH_2})
+        set(counter ${CMAKE_MATCH_3})
+        _cd_check_format("${attr_formatLabel}" "${attr_formatDefinition}")
+        _cd_string("${attr_audioTrackFormatName}" name)
+        set(stream_ref -1)
+        set(context track)
+      else()
+        _cd_error("unsupported element")
+      endif()
+
+    elseif(context STREQUAL "pack")
+      if(kind STREQUAL "text" AND attributes STREQUAL ""
+         AND tag STREQUAL "audioChannelFormatIDRef")
+        _cd_index("${text}" index)
+        list(APPEND pack_channel_refs "${index},")
+        math(EXPR pack_channel_ref_count "${pack_channel_ref_count} + 1")
+      elseif(kind STREQUAL "text" AND attributes STREQUAL ""
+             AND tag STREQUAL "audioPackFormatIDRef")
+        _cd_index("${text}" index)
+        list(APPEND pack_pack_refs "${index},")
+        math(EXPR pack_pack_ref_count "${pack_pack_ref_count} + 1")
+      elseif(kind STREQUAL "close" AND tag STREQUAL "audioPackFormat")
+        list(APPEND pack_formats
+             "{${name}, 0x${type}, 0x${value}, {${channel_refs_begin}, ${pack_channel_ref_count}}, {${pack_refs_begin}, ${pack_pack_ref_count}}},")
+        set(context "")
+      else()
+        _cd_error("unsupported element")
+      endif()
+
+    elseif(context STREQUAL "channel")
+      if(kind STREQUAL "text" AND tag STREQUAL "frequency")
+        _cd_parse_attributes("${attributes}" attr typeDefinition)
+        if(attr_typeDefinition STREQUAL "lowPass")
+          _cd_float("${text}" low_pass)
+        elseif(attr_typeDefinition STREQUAL "highPass")
+          _cd_float("${text}" high_pass)
+        else()
+          _cd_error("unsupported frequency typeDefinition")
+        endif()
+      elseif(tag STREQUAL "audioBlockFormat"
+             AND (kind STREQUAL "open" OR kind STREQUAL "empty"))
+        _cd_parse_attributes("${attributes}" attr audioBlockFormatID)
+        if(NOT attr_audioBlockFormatID MATCHES
+           "^AB_(${_cd_hex4})(${_cd_hex4})_(${_cd_hex8})$")
+          _cd_error("invalid audioBlockFormatID")
+        endif()
+        string(TOUPPER "${type}${value}" channel_part)
+        string(TOUPPER "${CMAKE_MATCH_1}${CMAKE_MATCH_2}" block_part)
+        if(NOT block_part STREQUAL "${channel_part}")
+          _cd_error("audioBlockFormatID does not match audioChannelFormatID")
+        endif()
+        set(block_counter ${CMAKE_MATCH_3})
+        set(speaker_label nullptr)
+        set(azimuth "")
+        set(elevation "")
+        set(distance "")
+        set(horizontal_edge nullptr)
+        set(vertical_edge nullptr)
+        set(order "")
+        set(degree "")
+        set(normalization nullptr)
+        set(context block)
+      elseif(kind STREQUAL "close" AND tag STREQUAL "audioChannelFormat")
+        set(has_low_pass false)
+        set(has_high_pass false)
+        if(NOT low_pass STREQUAL "")
+          set(has_low_pass true)
+        else()
+          set(low_pass 0.f)
+        endif()
+        if(NOT high_pass STREQUAL "")
+          set(has_high_pass true)
+        else()
+          set(high_pass 0.f)
+        endif()
+        list(APPEND channel_formats
+             "{${name}, 0x${type}, 0x${value}, ${has_low_pass}, ${low_pass}, ${has_high_pass}, ${high_pass}, {${blocks_begin}, ${${block_table}_block_count}}},")
+        set(context "")
+      else()
+        _cd_error("unsupported element")
+      endif()
+
+    elseif(context STREQUAL "block")
+      if(kind STREQUAL "text" AND block_table STREQUAL "direct_speakers"
+         AND attributes STREQUAL "" AND tag STREQUAL "speakerLabel")
+        if(NOT speaker_label STREQUAL "nullptr")
+          _cd_error("multiple speakerLabels are not supported")
+        endif()
+        _cd_string("${text}" speaker_label)
+      elseif(kind STREQUAL "text" AND block_table STREQUAL "direct_speakers"
+             AND tag STREQUAL "position")
+        _cd_parse_attributes("${attributes}" attr coordinate screenEdgeLock)
+        if(attr_coordinate STREQUAL "azimuth")
+          _cd_float("${text}" azimuth)
+          if(NOT attr_screenEdgeLock STREQUAL "")
+            _cd_string("${attr_screenEdgeLock}" horizontal_edge)
+          endif()
+        elseif(attr_coordinate STREQUAL "elevation")
+          _cd_float("${text}" elevation)
+          if(NOT attr_screenEdgeLock STREQUAL "")
+            _cd_string("${attr_screenEdgeLock}" vertical_edge)
+          endif()
+        elseif(attr_coordinate STREQUAL "distance"
+               AND attr_screenEdgeLock STREQUAL "")
+          _cd_float("${text}" distance)
+        else()
+          _cd_error("unsupported position")
+        endif()
+      elseif(kind STREQUAL "text" AND block_table STREQUAL "hoa"
+             AND attributes STREQUAL "" AND tag STREQUAL "order")
+        _cd_int("${text}" order)
+      elseif(kind STREQUAL "text" AND block_table STREQUAL "hoa"
+             AND attributes STREQUAL "" AND tag STREQUAL "degree")
+        _cd_int("${text}" degree)
+      elseif(kind STREQUAL "text" AND block_table STREQUAL "hoa"
+             AND attributes STREQUAL "" AND tag STREQUAL "normalization")
+        _cd_string("${text}" normalization)
+      elseif(kind STREQUAL "close" AND tag STREQUAL "audioBlockFormat")
+        # handled below, together with empty audioBlockFormat elements
+      else()
+        _cd_error("unsupported element")
+      endif()
+
+    elseif(context STREQUAL "stream")
+      if(kind STREQUAL "text" AND attributes STREQUAL ""
+         AND tag STREQUAL "audioChannelFormatIDRef")
+        _cd_index("${text}" channel_ref)
+      elseif(kind STREQUAL "text" AND attributes STREQUAL ""
+             AND tag STREQUAL "audioPackFormatIDRef")
+        _cd_index("${text}" pack_ref)
+      elseif(kind STREQUAL "text" AND attributes STREQUAL ""
+             AND tag STREQUAL "audioTrackFormatIDRef")
+        _cd_index("${text}" index)
+        list(APPEND stream_track_refs "${index},")
+        math(EXPR stream_track_ref_count "${stream_track_ref_count} + 1")
+      elseif(kind STREQUAL "close" AND tag STREQUAL "audioStreamFormat")
+        list(APPEND stream_formats
+             "{${name}, 0x${type}, 0x${value}, ${channel_ref}, ${pack_ref}, {${track_refs_begin}, ${stream_track_ref_count}}},")
+        set(context "")
+      else()
+        _cd_error("unsupported element")
+      endif()
+
+    elseif(context STREQUAL "track")
+      if(kind STREQUAL "text" AND attributes STREQUAL ""
+         AND tag STREQUAL "audioStreamFormatIDRef")
+        _cd_index("${text}" stream_ref)
+      elseif(kind STREQUAL "close" AND tag STREQUAL "audioTrackFormat")
+        list(APPEND track_formats
+             "{${name}, 0x${type}, 0x${value}, 0x${counter}, ${stream_ref}},")
+        set(context "")
+      else()
+        _cd_error("unsupported element")
+      endif()
+    endif()
+
+    # finish the current audioBlockFormat
+    if(context STREQUAL "block" AND tag STREQUAL "audioBlockFormat"
+       AND (kind STREQUAL "close" OR kind STREQUAL "empty"))
+      if(block_table STREQUAL "direct_speakers")
+        if(azimuth STREQUAL "" OR elevation STREQUAL "")
+          _cd_error("audioBlockFormat needs an azimuth and elevation")
+        endif()
+        set(has_distance false)
+        if(NOT distance STREQUAL "")
+          set(has_distance true)
+        else()
+          set(distance 0.f)
+        endif()
+        list(APPEND direct_speakers_blocks
+             "{0x${block_counter}, ${speaker_label}, ${azimuth}, ${elevation}, ${has_distance}, ${distance}, ${horizontal_edge}, ${vertical_edge}},")
+      elseif(block_table STREQUAL "hoa")
+        if(order STREQUAL "" OR degree STREQUAL "")
+          _cd_error("audioBlockFormat needs an order and degree")
+        endif()
+        list(APPEND hoa_blocks
+             "{0x${block_counter}, ${order}, ${degree}, ${normalization}},")
+      else()
+        list(APPEND binaural_blocks "{0x${block_counter}},")
+      endif()
+      math(EXPR ${block_table}_block_count "${${block_table}_block_count} + 1")
+      set(context channel)
+    endif()
+  endforeach()
+
+  if(NOT context STREQUAL "")
+    set(line "")
+    _cd_error("unexpected end of file")
+  endif()
+
+  get_filename_component(COMPILE_INPUT_NAME "${COMPILE_INPUT}" NAME)
+  foreach(table pack_formats pack_channel_refs pack_pack_refs channel_formats
+                direct_speakers_blocks hoa_blocks binaural_blocks
+                stream_formats stream_track_refs track_formats)
+    string(TOUPPER ${table} upper)
+    list(LENGTH ${table} ${upper}_COUNT)
+    list(JOIN ${table} "\n" ${upper})
+  endforeach()
+
+  configure_file("${current_dir}/common_definitions_tables.cpp.in"
+                 "${COMPILE_OUTPUT}" @ONLY)
+endfunction()
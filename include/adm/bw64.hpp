@@ -0,0 +1,75 @@
+/// @file bw64.hpp
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+#include "adm/export.h"
+#include "adm/parse.hpp"
+
+namespace adm {
+
+  class Document;
+
+  /**
+   * @addtogroup xml
+   * @{
+   */
+
+  /**
+   * @brief One entry in the `chna` chunk of a BW64 file (ITU-R BS.2088)
+   *
+   * The IDs are as written in the file, without any padding.
+   */
+  struct ChnaEntry {
+    /// the track in the file that this refers to, starting from 1
+    std::uint16_t trackIndex = 0;
+    /// the audioTrackUID of the track
+    std::string audioTrackUid;
+    /// the audioTrackFormatID (or audioChannelFormatID) of the track
+    std::string trackRef;
+    /// the audioPackFormatID of the track
+    std::string packRef;
+  };
+
+  /// the ADM metadata in a BW64 file
+  struct Bw64Metadata {
+    /// the parsed `axml` chunk, or nullptr if there is none
+    std::shared_ptr<Document> document;
+    /// the entries of the `chna` chunk, which is empty if there is none
+    std::vector<ChnaEntry> chna;
+  };
+
+  /**
+   * @brief Read the ADM metadata from a BW64 (ITU-R BS.2088), RF64 or RIFF
+   * WAVE file
+   *
+   * Only the headers of the chunks in the file are read to find the `axml`
+   * and `chna` chunks, so the cost does not depend on the size of the audio
+   * data. The `axml` chunk is read into memory and parsed in place, as with
+   * `parseXml(char*, std::size_t, xml::ParserOptions)`.
+   *
+   * @param filename file to read
+   * @param options Options to influence the XML parser behaviour
+   * @throws std::runtime_error if the file can not be read, or is not a
+   * WAVE file
+   */
+  ADM_EXPORT Bw64Metadata parseBw64(
+      const std::string& filename,
+      xml::ParserOptions options = xml::ParserOptions::none);
+
+  /**
+   * @brief Read the ADM metadata from a BW64, RF64 or RIFF WAVE file
+   *
+   * As `parseBw64(const std::string&, xml::ParserOptions)`, but reading from
+   * a stream, which must support seeking.
+   */
+  ADM_EXPORT Bw64Metadata parseBw64(
+      std::istream& stream,
+      xml::ParserOptions options = xml::ParserOptions::none);
+
+  /**
+   * @}
+   */
+}  // namespace adm
@@ -0,0 +1,26 @@
+/// @file hash.hpp
+#pragma once
+#include <cstddef>
+#include <functional>
+
+namespace adm {
+  namespace detail {
+
+    /// mix the hash of value into seed, as boost::hash_combine does
+    template <typename T>
+    void hashCombine(std::size_t& seed, const T& value) {
+      seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    /// hash the underlying values of some NamedTypes, in order
+    template <typename... NamedTypes>
+    std::size_t hashNamedTypes(const NamedTypes&... values) {
+      std::size_t seed = 0;
+      // expand in order; the array is unused
+      int expand[] = {(hashCombine(seed, values.get()), 0)...};
+      (void)expand;
+      return seed;
+    }
+
+  }  // namespace detail
+}  // namespace adm
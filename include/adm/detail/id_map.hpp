@@ -1,5 +1,6 @@
 #include "adm/document.hpp"
 #include <memory>
+#include <unordered_map>
 
 namespace adm {
   namespace detail {
@@ -108,15 +109,22 @@ namespace adm {
       /// update the mapping to match the given document
       void update(Document &document) {
         id_to_element.clear();
+        id_to_element.reserve(document.getElements<Element>().size());
         for (const auto &el : document.getElements<Element>())
           id_to_element.emplace(el->template get<Id>(), el);
       }
 
+      /// remove all elements, keeping the memory allocated for the mapping
+      void clear() { id_to_element.clear(); }
+
       /// add a new element
       void add(std::shared_ptr<Element> element) {
         id_to_element.emplace(element->template get<Id>(), std::move(element));
       }
 
+      /// remove the element with a given ID, if there is one
+      void remove(const Id &id) { id_to_element.erase(id); }
+
       /// get an element with a given ID
       std::shared_ptr<Element> lookup(const Id &id) const {
         auto it = id_to_element.find(id);
@@ -132,7 +140,7 @@ namespace adm {
       }
 
      private:
-      std::map<Id, std::shared_ptr<Element>> id_to_element;
+      std::unordered_map<Id, std::shared_ptr<Element>> id_to_element;
     };
 
     /// mapping from IDs to elements for all top-level element types
@@ -147,12 +155,24 @@ namespace adm {
         idMaps.visit([&doc](auto &idMap) { idMap.update(doc); });
       }
 
+      /// remove all elements, keeping the memory allocated for the mapping
+      void clear() {
+        idMaps.visit([](auto &idMap) { idMap.clear(); });
+      }
+
       /// add a new element
       template <typename Element>
       void add(std::shared_ptr<Element> element) {
         idMaps.template get<Element>().add(std::move(element));
       }
 
+      /// remove the element with a given ID, if there is one
+      template <typename Id>
+      void remove(const Id &id) {
+        using Element = IdToElementT<Id>;
+        idMaps.template get<Element>().remove(id);
+      }
+
       /// get an element with a given ID
       template <typename Id>
       auto lookup(const Id &id) {
@@ -9,6 +9,14 @@ namespace adm {
   /// @brief Implementation details
   namespace detail {
 
+    /**
+     * @brief Tag to select the NamedType constructor which does not validate
+     *
+     * Only for use inside the library, with values which are already known to
+     * be valid, like constant defaults.
+     */
+    struct TrustedTag {};
+
     /**
      * @brief Named type class
      *
@@ -29,6 +37,8 @@ namespace adm {
       explicit NamedType(T&& value) : value_(std::move(value)) {
         Validator::validate(get());
       }
+      /// @brief Construct without calling the validator; see TrustedTag
+      NamedType(T value, TrustedTag) : value_(std::move(value)) {}
       T& get() { return value_; }
       T const& get() const { return value_; }
 
@@ -54,6 +54,7 @@
 #include "adm/elements/importance.hpp"
 #include "adm/elements/jump_position.hpp"
 #include "adm/elements/loudness_metadata.hpp"
+#include "adm/elements/matrix_coefficient.hpp"
 #include "adm/elements/object_divergence.hpp"
 #include "adm/elements/position.hpp"
 #include "adm/elements/position_types.hpp"
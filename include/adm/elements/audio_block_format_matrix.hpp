@@ -5,6 +5,7 @@
 #include "adm/elements/time.hpp"
 #include "adm/elements/audio_block_format_id.hpp"
 #include "adm/elements/common_parameters.hpp"
+#include "adm/elements/matrix_coefficient.hpp"
 #include "adm/elements_fwd.hpp"
 #include "adm/detail/named_option_helper.hpp"
 #include "adm/detail/named_type.hpp"
@@ -15,9 +16,23 @@ namespace adm {
 
   class Document;
 
+  /// @brief Tag for NamedType ::OutputChannelFormatId
+  struct OutputChannelFormatIdTag {};
+  /// @brief NamedType for the outputChannelFormatIDRef element of a Matrix
+  /// audioBlockFormat
+  using OutputChannelFormatId =
+      detail::NamedType<AudioChannelFormatId, OutputChannelFormatIdTag>;
+
   namespace detail {
+    extern template class ADM_EXPORT_TEMPLATE_METHODS
+        OptionalParameter<OutputChannelFormatId>;
+    extern template class ADM_EXPORT_TEMPLATE_METHODS
+        VectorParameter<MatrixCoefficients>;
+
     using AudioBlockFormatMatrixBase =
-        HasParameters<DefaultParameter<Gain>, DefaultParameter<Importance>>;
+        HasParameters<OptionalParameter<OutputChannelFormatId>,
+                      VectorParameter<MatrixCoefficients>,
+                      DefaultParameter<Gain>, DefaultParameter<Importance>>;
   }  // namespace detail
 
   /// @brief Tag for AudioBlockFormatMatrix
@@ -26,6 +41,32 @@ namespace adm {
    * @brief Class representation for ADM element audioBlockFormat if
    * audioChannelFormat.typeDefinition == "Matrix"
    *
+   * Supported parameters are as follows:
+   *
+   * \rst
+   * +--------------------------+-------------------------------+----------------------------+
+   * | ADM Parameter            | Parameter Type                | Pattern Type               |
+   * +==========================+===============================+============================+
+   * | audioBlockFormatId       | :class:`AudioBlockFormatId`   | :class:`RequiredParameter` |
+   * +--------------------------+-------------------------------+----------------------------+
+   * | rtime                    | :type:`Rtime`                 | :class:`DefaultParameter`  |
+   * +--------------------------+-------------------------------+----------------------------+
+   * | duration                 | :type:`Duration`              | :class:`OptionalParameter` |
+   * +--------------------------+-------------------------------+----------------------------+
+   * | outputChannelFormatIDRef | :type:`OutputChannelFormatId` | :class:`OptionalParameter` |
+   * +--------------------------+-------------------------------+----------------------------+
+   * | matrix                   | :type:`MatrixCoefficients`    | :class:`VectorParameter`   |
+   * +--------------------------+-------------------------------+----------------------------+
+   * | gain                     | :class:`Gain`                 | :class:`DefaultParameter`  |
+   * +--------------------------+-------------------------------+----------------------------+
+   * | importance               | :type:`Importance`            | :class:`DefaultParameter`  |
+   * +--------------------------+-------------------------------+----------------------------+
+   * \endrst
+   *
+   * Coefficients added one at a time with add() are checked against the
+   * existing ones, so for large matrices set() the whole MatrixCoefficients
+   * at once.
+   *
    * @warning This class has unsupported parameters
    *   - encodePackFormatIDRef
    *   - decodePackFormatIDRef
@@ -85,6 +126,8 @@ namespace adm {
     ADM_EXPORT void set(Duration duration);
 
     using detail::AudioBlockFormatMatrixBase::set;
+    using detail::AudioBlockFormatMatrixBase::add;
+    using detail::AudioBlockFormatMatrixBase::remove;
     /**
      * @brief ADM parameter unset template
      *
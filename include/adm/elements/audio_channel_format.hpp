@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <boost/optional.hpp>
 #include <boost/variant.hpp>
+#include <functional>
 #include <memory>
 #include <vector>
 #include "adm/elements/audio_block_format_binaural.hpp"
@@ -190,6 +191,14 @@ namespace adm {
      */
     ADM_EXPORT void clearAudioBlockFormats();
 
+    /**
+     * @brief Reserve space for AudioBlockFormats
+     *
+     * Reserves space for `count` audioBlockFormats of the type of this
+     * AudioChannelFormat, so that adding that many does not reallocate.
+     */
+    ADM_EXPORT void reserveAudioBlockFormats(std::size_t count);
+
     /**
      * @brief Print overview to ostream
      */
@@ -241,6 +250,18 @@ namespace adm {
     ADM_EXPORT bool add(detail::ParameterTraits<AudioBlockFormatBinaural>::tag,
                         const AudioBlockFormatBinaural &blockFormat);
 
+    /// add an audioBlockFormat whose counter need not follow on from the
+    /// last one; the parser uses this for the audioBlockFormats after one
+    /// which could not be parsed
+    ADM_EXPORT void addAfterGap(AudioBlockFormatDirectSpeakers blockFormat);
+    ADM_EXPORT void addAfterGap(AudioBlockFormatMatrix blockFormat);
+    ADM_EXPORT void addAfterGap(AudioBlockFormatObjects blockFormat);
+    ADM_EXPORT void addAfterGap(AudioBlockFormatHoa blockFormat);
+    ADM_EXPORT void addAfterGap(AudioBlockFormatBinaural blockFormat);
+    template <typename BlockFormat>
+    void addAfterGap(std::vector<BlockFormat> &blockFormats,
+                     BlockFormat blockFormat);
+
     template <typename BlockFormat>
     void assignId(BlockFormat &blockFormat, BlockFormat *previousBlock = nullptr);
 
@@ -282,6 +303,15 @@ namespace adm {
     BlockFormatsRange<AudioBlockFormatBinaural> get(
         detail::ParameterTraits<AudioBlockFormatBinaural>::tag);
 
+    // ----- Lazy AudioBlockFormats ----- //
+    using AudioBlockFormatLoader = std::function<void(AudioChannelFormat &)>;
+
+    /// set a function to add the audioBlockFormats the first time they are
+    /// needed
+    ADM_EXPORT void setAudioBlockFormatLoader(AudioBlockFormatLoader loader);
+    /// run and clear the loader, if there is one
+    ADM_EXPORT void loadAudioBlockFormats() const;
+
     // ----- Common ----- //
     ADM_EXPORT void setParent(std::weak_ptr<Document> document);
 
@@ -297,6 +327,12 @@ namespace adm {
     std::vector<AudioBlockFormatObjects> audioBlockFormatsObjects_;
     std::vector<AudioBlockFormatHoa> audioBlockFormatsHoa_;
     std::vector<AudioBlockFormatBinaural> audioBlockFormatsBinaural_;
+    /// the loader set by setAudioBlockFormatLoader(), with a mutex so that
+    /// it is only run once when const getters are called from several
+    /// threads; this is accessed atomically, and reset once loaded
+    struct AudioBlockFormatLoaderState;
+    mutable std::shared_ptr<AudioBlockFormatLoaderState>
+        audioBlockFormatLoader_;
   };
 
   // ---- Implementation ---- //
@@ -4,6 +4,7 @@
 #include <boost/optional.hpp>
 #include <string>
 #include "adm/elements/type_descriptor.hpp"
+#include "adm/detail/hash.hpp"
 #include "adm/detail/named_option_helper.hpp"
 #include "adm/detail/named_type.hpp"
 #include "adm/export.h"
@@ -151,3 +152,13 @@ namespace adm {
   }
 
 }  // namespace adm
+
+namespace std {
+  /// @brief Hash for AudioObjectId, consistent with operator==
+  template <>
+  struct hash<adm::AudioObjectId> {
+    std::size_t operator()(const adm::AudioObjectId& id) const {
+      return adm::detail::hashNamedTypes(id.get<adm::AudioObjectIdValue>());
+    }
+  };
+}  // namespace std
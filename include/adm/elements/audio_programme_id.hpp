@@ -4,6 +4,7 @@
 #include <boost/optional.hpp>
 #include <string>
 #include "adm/elements/type_descriptor.hpp"
+#include "adm/detail/hash.hpp"
 #include "adm/detail/named_option_helper.hpp"
 #include "adm/detail/named_type.hpp"
 #include "adm/export.h"
@@ -152,3 +153,13 @@ namespace adm {
   }
 
 }  // namespace adm
+
+namespace std {
+  /// @brief Hash for AudioProgrammeId, consistent with operator==
+  template <>
+  struct hash<adm::AudioProgrammeId> {
+    std::size_t operator()(const adm::AudioProgrammeId& id) const {
+      return adm::detail::hashNamedTypes(id.get<adm::AudioProgrammeIdValue>());
+    }
+  };
+}  // namespace std
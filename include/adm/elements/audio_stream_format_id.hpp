@@ -4,6 +4,7 @@
 #include <boost/optional.hpp>
 #include <string>
 #include "adm/elements/type_descriptor.hpp"
+#include "adm/detail/hash.hpp"
 #include "adm/detail/named_option_helper.hpp"
 #include "adm/detail/named_type.hpp"
 #include "adm/export.h"
@@ -161,3 +162,15 @@ namespace adm {
   }
 
 }  // namespace adm
+
+namespace std {
+  /// @brief Hash for AudioStreamFormatId, consistent with operator==
+  template <>
+  struct hash<adm::AudioStreamFormatId> {
+    std::size_t operator()(const adm::AudioStreamFormatId& id) const {
+      return adm::detail::hashNamedTypes(
+          id.get<adm::TypeDescriptor>(),
+          id.get<adm::AudioStreamFormatIdValue>());
+    }
+  };
+}  // namespace std
@@ -4,6 +4,7 @@
 #include <boost/optional.hpp>
 #include <string>
 #include "adm/elements/type_descriptor.hpp"
+#include "adm/detail/hash.hpp"
 #include "adm/detail/named_option_helper.hpp"
 #include "adm/detail/named_type.hpp"
 #include "adm/export.h"
@@ -178,3 +179,15 @@ namespace adm {
   }
 
 }  // namespace adm
+
+namespace std {
+  /// @brief Hash for AudioTrackFormatId, consistent with operator==
+  template <>
+  struct hash<adm::AudioTrackFormatId> {
+    std::size_t operator()(const adm::AudioTrackFormatId& id) const {
+      return adm::detail::hashNamedTypes(
+          id.get<adm::TypeDescriptor>(), id.get<adm::AudioTrackFormatIdValue>(),
+          id.get<adm::AudioTrackFormatIdCounter>());
+    }
+  };
+}  // namespace std
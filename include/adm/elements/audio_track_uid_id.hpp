@@ -4,6 +4,7 @@
 #include <boost/optional.hpp>
 #include <string>
 #include "adm/elements/type_descriptor.hpp"
+#include "adm/detail/hash.hpp"
 #include "adm/detail/named_option_helper.hpp"
 #include "adm/detail/named_type.hpp"
 #include "adm/export.h"
@@ -152,3 +153,13 @@ namespace adm {
   }
 
 }  // namespace adm
+
+namespace std {
+  /// @brief Hash for AudioTrackUidId, consistent with operator==
+  template <>
+  struct hash<adm::AudioTrackUidId> {
+    std::size_t operator()(const adm::AudioTrackUidId& id) const {
+      return adm::detail::hashNamedTypes(id.get<adm::AudioTrackUidIdValue>());
+    }
+  };
+}  // namespace std
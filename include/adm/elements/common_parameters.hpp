@@ -14,7 +14,7 @@ namespace adm {
   namespace detail {
     template <>
     inline Importance getDefault<Importance>() {
-      return Importance{10};
+      return Importance{10, TrustedTag{}};
     }
 
     template <>
@@ -20,7 +20,7 @@ namespace adm {
     /// @brief default value for DirectToReverberantRatio is +130dB
     template <>
     inline DirectToReverberantRatio getDefault<DirectToReverberantRatio>() {
-      return DirectToReverberantRatio(130);
+      return DirectToReverberantRatio(130, TrustedTag{});
     }
 
     extern template class ADM_EXPORT_TEMPLATE_METHODS DefaultParameter<Bypass>;
@@ -127,6 +127,9 @@ namespace adm {
   ADM_EXPORT void disable(JumpPosition &jumpPosition);
 
   /// @brief Parse interpolationLength
+  ///
+  /// The value is read as an xs:float in seconds, independent of the locale.
+  /// @throws std::invalid_argument if length is not a number
   ADM_EXPORT InterpolationLength
   parseInterpolationLength(const std::string &length);
   /// @brief Format interpolationLength
@@ -0,0 +1,212 @@
+/// @file matrix_coefficient.hpp
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include "adm/elements/audio_channel_format_id.hpp"
+#include "adm/elements/gain.hpp"
+#include "adm/detail/named_option_helper.hpp"
+#include "adm/detail/named_type.hpp"
+#include "adm/detail/type_traits.hpp"
+#include "adm/export.h"
+
+namespace adm {
+
+  /// @brief Tag for NamedType ::Phase
+  struct PhaseTag {};
+  /// @brief NamedType for the phase attribute of a matrix coefficient, in
+  /// degrees
+  using Phase = detail::NamedType<float, PhaseTag>;
+  /// @brief Tag for NamedType ::Delay
+  struct DelayTag {};
+  /// @brief NamedType for the delay attribute of a matrix coefficient, in
+  /// milliseconds
+  using Delay = detail::NamedType<float, DelayTag>;
+
+  /// @brief Tag for MatrixCoefficient class
+  struct MatrixCoefficientTag {};
+  /**
+   * @brief ADM parameter class to specify one coefficient element of a
+   * Matrix audioBlockFormat
+   *
+   * The referenced input audioChannelFormat is held by ID rather than as a
+   * reference to the element. Coefficients are stored by value with a bit
+   * for each optional parameter, so a block holds all of its coefficients in
+   * one contiguous vector.
+   *
+   * Supported parameters are as follows:
+   *
+   * \rst
+   * +-------------------------+-------------------------------+------------+
+   * | ADM Parameter           | Parameter Type                | Default    |
+   * +=========================+===============================+============+
+   * | inputChannelFormatIDRef | :class:`AudioChannelFormatId` | (required) |
+   * +-------------------------+-------------------------------+------------+
+   * | gain                    | :class:`Gain`                 | 1.0        |
+   * +-------------------------+-------------------------------+------------+
+   * | phase                   | :type:`Phase`                 | 0.0        |
+   * +-------------------------+-------------------------------+------------+
+   * | delay                   | :type:`Delay`                 | 0.0        |
+   * +-------------------------+-------------------------------+------------+
+   * \endrst
+   *
+   * @warning This class has unsupported parameters
+   *   - gainVar
+   *   - phaseVar
+   *   - delayVar
+   */
+  class MatrixCoefficient {
+   public:
+    typedef MatrixCoefficientTag tag;
+
+    /**
+     * @brief Constructor template
+     *
+     * Templated constructor which accepts a variable number of ADM parameters
+     * in random order after the mandatory ADM parameters.
+     */
+    template <typename... Parameters>
+    explicit MatrixCoefficient(AudioChannelFormatId inputChannelFormatId,
+                               Parameters... optionalNamedArgs);
+
+    /**
+     * @brief ADM parameter getter template
+     *
+     * Templated getter with the wanted ADM parameter type as template
+     * argument. If currently no value is available trying to get the adm
+     * parameter will result in an exception. Check with the has method before
+     */
+    template <typename Parameter>
+    Parameter get() const;
+
+    /**
+     * @brief ADM parameter has template
+     *
+     * Templated has method with the ADM parameter type as template argument.
+     * Returns true if the ADM parameter is set or has a default value.
+     */
+    template <typename Parameter>
+    bool has() const;
+
+    /**
+     * @brief ADM parameter isDefault template
+     *
+     * Templated isDefault method with the ADM parameter type as template
+     * argument. Returns true if the ADM parameter is the default value.
+     */
+    template <typename Parameter>
+    bool isDefault() const;
+
+    /// @brief AudioChannelFormatId (inputChannelFormatIDRef) setter
+    ADM_EXPORT void set(AudioChannelFormatId inputChannelFormatId);
+    /// @brief Gain setter
+    ADM_EXPORT void set(Gain gain);
+    /// @brief Phase setter
+    ADM_EXPORT void set(Phase phase);
+    /// @brief Delay setter
+    ADM_EXPORT void set(Delay delay);
+
+    /**
+     * @brief ADM parameter unset template
+     *
+     * Templated unset method with the ADM parameter type as template
+     * argument. Removes an ADM parameter if it is optional or resets it to
+     * the default value if there is one.
+     */
+    template <typename Parameter>
+    void unset();
+
+    /**
+     * @brief Print overview to ostream
+     */
+    ADM_EXPORT void print(std::ostream &os) const;
+
+   private:
+    ADM_EXPORT AudioChannelFormatId
+        get(detail::ParameterTraits<AudioChannelFormatId>::tag) const;
+    ADM_EXPORT Gain get(detail::ParameterTraits<Gain>::tag) const;
+    ADM_EXPORT Phase get(detail::ParameterTraits<Phase>::tag) const;
+    ADM_EXPORT Delay get(detail::ParameterTraits<Delay>::tag) const;
+
+    ADM_EXPORT bool has(
+        detail::ParameterTraits<AudioChannelFormatId>::tag) const;
+    ADM_EXPORT bool has(detail::ParameterTraits<Gain>::tag) const;
+    ADM_EXPORT bool has(detail::ParameterTraits<Phase>::tag) const;
+    ADM_EXPORT bool has(detail::ParameterTraits<Delay>::tag) const;
+
+    template <typename Tag>
+    bool isDefault(Tag) const {
+      return false;
+    }
+    ADM_EXPORT bool isDefault(detail::ParameterTraits<Gain>::tag) const;
+    ADM_EXPORT bool isDefault(detail::ParameterTraits<Phase>::tag) const;
+    ADM_EXPORT bool isDefault(detail::ParameterTraits<Delay>::tag) const;
+
+    ADM_EXPORT void unset(detail::ParameterTraits<Gain>::tag);
+    ADM_EXPORT void unset(detail::ParameterTraits<Phase>::tag);
+    ADM_EXPORT void unset(detail::ParameterTraits<Delay>::tag);
+
+    /// bits of flags_
+    enum : std::uint8_t {
+      gainSet = 1,
+      gainIsDb = 2,
+      phaseSet = 4,
+      delaySet = 8,
+    };
+
+    AudioChannelFormatId inputChannelFormatId_;
+    double gain_ = 1.0;
+    float phase_ = 0.0f;
+    float delay_ = 0.0f;
+    std::uint8_t flags_ = 0;
+  };
+
+  /// @brief Tag for MatrixCoefficients
+  struct MatrixCoefficientsTag {};
+  /// @brief The coefficients of a Matrix audioBlockFormat
+  using MatrixCoefficients = std::vector<MatrixCoefficient>;
+  ADD_TRAIT(MatrixCoefficients, MatrixCoefficientsTag);
+
+  /// @brief Compare two MatrixCoefficients, including which parameters are
+  /// defaults
+  ADM_EXPORT bool operator==(const MatrixCoefficient &lhs,
+                             const MatrixCoefficient &rhs);
+  ADM_EXPORT bool operator!=(const MatrixCoefficient &lhs,
+                             const MatrixCoefficient &rhs);
+
+  // ---- Implementation ---- //
+
+  template <typename... Parameters>
+  MatrixCoefficient::MatrixCoefficient(
+      AudioChannelFormatId inputChannelFormatId,
+      Parameters... optionalNamedArgs)
+      : inputChannelFormatId_(inputChannelFormatId) {
+    detail::setNamedOptionHelper(this, std::move(optionalNamedArgs)...);
+  }
+
+  template <typename Parameter>
+  Parameter MatrixCoefficient::get() const {
+    typedef typename detail::ParameterTraits<Parameter>::tag Tag;
+    return get(Tag());
+  }
+
+  template <typename Parameter>
+  bool MatrixCoefficient::has() const {
+    typedef typename detail::ParameterTraits<Parameter>::tag Tag;
+    return has(Tag());
+  }
+
+  template <typename Parameter>
+  bool MatrixCoefficient::isDefault() const {
+    typedef typename detail::ParameterTraits<Parameter>::tag Tag;
+    return isDefault(Tag());
+  }
+
+  template <typename Parameter>
+  void MatrixCoefficient::unset() {
+    typedef typename detail::ParameterTraits<Parameter>::tag Tag;
+    return unset(Tag());
+  }
+
+}  // namespace adm
@@ -15,6 +15,10 @@
 
 namespace adm {
 
+  namespace xml {
+    class XmlParser;
+  }  // namespace xml
+
   class AudioProgrammeAttorney {
    private:
     friend class Document;
@@ -67,12 +71,25 @@ namespace adm {
     friend class Document;
     friend class AudioPackFormat;
     friend class AudioStreamFormat;
+    friend class xml::XmlParser;
 
     static void setParent(
         const std::shared_ptr<AudioChannelFormat>& channelFormat,
         std::weak_ptr<Document> parent) {
       channelFormat->setParent(std::move(parent));
     }
+
+    static void setAudioBlockFormatLoader(
+        AudioChannelFormat& channelFormat,
+        AudioChannelFormat::AudioBlockFormatLoader loader) {
+      channelFormat.setAudioBlockFormatLoader(std::move(loader));
+    }
+
+    template <typename BlockFormat>
+    static void addAfterGap(AudioChannelFormat& channelFormat,
+                            BlockFormat blockFormat) {
+      channelFormat.addAfterGap(std::move(blockFormat));
+    }
   };
 
   class AudioStreamFormatAttorney {
@@ -52,6 +52,9 @@ namespace adm {
                                boost::optional<int> line = boost::none);
       explicit XmlParsingError(int line);
 
+      /// the line on which the error was found, counted from the root element
+      boost::optional<int> line() const { return line_; }
+
      private:
       std::string formatMessage(const std::string& message,
                                 boost::optional<int> line) const;
@@ -86,6 +89,12 @@ namespace adm {
                                        const std::string& value);
     };
 
+    /// thrown by the parser when its CancellationToken has been cancelled
+    class ADM_EXPORT ParsingCancelled : public AdmException {
+     public:
+      ParsingCancelled();
+    };
+
     namespace detail {
 
       /**
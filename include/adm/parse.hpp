@@ -1,14 +1,22 @@
 /// @file xml_parser.hpp
 #pragma once
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
 #include <string>
 #include <memory>
 #include <iosfwd>
+#include <vector>
+#include <boost/optional.hpp>
 #include "adm/detail/enum_bitmask.hpp"
 #include "adm/export.h"
 
 namespace adm {
 
   class Document;
+  class AudioProgrammeId;
 
   namespace xml {
     /**
@@ -33,6 +41,36 @@ namespace adm {
       none = 0x0,  ///< default behaviour
       recursive_node_search =
           0x1,  ///< recursively search whole xml for audioFormatExtended node
+      streaming = 0x2,  ///< read the input incrementally, holding only the
+                        ///< element being parsed in memory rather than the
+                        ///< whole document
+      memory_map = 0x4,  ///< when parsing a file, map it into memory rather
+                         ///< than reading it into a buffer; this has no effect
+                         ///< on streams or with streaming
+      parallel = 0x8,  ///< build the elements on multiple threads once the
+                       ///< document has been read; the result is the same as
+                       ///< without this option. This has no effect with
+                       ///< streaming
+      skip_audio_block_formats = 0x10,  ///< do not parse audioBlockFormats;
+                                        ///< audioChannelFormats will have
+                                        ///< none
+      first_audio_block_format_only =
+          0x20,  ///< only parse the first audioBlockFormat of each
+                 ///< audioChannelFormat
+      lazy_audio_block_formats =
+          0x40,  ///< parse the audioBlockFormats of each audioChannelFormat
+                 ///< the first time they are accessed. A copy of the whole
+                 ///< input is kept for as long as any audioChannelFormat has
+                 ///< not been loaded. With memory_map, a second mapping of
+                 ///< the file is kept instead, so the parts of it which are
+                 ///< never loaded take no memory; the file must then not be
+                 ///< changed until all of the blocks have been loaded, as
+                 ///< they would be parsed from the changed file, or if it is
+                 ///< shortened, the process may crash (SIGBUS). On Windows,
+                 ///< the file can not be replaced or deleted while it is
+                 ///< mapped. Errors in audioBlockFormats are thrown from the
+                 ///< access rather than from parseXml. This has no effect
+                 ///< with streaming
     };
   }  // namespace xml
 
@@ -64,6 +102,522 @@ namespace adm {
       std::istream& stream,
       xml::ParserOptions options = xml::ParserOptions::none);
 
+  /**
+   * @brief Parse an XML representation of the Audio Definition Model in
+   * place
+   *
+   * Parse adm data from a buffer in memory, without copying it. The buffer
+   * is modified during parsing, and its contents are unspecified afterwards.
+   *
+   * `ParserOptions::streaming` and `ParserOptions::memory_map` have no effect.
+   * @param data XML data to parse; `data[size]` must be a null terminator
+   * @param size size of the data, excluding the terminator
+   * @param options Options to influence the XML parser behaviour
+   * @throws std::invalid_argument if `data[size]` is not a null terminator
+   */
+  ADM_EXPORT std::shared_ptr<Document> parseXml(
+      char* data, std::size_t size,
+      xml::ParserOptions options = xml::ParserOptions::none);
+
+  /**
+   * @brief Parse an XML representation of the Audio Definition Model
+   *
+   * As `parseXml(char*, std::size_t, ParserOptions)`, but the data is copied
+   * once and not modified, and need not be null-terminated.
+   * @param data XML data to parse
+   * @param size size of the data
+   * @param options Options to influence the XML parser behaviour
+   */
+  ADM_EXPORT std::shared_ptr<Document> parseXml(
+      const char* data, std::size_t size,
+      xml::ParserOptions options = xml::ParserOptions::none);
+
+  /**
+   * @brief Parse the elements of one audioProgramme from an XML
+   * representation of the Audio Definition Model
+   *
+   * Only the audioProgramme with the given ID and the elements reachable
+   * from it through references are parsed; everything else in the
+   * audioFormatExtended element is skipped without being checked. Elements
+   * are matched by the IDs written in the document, ignoring the case of
+   * hex digits.
+   *
+   * This cannot be used with `ParserOptions::streaming`, as the references
+   * must be known before elements are parsed.
+   *
+   * @param filename XML file to read and parse
+   * @param programmeId ID of the audioProgramme to parse
+   * @param options Options to influence the XML parser behaviour
+   * @throws error::XmlParsingError if there is no audioProgramme with
+   * the given ID
+   */
+  ADM_EXPORT std::shared_ptr<Document> parseXml(
+      const std::string& filename, const AudioProgrammeId& programmeId,
+      xml::ParserOptions options = xml::ParserOptions::none);
+
+  /**
+   * @brief Parse the elements of one audioProgramme from an XML
+   * representation of the Audio Definition Model
+   *
+   * As `parseXml(const std::string&, const AudioProgrammeId&, ParserOptions)`,
+   * but reading from an `std::istream`.
+   */
+  ADM_EXPORT std::shared_ptr<Document> parseXml(
+      std::istream& stream, const AudioProgrammeId& programmeId,
+      xml::ParserOptions options = xml::ParserOptions::none);
+
+  /// a problem found by parseXmlCollectingErrors()
+  struct ParseDiagnostic {
+    /// description of the problem, as would have been thrown by parseXml()
+    std::string message;
+    /// the line of the problem, counted from the root element, if known
+    boost::optional<int> line;
+    /// the exception that parseXml() would have thrown
+    std::exception_ptr error;
+  };
+
+  /// the result of parseXmlCollectingErrors()
+  struct ParseResult {
+    /// the elements that could be parsed, or nullptr if the XML could not be
+    /// parsed at all
+    std::shared_ptr<Document> document;
+    /// the problems found, in the order they were found
+    std::vector<ParseDiagnostic> diagnostics;
+  };
+
+  /**
+   * @brief Parse an XML representation of the Audio Definition Model,
+   * collecting all of the problems found rather than throwing at the first
+   *
+   * Where parseXml() would throw, this records a ParseDiagnostic and
+   * carries on:
+   *
+   * - a top-level element which can not be parsed (e.g. because of a bad
+   *   value or a duplicate ID) is left out of the document, along with its
+   *   references;
+   * - an audioBlockFormat which can not be parsed is left out of its
+   *   audioChannelFormat;
+   * - unresolved references, and references which can not be set (e.g.
+   *   because they would make a cycle), are left unset.
+   *
+   * If the XML is not well-formed, or audioFormatExtended can not be found,
+   * the result has one diagnostic and no document.
+   *
+   * Lines are found from an index of the input built before it is parsed, so
+   * each diagnostic costs the same however large the document is.
+   *
+   * `ParserOptions::parallel` has no effect, and deferred audioBlockFormats
+   * (`ParserOptions::lazy_audio_block_formats`) still throw when loaded.
+   *
+   * @param filename XML file to read and parse
+   * @param options Options to influence the XML parser behaviour
+   * @throws std::invalid_argument with `ParserOptions::streaming`, which is
+   * not supported
+   * @throws std::runtime_error if the file can not be read
+   */
+  ADM_EXPORT ParseResult parseXmlCollectingErrors(
+      const std::string& filename,
+      xml::ParserOptions options = xml::ParserOptions::none);
+
+  /**
+   * @brief Parse an XML representation of the Audio Definition Model,
+   * collecting all of the problems found rather than throwing at the first
+   *
+   * As `parseXmlCollectingErrors(const std::string&, ParserOptions)`, but
+   * reading from an `std::istream`.
+   */
+  ADM_EXPORT ParseResult parseXmlCollectingErrors(
+      std::istream& stream,
+      xml::ParserOptions options = xml::ParserOptions::none);
+
+  /// the phases of parsing a document, in order
+  enum class ParsePhase {
+    /// reading a file into memory; this is skipped for buffers, streams, and
+    /// with ParserOptions::memory_map or ParserOptions::streaming
+    read,
+    /// building the XML DOM, or with ParserOptions::streaming, reading the
+    /// input and building elements together
+    dom,
+    /// building the ADM elements from the DOM
+    elements,
+    /// resolving references between the elements
+    references
+  };
+
+  /**
+   * @brief Progress reported while parsing
+   *
+   * Totals are 0 if they are not known, e.g. the size of a stream being
+   * parsed with ParserOptions::streaming.
+   */
+  struct ParseProgress {
+    ParsePhase phase;
+    /// bytes of input read (in ParsePhase::read) or tokenized so far, and
+    /// the size of the input
+    std::size_t bytes;
+    std::size_t totalBytes;
+    /// top-level elements built so far in ParsePhase::dom and
+    /// ParsePhase::elements, or references resolved so far in
+    /// ParsePhase::references, and the number there are to do
+    std::size_t elements;
+    std::size_t totalElements;
+  };
+
+  /**
+   * @brief Called with the progress of a parse
+   *
+   * This is called on the thread doing the parsing, at the start and end of
+   * each phase and regularly in between. The exception is ParsePhase::dom
+   * without ParserOptions::streaming: the DOM is built in one step, so this is
+   * only called at its start and end. It may throw to abandon the parse.
+   */
+  using ProgressCallback = std::function<void(const ParseProgress&)>;
+
+  /**
+   * @brief A flag to ask a parse to stop
+   *
+   * Copies share the same flag, so one copy can be given to a parse, and
+   * another cancelled from any thread. The parser checks the flag between
+   * blocks of a file being read, top-level elements and batches of
+   * audioBlockFormats, and throws error::ParsingCancelled if it is set.
+   * Building the XML DOM (without ParserOptions::streaming) can not be
+   * interrupted, so it is only checked before and after that.
+   */
+  class CancellationToken {
+   public:
+    CancellationToken() : cancelled_(std::make_shared<std::atomic<bool>>()) {}
+
+    void cancel() { cancelled_->store(true); }
+    bool isCancelled() const { return cancelled_->load(); }
+
+   private:
+    std::shared_ptr<std::atomic<bool>> cancelled_;
+  };
+
+  /**
+   * @brief Parse an XML file on another thread
+   *
+   * The file is parsed as by `parseXml(const std::string&, ParserOptions)`
+   * on a new thread, and the result or error is returned through the future.
+   *
+   * @param filename XML file to read and parse
+   * @param options Options to influence the XML parser behaviour
+   * @param progress called with the progress of the parse, on the parsing
+   * thread
+   * @param cancellation cancel this to stop the parse early, in which case
+   * the future holds error::ParsingCancelled
+   */
+  ADM_EXPORT std::future<std::shared_ptr<Document>> parseXmlAsync(
+      const std::string& filename,
+      xml::ParserOptions options = xml::ParserOptions::none,
+      ProgressCallback progress = nullptr,
+      CancellationToken cancellation = CancellationToken());
+
+  /**
+   * @brief Parse an XML document in memory on another thread
+   *
+   * As `parseXmlAsync(const std::string&, ...)`, but parsing a copy of a
+   * buffer, which may be freed once this returns.
+   */
+  ADM_EXPORT std::future<std::shared_ptr<Document>> parseXmlAsync(
+      const char* data, std::size_t size,
+      xml::ParserOptions options = xml::ParserOptions::none,
+      ProgressCallback progress = nullptr,
+      CancellationToken cancellation = CancellationToken());
+
+  namespace xml {
+    struct ParserScratch;
+  }  // namespace xml
+
+  /**
+   * @brief Storage for parsing many documents one after another
+   *
+   * Parsing allocates memory for the XML DOM, an index of elements by ID,
+   * unresolved references and a copy of the input, all of which is freed
+   * again once the Document has been built. A ParserContext keeps this
+   * memory between calls to its `parseXml` functions, so that parsing a
+   * sequence of similar documents mostly only allocates the Documents
+   * themselves.
+   *
+   * The `parseXml` functions behave exactly like the free functions with
+   * the same arguments. A ParserContext must not be used by more than one
+   * thread at a time.
+   */
+  class ParserContext {
+   public:
+    ADM_EXPORT ParserContext();
+    ADM_EXPORT ~ParserContext();
+
+    ParserContext(const ParserContext&) = delete;
+    ParserContext& operator=(const ParserContext&) = delete;
+
+    /// see adm::parseXml(const std::string&, xml::ParserOptions)
+    ADM_EXPORT std::shared_ptr<Document> parseXml(
+        const std::string& filename,
+        xml::ParserOptions options = xml::ParserOptions::none);
+
+    /// see adm::parseXml(std::istream&, xml::ParserOptions)
+    ADM_EXPORT std::shared_ptr<Document> parseXml(
+        std::istream& stream,
+        xml::ParserOptions options = xml::ParserOptions::none);
+
+    /// see adm::parseXml(char*, std::size_t, xml::ParserOptions)
+    ADM_EXPORT std::shared_ptr<Document> parseXml(
+        char* data, std::size_t size,
+        xml::ParserOptions options = xml::ParserOptions::none);
+
+    /// see adm::parseXml(const char*, std::size_t, xml::ParserOptions)
+    ADM_EXPORT std::shared_ptr<Document> parseXml(
+        const char* data, std::size_t size,
+        xml::ParserOptions options = xml::ParserOptions::none);
+
+   private:
+    std::unique_ptr<xml::ParserScratch> scratch_;
+  };
+
+  namespace detail {
+    class IDMap;
+    class ThreadPool;
+  }  // namespace detail
+
+  /// the result of parsing one input of a batch; see BatchParser
+  struct BatchParseResult {
+    /// the parsed document, or nullptr if parsing failed
+    std::shared_ptr<Document> document;
+    /// the exception that parsing threw, if any
+    std::exception_ptr error;
+  };
+
+  /// an XML document in memory, which need not be null-terminated
+  struct XmlBuffer {
+    const char* data;
+    std::size_t size;
+  };
+
+  /**
+   * @brief Parse many documents concurrently on a pool of threads
+   *
+   * Each thread keeps its own parser storage (as in ParserContext) between
+   * documents and between calls, and the common definitions are shared by
+   * all of them, so parsing a large number of documents costs little more
+   * than parsing the documents themselves.
+   *
+   * Results are returned in the same order as the inputs. An input that can
+   * not be parsed gives a result holding the exception, and does not affect
+   * the others.
+   *
+   * `ParserOptions::parallel` should not normally be used with this, as
+   * the documents are already spread across threads. A BatchParser must not
+   * be used by more than one thread at a time.
+   */
+  class BatchParser {
+   public:
+    /**
+     * @param threads the number of threads to parse on, including the
+     * calling thread; 0 means one per core
+     */
+    ADM_EXPORT explicit BatchParser(unsigned threads = 0);
+    ADM_EXPORT ~BatchParser();
+
+    BatchParser(const BatchParser&) = delete;
+    BatchParser& operator=(const BatchParser&) = delete;
+
+    /// the number of threads used, including the calling thread
+    ADM_EXPORT unsigned threads() const;
+
+    /// parse XML files; see adm::parseXml(const std::string&,
+    /// xml::ParserOptions)
+    ADM_EXPORT std::vector<BatchParseResult> parseXml(
+        const std::vector<std::string>& filenames,
+        xml::ParserOptions options = xml::ParserOptions::none);
+
+    /// parse XML documents in memory; see adm::parseXml(const char*,
+    /// std::size_t, xml::ParserOptions)
+    ADM_EXPORT std::vector<BatchParseResult> parseXml(
+        const std::vector<XmlBuffer>& buffers,
+        xml::ParserOptions options = xml::ParserOptions::none);
+
+   private:
+    std::unique_ptr<detail::ThreadPool> pool_;
+    /// parser storage for each thread
+    std::vector<std::unique_ptr<xml::ParserScratch>> scratch_;
+  };
+
+  /**
+   * @brief Parse XML through a cache of parsed documents on disk
+   *
+   * Parsed documents are stored in a compact binary form in a local
+   * directory, keyed by a hash of the input bytes and the ParserOptions.
+   * When the same input is parsed again with the same options, the document
+   * is loaded from the cache instead of being parsed, so repeat parses cost
+   * little more than reading the input and the cache entry.
+   *
+   * An entry is only used if its input size, options, library version and
+   * common definitions all match, and a checksum of its contents is
+   * correct; otherwise the input is parsed and the entry is replaced.
+   * Failing to write an entry is not an error. Entries are written to a
+   * temporary file and renamed into place, so a cache directory can be
+   * shared by several processes.
+   *
+   * Documents are the same as those returned by adm::parseXml(), except that
+   * `ParserOptions::lazy_audio_block_formats` is not supported through the
+   * cache; inputs parsed with it are always parsed directly.
+   *
+   * A ParseCache may be used by more than one thread at a time.
+   */
+  class ParseCache {
+   public:
+    /**
+     * @param directory the directory to store entries in; this is created
+     * if it does not exist, but its parent must exist
+     */
+    ADM_EXPORT explicit ParseCache(std::string directory);
+
+    /// parse an XML file; see adm::parseXml(const std::string&,
+    /// xml::ParserOptions)
+    ADM_EXPORT std::shared_ptr<Document> parseXml(
+        const std::string& filename,
+        xml::ParserOptions options = xml::ParserOptions::none);
+
+    /// parse XML from a stream; the whole stream is read to find the entry
+    ADM_EXPORT std::shared_ptr<Document> parseXml(
+        std::istream& stream,
+        xml::ParserOptions options = xml::ParserOptions::none);
+
+    /// parse an XML document in memory, which need not be null-terminated
+    ADM_EXPORT std::shared_ptr<Document> parseXml(
+        const char* data, std::size_t size,
+        xml::ParserOptions options = xml::ParserOptions::none);
+
+    /// the path of the entry that would be used for the given input
+    ADM_EXPORT std::string entryPath(
+        const char* data, std::size_t size,
+        xml::ParserOptions options = xml::ParserOptions::none) const;
+
+    /// the number of documents loaded from the cache
+    std::size_t hits() const { return hits_; }
+    /// the number of documents which had to be parsed
+    std::size_t misses() const { return misses_; }
+
+   private:
+    std::shared_ptr<Document> parse(char* data, std::size_t size,
+                                    xml::ParserOptions options);
+
+    std::string directory_;
+    std::atomic<std::size_t> hits_{0};
+    std::atomic<std::size_t> misses_{0};
+  };
+
+  /**
+   * @brief Parse a sequence of serial ADM (ITU-R BS.2125) frames into a
+   * single Document
+   *
+   * Each frame is an XML document with a `frame` root element (or an
+   * ebuCoreMain document or bare audioFormatExtended element) whose
+   * audioFormatExtended carries some elements. For each element in a frame:
+   *
+   * - if no element with the same ID is in the document, it is added, and
+   *   its references are resolved against the whole document;
+   * - if it is an audioChannelFormat that is already in the document, any
+   *   of its audioBlockFormats that come after the last one already in the
+   *   channel are appended, so blocks that are repeated between frames are
+   *   only added once;
+   * - otherwise it is ignored.
+   *
+   * Elements are looked up by ID through an index that is kept between
+   * frames, so the cost of each frame depends on the size of the frame rather
+   * than the size of the document, as long as most frames only carry
+   * audioBlockFormats for existing channels. The document must therefore
+   * not be changed other than through this while it is in use.
+   *
+   * The audioBlockFormats to append are parsed and checked before anything
+   * else in the frame, so if any of them can not be parsed or their IDs do
+   * not follow on from the last audioBlockFormat of their channel, parsing
+   * the frame throws without changing the document. If a new element can
+   * not be parsed or its references can not be resolved, the elements of
+   * that frame before the error will already have been added.
+   */
+  class FrameParser {
+   public:
+    /**
+     * @param document the Document to add to; this may already contain
+     * elements, e.g. from a previous call to parseXml().
+     */
+    ADM_EXPORT explicit FrameParser(std::shared_ptr<Document> document);
+    ADM_EXPORT ~FrameParser();
+
+    FrameParser(const FrameParser&) = delete;
+    FrameParser& operator=(const FrameParser&) = delete;
+
+    /// parse one frame from stream into the document
+    ADM_EXPORT void parseFrame(std::istream& stream);
+
+    /// the document that frames are added to
+    ADM_EXPORT std::shared_ptr<Document> getDocument() const;
+
+   private:
+    std::shared_ptr<Document> document_;
+    std::unique_ptr<detail::IDMap> idMap_;
+  };
+
+  /// the number of top-level elements changed by reparseXml()
+  struct ReparseSummary {
+    /// elements which were left as they were
+    std::size_t unchanged = 0;
+    /// elements whose contents or references were changed in place
+    std::size_t updated = 0;
+    /// elements which were added, including replacements
+    std::size_t added = 0;
+    /// elements which were removed, including those which were replaced
+    std::size_t removed = 0;
+  };
+
+  /**
+   * @brief Parse a new version of an XML document into an existing Document
+   *
+   * The XML is parsed as by `parseXml(std::istream&, ParserOptions)`, and
+   * document is then changed to hold the same elements, matching elements
+   * by ID:
+   *
+   * - elements whose contents (name, parameters and audioBlockFormats) and
+   *   references are the same are left alone;
+   * - elements which have changed are updated in place;
+   * - elements which are new are added after the existing elements of the
+   *   same type, and elements which are no longer present are removed.
+   *
+   * Pointers to elements which are still present therefore stay valid. The
+   * exception is an element whose typeDefinition or formatDefinition has
+   * changed, or an audioPackFormat which has become HOA or stopped being
+   * HOA, which can not be changed in place and so is replaced.
+   *
+   * Elements are looked up through an index of document built once, and
+   * compared through their serialized contents, so apart from parsing, the
+   * cost is one pass over both documents plus the cost of the changes;
+   * adding and removing elements costs as much as Document::add() and
+   * Document::remove().
+   *
+   * The XML is parsed before document is changed, so if parsing throws,
+   * document is unchanged.
+   *
+   * @param document the Document to update, e.g. from an earlier parseXml()
+   * @param stream input stream to parse XML data
+   * @param options Options to influence the XML parser behaviour
+   */
+  ADM_EXPORT ReparseSummary
+  reparseXml(const std::shared_ptr<Document>& document, std::istream& stream,
+             xml::ParserOptions options = xml::ParserOptions::none);
+
+  /**
+   * @brief Parse a new version of an XML file into an existing Document
+   *
+   * As `reparseXml(const std::shared_ptr<Document>&, std::istream&,
+   * ParserOptions)`, but reading from a file.
+   */
+  ADM_EXPORT ReparseSummary
+  reparseXml(const std::shared_ptr<Document>& document,
+             const std::string& filename,
+             xml::ParserOptions options = xml::ParserOptions::none);
+
   /**
    * @}
    */
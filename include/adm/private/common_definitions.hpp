@@ -0,0 +1,19 @@
+#pragma once
+#include <memory>
+#include "adm/document.hpp"
+
+namespace adm {
+  namespace detail {
+
+    /**
+     * @brief Get the process-wide common definitions Document
+     *
+     * The common definitions are built on first use and then shared by all
+     * callers; this is thread-safe. The returned Document must never be
+     * modified, so use `deepCopy()` or `deepCopyTo()` to seed new Documents
+     * from it.
+     */
+    std::shared_ptr<const Document> getCommonDefinitionsSnapshot();
+
+  }  // namespace detail
+}  // namespace adm
@@ -0,0 +1,113 @@
+#pragma once
+#include <cstddef>
+
+namespace adm {
+  namespace detail {
+    /**
+     * @brief Tables describing the common definitions
+     *
+     * These are generated during configuration from
+     * resources/common_definitions.xml by the cmake function
+     * compile_common_definitions(). IDs are stored as their numeric parts and
+     * references as indices into the table of the referenced element type, so
+     * no XML, IDs or numbers have to be parsed when they are loaded.
+     */
+    namespace common_definitions {
+
+      /// a range of entries [begin, end) in another table
+      struct IndexRange {
+        unsigned begin;
+        unsigned end;
+      };
+
+      struct PackFormatEntry {
+        const char* name;
+        unsigned type;
+        unsigned value;
+        /// indices of audioChannelFormats in packFormatChannelFormatRefs
+        IndexRange channelFormatRefs;
+        /// indices of audioPackFormats in packFormatPackFormatRefs
+        IndexRange packFormatRefs;
+      };
+
+      struct ChannelFormatEntry {
+        const char* name;
+        unsigned type;
+        unsigned value;
+        bool hasLowPass;
+        float lowPass;
+        bool hasHighPass;
+        float highPass;
+        /// entries in the block table matching type
+        IndexRange blockFormats;
+      };
+
+      struct DirectSpeakersBlockEntry {
+        unsigned counter;
+        const char* speakerLabel;  ///< nullptr if not present
+        float azimuth;
+        float elevation;
+        bool hasDistance;
+        float distance;
+        const char* horizontalEdge;  ///< nullptr if not present
+        const char* verticalEdge;  ///< nullptr if not present
+      };
+
+      struct HoaBlockEntry {
+        unsigned counter;
+        int order;
+        int degree;
+        const char* normalization;  ///< nullptr if not present
+      };
+
+      struct BinauralBlockEntry {
+        unsigned counter;
+      };
+
+      struct StreamFormatEntry {
+        const char* name;
+        unsigned type;
+        unsigned value;
+        int channelFormatRef;  ///< -1 if not present
+        int packFormatRef;  ///< -1 if not present
+        /// indices of audioTrackFormats in streamFormatTrackFormatRefs
+        IndexRange trackFormatRefs;
+      };
+
+      struct TrackFormatEntry {
+        const char* name;
+        unsigned type;
+        unsigned value;
+        unsigned counter;
+        int streamFormatRef;  ///< -1 if not present
+      };
+
+      template <typename T>
+      struct Table {
+        const T* data;
+        std::size_t size;
+
+        const T* begin() const { return data; }
+        const T* end() const { return data + size; }
+        const T& operator[](std::size_t index) const { return data[index]; }
+      };
+
+      struct Tables {
+        Table<PackFormatEntry> packFormats;
+        Table<unsigned> packFormatChannelFormatRefs;
+        Table<unsigned> packFormatPackFormatRefs;
+        Table<ChannelFormatEntry> channelFormats;
+        Table<DirectSpeakersBlockEntry> directSpeakersBlocks;
+        Table<HoaBlockEntry> hoaBlocks;
+        Table<BinauralBlockEntry> binauralBlocks;
+        Table<StreamFormatEntry> streamFormats;
+        Table<unsigned> streamFormatTrackFormatRefs;
+        Table<TrackFormatEntry> trackFormats;
+      };
+
+      /// get the generated tables; these are constant-initialised
+      const Tables& getTables();
+
+    }  // namespace common_definitions
+  }  // namespace detail
+}  // namespace adm
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace adm {
+  namespace detail {
+
+    /// a 128 bit hash of some data, used to tell whether it has changed
+    struct ContentHash {
+      std::uint64_t first;
+      std::uint64_t second;
+
+      bool operator==(const ContentHash& other) const {
+        return first == other.first && second == other.second;
+      }
+      bool operator!=(const ContentHash& other) const {
+        return !(*this == other);
+      }
+    };
+
+    /**
+     * @brief XXH64 hash of data
+     *
+     * Words are read in the native byte order, so the result is only
+     * comparable with hashes made on machines with the same byte order.
+     */
+    std::uint64_t hash64(const char* data, std::size_t size,
+                         std::uint64_t seed = 0);
+
+    /// hash data with XXH64 using two different seeds, in a single pass
+    ContentHash hashContent(const char* data, std::size_t size);
+
+  }  // namespace detail
+}  // namespace adm
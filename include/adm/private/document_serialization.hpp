@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include "adm/document.hpp"
+
+namespace adm {
+  namespace detail {
+
+    /**
+     * @brief Serialize a parsed Document into a compact binary form
+     *
+     * The document must start with the common definitions (as documents
+     * returned by parseXml() do); these are not stored, only the elements
+     * after them.
+     *
+     * The format is specific to this build of the library, and to the
+     * machine's byte order, so it is only suitable for caching.
+     *
+     * @throws std::runtime_error if the document does not start with the
+     * common definitions
+     */
+    std::string serializeDocument(const Document& document);
+
+    /**
+     * @brief Rebuild a Document from the output of serializeDocument()
+     *
+     * @throws std::runtime_error if the data is malformed; other exceptions
+     * may be thrown if values do not pass validation
+     */
+    std::shared_ptr<Document> deserializeDocument(const char* data,
+                                                  std::size_t size);
+
+    /**
+     * @brief Serialize the contents of one element, without its references
+     *
+     * This covers the same information as serializeDocument() does for the
+     * element: its ID, name, the parameters which have been set and, for
+     * audioChannelFormats, the audioBlockFormats. Two elements of the same
+     * type have the same contents if the results are equal.
+     */
+    template <typename Element>
+    std::string serializeElement(const Element& element);
+
+    /**
+     * @brief Make the contents of target (as in serializeElement()) the same
+     * as those of source, leaving its references alone
+     *
+     * @returns false, without changing target, if this can not be done in
+     * place because the elements differ in something which is only given on
+     * construction, like the typeDefinition or whether an audioPackFormat is
+     * HOA
+     */
+    template <typename Element>
+    bool assignElement(Element& target, const Element& source);
+
+  }  // namespace detail
+}  // namespace adm
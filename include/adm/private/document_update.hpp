@@ -0,0 +1,21 @@
+#pragma once
+#include <memory>
+#include "adm/document.hpp"
+#include "adm/parse.hpp"
+
+namespace adm {
+  namespace detail {
+
+    /**
+     * @brief Change target to have the same elements as source, keeping
+     * those elements of target which match by ID
+     *
+     * This implements reparseXml(); see there for how elements are matched
+     * and changed. source is not modified, and none of its elements end up
+     * in target.
+     */
+    ReparseSummary updateDocument(const std::shared_ptr<Document>& target,
+                                  const Document& source);
+
+  }  // namespace detail
+}  // namespace adm
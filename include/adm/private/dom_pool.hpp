@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "rapidxml/rapidxml.hpp"
+
+namespace adm {
+  namespace xml {
+
+    /**
+     * @brief Memory for rapidxml documents which is kept between parses
+     *
+     * rapidxml allocates the nodes of a document in blocks, which are freed
+     * when the document is cleared. A document given to `attach()` instead
+     * takes its blocks from the pool in use on the calling thread (see
+     * `Use`), and gives them back to it when cleared, so that parsing
+     * similar documents one after another does not allocate once the pool
+     * has grown to fit.
+     *
+     * Without a pool in use, attached documents allocate as usual.
+     */
+    class DomPool {
+     public:
+      DomPool() = default;
+      DomPool(const DomPool&) = delete;
+      DomPool& operator=(const DomPool&) = delete;
+      ~DomPool();
+
+      /// make a document use the pool in use when it allocates or frees
+      /// blocks; this must be called before it allocates anything
+      static void attach(rapidxml::xml_document<>& document);
+
+      /// use a pool on this thread while this exists
+      class Use {
+       public:
+        explicit Use(DomPool& pool);
+        Use(const Use&) = delete;
+        Use& operator=(const Use&) = delete;
+        ~Use();
+
+       private:
+        DomPool* previous_;
+      };
+
+     private:
+      static void* allocate(std::size_t size);
+      static void free(void* memory);
+
+      /// blocks which are not in use, each preceded by its size
+      std::vector<void*> blocks_;
+    };
+
+  }  // namespace xml
+}  // namespace adm
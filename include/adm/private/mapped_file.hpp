@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace adm {
+  namespace xml {
+
+    /**
+     * @brief A file mapped into memory for parsing in place
+     *
+     * The mapping is private and copy-on-write, so the data can be modified
+     * (as rapidxml does when parsing in situ) without changing the file, and
+     * only the pages which are modified use memory of their own.
+     *
+     * The data is always followed by a null terminator.
+     */
+    class MappedFile {
+     public:
+      explicit MappedFile(const std::string& filename);
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+      ~MappedFile();
+
+      char* data() { return data_; }
+      std::size_t size() const { return size_; }
+
+     private:
+      char* data_ = nullptr;
+      std::size_t size_ = 0;
+      std::size_t mappedSize_ = 0;
+      /// used instead of a mapping where a terminator can not be mapped
+      std::vector<char> buffer_;
+    };
+
+  }  // namespace xml
+}  // namespace adm
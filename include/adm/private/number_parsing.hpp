@@ -0,0 +1,32 @@
+#pragma once
+#include <cstring>
+
+namespace adm {
+  namespace xml {
+    namespace detail {
+
+      // Parse numbers from XML values, reading directly from [begin, end).
+      //
+      // These do not allocate, and do not depend on the C or C++ locale. The
+      // whole range must be a single value in the XML Schema lexical form of
+      // the type (e.g. xs:int, xs:float), optionally surrounded by
+      // whitespace; otherwise std::invalid_argument is thrown. Values which do
+      // not fit in the result type throw std::out_of_range.
+
+      int parseInt(const char* begin, const char* end);
+      unsigned int parseUnsigned(const char* begin, const char* end);
+      /// accepts 0, 1, false and true
+      bool parseBool(const char* begin, const char* end);
+      /// accepts decimals with an optional exponent, INF, -INF and NaN
+      float parseFloat(const char* begin, const char* end);
+      /// accepts decimals with an optional exponent, INF, -INF and NaN
+      double parseDouble(const char* begin, const char* end);
+
+      /// end of a null-terminated value, for use with the above
+      inline const char* valueEnd(const char* value) {
+        return value + std::strlen(value);
+      }
+
+    }  // namespace detail
+  }  // namespace xml
+}  // namespace adm
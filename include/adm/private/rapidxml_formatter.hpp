@@ -52,6 +52,10 @@ namespace adm {
         XmlNode &node, const AudioBlockFormatDirectSpeakers &audioBlock);
     void formatBlockFormatMatrix(XmlNode &node,
                                  const AudioBlockFormatMatrix &audioBlock);
+    void formatMatrixCoefficients(XmlNode &node,
+                                  const MatrixCoefficients &coefficients);
+    void formatMatrixCoefficient(XmlNode &node,
+                                 const MatrixCoefficient &coefficient);
     void formatBlockFormatObjects(XmlNode &node,
                                   const AudioBlockFormatObjects &audioBlock);
     void formatBlockFormatHoa(XmlNode &node,
@@ -93,6 +97,8 @@ namespace adm {
       std::string toString(const AudioStreamFormatId &id);
       std::string toString(const AudioTrackFormatId &id);
       std::string toString(const AudioTrackUidId &id);
+      /// the value of a Gain, in its own unit
+      std::string formatGainValue(const Gain &gain);
 
       template <typename T, typename std::enable_if<
                                 std::is_integral<T>::value>::type * = nullptr>
@@ -2,6 +2,10 @@
 
 #include "rapidxml/rapidxml.hpp"
 #include <algorithm>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
 
 namespace adm {
   namespace xml {
@@ -10,11 +14,142 @@ namespace adm {
       return static_cast<int>(std::count(begin, end, '\n'));
     }
 
+    /**
+     * @brief The positions of the line breaks in a buffer
+     *
+     * This is built once, so that the line of any position can then be found
+     * with a binary search rather than by counting.
+     */
+    class LineIndex {
+     public:
+      LineIndex(const char* begin, const char* end) {
+        for (const char* p = begin; p < end; ++p) {
+          p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+          if (!p) {
+            break;
+          }
+          breaks_.push_back(p);
+        }
+      }
+
+      /// the number of line breaks before p
+      int linesBefore(const char* p) const {
+        return static_cast<int>(
+            std::upper_bound(breaks_.begin(), breaks_.end(), p) -
+            breaks_.begin());
+      }
+
+     private:
+      std::vector<const char*> breaks_;
+    };
+
+    /// how lines are found for a document; see DocumentLineOffset
+    struct DocumentLines {
+      const rapidxml::xml_document<>* document;
+      int offset;
+      const LineIndex* index;
+      /// if set, finds offset the first time that it is needed
+      std::function<int()> findOffset;
+    };
+
+    using DocumentLineOffsets = std::vector<DocumentLines>;
+
+    /// offsets registered by DocumentLineOffset on this thread
+    inline DocumentLineOffsets& documentLineOffsets() {
+      static thread_local DocumentLineOffsets offsets;
+      return offsets;
+    }
+
+    inline const DocumentLines* getDocumentLines(
+        const rapidxml::xml_document<>* doc) {
+      for (auto& entry : documentLineOffsets()) {
+        if (entry.document == doc) {
+          if (entry.findOffset) {
+            entry.offset = entry.findOffset();
+            entry.findOffset = nullptr;
+          }
+          return &entry;
+        }
+      }
+      return nullptr;
+    }
+
+    /**
+     * @brief Offset the lines reported for a document
+     *
+     * For a document which was parsed from part of a larger document, this
+     * makes `getDocumentLine()` report lines in the larger document for as
+     * long as it exists. It must be destroyed on the thread it was created
+     * on.
+     */
+    class DocumentLineOffset {
+     public:
+      explicit DocumentLineOffset(const rapidxml::xml_document<>* doc,
+                                  int offset = 0)
+          : doc_(doc) {
+        documentLineOffsets().push_back({doc, offset, nullptr, nullptr});
+      }
+      DocumentLineOffset(const DocumentLineOffset&) = delete;
+      DocumentLineOffset& operator=(const DocumentLineOffset&) = delete;
+      ~DocumentLineOffset() {
+        auto& offsets = documentLineOffsets();
+        offsets.erase(std::find_if(offsets.begin(), offsets.end(),
+                                   [this](const DocumentLines& entry) {
+                                     return entry.document == doc_;
+                                   }));
+      }
+
+      void set(int offset) {
+        entry().offset = offset;
+        entry().findOffset = nullptr;
+      }
+
+      /// as set(), but the offset is only found if a line is needed, for
+      /// when finding it is expensive
+      void setDeferred(std::function<int()> findOffset) {
+        entry().findOffset = std::move(findOffset);
+      }
+
+      /**
+       * @brief Find lines using an index of the buffer that the document was
+       * parsed from, instead of counting
+       *
+       * The index must have been built before the buffer was parsed in place,
+       * and must outlive this. Lines are counted from root, the name of the
+       * root element.
+       */
+      void useIndex(const LineIndex& index, const char* root) {
+        entry().offset = -index.linesBefore(root);
+        entry().index = &index;
+        entry().findOffset = nullptr;
+      }
+
+     private:
+      DocumentLines& entry() {
+        return *std::find_if(documentLineOffsets().begin(),
+                             documentLineOffsets().end(),
+                             [this](const DocumentLines& entry) {
+                               return entry.document == doc_;
+                             });
+      }
+
+      const rapidxml::xml_document<>* doc_;
+    };
+
+    inline int getDocumentLine(const rapidxml::xml_document<>* doc,
+                               const char* name) {
+      auto lines = getDocumentLines(doc);
+      if (lines && lines->index) {
+        return lines->offset + lines->index->linesBefore(name);
+      }
+      return (lines ? lines->offset : 0) +
+             countLines<const char*>(doc->first_node()->name(), name);
+    }
     inline int getDocumentLine(rapidxml::xml_node<>* node) {
-      return countLines(node->document()->first_node()->name(), node->name());
+      return getDocumentLine(node->document(), node->name());
     }
     inline int getDocumentLine(rapidxml::xml_attribute<>* attr) {
-      return countLines(attr->document()->first_node()->name(), attr->name());
+      return getDocumentLine(attr->document(), attr->name());
     }
   }  // namespace xml
 }  // namespace adm
@@ -1,45 +1,52 @@
 #pragma once
 #include "adm/document.hpp"
-#include "rapidxml/rapidxml.hpp"
-#include "rapidxml/rapidxml_print.hpp"
-#include "rapidxml/rapidxml_utils.hpp"
 
 #include "adm/elements.hpp"
 #include "adm/utilities/id_assignment.hpp"
 #include "adm/private/rapidxml_formatter.hpp"
+#include "adm/private/xml_stream_writer.hpp"
 
-#include <iostream>
+#include <iosfwd>
 #include <string>
 
 namespace adm {
   namespace xml {
 
-    using NodePtr = rapidxml::xml_node<> *;
-
     class XmlNode;
 
+    /**
+     * @brief The document being written by XmlWriter
+     *
+     * Nodes are written to the stream as they are added, through an
+     * XmlStreamWriter, rather than being built into a DOM first, so a node
+     * must be finished (attributes before children) before the next node at
+     * the same or a higher level is added. finish() must be called once the
+     * last node has been added.
+     */
     class XmlDocument {
      public:
-      XmlDocument() = default;
+      explicit XmlDocument(std::ostream &stream) : writer_(stream) {}
       XmlNode addNode(const std::string &name);
 
-      XmlNode addDeclaration();
+      void addDeclaration();
       XmlNode addItuStructure();
       XmlNode addEbuStructure();
 
       void setDiscardDefaults(bool value) { discardDefaultValues_ = value; }
 
-     private:
-      friend std::ostream &operator<<(std::ostream &os, XmlDocument const &doc);
+      /// close all nodes and write any buffered output to the stream
+      void finish() { writer_.finish(); }
 
-      rapidxml::xml_document<> doc_;
+     private:
+      XmlStreamWriter writer_;
       bool discardDefaultValues_ = false;
     };
 
     class XmlNode {
      public:
       XmlNode() = default;
-      XmlNode(NodePtr node, bool discardDefaults);
+      XmlNode(XmlStreamWriter *writer, std::size_t depth,
+              XmlStreamWriter::Handle handle, bool discardDefaults);
 
       // --- GENERAL ---- //
       XmlNode addNode(const std::string &name);
@@ -115,14 +122,12 @@ namespace adm {
           const std::string &name);
 
      private:
-      NodePtr node_;
+      XmlStreamWriter *writer_ = nullptr;
+      std::size_t depth_ = 0;
+      XmlStreamWriter::Handle handle_ = 0;
       bool discardDefaultValues_ = true;
     };
 
-    inline std::ostream &operator<<(std::ostream &os, XmlDocument const &doc) {
-      return os << doc.doc_;
-    }
-
     // ---- Implementation ---- //
 
     template <typename ValueType>
@@ -0,0 +1,54 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace adm {
+  namespace detail {
+
+    /**
+     * @brief A fixed set of worker threads
+     *
+     * Work is given to the pool with `parallelFor()`, in which the calling
+     * thread also takes part. This means that it is safe to call from within
+     * a task running on the same pool, and that a pool with no threads just
+     * runs everything on the calling thread.
+     */
+    class ThreadPool {
+     public:
+      explicit ThreadPool(unsigned threads);
+      ThreadPool(const ThreadPool&) = delete;
+      ThreadPool& operator=(const ThreadPool&) = delete;
+      ~ThreadPool();
+
+      /// number of worker threads, not counting callers of parallelFor()
+      unsigned size() const { return static_cast<unsigned>(threads_.size()); }
+
+      /**
+       * @brief Call `f(i)` for each `i` in `[0, n)`, using the pool
+       *
+       * Returns once all calls have finished. Calls may happen in any order
+       * and on any thread; `f` must not throw.
+       */
+      void parallelFor(std::size_t n,
+                       const std::function<void(std::size_t)>& f);
+
+      /// a pool shared by the whole process, with one thread per core
+      static ThreadPool& shared();
+
+     private:
+      void run();
+
+      std::vector<std::thread> threads_;
+      std::deque<std::function<void()>> queue_;
+      std::mutex mutex_;
+      std::condition_variable condition_;
+      bool stopping_ = false;
+    };
+
+  }  // namespace detail
+}  // namespace adm
@@ -1,8 +1,9 @@
 #pragma once
+#include <functional>
 #include <iosfwd>
-#include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include "adm/document.hpp"
 #include "adm/elements.hpp"
@@ -12,6 +13,9 @@
 #include "rapidxml/rapidxml_utils.hpp"
 #include "adm/elements/audio_pack_format_hoa.hpp"
 #include "adm/detail/id_map.hpp"
+#include "adm/private/dom_pool.hpp"
+#include "adm/private/mapped_file.hpp"
+#include "adm/private/xml_stream_reader.hpp"
 
 namespace adm {
   /**
@@ -34,6 +38,8 @@ namespace adm {
     DialogueId parseDialogueId(NodePtr node);
     ContentKind parseContentKind(NodePtr node);
     Cartesian guessCartesianFlag(NodePtr node, const char* elementName);
+    /// guess the cartesian flag from the first position element, or nullptr
+    Cartesian guessCartesianFlag(NodePtr position);
     SphericalPosition parseSphericalPosition(std::vector<NodePtr> nodes);
     CartesianPosition parseCartesianPosition(std::vector<NodePtr> nodes);
     SphericalPositionOffset parseSphericalPositionOffset(
@@ -64,92 +70,403 @@ namespace adm {
     HeadphoneVirtualise parseHeadphoneVirtualise(NodePtr node);
     AudioBlockFormatHoa parseAudioBlockFormatHoa(NodePtr node);
     AudioBlockFormatBinaural parseAudioBlockFormatBinaural(NodePtr node);
+    AudioBlockFormatMatrix parseAudioBlockFormatMatrix(NodePtr node);
+    /// parse the coefficient elements within a matrix element
+    MatrixCoefficients parseMatrixCoefficients(NodePtr node);
+    void addAudioBlockFormat(AudioChannelFormat& audioChannelFormat,
+                             NodePtr node);
+    /**
+     * @brief Parse the audioBlockFormats within node that come after the last
+     * audioBlockFormat already in audioChannelFormat
+     *
+     * This returns a function which adds them. It throws without changing
+     * audioChannelFormat if any of them can not be parsed, or their IDs do
+     * not follow on from the last audioBlockFormat.
+     */
+    std::function<void()> prepareAudioBlockFormats(
+        AudioChannelFormat& audioChannelFormat, NodePtr node);
+    /// prepareAudioBlockFormats(), then add them
+    void appendAudioBlockFormats(AudioChannelFormat& audioChannelFormat,
+                                 NodePtr node);
+
+    /// a reference from an element of type Src to an element with an ID of
+    /// type Id
+    template <typename Src, typename Id>
+    struct PendingReference {
+      std::shared_ptr<Src> source;
+      Id id;
+      /// the name of the element holding the reference, within the text
+      /// that was parsed; used to find its line when reporting an error
+      const char* location;
+    };
+
+    /// references from elements of type Src to elements with IDs of type Id,
+    /// in the order they were found
+    template <typename Src, typename Id>
+    using ReferenceTable = std::vector<PendingReference<Src, Id>>;
+
+    /**
+     * @brief References found while parsing elements, to be resolved once all
+     * elements have been added
+     *
+     * Each element parsed in parallel gets its own, which are merged in
+     * document order. Tables ending in `Ref` hold at most one reference per
+     * element, and are resolved with `setReference` rather than
+     * `addReference`.
+     */
+    struct PendingReferences {
+      // clang-format off
+      ReferenceTable<AudioProgramme, AudioContentId> programmeContentRefs;
+      ReferenceTable<AudioContent, AudioObjectId> contentObjectRefs;
+      ReferenceTable<AudioObject, AudioObjectId> objectObjectRefs;
+      ReferenceTable<AudioObject, AudioPackFormatId> objectPackFormatRefs;
+      ReferenceTable<AudioObject, AudioTrackUidId> objectTrackUidRefs;
+      ReferenceTable<AudioTrackUid, AudioTrackFormatId> trackUidTrackFormatRef;
+      ReferenceTable<AudioTrackUid, AudioChannelFormatId> trackUidChannelFormatRef;
+      ReferenceTable<AudioTrackUid, AudioPackFormatId> trackUidPackFormatRef;
+      ReferenceTable<AudioPackFormat, AudioChannelFormatId> packFormatChannelFormatRefs;
+      ReferenceTable<AudioPackFormat, AudioPackFormatId> packFormatPackFormatRefs;
+      ReferenceTable<AudioTrackFormat, AudioStreamFormatId> trackFormatStreamFormatRef;
+      ReferenceTable<AudioStreamFormat, AudioChannelFormatId> streamFormatChannelFormatRef;
+      ReferenceTable<AudioStreamFormat, AudioPackFormatId> streamFormatPackFormatRef;
+      ReferenceTable<AudioStreamFormat, AudioTrackFormatId> streamFormatTrackFormatRefs;
+      // clang-format on
+
+      /// move the references from other onto the end of this
+      void merge(PendingReferences& other);
+      /// remove all references, keeping the memory allocated for them
+      void clear();
+      /// the total number of references in all tables
+      std::size_t size() const;
+    };
+
+    /**
+     * @brief An unmodified copy or mapping of the input to a parser
+     *
+     * This is kept for as long as any audioBlockFormats parsed with
+     * ParserOptions::lazy_audio_block_formats have not been loaded.
+     */
+    class LazySource {
+     public:
+      /// map a file into memory
+      explicit LazySource(const std::string& filename);
+      /// copy data
+      LazySource(const char* data, std::size_t size);
+      LazySource(const LazySource&) = delete;
+      LazySource& operator=(const LazySource&) = delete;
+
+      const char* data() const { return data_; }
+      std::size_t size() const { return size_; }
+
+     private:
+      std::unique_ptr<MappedFile> mappedFile_;
+      std::vector<char> buffer_;
+      const char* data_ = nullptr;
+      std::size_t size_ = 0;
+    };
+
+    /**
+     * @brief Working storage for XmlParser, which may be kept between parses
+     *
+     * This holds everything that the parser allocates other than the
+     * Document and the elements in it. An XmlParser normally has its own,
+     * but can be given one to use instead (see ParserContext); this is
+     * cleared when the parser is destroyed, keeping the memory it has
+     * allocated.
+     */
+    struct ParserScratch {
+      ParserScratch();
+      ParserScratch(const ParserScratch&) = delete;
+      ParserScratch& operator=(const ParserScratch&) = delete;
+
+      /// remove everything from the last parse
+      void clear();
+
+      /// the input when not parsed in place
+      std::vector<char> buffer;
+      DomPool domPool;
+      /// attached to domPool; this is only used while domPool is in use
+      rapidxml::xml_document<> xmlDocument;
+      adm::detail::IDMap idMap;
+      PendingReferences references;
+    };
 
     NodePtr findAudioFormatExtendedNodeEbuCore(NodePtr root);
     NodePtr findAudioFormatExtendedNodeFullRecursive(NodePtr root);
+    NodePtr findAudioFormatExtendedNodeFrame(NodePtr root);
+
+    /// part of a buffer holding one element
+    struct ElementSpan {
+      const char* begin = nullptr;  ///< the start of its start tag
+      const char* end = nullptr;  ///< just past its end tag
+    };
+
+    /**
+     * @brief Find the audioFormatExtended element in an XML document without
+     * parsing it
+     *
+     * This looks only at the tags in [begin, end), and finds the same element
+     * that findAudioFormatExtendedNodeEbuCore(), or
+     * findAudioFormatExtendedNodeFullRecursive() if recursive is true, would
+     * find from the root element.
+     *
+     * @param rootName set to the start of the name of the root element
+     * @returns the span of the element, or an empty span if it was not found
+     * or the document is not well-formed enough to tell
+     */
+    ElementSpan findAudioFormatExtendedSpan(const char* begin, const char* end,
+                                            bool recursive,
+                                            const char*& rootName);
     class XmlParser {
      public:
       explicit XmlParser(
           const std::string& filename,
           ParserOptions options = ParserOptions::none,
-          std::shared_ptr<Document> destDocument = Document::create());
+          std::shared_ptr<Document> destDocument = Document::create(),
+          ParserScratch* scratch = nullptr);
       explicit XmlParser(
           std::istream& stream, ParserOptions options = ParserOptions::none,
-          std::shared_ptr<Document> destDocument = Document::create());
+          std::shared_ptr<Document> destDocument = Document::create(),
+          ParserScratch* scratch = nullptr);
+      /**
+       * @brief Parser for a buffer in memory, which is parsed in place
+       *
+       * data[size] must be a null terminator. ParserOptions::streaming and
+       * ParserOptions::memory_map have no effect.
+       */
+      XmlParser(char* data, std::size_t size,
+                ParserOptions options = ParserOptions::none,
+                std::shared_ptr<Document> destDocument = Document::create(),
+                ParserScratch* scratch = nullptr);
+      /// parser for a copy of a buffer in memory, which need not be
+      /// null-terminated
+      XmlParser(const char* data, std::size_t size,
+                ParserOptions options = ParserOptions::none,
+                std::shared_ptr<Document> destDocument = Document::create(),
+                ParserScratch* scratch = nullptr);
+      /**
+       * @brief Parser for a serial ADM frame
+       *
+       * idMap must match destDocument, and is used and updated in place of
+       * building a new one, so that the cost of parsing does not depend on
+       * the size of destDocument.
+       */
+      XmlParser(std::istream& stream, std::shared_ptr<Document> destDocument,
+                adm::detail::IDMap& idMap);
+      XmlParser(const XmlParser&) = delete;
+      XmlParser& operator=(const XmlParser&) = delete;
+      ~XmlParser();
+
+      /// only parse the given audioProgramme and the elements it references;
+      /// see parseXml()
+      void selectProgramme(const AudioProgrammeId& programmeId);
 
       std::shared_ptr<Document> parse();
 
+      /**
+       * @brief Record problems in diagnostics rather than throwing
+       *
+       * Elements that can not be parsed are left out of the document, and
+       * unresolved references are dropped; see parseXmlCollectingErrors().
+       * This is not supported with ParserOptions::streaming.
+       */
+      void collectDiagnostics(std::vector<ParseDiagnostic>& diagnostics);
+
+      /// call progress with the progress of parse(); see ProgressCallback
+      void setProgressCallback(ProgressCallback progress);
+      /// make parse() throw error::ParsingCancelled once cancellation has
+      /// been cancelled
+      void setCancellationToken(CancellationToken cancellation);
+
+      /**
+       * @brief Parse a serial ADM frame into the document
+       *
+       * Elements with IDs that are not already in the document are added.
+       * Other elements are ignored, except that audioBlockFormats in
+       * audioChannelFormats are appended to the existing audioChannelFormat
+       * if they come after its last audioBlockFormat.
+       */
+      void parseFrame();
+
       bool hasUnresolvedReferences();
 
      private:
-      explicit XmlParser(
-          rapidxml::file<> file, ParserOptions options = ParserOptions::none,
-          std::shared_ptr<Document> destDocument = Document::create());
-
-      std::shared_ptr<AudioProgramme> parseAudioProgramme(NodePtr node);
-      std::shared_ptr<AudioContent> parseAudioContent(NodePtr node);
-      std::shared_ptr<AudioObject> parseAudioObject(NodePtr node);
-      std::shared_ptr<AudioTrackFormat> parseAudioTrackFormat(NodePtr node);
-      std::shared_ptr<AudioStreamFormat> parseAudioStreamFormat(NodePtr node);
-      std::shared_ptr<AudioPackFormat> parseAudioPackFormat(NodePtr node);
-      std::shared_ptr<AudioTrackUid> parseAudioTrackUid(NodePtr node);
+      XmlParser(ParserOptions options, std::shared_ptr<Document> destDocument,
+                ParserScratch* scratch);
+      XmlParser(ParserOptions options, std::shared_ptr<Document> destDocument,
+                adm::detail::IDMap& idMap);
+
+      /// read filename_ into xmlData_
+      void readInputFile();
+      /// parse the whole input into a DOM, then build the elements from it
+      std::shared_ptr<Document> parseDom();
+      /// build the elements while reading the input, one at a time
+      std::shared_ptr<Document> parseStreaming();
+      void parseAudioFormatExtended(XmlStreamReader& reader, int rootLine);
+      void parseAudioChannelFormat(XmlStreamReader& reader, int rootLine);
+
+      /// parse a child of audioFormatExtended and add it to the document
+      void parseElement(NodePtr node);
+      void parseElement(NodePtr node, PendingReferences& references);
+      /// call from a catch block: rethrow the current exception, or record
+      /// it if collecting diagnostics; node is the element being parsed, if
+      /// any, and gives the line if the exception does not have one
+      void reportError(NodePtr node);
+      /// report a reference to an ID that is not in the document; location
+      /// is that of the PendingReference
+      void unresolvedReference(const std::string& id, const char* location);
+      /// as reportError(), for a reference which could not be set, e.g.
+      /// because it would make a cycle
+      void reportReferenceError(const char* location);
+      /// the line of a PendingReference location, if it can be found
+      boost::optional<int> referenceLine(const char* location) const;
+
+      bool isCancelled() const;
+      /// throw error::ParsingCancelled if the parse has been cancelled
+      void checkCancelled() const;
+      void reportProgress(ParsePhase phase, std::size_t bytes,
+                          std::size_t totalBytes, std::size_t elements,
+                          std::size_t totalElements) const;
+      /// count references resolved from one table, reporting progress and
+      /// checking for cancellation
+      void referencesResolved(std::size_t count);
+      /// addAudioBlockFormat(), without checking that the counter of the new
+      /// audioBlockFormat follows on from the last one
+      static void addAudioBlockFormatAfterGap(
+          AudioChannelFormat& audioChannelFormat, NodePtr node);
+      /// parseElement() for serial ADM frames; see parseFrame()
+      void parseFrameElement(NodePtr node);
+      /// the existing audioChannelFormat with the ID of node, if it is one
+      std::shared_ptr<AudioChannelFormat> knownAudioChannelFormat(
+          NodePtr node);
+      /// is there already an element with the ID in attribute attributeName?
+      template <typename Id, typename Parser>
+      bool isKnownId(NodePtr node, const char* attributeName, Parser parser);
+      void resolveReferences();
+
+      /// the children of root to parse, in document order
+      std::vector<NodePtr> selectElements(NodePtr root);
+      /// should the audioBlockFormat at index within its audioChannelFormat
+      /// be parsed?
+      bool keepAudioBlockFormat(std::size_t index) const;
+      /// the audioBlockFormat nodes within an audioChannelFormat to parse
+      std::vector<NodePtr> findAudioBlockFormats(NodePtr node) const;
+      /// with ParserOptions::lazy_audio_block_formats, arrange for blockNodes
+      /// to be parsed and added to audioChannelFormat when they are first
+      /// accessed, and return true
+      bool deferAudioBlockFormats(AudioChannelFormat& audioChannelFormat,
+                                  const std::vector<NodePtr>& blockNodes);
+
+      /// build the elements from the given nodes on the threads of
+      /// ThreadPool::shared(), then add them in document order
+      void parseElementsParallel(const std::vector<NodePtr>& nodes);
+
+      // Element parsers; references found are added to the given
+      // PendingReferences, and the element is not added to the document.
+      // These may be called concurrently as long as the document is not
+      // changed.
+      std::shared_ptr<AudioProgramme> parseAudioProgramme(
+          NodePtr node, PendingReferences& references);
+      std::shared_ptr<AudioContent> parseAudioContent(
+          NodePtr node, PendingReferences& references);
+      std::shared_ptr<AudioObject> parseAudioObject(
+          NodePtr node, PendingReferences& references);
+      std::shared_ptr<AudioTrackFormat> parseAudioTrackFormat(
+          NodePtr node, PendingReferences& references);
+      std::shared_ptr<AudioStreamFormat> parseAudioStreamFormat(
+          NodePtr node, PendingReferences& references);
+      std::shared_ptr<AudioPackFormat> parseAudioPackFormat(
+          NodePtr node, PendingReferences& references);
+      std::shared_ptr<AudioTrackUid> parseAudioTrackUid(
+          NodePtr node, PendingReferences& references);
       std::shared_ptr<AudioChannelFormat> parseAudioChannelFormat(NodePtr node);
+      /// parse an audioChannelFormat without its audioBlockFormats
+      std::shared_ptr<AudioChannelFormat> createAudioChannelFormat(
+          NodePtr node);
 
-      rapidxml::file<> xmlFile_;
+      /// a file to be read into xmlData_ by parse()
+      std::string filename_;
+      /// the whole input, unless parsing with ParserOptions::streaming; this
+      /// is null-terminated and is parsed in place
+      char* xmlData_ = nullptr;
+      /// storage for xmlData_, if it is not in scratch_.buffer
+      std::unique_ptr<MappedFile> mappedFile_;
+      /// the size of the data in xmlData_, excluding the terminator
+      std::size_t xmlSize_ = 0;
+      /// with ParserOptions::lazy_audio_block_formats, the unmodified input
+      /// and the offset of the root element within it
+      std::shared_ptr<const LazySource> lazySource_;
+      std::size_t rootOffset_ = 0;
+      /// the input when parsing with ParserOptions::streaming
+      std::istream* stream_ = nullptr;
+      std::unique_ptr<std::istream> ownedStream_;
       ParserOptions options_;
+      boost::optional<AudioProgrammeId> programmeId_;
       std::shared_ptr<Document> document_;
 
-      // clang-format off
-      std::map<std::shared_ptr<AudioProgramme>, std::vector<AudioContentId>> programmeContentRefs_;
-      std::map<std::shared_ptr<AudioContent>, std::vector<AudioObjectId>> contentObjectRefs_;
-      std::map<std::shared_ptr<AudioObject>, std::vector<AudioObjectId>> objectObjectRefs_;
-      std::map<std::shared_ptr<AudioObject>, std::vector<AudioPackFormatId>> objectPackFormatRefs_;
-      std::map<std::shared_ptr<AudioObject>, std::vector<AudioTrackUidId>> objectTrackUidRefs_;
-      std::map<std::shared_ptr<AudioTrackUid>, AudioTrackFormatId> trackUidTrackFormatRef_;
-      std::map<std::shared_ptr<AudioTrackUid>, AudioChannelFormatId> trackUidChannelFormatRef_;
-      std::map<std::shared_ptr<AudioTrackUid>, AudioPackFormatId> trackUidPackFormatRef_;
-      std::map<std::shared_ptr<AudioPackFormat>, std::vector<AudioChannelFormatId>> packFormatChannelFormatRefs_;
-      std::map<std::shared_ptr<AudioPackFormat>, std::vector<AudioPackFormatId>> packFormatPackFormatRefs_;
-      std::map<std::shared_ptr<AudioTrackFormat>, AudioStreamFormatId> trackFormatStreamFormatRef_;
-      std::map<std::shared_ptr<AudioStreamFormat>, AudioChannelFormatId> streamFormatChannelFormatRef_;
-      std::map<std::shared_ptr<AudioStreamFormat>, AudioPackFormatId> streamFormatPackFormatRef_;
-      std::map<std::shared_ptr<AudioStreamFormat>, std::vector<AudioTrackFormatId>> streamFormatTrackFormatRefs_;
-      // clang-format on
+      /// either ownScratch_ or one given to the constructor
+      std::unique_ptr<ParserScratch> ownScratch_;
+      ParserScratch& scratch_;
+      PendingReferences& references_;
 
       /// used to keep track of element IDs ourselves to avoid having it
-      /// iterate through the whole document for each element and reference
-      detail::IDMap idMap_;
+      /// iterate through the whole document for each element and reference;
+      /// this is either scratch_.idMap or one given when parsing a frame
+      detail::IDMap& idMap_;
+
+      /// if set, errors are recorded here rather than thrown
+      std::vector<ParseDiagnostic>* diagnostics_ = nullptr;
+      /// when collecting diagnostics, the line breaks in xmlData_ and the
+      /// name of the root element, from which lines are counted
+      std::unique_ptr<LineIndex> lineIndex_;
+      const char* rootName_ = nullptr;
+      /// references of the element being parsed, which are only kept if it
+      /// is parsed without error; used when collecting diagnostics
+      PendingReferences elementReferences_;
+
+      ProgressCallback progress_;
+      boost::optional<CancellationToken> cancellation_;
+      /// progress through resolveReferences()
+      std::size_t referencesResolved_ = 0;
+      std::size_t referencesTotal_ = 0;
 
       /// add an element to both the document and idMap_
       template <typename Element>
       void add(std::shared_ptr<Element> el);
 
       template <typename Src, typename TargetId>
-      void resolveReferences(const std::map<Src, std::vector<TargetId>>& map) {
-        for (const auto& entry : map) {
-          for (const auto& id : entry.second) {
-            if (auto element = idMap_.lookup(id)) {
-              entry.first->addReference(std::move(element));
-            } else {
-              throw error::XmlParsingUnresolvedReference(formatId(id));
+      void resolveReferences(const ReferenceTable<Src, TargetId>& table) {
+        for (const auto& entry : table) {
+          if (auto element = idMap_.lookup(entry.id)) {
+            try {
+              entry.source->addReference(std::move(element));
+            } catch (const std::exception&) {
+              reportReferenceError(entry.location);
             }
+          } else {
+            unresolvedReference(formatId(entry.id), entry.location);
           }
         }
+        referencesResolved(table.size());
       }
 
-      template <typename Src, typename Target>
-      void resolveReference(const std::map<Src, Target>& map) {
-        for (const auto& entry : map) {
-          const auto& id = entry.second;
-          if (auto element = idMap_.lookup(id)) {
-            entry.first->setReference(std::move(element));
+      template <typename Src, typename TargetId>
+      void resolveReference(const ReferenceTable<Src, TargetId>& table) {
+        for (const auto& entry : table) {
+          if (auto element = idMap_.lookup(entry.id)) {
+            try {
+              entry.source->setReference(std::move(element));
+            } catch (const std::exception&) {
+              reportReferenceError(entry.location);
+            }
           } else {
-            throw error::XmlParsingUnresolvedReference(formatId(id));
+            unresolvedReference(formatId(entry.id), entry.location);
           }
         }
+        referencesResolved(table.size());
       }
       void setCommonProperties(std::shared_ptr<AudioPackFormat> audioPackFormat,
-                               NodePtr node);
+                               NodePtr node, PendingReferences& references);
     };
 
   }  // namespace xml
@@ -1,6 +1,7 @@
 #pragma once
 #include <boost/optional.hpp>
 #include <functional>
+#include <initializer_list>
 #include <map>
 #include <sstream>
 #include <string>
@@ -9,12 +10,14 @@
 #include "adm/document.hpp"
 #include "adm/elements/format_descriptor.hpp"
 #include "adm/elements/type_descriptor.hpp"
+#include "adm/private/number_parsing.hpp"
 #include "adm/private/rapidxml_utils.hpp"
 #include "rapidxml/rapidxml.hpp"
 
 namespace adm {
   namespace xml {
     using NodePtr = rapidxml::xml_node<>*;
+    using AttributePtr = rapidxml::xml_attribute<>*;
     /// @brief Implementation details
     namespace detail {
 
@@ -88,34 +91,124 @@ namespace adm {
       template <typename T>
       struct TypeTag {};
 
-      inline int parseImpl(const std::string& v, TypeTag<int>) {
-        return std::stoi(v);
+      inline int parseImpl(const char* v, TypeTag<int>) {
+        return parseInt(v, valueEnd(v));
       }
-      inline unsigned int parseImpl(const std::string& v,
-                                    TypeTag<unsigned int>) {
-        return std::stoul(v);
+      inline unsigned int parseImpl(const char* v, TypeTag<unsigned int>) {
+        return parseUnsigned(v, valueEnd(v));
       }
-      inline std::string parseImpl(std::string v, TypeTag<std::string>) {
+      inline std::string parseImpl(const char* v, TypeTag<std::string>) {
         return v;
       }
-      inline float parseImpl(const std::string& v, TypeTag<float>) {
-        return std::stof(v);
+      inline float parseImpl(const char* v, TypeTag<float>) {
+        return parseFloat(v, valueEnd(v));
       }
-      inline double parseImpl(const std::string& v, TypeTag<double>) {
-        return std::stod(v);
+      inline double parseImpl(const char* v, TypeTag<double>) {
+        return parseDouble(v, valueEnd(v));
       }
-      inline bool parseImpl(const std::string& v, TypeTag<bool>) {
-        return std::stoi(v) != 0;
+      inline bool parseImpl(const char* v, TypeTag<bool>) {
+        return parseBool(v, valueEnd(v));
       }
 
+      /// parse a null-terminated value from the document into NT, using the
+      /// parsers in number_parsing.hpp for numeric types
       template <typename NT>
-      NT parseDefault(std::string v) {
+      NT parseDefault(const char* v) {
         typedef typename NT::value_type value_type;
         typedef TypeTag<value_type> DispatchTypeTag;
-        return NT(parseImpl(std::move(v), DispatchTypeTag()));
+        return NT(parseImpl(v, DispatchTypeTag()));
       }
     }  // namespace detail
 
+    /**
+     * @brief Names of the attributes and elements of interest within a node
+     *
+     * This lets all of them be found in a single pass over the attributes and
+     * children of a node, rather than searching once per name. Each name maps
+     * to a member of Children: for `NodePtr` and `AttributePtr` members the
+     * first attribute or element with that name is stored, as
+     * `first_attribute()` and `first_node()` would return, and for
+     * `std::vector<NodePtr>` members all elements with that name are appended
+     * in document order.
+     *
+     * Tables should be built once (e.g. as function-local statics) and then
+     * reused.
+     */
+    template <typename Children>
+    class ChildTable {
+     public:
+      struct Attribute {
+        const char* name;
+        AttributePtr Children::*first;
+      };
+      struct Element {
+        const char* name;
+        NodePtr Children::*first;
+        std::vector<NodePtr> Children::*all = nullptr;
+      };
+
+      ChildTable(std::initializer_list<Attribute> attributes,
+                 std::initializer_list<Element> elements) {
+        for (auto& attribute : attributes) {
+          attributes_.push_back({std::strlen(attribute.name), attribute});
+        }
+        for (auto& element : elements) {
+          elements_.push_back({std::strlen(element.name), element});
+        }
+      }
+
+      /// find the attributes and elements of node; children should be
+      /// value-initialised
+      void find(NodePtr node, Children& children) const {
+        for (AttributePtr attribute = node->first_attribute(); attribute;
+             attribute = attribute->next_attribute()) {
+          auto entry = lookup(attributes_, attribute->name(),
+                              attribute->name_size());
+          if (entry && !(children.*(entry->first))) {
+            children.*(entry->first) = attribute;
+          }
+        }
+        for (NodePtr element = node->first_node(); element;
+             element = element->next_sibling()) {
+          if (element->type() != rapidxml::node_element) {
+            continue;
+          }
+          auto entry =
+              lookup(elements_, element->name(), element->name_size());
+          if (!entry) {
+            continue;
+          }
+          if (entry->all) {
+            (children.*(entry->all)).push_back(element);
+          } else if (!(children.*(entry->first))) {
+            children.*(entry->first) = element;
+          }
+        }
+      }
+
+     private:
+      template <typename Entry>
+      struct Named {
+        std::size_t size;
+        Entry entry;
+      };
+
+      template <typename Entry>
+      static const Entry* lookup(const std::vector<Named<Entry>>& entries,
+                                 const char* name, std::size_t size) {
+        for (auto& named : entries) {
+          if (named.size == size &&
+              std::memcmp(named.entry.name, name, size) == 0) {
+            return &named.entry;
+          }
+        }
+        return nullptr;
+      }
+
+      std::vector<Named<Attribute>> attributes_;
+      std::vector<Named<Element>> elements_;
+    };
+
     // ---- attributes ---- //
     template <typename NT, typename Callable>
     boost::optional<NT> parseOptionalAttribute(NodePtr node,
@@ -181,6 +274,20 @@ namespace adm {
                                detail::parseDefault<NT>);
     }
 
+    /// set target from an attribute found with ChildTable, if there is one
+    template <typename NT, typename Target, typename Callable>
+    void setFromAttribute(AttributePtr attribute, Target& target,
+                          Callable parser) {
+      if (attribute) {
+        detail::invokeSet(target, NT(parser(attribute->value())));
+      }
+    }
+
+    template <typename NT, typename Target>
+    void setFromAttribute(AttributePtr attribute, Target& target) {
+      setFromAttribute<NT>(attribute, target, detail::parseDefault<NT>);
+    }
+
     // ---- element ---- //
     template <typename NT, typename Callable>
     boost::optional<NT> parseOptionalElement(NodePtr node,
@@ -281,13 +388,59 @@ namespace adm {
       }
     }
 
+    /// set target from an element found with ChildTable, if there is one
+    template <typename NT, typename Target, typename Callable>
+    void setFromElement(NodePtr element, Target& target, Callable parser) {
+      if (element) {
+        detail::invokeSet(target, NT(parser(element)));
+      }
+    }
+
+    template <typename NT, typename Target>
+    void setFromElement(NodePtr element, Target& target) {
+      if (element) {
+        detail::invokeSet(target, detail::parseDefault<NT>(element->value()));
+      }
+    }
+
+    /// add to target from each of the elements found with ChildTable
+    template <typename NT, typename Target, typename Callable>
+    void addFromElements(const std::vector<NodePtr>& elements, Target& target,
+                         Callable parser) {
+      for (auto& element : elements) {
+        detail::invokeAdd(target, NT(parser(element)));
+      }
+    }
+
+    /**
+     * @brief Set target from the elements named elementName found within node
+     * with ChildTable
+     *
+     * Throws in the same way as setMultiElement() if there are none.
+     */
+    template <typename NT, typename Target, typename Callable>
+    void setFromMultiElement(NodePtr node, const char* elementName,
+                             const std::vector<NodePtr>& elements,
+                             Target& target, Callable parser) {
+      if (!elements.empty()) {
+        detail::invokeSet(target, NT(parser(elements)));
+      } else {
+        std::stringstream errorString;
+        int errorLine = getDocumentLine(node);
+        errorString << "mandatory element '" << elementName << "' not found"
+                    << errorLine << ")";
+        throw std::runtime_error(errorString.str());
+      }
+    }
+
     // ---- references ---- //
     template <typename NT, typename Src, typename Target, typename Callable>
     void addOptionalReferences(NodePtr node, const char* elementName,
                                const Src src, Target& target, Callable parser) {
       auto elements = detail::findElements(node, elementName);
       for (auto& elementNode : elements) {
-        target[src].push_back(NT(parser(elementNode->value())));
+        target.push_back(
+            {src, NT(parser(elementNode->value())), elementNode->name()});
       }
     }
 
@@ -296,7 +449,8 @@ namespace adm {
                               const Src src, Target& target, Callable parser) {
       auto elementNode = detail::findElement(node, elementName);
       if (elementNode) {
-        target[src] = NT(parser(elementNode->value()));
+        target.push_back(
+            {src, NT(parser(elementNode->value())), elementNode->name()});
       }
     }
 
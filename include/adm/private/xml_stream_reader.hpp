@@ -0,0 +1,113 @@
+#pragma once
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "rapidxml/rapidxml.hpp"
+#include "adm/private/rapidxml_utils.hpp"
+
+namespace adm {
+  namespace xml {
+
+    /**
+     * @brief Split an XML stream into tags and text, one at a time
+     *
+     * Only as much of the stream as is needed to read the next token is held
+     * in memory, so arbitrarily large documents can be processed. The raw
+     * text of each token is kept so that elements of interest can be
+     * reassembled and parsed on their own with rapidxml (see XmlFragment).
+     *
+     * This is only concerned with finding token boundaries; the contents are
+     * checked when fragments are parsed.
+     */
+    class XmlStreamReader {
+     public:
+      enum class TokenType {
+        start_tag,  ///< `<name ...>`
+        empty_element_tag,  ///< `<name .../>`
+        end_tag,  ///< `</name>`
+        text,  ///< character data between tags
+        other,  ///< comments, CDATA, processing instructions and DOCTYPE
+      };
+
+      explicit XmlStreamReader(std::istream& stream);
+
+      /**
+       * @brief Read the next token
+       *
+       * @param keepText if false, the contents of text tokens are skipped
+       * rather than stored, for when they will not be used
+       * @returns false at the end of the stream
+       */
+      bool next(bool keepText = true);
+
+      TokenType type() const { return type_; }
+      /// raw text of the current token
+      const std::string& text() const { return text_; }
+      /// element name of the current token, if it is a tag
+      const std::string& name() const { return name_; }
+      /// number of newlines before the start of the current token
+      int line() const { return line_; }
+      /// number of bytes read from the stream up to the end of the current
+      /// token
+      std::size_t offset() const { return read_ - (size_ - position_); }
+
+     private:
+      bool fill();
+      int peek();
+      int get();
+      void readTag();
+      void readUntil(const char* terminator);
+      void readDoctype();
+
+      std::istream& stream_;
+      std::vector<char> buffer_;
+      std::size_t position_ = 0;
+      std::size_t size_ = 0;
+      /// total bytes read into buffer_
+      std::size_t read_ = 0;
+      int lines_ = 0;
+
+      TokenType type_ = TokenType::other;
+      std::string text_;
+      std::string name_;
+      int line_ = 0;
+    };
+
+    /**
+     * @brief A single element taken from a larger document and parsed alone
+     *
+     * While a fragment exists, `getDocumentLine()` reports the lines of its
+     * nodes as lines in the document it was taken from.
+     */
+    class XmlFragment {
+     public:
+      XmlFragment();
+      XmlFragment(const XmlFragment&) = delete;
+      XmlFragment& operator=(const XmlFragment&) = delete;
+
+      /// the XML text of the element; this is parsed in place
+      std::string& text() { return text_; }
+
+      /**
+       * @brief Parse text() and return its root element
+       *
+       * @param line the line in the original document on which the element
+       * started, as would be returned by `getDocumentLine()`
+       */
+      rapidxml::xml_node<>* parse(int line);
+
+      /**
+       * @brief As `parse(int)`, but the line is only found by calling
+       * findLine if it is needed, e.g. to report an error
+       */
+      rapidxml::xml_node<>* parse(std::function<int()> findLine);
+
+     private:
+      std::string text_;
+      rapidxml::xml_document<> document_;
+      DocumentLineOffset lineOffset_;
+    };
+
+  }  // namespace xml
+}  // namespace adm
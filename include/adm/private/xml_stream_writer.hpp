@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "adm/export.h"
+
+namespace adm {
+  namespace xml {
+
+    /**
+     * @brief Write XML to a stream as it is generated, without building a
+     * DOM
+     *
+     * Elements are identified by their depth and the handle returned by
+     * startElement(). An element stays open until an element at the same or
+     * a lower depth is started, or finish() is called, so only the elements
+     * from the root to the current one are held in memory. Output goes
+     * through a buffer which is written to the stream in blocks.
+     *
+     * The output is formatted exactly as rapidxml prints a DOM built with the
+     * same calls: elements are indented with tabs, elements without children
+     * have their value on the same line, and elements without children or a
+     * value are written as empty element tags. As with the DOM, strings end
+     * at the first null character.
+     *
+     * Attributes must be added before an element's children, and elements
+     * can not be changed once they have been closed; doing either throws
+     * std::logic_error.
+     */
+    class ADM_EXPORT XmlStreamWriter {
+     public:
+      using Handle = std::uint64_t;
+
+      explicit XmlStreamWriter(std::ostream& stream);
+
+      /// write the `<?xml ...?>` declaration
+      void declaration();
+
+      /**
+       * @brief Start a new element
+       *
+       * This closes any open elements at depth or deeper, so the new element
+       * follows them as the last child of the open element at depth - 1.
+       */
+      Handle startElement(std::size_t depth, const std::string& name);
+
+      /// add an attribute to an open element
+      void addAttribute(std::size_t depth, Handle handle,
+                        const std::string& name, const std::string& value);
+
+      /**
+       * @brief Set the value of an open element
+       *
+       * As with rapidxml, the value is only written if the element has no
+       * children.
+       */
+      void setValue(std::size_t depth, Handle handle,
+                    const std::string& value);
+
+      /// close all open elements and write everything to the stream
+      void finish();
+
+     private:
+      struct OpenElement {
+        std::string name;
+        Handle handle;
+        bool hasChildren;
+        std::string value;
+      };
+
+      /// close elements until depth are open
+      void closeTo(std::size_t depth);
+      void close();
+      /// check that handle is the innermost open element at depth, after
+      /// closing any deeper ones
+      OpenElement& element(std::size_t depth, Handle handle);
+
+      void indent(std::size_t depth);
+      void appendEscaped(const std::string& text, char noExpand);
+      void flushIfFull();
+
+      std::ostream& stream_;
+      std::string buffer_;
+      /// the open elements are the first openCount_; the rest are kept to
+      /// reuse the memory of their strings
+      std::vector<OpenElement> open_;
+      std::size_t openCount_ = 0;
+      Handle nextHandle_ = 0;
+    };
+
+  }  // namespace xml
+}  // namespace adm
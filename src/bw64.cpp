@@ -0,0 +1,206 @@
+#include "adm/bw64.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "adm/common_definitions.hpp"
+#include "adm/private/xml_parser.hpp"
+
+namespace adm {
+
+  namespace {
+    using ChunkId = std::array<char, 4>;
+
+    bool isChunk(const ChunkId& id, const char* name) {
+      return std::memcmp(id.data(), name, id.size()) == 0;
+    }
+
+    /// reads little-endian values and chunk headers from a stream
+    class ChunkReader {
+     public:
+      explicit ChunkReader(std::istream& stream) : stream_(stream) {}
+
+      void read(char* data, std::size_t size) {
+        if (!stream_.read(data, static_cast<std::streamsize>(size))) {
+          throw std::runtime_error("unexpected end of BW64 file");
+        }
+      }
+
+      ChunkId readId() {
+        ChunkId id;
+        read(id.data(), id.size());
+        return id;
+      }
+
+      std::uint64_t readInt(std::size_t bytes) {
+        unsigned char data[8];
+        read(reinterpret_cast<char*>(data), bytes);
+        std::uint64_t value = 0;
+        for (std::size_t i = bytes; i-- > 0;) {
+          value = (value << 8) | data[i];
+        }
+        return value;
+      }
+
+      void skip(std::uint64_t size) {
+        stream_.seekg(static_cast<std::streamoff>(size), std::ios::cur);
+        if (!stream_) {
+          throw std::runtime_error("unexpected end of BW64 file");
+        }
+      }
+
+      /// check that there are at least size bytes left in the stream, so
+      /// that a size from a corrupt header is not used to allocate or seek
+      void require(std::uint64_t size) {
+        auto position = stream_.tellg();
+        if (position < 0 || !stream_.seekg(0, std::ios::end)) {
+          throw std::runtime_error("cannot seek in BW64 file");
+        }
+        auto end = stream_.tellg();
+        if (end < 0 || !stream_.seekg(position)) {
+          throw std::runtime_error("cannot seek in BW64 file");
+        }
+        if (size > static_cast<std::uint64_t>(end - position)) {
+          throw std::runtime_error("unexpected end of BW64 file");
+        }
+      }
+
+      /// read a chunk header; false at the end of the stream
+      bool next(ChunkId& id, std::uint32_t& size) {
+        if (stream_.peek() == std::char_traits<char>::eof()) {
+          return false;
+        }
+        id = readId();
+        size = static_cast<std::uint32_t>(readInt(4));
+        return true;
+      }
+
+     private:
+      std::istream& stream_;
+    };
+
+    /// an ID from a chna entry, without the null padding
+    std::string chnaId(const char* data, std::size_t size) {
+      return std::string(data, std::find(data, data + size, '\0'));
+    }
+
+    std::vector<ChnaEntry> parseChna(const std::vector<char>& data) {
+      auto readInt16 = [&data](std::size_t offset) {
+        return static_cast<std::uint16_t>(
+            static_cast<unsigned char>(data[offset]) |
+            static_cast<unsigned char>(data[offset + 1]) << 8);
+      };
+      const std::size_t headerSize = 4;
+      const std::size_t entrySize = 40;
+      if (data.size() < headerSize) {
+        throw std::runtime_error("chna chunk is too small");
+      }
+      std::size_t count = readInt16(2);
+      if (data.size() < headerSize + count * entrySize) {
+        throw std::runtime_error("chna chunk is too small");
+      }
+
+      std::vector<ChnaEntry> entries;
+      entries.reserve(count);
+      for (std::size_t i = 0; i < count; i++) {
+        std::size_t offset = headerSize + i * entrySize;
+        ChnaEntry entry;
+        entry.trackIndex = readInt16(offset);
+        entry.audioTrackUid = chnaId(&data[offset + 2], 12);
+        entry.trackRef = chnaId(&data[offset + 14], 14);
+        entry.packRef = chnaId(&data[offset + 28], 11);
+        entries.push_back(std::move(entry));
+      }
+      return entries;
+    }
+  }  // namespace
+
+  Bw64Metadata parseBw64(const std::string& filename,
+                         xml::ParserOptions options) {
+    std::ifstream stream(filename, std::ios::binary);
+    if (!stream) {
+      throw std::runtime_error("cannot open file " + filename);
+    }
+    return parseBw64(stream, options);
+  }
+
+  Bw64Metadata parseBw64(std::istream& stream, xml::ParserOptions options) {
+    ChunkReader reader(stream);
+    ChunkId riffId = reader.readId();
+    bool is64Bit = isChunk(riffId, "RF64") || isChunk(riffId, "BW64");
+    if (!is64Bit && !isChunk(riffId, "RIFF")) {
+      throw std::runtime_error("not a RIFF, RF64 or BW64 file");
+    }
+    reader.skip(4);
+    if (!isChunk(reader.readId(), "WAVE")) {
+      throw std::runtime_error("not a WAVE file");
+    }
+
+    // sizes of chunks too large for their header, from the ds64 chunk
+    std::vector<std::pair<ChunkId, std::uint64_t>> largeSizes;
+    Bw64Metadata metadata;
+    std::vector<char> axml;
+    bool hasAxml = false;
+
+    ChunkId id;
+    std::uint32_t size32;
+    while (reader.next(id, size32)) {
+      std::uint64_t size = size32;
+      if (isChunk(id, "ds64")) {
+        if (!is64Bit || size < 28) {
+          throw std::runtime_error("unexpected ds64 chunk");
+        }
+        reader.skip(8);  // RIFF size
+        largeSizes.emplace_back(ChunkId{{'d', 'a', 't', 'a'}},
+                                reader.readInt(8));
+        reader.skip(8);  // sample count
+        std::uint64_t tableLength = reader.readInt(4);
+        if (size < 28 + tableLength * 12) {
+          throw std::runtime_error("ds64 chunk is too small");
+        }
+        for (std::uint64_t i = 0; i < tableLength; i++) {
+          ChunkId tableId = reader.readId();
+          largeSizes.emplace_back(tableId, reader.readInt(8));
+        }
+        reader.skip(size - 28 - tableLength * 12 + size % 2);
+        continue;
+      }
+
+      if (is64Bit && size32 == 0xFFFFFFFF) {
+        for (const auto& entry : largeSizes) {
+          if (entry.first == id) {
+            size = entry.second;
+            break;
+          }
+        }
+      }
+
+      if (isChunk(id, "axml") && !hasAxml) {
+        reader.require(size);
+        axml.resize(size + 1);
+        reader.read(axml.data(), size);
+        axml[size] = '\0';
+        reader.skip(size % 2);
+        hasAxml = true;
+      } else if (isChunk(id, "chna") && metadata.chna.empty()) {
+        reader.require(size);
+        std::vector<char> chna(size);
+        reader.read(chna.data(), size);
+        reader.skip(size % 2);
+        metadata.chna = parseChna(chna);
+      } else {
+        reader.require(size);
+        reader.skip(size + size % 2);
+      }
+    }
+
+    if (hasAxml) {
+      xml::XmlParser parser(axml.data(), axml.size() - 1, options,
+                            getCommonDefinitions());
+      metadata.document = parser.parse();
+    }
+    return metadata;
+  }
+
+}  // namespace adm
@@ -1,6 +1,6 @@
 #include "adm/common_definitions.hpp"
-#include "resources.hpp"
-#include "adm/private/xml_parser.hpp"
+#include "adm/private/common_definitions.hpp"
+#include "adm/private/common_definitions_tables.hpp"
 #include "adm/utilities/copy.hpp"
 #include <iostream>
 #include <iomanip>
@@ -155,16 +155,209 @@ namespace adm {
                                    AudioTrackFormatIdCounter(1));
   }
 
+  namespace {
+    using namespace detail::common_definitions;
+
+    AudioBlockFormatDirectSpeakers makeBlockFormat(
+        const AudioChannelFormatId& channelFormatId,
+        const DirectSpeakersBlockEntry& entry) {
+      AudioBlockFormatDirectSpeakers blockFormat;
+      blockFormat.set(AudioBlockFormatId(
+          channelFormatId.get<TypeDescriptor>(),
+          AudioBlockFormatIdValue(
+              channelFormatId.get<AudioChannelFormatIdValue>().get()),
+          AudioBlockFormatIdCounter(entry.counter)));
+      SphericalSpeakerPosition speakerPosition{Azimuth(entry.azimuth),
+                                               Elevation(entry.elevation)};
+      if (entry.hasDistance) {
+        speakerPosition.set(Distance(entry.distance));
+      }
+      ScreenEdgeLock screenEdgeLock;
+      if (entry.horizontalEdge) {
+        screenEdgeLock.set(HorizontalEdge(entry.horizontalEdge));
+      }
+      if (entry.verticalEdge) {
+        screenEdgeLock.set(VerticalEdge(entry.verticalEdge));
+      }
+      speakerPosition.set(screenEdgeLock);
+      blockFormat.set(SpeakerPosition(speakerPosition));
+      if (entry.speakerLabel) {
+        blockFormat.add(SpeakerLabel(entry.speakerLabel));
+      }
+      return blockFormat;
+    }
+
+    AudioBlockFormatHoa makeBlockFormat(
+        const AudioChannelFormatId& channelFormatId,
+        const HoaBlockEntry& entry) {
+      AudioBlockFormatHoa blockFormat{Order(entry.order),
+                                      Degree(entry.degree)};
+      blockFormat.set(AudioBlockFormatId(
+          channelFormatId.get<TypeDescriptor>(),
+          AudioBlockFormatIdValue(
+              channelFormatId.get<AudioChannelFormatIdValue>().get()),
+          AudioBlockFormatIdCounter(entry.counter)));
+      if (entry.normalization) {
+        blockFormat.set(Normalization(entry.normalization));
+      }
+      return blockFormat;
+    }
+
+    AudioBlockFormatBinaural makeBlockFormat(
+        const AudioChannelFormatId& channelFormatId,
+        const BinauralBlockEntry& entry) {
+      AudioBlockFormatBinaural blockFormat;
+      blockFormat.set(AudioBlockFormatId(
+          channelFormatId.get<TypeDescriptor>(),
+          AudioBlockFormatIdValue(
+              channelFormatId.get<AudioChannelFormatIdValue>().get()),
+          AudioBlockFormatIdCounter(entry.counter)));
+      return blockFormat;
+    }
+
+    template <typename Entry>
+    void addBlockFormats(AudioChannelFormat& channelFormat,
+                         const Table<Entry>& blocks, IndexRange range) {
+      auto id = channelFormat.get<AudioChannelFormatId>();
+      for (auto i = range.begin; i != range.end; ++i) {
+        channelFormat.add(makeBlockFormat(id, blocks[i]));
+      }
+    }
+
+    /// build the common definitions from the tables generated from
+    /// common_definitions.xml; this gives the same Document as parsing it
+    std::shared_ptr<const Document> buildCommonDefinitions() {
+      const Tables& tables = getTables();
+      auto document = Document::create();
+
+      std::vector<std::shared_ptr<AudioPackFormat>> packFormats;
+      packFormats.reserve(tables.packFormats.size);
+      for (const auto& entry : tables.packFormats) {
+        TypeDescriptor type(entry.type);
+        AudioPackFormatId id(type, AudioPackFormatIdValue(entry.value));
+        AudioPackFormatName name(entry.name);
+        if (type == TypeDefinition::HOA) {
+          packFormats.push_back(AudioPackFormatHoa::create(name, id));
+        } else {
+          packFormats.push_back(AudioPackFormat::create(name, type, id));
+        }
+        document->add(packFormats.back());
+      }
+
+      std::vector<std::shared_ptr<AudioChannelFormat>> channelFormats;
+      channelFormats.reserve(tables.channelFormats.size);
+      for (const auto& entry : tables.channelFormats) {
+        TypeDescriptor type(entry.type);
+        auto channelFormat = AudioChannelFormat::create(
+            AudioChannelFormatName(entry.name), type,
+            AudioChannelFormatId(type,
+                                 AudioChannelFormatIdValue(entry.value)));
+        if (entry.hasLowPass || entry.hasHighPass) {
+          Frequency frequency;
+          if (entry.hasLowPass) {
+            frequency.set(LowPass(entry.lowPass));
+          }
+          if (entry.hasHighPass) {
+            frequency.set(HighPass(entry.highPass));
+          }
+          channelFormat->set(frequency);
+        }
+        if (type == TypeDefinition::DIRECT_SPEAKERS) {
+          addBlockFormats(*channelFormat, tables.directSpeakersBlocks,
+                          entry.blockFormats);
+        } else if (type == TypeDefinition::HOA) {
+          addBlockFormats(*channelFormat, tables.hoaBlocks,
+                          entry.blockFormats);
+        } else if (type == TypeDefinition::BINAURAL) {
+          addBlockFormats(*channelFormat, tables.binauralBlocks,
+                          entry.blockFormats);
+        }
+        channelFormats.push_back(channelFormat);
+        document->add(channelFormat);
+      }
+
+      std::vector<std::shared_ptr<AudioStreamFormat>> streamFormats;
+      streamFormats.reserve(tables.streamFormats.size);
+      for (const auto& entry : tables.streamFormats) {
+        streamFormats.push_back(AudioStreamFormat::create(
+            AudioStreamFormatName(entry.name), FormatDefinition::PCM,
+            AudioStreamFormatId(TypeDescriptor(entry.type),
+                                AudioStreamFormatIdValue(entry.value))));
+        document->add(streamFormats.back());
+      }
+
+      std::vector<std::shared_ptr<AudioTrackFormat>> trackFormats;
+      trackFormats.reserve(tables.trackFormats.size);
+      for (const auto& entry : tables.trackFormats) {
+        trackFormats.push_back(AudioTrackFormat::create(
+            AudioTrackFormatName(entry.name), FormatDefinition::PCM,
+            AudioTrackFormatId(TypeDescriptor(entry.type),
+                               AudioTrackFormatIdValue(entry.value),
+                               AudioTrackFormatIdCounter(entry.counter))));
+        document->add(trackFormats.back());
+      }
+
+      // references are resolved in the same order as in the XML parser
+      for (std::size_t i = 0; i < packFormats.size(); ++i) {
+        const auto& refs = tables.packFormats[i].channelFormatRefs;
+        for (auto ref = refs.begin; ref != refs.end; ++ref) {
+          packFormats[i]->addReference(
+              channelFormats[tables.packFormatChannelFormatRefs[ref]]);
+        }
+      }
+      for (std::size_t i = 0; i < packFormats.size(); ++i) {
+        const auto& refs = tables.packFormats[i].packFormatRefs;
+        for (auto ref = refs.begin; ref != refs.end; ++ref) {
+          packFormats[i]->addReference(
+              packFormats[tables.packFormatPackFormatRefs[ref]]);
+        }
+      }
+      for (std::size_t i = 0; i < trackFormats.size(); ++i) {
+        auto ref = tables.trackFormats[i].streamFormatRef;
+        if (ref >= 0) {
+          trackFormats[i]->setReference(streamFormats[ref]);
+        }
+      }
+      for (std::size_t i = 0; i < streamFormats.size(); ++i) {
+        auto ref = tables.streamFormats[i].channelFormatRef;
+        if (ref >= 0) {
+          streamFormats[i]->setReference(channelFormats[ref]);
+        }
+      }
+      for (std::size_t i = 0; i < streamFormats.size(); ++i) {
+        auto ref = tables.streamFormats[i].packFormatRef;
+        if (ref >= 0) {
+          streamFormats[i]->setReference(packFormats[ref]);
+        }
+      }
+      for (std::size_t i = 0; i < streamFormats.size(); ++i) {
+        const auto& refs = tables.streamFormats[i].trackFormatRefs;
+        for (auto ref = refs.begin; ref != refs.end; ++ref) {
+          streamFormats[i]->addReference(
+              trackFormats[tables.streamFormatTrackFormatRefs[ref]]);
+        }
+      }
+
+      return document;
+    }
+  }  // namespace
+
+  namespace detail {
+    std::shared_ptr<const Document> getCommonDefinitionsSnapshot() {
+      // initialisation of function-local statics is thread-safe, so this is
+      // only ever built once per process
+      static const std::shared_ptr<const Document> snapshot =
+          buildCommonDefinitions();
+      return snapshot;
+    }
+  }  // namespace detail
+
   std::shared_ptr<Document> getCommonDefinitions() {
-    std::stringstream commonDefinitions;
-    getEmbeddedFile("common_definitions.xml", commonDefinitions);
-    xml::XmlParser parser(commonDefinitions,
-                          xml::ParserOptions::recursive_node_search);
-    return parser.parse();
+    return deepCopy(detail::getCommonDefinitionsSnapshot());
   }
 
   void addCommonDefinitionsTo(std::shared_ptr<Document> document) {
-    deepCopyTo(getCommonDefinitions(), document);
+    deepCopyTo(detail::getCommonDefinitionsSnapshot(), document);
   }
 
 }  // namespace adm
@@ -1,6 +1,11 @@
 #include "adm/elements/audio_block_format_matrix.hpp"
 
 namespace adm {
+  namespace detail {
+    template class OptionalParameter<OutputChannelFormatId>;
+    template class VectorParameter<MatrixCoefficients>;
+  }  // namespace detail
+
   namespace {
     const Rtime rtimeDefault{std::chrono::seconds(0)};
   }
@@ -34,7 +39,7 @@ namespace adm {
   // ---- isDefault ---- //
   bool AudioBlockFormatMatrix::isDefault(
       detail::ParameterTraits<Rtime>::tag) const {
-    return duration_ == boost::none;
+    return rtime_ == boost::none;
   }
 
   // ---- Setter ---- //
@@ -1,5 +1,6 @@
 #include "adm/elements/audio_channel_format.hpp"
 #include <algorithm>
+#include <mutex>
 #include <sstream>
 #include "adm/document.hpp"
 #include "adm/elements/audio_block_format_binaural.hpp"
@@ -14,6 +15,12 @@
 
 namespace adm {
 
+  struct AudioChannelFormat::AudioBlockFormatLoaderState {
+    // recursive, as the loader adds blocks through add(), which loads first
+    std::recursive_mutex mutex;
+    AudioBlockFormatLoader loader;
+  };
+
   // ---- Getter ---- //
   AudioChannelFormatId AudioChannelFormat::get(
       detail::ParameterTraits<AudioChannelFormatId>::tag) const {
@@ -46,12 +53,23 @@ namespace adm {
       throw std::runtime_error("id already in use");
     }
     if (id.get<TypeDescriptor>() == get<TypeDescriptor>()) {
+      // blocks always have the value of the channel ID, so only need
+      // updating (and loading, if they have not been) if it changes
+      bool valueChanged = id.get<AudioChannelFormatIdValue>() !=
+                          id_.get<AudioChannelFormatIdValue>();
+      // the loader adds blocks with the old ID value, so it must run
+      // before id_ changes
+      if (valueChanged) {
+        loadAudioBlockFormats();
+      }
       id_ = id;
-      assignNewIdValue<AudioBlockFormatDirectSpeakers>();
-      assignNewIdValue<AudioBlockFormatMatrix>();
-      assignNewIdValue<AudioBlockFormatObjects>();
-      assignNewIdValue<AudioBlockFormatHoa>();
-      assignNewIdValue<AudioBlockFormatBinaural>();
+      if (valueChanged) {
+        assignNewIdValue<AudioBlockFormatDirectSpeakers>();
+        assignNewIdValue<AudioBlockFormatMatrix>();
+        assignNewIdValue<AudioBlockFormatObjects>();
+        assignNewIdValue<AudioBlockFormatHoa>();
+        assignNewIdValue<AudioBlockFormatBinaural>();
+      }
     } else {
       std::stringstream errorString;
       errorString << "missmatch between TypeDefinition of AudioChannelFormat ("
@@ -90,6 +108,7 @@ namespace adm {
 
   // ---- AudioBlocks ---- //
   void AudioChannelFormat::add(AudioBlockFormatDirectSpeakers blockFormat) {
+    loadAudioBlockFormats();
     if (audioBlockFormatsDirectSpeakers_.empty()) {
       assignId(blockFormat);
     } else {
@@ -98,6 +117,7 @@ namespace adm {
     audioBlockFormatsDirectSpeakers_.push_back(std::move(blockFormat));
   }
   void AudioChannelFormat::add(AudioBlockFormatMatrix blockFormat) {
+    loadAudioBlockFormats();
     if (audioBlockFormatsMatrix_.empty()) {
       assignId(blockFormat);
     } else {
@@ -107,6 +127,7 @@ namespace adm {
   }
 
   void AudioChannelFormat::add(AudioBlockFormatObjects blockFormat) {
+    loadAudioBlockFormats();
     if (audioBlockFormatsObjects_.empty()) {
       assignId(blockFormat);
     } else {
@@ -116,6 +137,7 @@ namespace adm {
   }
 
   void AudioChannelFormat::add(AudioBlockFormatHoa blockFormat) {
+    loadAudioBlockFormats();
     if (audioBlockFormatsHoa_.empty()) {
       assignId(blockFormat);
     } else {
@@ -125,6 +147,7 @@ namespace adm {
   }
 
   void AudioChannelFormat::add(AudioBlockFormatBinaural blockFormat) {
+    loadAudioBlockFormats();
     if (audioBlockFormatsBinaural_.empty()) {
       assignId(blockFormat);
     } else {
@@ -133,60 +156,104 @@ namespace adm {
     audioBlockFormatsBinaural_.push_back(std::move(blockFormat));
   }
 
+  template <typename BlockFormat>
+  void AudioChannelFormat::addAfterGap(std::vector<BlockFormat> &blockFormats,
+                                       BlockFormat blockFormat) {
+    loadAudioBlockFormats();
+    // without a previous block, assignId() only checks the type and value;
+    // blocks without an ID still get the next counter
+    if (isUndefined(blockFormat.template get<AudioBlockFormatId>()) &&
+        !blockFormats.empty()) {
+      assignId(blockFormat, &blockFormats.back());
+    } else {
+      assignId(blockFormat);
+    }
+    blockFormats.push_back(std::move(blockFormat));
+  }
+
+  void AudioChannelFormat::addAfterGap(
+      AudioBlockFormatDirectSpeakers blockFormat) {
+    addAfterGap(audioBlockFormatsDirectSpeakers_, std::move(blockFormat));
+  }
+  void AudioChannelFormat::addAfterGap(AudioBlockFormatMatrix blockFormat) {
+    addAfterGap(audioBlockFormatsMatrix_, std::move(blockFormat));
+  }
+  void AudioChannelFormat::addAfterGap(AudioBlockFormatObjects blockFormat) {
+    addAfterGap(audioBlockFormatsObjects_, std::move(blockFormat));
+  }
+  void AudioChannelFormat::addAfterGap(AudioBlockFormatHoa blockFormat) {
+    addAfterGap(audioBlockFormatsHoa_, std::move(blockFormat));
+  }
+  void AudioChannelFormat::addAfterGap(AudioBlockFormatBinaural blockFormat) {
+    addAfterGap(audioBlockFormatsBinaural_, std::move(blockFormat));
+  }
+
   BlockFormatsConstRange<AudioBlockFormatDirectSpeakers>
   AudioChannelFormat::get(
       detail::ParameterTraits<AudioBlockFormatDirectSpeakers>::tag) const {
+    loadAudioBlockFormats();
     return boost::make_iterator_range(audioBlockFormatsDirectSpeakers_.begin(),
                                       audioBlockFormatsDirectSpeakers_.end());
   }
   BlockFormatsConstRange<AudioBlockFormatMatrix> AudioChannelFormat::get(
       detail::ParameterTraits<AudioBlockFormatMatrix>::tag) const {
+    loadAudioBlockFormats();
     return boost::make_iterator_range(audioBlockFormatsMatrix_.begin(),
                                       audioBlockFormatsMatrix_.end());
   }
   BlockFormatsConstRange<AudioBlockFormatObjects> AudioChannelFormat::get(
       detail::ParameterTraits<AudioBlockFormatObjects>::tag) const {
+    loadAudioBlockFormats();
     return boost::make_iterator_range(audioBlockFormatsObjects_.begin(),
                                       audioBlockFormatsObjects_.end());
   }
   BlockFormatsConstRange<AudioBlockFormatHoa> AudioChannelFormat::get(
       detail::ParameterTraits<AudioBlockFormatHoa>::tag) const {
+    loadAudioBlockFormats();
     return boost::make_iterator_range(audioBlockFormatsHoa_.begin(),
                                       audioBlockFormatsHoa_.end());
   }
   BlockFormatsConstRange<AudioBlockFormatBinaural> AudioChannelFormat::get(
       detail::ParameterTraits<AudioBlockFormatBinaural>::tag) const {
+    loadAudioBlockFormats();
     return boost::make_iterator_range(audioBlockFormatsBinaural_.begin(),
                                       audioBlockFormatsBinaural_.end());
   }
 
   BlockFormatsRange<AudioBlockFormatDirectSpeakers> AudioChannelFormat::get(
       detail::ParameterTraits<AudioBlockFormatDirectSpeakers>::tag) {
+    loadAudioBlockFormats();
     return boost::make_iterator_range(audioBlockFormatsDirectSpeakers_.begin(),
                                       audioBlockFormatsDirectSpeakers_.end());
   }
   BlockFormatsRange<AudioBlockFormatMatrix> AudioChannelFormat::get(
       detail::ParameterTraits<AudioBlockFormatMatrix>::tag) {
+    loadAudioBlockFormats();
     return boost::make_iterator_range(audioBlockFormatsMatrix_.begin(),
                                       audioBlockFormatsMatrix_.end());
   }
   BlockFormatsRange<AudioBlockFormatObjects> AudioChannelFormat::get(
       detail::ParameterTraits<AudioBlockFormatObjects>::tag) {
+    loadAudioBlockFormats();
     return boost::make_iterator_range(audioBlockFormatsObjects_.begin(),
                                       audioBlockFormatsObjects_.end());
   }
   BlockFormatsRange<AudioBlockFormatHoa> AudioChannelFormat::get(
       detail::ParameterTraits<AudioBlockFormatHoa>::tag) {
+    loadAudioBlockFormats();
     return boost::make_iterator_range(audioBlockFormatsHoa_.begin(),
                                       audioBlockFormatsHoa_.end());
   }
   BlockFormatsRange<AudioBlockFormatBinaural> AudioChannelFormat::get(
       detail::ParameterTraits<AudioBlockFormatBinaural>::tag) {
+    loadAudioBlockFormats();
     return boost::make_iterator_range(audioBlockFormatsBinaural_.begin(),
                                       audioBlockFormatsBinaural_.end());
   }
 
   void AudioChannelFormat::clearAudioBlockFormats() {
+    std::atomic_store(&audioBlockFormatLoader_,
+                      std::shared_ptr<AudioBlockFormatLoaderState>());
     audioBlockFormatsDirectSpeakers_.clear();
     audioBlockFormatsMatrix_.clear();
     audioBlockFormatsObjects_.clear();
@@ -194,6 +261,64 @@ namespace adm {
     audioBlockFormatsBinaural_.clear();
   }
 
+  void AudioChannelFormat::reserveAudioBlockFormats(std::size_t count) {
+    loadAudioBlockFormats();
+    auto type = get<TypeDescriptor>();
+    if (type == TypeDefinition::DIRECT_SPEAKERS) {
+      audioBlockFormatsDirectSpeakers_.reserve(count);
+    } else if (type == TypeDefinition::MATRIX) {
+      audioBlockFormatsMatrix_.reserve(count);
+    } else if (type == TypeDefinition::OBJECTS) {
+      audioBlockFormatsObjects_.reserve(count);
+    } else if (type == TypeDefinition::HOA) {
+      audioBlockFormatsHoa_.reserve(count);
+    } else if (type == TypeDefinition::BINAURAL) {
+      audioBlockFormatsBinaural_.reserve(count);
+    }
+  }
+
+  void AudioChannelFormat::setAudioBlockFormatLoader(
+      AudioBlockFormatLoader loader) {
+    std::shared_ptr<AudioBlockFormatLoaderState> state;
+    if (loader) {
+      state = std::make_shared<AudioBlockFormatLoaderState>();
+      state->loader = std::move(loader);
+    }
+    std::atomic_store(&audioBlockFormatLoader_, std::move(state));
+  }
+
+  void AudioChannelFormat::loadAudioBlockFormats() const {
+    auto state = std::atomic_load(&audioBlockFormatLoader_);
+    if (!state) {
+      return;
+    }
+    std::lock_guard<std::recursive_mutex> lock(state->mutex);
+    // another thread may have loaded the blocks while this one waited, and
+    // the loader adds blocks through add(), which calls this again
+    if (!state->loader) {
+      return;
+    }
+    auto loader = std::move(state->loader);
+    state->loader = nullptr;
+    // this is only called on AudioChannelFormats made by create(), which are
+    // not const
+    auto& self = const_cast<AudioChannelFormat&>(*this);
+    try {
+      loader(self);
+    } catch (...) {
+      // try again next time, rather than leaving some of the blocks
+      self.audioBlockFormatsDirectSpeakers_.clear();
+      self.audioBlockFormatsMatrix_.clear();
+      self.audioBlockFormatsObjects_.clear();
+      self.audioBlockFormatsHoa_.clear();
+      self.audioBlockFormatsBinaural_.clear();
+      state->loader = std::move(loader);
+      throw;
+    }
+    std::atomic_store(&audioBlockFormatLoader_,
+                      std::shared_ptr<AudioBlockFormatLoaderState>());
+  }
+
   // ---- Common ---- //
   void AudioChannelFormat::print(std::ostream& os) const {
     os << get<AudioChannelFormatId>();
@@ -216,8 +341,19 @@ namespace adm {
   }
 
   std::shared_ptr<AudioChannelFormat> AudioChannelFormat::copy() const {
+    // hold the loader's mutex so that the blocks are not copied while
+    // another thread loads them, and give the copy a loader of its own
+    auto state = std::atomic_load(&audioBlockFormatLoader_);
+    std::unique_lock<std::recursive_mutex> lock;
+    if (state) {
+      lock = std::unique_lock<std::recursive_mutex>(state->mutex);
+    }
     auto audioChannelFormatCopy =
         std::shared_ptr<AudioChannelFormat>(new AudioChannelFormat(*this));
+    audioChannelFormatCopy->audioBlockFormatLoader_ = nullptr;
+    if (state && state->loader) {
+      audioChannelFormatCopy->setAudioBlockFormatLoader(state->loader);
+    }
     audioChannelFormatCopy->setParent(std::weak_ptr<Document>());
     return audioChannelFormatCopy;
   }
@@ -1,6 +1,7 @@
 #include "adm/elements/jump_position.hpp"
 
 #include <iomanip>
+#include "adm/private/number_parsing.hpp"
 
 namespace adm {
 
@@ -68,9 +69,10 @@ namespace adm {
     return jumpPosition.set(JumpPositionFlag(false));
   }
   InterpolationLength parseInterpolationLength(const std::string &length) {
-    auto floatTime = std::chrono::duration<float>(stof(length));
+    auto time = std::chrono::duration<double>(xml::detail::parseDouble(
+        length.data(), length.data() + length.size()));
     return InterpolationLength(
-        std::chrono::duration_cast<std::chrono::nanoseconds>(floatTime));
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time));
   }
 
   std::string formatInterpolationLength(const InterpolationLength length) {
@@ -0,0 +1,118 @@
+#include "adm/elements/matrix_coefficient.hpp"
+#include <ostream>
+
+namespace adm {
+
+  // ---- Getter ---- //
+  AudioChannelFormatId MatrixCoefficient::get(
+      detail::ParameterTraits<AudioChannelFormatId>::tag) const {
+    return inputChannelFormatId_;
+  }
+  Gain MatrixCoefficient::get(detail::ParameterTraits<Gain>::tag) const {
+    if (flags_ & gainIsDb) {
+      return Gain::fromDb(gain_);
+    }
+    return Gain::fromLinear(gain_);
+  }
+  Phase MatrixCoefficient::get(detail::ParameterTraits<Phase>::tag) const {
+    return Phase(phase_);
+  }
+  Delay MatrixCoefficient::get(detail::ParameterTraits<Delay>::tag) const {
+    return Delay(delay_);
+  }
+
+  // ---- Has ---- //
+  bool MatrixCoefficient::has(
+      detail::ParameterTraits<AudioChannelFormatId>::tag) const {
+    return true;
+  }
+  bool MatrixCoefficient::has(detail::ParameterTraits<Gain>::tag) const {
+    return true;
+  }
+  bool MatrixCoefficient::has(detail::ParameterTraits<Phase>::tag) const {
+    return true;
+  }
+  bool MatrixCoefficient::has(detail::ParameterTraits<Delay>::tag) const {
+    return true;
+  }
+
+  // ---- isDefault ---- //
+  bool MatrixCoefficient::isDefault(
+      detail::ParameterTraits<Gain>::tag) const {
+    return !(flags_ & gainSet);
+  }
+  bool MatrixCoefficient::isDefault(
+      detail::ParameterTraits<Phase>::tag) const {
+    return !(flags_ & phaseSet);
+  }
+  bool MatrixCoefficient::isDefault(
+      detail::ParameterTraits<Delay>::tag) const {
+    return !(flags_ & delaySet);
+  }
+
+  // ---- Setter ---- //
+  void MatrixCoefficient::set(AudioChannelFormatId inputChannelFormatId) {
+    inputChannelFormatId_ = inputChannelFormatId;
+  }
+  void MatrixCoefficient::set(Gain gain) {
+    if (gain.isDb()) {
+      gain_ = gain.asDb();
+      flags_ |= gainSet | gainIsDb;
+    } else {
+      gain_ = gain.asLinear();
+      flags_ = (flags_ | gainSet) & ~gainIsDb;
+    }
+  }
+  void MatrixCoefficient::set(Phase phase) {
+    phase_ = phase.get();
+    flags_ |= phaseSet;
+  }
+  void MatrixCoefficient::set(Delay delay) {
+    delay_ = delay.get();
+    flags_ |= delaySet;
+  }
+
+  // ---- Unsetter ---- //
+  void MatrixCoefficient::unset(detail::ParameterTraits<Gain>::tag) {
+    gain_ = 1.0;
+    flags_ &= ~(gainSet | gainIsDb);
+  }
+  void MatrixCoefficient::unset(detail::ParameterTraits<Phase>::tag) {
+    phase_ = 0.0f;
+    flags_ &= ~phaseSet;
+  }
+  void MatrixCoefficient::unset(detail::ParameterTraits<Delay>::tag) {
+    delay_ = 0.0f;
+    flags_ &= ~delaySet;
+  }
+
+  void MatrixCoefficient::print(std::ostream &os) const {
+    os << "(inputChannelFormatIDRef=" << formatId(inputChannelFormatId_);
+    if (flags_ & gainSet) {
+      os << ", gain=" << gain_ << ((flags_ & gainIsDb) ? "dB" : "");
+    }
+    if (flags_ & phaseSet) {
+      os << ", phase=" << phase_;
+    }
+    if (flags_ & delaySet) {
+      os << ", delay=" << delay_;
+    }
+    os << ")";
+  }
+
+  // ---- Free Functions ---- //
+  bool operator==(const MatrixCoefficient &lhs, const MatrixCoefficient &rhs) {
+    return lhs.get<AudioChannelFormatId>() == rhs.get<AudioChannelFormatId>() &&
+           lhs.isDefault<Gain>() == rhs.isDefault<Gain>() &&
+           lhs.get<Gain>().isDb() == rhs.get<Gain>().isDb() &&
+           lhs.get<Gain>().get() == rhs.get<Gain>().get() &&
+           lhs.isDefault<Phase>() == rhs.isDefault<Phase>() &&
+           lhs.get<Phase>() == rhs.get<Phase>() &&
+           lhs.isDefault<Delay>() == rhs.isDefault<Delay>() &&
+           lhs.get<Delay>() == rhs.get<Delay>();
+  }
+  bool operator!=(const MatrixCoefficient &lhs, const MatrixCoefficient &rhs) {
+    return !(lhs == rhs);
+  }
+
+}  // namespace adm
@@ -1,9 +1,9 @@
 #include "adm/elements/time.hpp"
 #include <boost/integer/common_factor.hpp>
-#include <boost/format.hpp>
 #include <iomanip>
-#include <regex>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
 
 namespace adm {
 
@@ -42,44 +42,93 @@ namespace adm {
     return boost::apply_visitor(AsFractionalVisitor(), time);
   }
 
-  Time parseTimecode(const std::string& timecode) {
-    const static std::regex commonFormat(
-        "(\\d{2}):(\\d{2}):(\\d{2}).(\\d{1,9})");
-    const static std::regex fractionalFormat(
-        "(\\d{2}):(\\d{2}):(\\d{2}).(\\d+)S(\\d+)");
-
-    std::smatch timecodeMatch;
-    if (std::regex_match(timecode, timecodeMatch, commonFormat)) {
-      // add trailing zeros to string
-      auto nanoseconds =
-          boost::str(boost::format("%1%") %
-                     boost::io::group(std::setw(9), std::left,
-                                      std::setfill('0'), timecodeMatch[4]));
-      return std::chrono::hours(stoi(timecodeMatch[1])) +
-             std::chrono::minutes(stoi(timecodeMatch[2])) +
-             std::chrono::seconds(stoi(timecodeMatch[3])) +
-             std::chrono::nanoseconds(stoi(nanoseconds));
-    } else if (std::regex_match(timecode, timecodeMatch, fractionalFormat)) {
-      int64_t seconds = 3600 * stoi(timecodeMatch[1]) +
-                        60 * stoi(timecodeMatch[2]) +
-                        1 * stoi(timecodeMatch[3]);
-
-      int64_t numerator = stoi(timecodeMatch[4]);
-      int64_t denominator = stoi(timecodeMatch[5]);
-
-      if (denominator == 0) {
-        std::stringstream errorString;
-        errorString << "invalid timecode: " << timecode
-                    << " has a zero denominator";
-        throw std::runtime_error(errorString.str());
+  namespace {
+    [[noreturn]] void throwInvalidTimecode(const std::string& timecode) {
+      std::stringstream errorString;
+      errorString << "invalid timecode: " << timecode;
+      throw std::runtime_error(errorString.str());
+    }
+
+    bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    /// parse exactly two digits at p
+    int parseTwoDigits(const char* p) {
+      return 10 * (p[0] - '0') + (p[1] - '0');
+    }
+
+    /// parse the digits in [begin, end) as an int, throwing out_of_range
+    /// as stoi would if it does not fit
+    int64_t parseDigits(const char* begin, const char* end) {
+      int64_t value = 0;
+      for (const char* p = begin; p != end; ++p) {
+        value = value * 10 + (*p - '0');
+        if (value > std::numeric_limits<int>::max()) {
+          throw std::out_of_range("timecode value out of range: " +
+                                  std::string(begin, end));
+        }
       }
+      return value;
+    }
+  }  // namespace
+
+  /*
+   * Accepts the same strings as the regular expressions
+   *   (\d{2}):(\d{2}):(\d{2}).(\d{1,9})
+   *   (\d{2}):(\d{2}):(\d{2}).(\d+)S(\d+)
+   * which were used previously; note that the separator before the fraction
+   * can be any character other than a line break.
+   */
+  Time parseTimecode(const std::string& timecode) {
+    const char* begin = timecode.data();
+    const char* end = begin + timecode.size();
+
+    // hh:mm:ss followed by a separator; the digits after are checked below
+    if (timecode.size() < 10 || !isDigit(begin[0]) || !isDigit(begin[1]) ||
+        begin[2] != ':' || !isDigit(begin[3]) || !isDigit(begin[4]) ||
+        begin[5] != ':' || !isDigit(begin[6]) || !isDigit(begin[7]) ||
+        begin[8] == '\n' || begin[8] == '\r') {
+      throwInvalidTimecode(timecode);
+    }
+    int hours = parseTwoDigits(begin);
+    int minutes = parseTwoDigits(begin + 3);
+    int seconds = parseTwoDigits(begin + 6);
+
+    const char* fractionBegin = begin + 9;
+    const char* fractionEnd = fractionBegin;
+    while (fractionEnd != end && isDigit(*fractionEnd)) ++fractionEnd;
+    if (fractionEnd == fractionBegin) throwInvalidTimecode(timecode);
+
+    if (fractionEnd == end) {
+      std::ptrdiff_t digits = fractionEnd - fractionBegin;
+      if (digits > 9) throwInvalidTimecode(timecode);
+      // add trailing zeros
+      int64_t nanoseconds = parseDigits(fractionBegin, fractionEnd);
+      for (std::ptrdiff_t i = digits; i < 9; ++i) nanoseconds *= 10;
+      return std::chrono::hours(hours) + std::chrono::minutes(minutes) +
+             std::chrono::seconds(seconds) +
+             std::chrono::nanoseconds(nanoseconds);
+    }
 
-      return FractionalTime{seconds * denominator + numerator, denominator};
-    } else {
+    const char* denominatorBegin = fractionEnd + 1;
+    const char* denominatorEnd = denominatorBegin;
+    while (denominatorEnd != end && isDigit(*denominatorEnd)) ++denominatorEnd;
+    if (*fractionEnd != 'S' || denominatorEnd == denominatorBegin ||
+        denominatorEnd != end) {
+      throwInvalidTimecode(timecode);
+    }
+
+    int64_t totalSeconds = 3600 * hours + 60 * minutes + seconds;
+    int64_t numerator = parseDigits(fractionBegin, fractionEnd);
+    int64_t denominator = parseDigits(denominatorBegin, denominatorEnd);
+
+    if (denominator == 0) {
       std::stringstream errorString;
-      errorString << "invalid timecode: " << timecode;
+      errorString << "invalid timecode: " << timecode
+                  << " has a zero denominator";
       throw std::runtime_error(errorString.str());
     }
+
+    return FractionalTime{totalSeconds * denominator + numerator, denominator};
   }
 
   struct FormatTimeVisitor : public boost::static_visitor<std::string> {
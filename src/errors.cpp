@@ -43,7 +43,7 @@ namespace adm {
         : AdmException(formatMessage(message, line)), line_(line) {}
 
     XmlParsingError::XmlParsingError(int line)
-        : XmlParsingError(formatMessage("Error parsing XML", line)) {}
+        : XmlParsingError("Error parsing XML", line) {}
 
     std::string XmlParsingError::formatMessage(
         const std::string& message, boost::optional<int> line) const {
@@ -71,6 +71,9 @@ namespace adm {
       return boost::str(boost::format("Id %1% could not be resolved") % id);
     }
 
+    ParsingCancelled::ParsingCancelled()
+        : AdmException("parsing was cancelled") {}
+
     XmlParsingUnexpectedAttrError::XmlParsingUnexpectedAttrError(
         const std::string& attr, const std::string& value,
         boost::optional<int> line)
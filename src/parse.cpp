@@ -1,7 +1,15 @@
 #include "adm/parse.hpp"
+#include <algorithm>
+#include <atomic>
+#include <future>
 #include <memory>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 #include "adm/common_definitions.hpp"
+#include "adm/private/document_update.hpp"
+#include "adm/private/thread_pool.hpp"
 #include "adm/private/xml_parser.hpp"
 
 namespace adm {
@@ -19,4 +27,212 @@ namespace adm {
     xml::XmlParser parser(stream, options, commonDefinitions);
     return parser.parse();
   }
+
+  std::shared_ptr<Document> parseXml(char* data, std::size_t size,
+                                     xml::ParserOptions options) {
+    auto commonDefinitions = getCommonDefinitions();
+    xml::XmlParser parser(data, size, options, commonDefinitions);
+    return parser.parse();
+  }
+
+  std::shared_ptr<Document> parseXml(const char* data, std::size_t size,
+                                     xml::ParserOptions options) {
+    auto commonDefinitions = getCommonDefinitions();
+    xml::XmlParser parser(data, size, options, commonDefinitions);
+    return parser.parse();
+  }
+
+  std::shared_ptr<Document> parseXml(const std::string& filename,
+                                     const AudioProgrammeId& programmeId,
+                                     xml::ParserOptions options) {
+    auto commonDefinitions = getCommonDefinitions();
+    xml::XmlParser parser(filename, options, commonDefinitions);
+    parser.selectProgramme(programmeId);
+    return parser.parse();
+  }
+
+  std::shared_ptr<Document> parseXml(std::istream& stream,
+                                     const AudioProgrammeId& programmeId,
+                                     xml::ParserOptions options) {
+    auto commonDefinitions = getCommonDefinitions();
+    xml::XmlParser parser(stream, options, commonDefinitions);
+    parser.selectProgramme(programmeId);
+    return parser.parse();
+  }
+
+  ParseResult parseXmlCollectingErrors(const std::string& filename,
+                                       xml::ParserOptions options) {
+    auto commonDefinitions = getCommonDefinitions();
+    ParseResult result;
+    xml::XmlParser parser(filename, options, commonDefinitions);
+    parser.collectDiagnostics(result.diagnostics);
+    result.document = parser.parse();
+    return result;
+  }
+
+  ParseResult parseXmlCollectingErrors(std::istream& stream,
+                                       xml::ParserOptions options) {
+    auto commonDefinitions = getCommonDefinitions();
+    ParseResult result;
+    xml::XmlParser parser(stream, options, commonDefinitions);
+    parser.collectDiagnostics(result.diagnostics);
+    result.document = parser.parse();
+    return result;
+  }
+
+  std::future<std::shared_ptr<Document>> parseXmlAsync(
+      const std::string& filename, xml::ParserOptions options,
+      ProgressCallback progress, CancellationToken cancellation) {
+    return std::async(std::launch::async, [=]() {
+      auto commonDefinitions = getCommonDefinitions();
+      xml::XmlParser parser(filename, options, commonDefinitions);
+      parser.setProgressCallback(progress);
+      parser.setCancellationToken(cancellation);
+      return parser.parse();
+    });
+  }
+
+  std::future<std::shared_ptr<Document>> parseXmlAsync(
+      const char* data, std::size_t size, xml::ParserOptions options,
+      ProgressCallback progress, CancellationToken cancellation) {
+    // copy the input now, and parse the copy in place
+    auto buffer = std::make_shared<std::vector<char>>(data, data + size);
+    buffer->push_back('\0');
+    return std::async(std::launch::async, [=]() {
+      auto commonDefinitions = getCommonDefinitions();
+      xml::XmlParser parser(buffer->data(), size, options, commonDefinitions);
+      parser.setProgressCallback(progress);
+      parser.setCancellationToken(cancellation);
+      return parser.parse();
+    });
+  }
+
+  ParserContext::ParserContext() : scratch_(new xml::ParserScratch) {}
+
+  ParserContext::~ParserContext() = default;
+
+  std::shared_ptr<Document> ParserContext::parseXml(
+      const std::string& filename, xml::ParserOptions options) {
+    auto commonDefinitions = getCommonDefinitions();
+    xml::XmlParser parser(filename, options, commonDefinitions,
+                          scratch_.get());
+    return parser.parse();
+  }
+
+  std::shared_ptr<Document> ParserContext::parseXml(
+      std::istream& stream, xml::ParserOptions options) {
+    auto commonDefinitions = getCommonDefinitions();
+    xml::XmlParser parser(stream, options, commonDefinitions, scratch_.get());
+    return parser.parse();
+  }
+
+  std::shared_ptr<Document> ParserContext::parseXml(
+      char* data, std::size_t size, xml::ParserOptions options) {
+    auto commonDefinitions = getCommonDefinitions();
+    xml::XmlParser parser(data, size, options, commonDefinitions,
+                          scratch_.get());
+    return parser.parse();
+  }
+
+  std::shared_ptr<Document> ParserContext::parseXml(
+      const char* data, std::size_t size, xml::ParserOptions options) {
+    auto commonDefinitions = getCommonDefinitions();
+    xml::XmlParser parser(data, size, options, commonDefinitions,
+                          scratch_.get());
+    return parser.parse();
+  }
+
+  BatchParser::BatchParser(unsigned threads) {
+    if (threads == 0) {
+      threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    // the calling thread also takes part in ThreadPool::parallelFor
+    pool_.reset(new detail::ThreadPool(threads - 1));
+    for (unsigned i = 0; i < threads; ++i) {
+      scratch_.emplace_back(new xml::ParserScratch);
+    }
+  }
+
+  BatchParser::~BatchParser() = default;
+
+  unsigned BatchParser::threads() const {
+    return static_cast<unsigned>(scratch_.size());
+  }
+
+  namespace {
+    /// call parse(i, scratch) for each of n inputs on the threads of pool,
+    /// with one of scratch for each thread
+    template <typename Parse>
+    std::vector<BatchParseResult> parseBatch(
+        detail::ThreadPool& pool,
+        std::vector<std::unique_ptr<xml::ParserScratch>>& scratch,
+        std::size_t n, Parse parse) {
+      std::vector<BatchParseResult> results(n);
+      // each worker takes the next input until there are none left, so that
+      // a few large inputs do not hold up the rest
+      std::atomic<std::size_t> next{0};
+      pool.parallelFor(std::min(scratch.size(), n), [&](std::size_t worker) {
+        for (std::size_t i = next++; i < n; i = next++) {
+          try {
+            results[i].document = parse(i, *scratch[worker]);
+          } catch (...) {
+            results[i].error = std::current_exception();
+          }
+        }
+      });
+      return results;
+    }
+  }  // namespace
+
+  std::vector<BatchParseResult> BatchParser::parseXml(
+      const std::vector<std::string>& filenames, xml::ParserOptions options) {
+    return parseBatch(
+        *pool_, scratch_, filenames.size(),
+        [&](std::size_t i, xml::ParserScratch& scratch) {
+          auto commonDefinitions = getCommonDefinitions();
+          xml::XmlParser parser(filenames[i], options, commonDefinitions,
+                                &scratch);
+          return parser.parse();
+        });
+  }
+
+  std::vector<BatchParseResult> BatchParser::parseXml(
+      const std::vector<XmlBuffer>& buffers, xml::ParserOptions options) {
+    return parseBatch(
+        *pool_, scratch_, buffers.size(),
+        [&](std::size_t i, xml::ParserScratch& scratch) {
+          auto commonDefinitions = getCommonDefinitions();
+          xml::XmlParser parser(buffers[i].data, buffers[i].size, options,
+                                commonDefinitions, &scratch);
+          return parser.parse();
+        });
+  }
+
+  FrameParser::FrameParser(std::shared_ptr<Document> document)
+      : document_(std::move(document)), idMap_(new detail::IDMap(*document_)) {}
+
+  FrameParser::~FrameParser() = default;
+
+  void FrameParser::parseFrame(std::istream& stream) {
+    xml::XmlParser parser(stream, document_, *idMap_);
+    parser.parseFrame();
+  }
+
+  std::shared_ptr<Document> FrameParser::getDocument() const {
+    return document_;
+  }
+
+  ReparseSummary reparseXml(const std::shared_ptr<Document>& document,
+                            std::istream& stream,
+                            xml::ParserOptions options) {
+    auto parsed = parseXml(stream, options);
+    return detail::updateDocument(document, *parsed);
+  }
+
+  ReparseSummary reparseXml(const std::shared_ptr<Document>& document,
+                            const std::string& filename,
+                            xml::ParserOptions options) {
+    auto parsed = parseXml(filename, options);
+    return detail::updateDocument(document, *parsed);
+  }
 }  // namespace adm
@@ -0,0 +1,288 @@
+#include "adm/parse.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "adm/document.hpp"
+#include "adm/version.hpp"
+#include "adm/private/common_definitions.hpp"
+#include "adm/private/content_hash.hpp"
+#include "adm/private/document_serialization.hpp"
+#include "adm/private/mapped_file.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace adm {
+
+  namespace {
+    /// change this whenever the layout of entries or the serialized form of
+    /// documents changes
+    const std::uint32_t formatVersion = 2;
+    const char magic[8] = {'A', 'D', 'M', 'C', 'A', 'C', 'H', 'E'};
+    const std::uint32_t byteOrderMark = 0x01020304;
+
+    bool isSet(xml::ParserOptions options, xml::ParserOptions flag) {
+      return static_cast<bool>(options & flag);
+    }
+
+    template <typename T>
+    void append(std::string& data, T value) {
+      data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename Element>
+    std::uint32_t count(const Document& document) {
+      return static_cast<std::uint32_t>(
+          document.getElements<Element>().size());
+    }
+
+    /**
+     * @brief Everything that must match for an entry to be used
+     *
+     * This is the first part of every entry, followed by the size and
+     * checksum of the serialized document, and then the document itself.
+     */
+    std::string makeKey(const detail::ContentHash& hash, std::size_t size,
+                        xml::ParserOptions options) {
+      std::string key(magic, sizeof(magic));
+      append(key, formatVersion);
+      append(key, byteOrderMark);
+      append(key, hash.first);
+      append(key, hash.second);
+      append(key, static_cast<std::uint64_t>(size));
+      append(key, static_cast<std::uint32_t>(options));
+
+      std::string version = ADM_VERSION;
+      append(key, static_cast<std::uint32_t>(version.size()));
+      key += version;
+
+      auto commonDefinitions = detail::getCommonDefinitionsSnapshot();
+      append(key, count<AudioProgramme>(*commonDefinitions));
+      append(key, count<AudioContent>(*commonDefinitions));
+      append(key, count<AudioObject>(*commonDefinitions));
+      append(key, count<AudioPackFormat>(*commonDefinitions));
+      append(key, count<AudioChannelFormat>(*commonDefinitions));
+      append(key, count<AudioStreamFormat>(*commonDefinitions));
+      append(key, count<AudioTrackFormat>(*commonDefinitions));
+      append(key, count<AudioTrackUid>(*commonDefinitions));
+      return key;
+    }
+
+    std::string entryName(const detail::ContentHash& hash,
+                          xml::ParserOptions options) {
+      std::ostringstream name;
+      name << std::hex << std::setfill('0') << std::setw(16) << hash.first
+           << std::setw(16) << hash.second << "-" << std::setw(8)
+           << static_cast<unsigned>(options) << ".admcache";
+      return name.str();
+    }
+
+    std::string joinPath(const std::string& directory,
+                         const std::string& name) {
+      if (directory.empty()) {
+        return name;
+      }
+      char last = directory.back();
+      if (last == '/' || last == '\\') {
+        return directory + name;
+      }
+      return directory + "/" + name;
+    }
+
+    /// read a whole file, or return false if it can not be read
+    bool readEntry(const std::string& path, std::vector<char>& data) {
+      std::ifstream file(path, std::ios::binary);
+      if (!file) {
+        return false;
+      }
+      data.assign(std::istreambuf_iterator<char>(file),
+                  std::istreambuf_iterator<char>());
+      return !file.bad();
+    }
+
+    /**
+     * @brief Load the document from an entry
+     *
+     * @returns nullptr if the entry does not match key or is corrupt
+     */
+    std::shared_ptr<Document> loadEntry(const std::vector<char>& entry,
+                                        const std::string& key) {
+      const std::size_t headerSize = key.size() + 2 * sizeof(std::uint64_t);
+      if (entry.size() < headerSize ||
+          std::memcmp(entry.data(), key.data(), key.size()) != 0) {
+        return nullptr;
+      }
+      std::uint64_t payloadSize;
+      std::uint64_t checksum;
+      std::memcpy(&payloadSize, entry.data() + key.size(),
+                  sizeof(payloadSize));
+      std::memcpy(&checksum, entry.data() + key.size() + sizeof(payloadSize),
+                  sizeof(checksum));
+      if (payloadSize != entry.size() - headerSize) {
+        return nullptr;
+      }
+      const char* payload = entry.data() + headerSize;
+      auto size = static_cast<std::size_t>(payloadSize);
+      if (detail::hash64(payload, size) != checksum) {
+        return nullptr;
+      }
+      try {
+        return detail::deserializeDocument(payload, size);
+      } catch (const std::exception&) {
+        return nullptr;
+      }
+    }
+
+#ifdef _WIN32
+    void makeDirectory(const std::string& path) {
+      CreateDirectoryA(path.c_str(), nullptr);
+    }
+
+    unsigned long processId() { return GetCurrentProcessId(); }
+
+    bool replaceFile(const std::string& from, const std::string& to) {
+      return MoveFileExA(from.c_str(), to.c_str(),
+                         MOVEFILE_REPLACE_EXISTING) != 0;
+    }
+#else
+    void makeDirectory(const std::string& path) { mkdir(path.c_str(), 0777); }
+
+    unsigned long processId() {
+      return static_cast<unsigned long>(getpid());
+    }
+
+    bool replaceFile(const std::string& from, const std::string& to) {
+      return std::rename(from.c_str(), to.c_str()) == 0;
+    }
+#endif
+
+    /// write an entry so that readers never see it partly written; failures
+    /// are ignored
+    void writeEntry(const std::string& path, const std::string& key,
+                    const std::string& payload) {
+      static std::atomic<unsigned> counter{0};
+      std::ostringstream temporaryPath;
+      temporaryPath << path << "." << processId() << "." << counter++
+                    << ".tmp";
+      {
+        std::ofstream file(temporaryPath.str(), std::ios::binary);
+        if (!file) {
+          return;
+        }
+        file.write(key.data(), static_cast<std::streamsize>(key.size()));
+        std::string sizes;
+        append(sizes, static_cast<std::uint64_t>(payload.size()));
+        append(sizes, detail::hash64(payload.data(), payload.size()));
+        file.write(sizes.data(), static_cast<std::streamsize>(sizes.size()));
+        file.write(payload.data(),
+                   static_cast<std::streamsize>(payload.size()));
+        file.close();
+        if (!file) {
+          std::remove(temporaryPath.str().c_str());
+          return;
+        }
+      }
+      if (!replaceFile(temporaryPath.str(), path)) {
+        std::remove(temporaryPath.str().c_str());
+      }
+    }
+  }  // namespace
+
+  ParseCache::ParseCache(std::string directory)
+      : directory_(std::move(directory)) {
+    if (!directory_.empty()) {
+      makeDirectory(directory_);
+    }
+  }
+
+  std::shared_ptr<Document> ParseCache::parseXml(const std::string& filename,
+                                                 xml::ParserOptions options) {
+    if (isSet(options, xml::ParserOptions::memory_map)) {
+      xml::MappedFile file(filename);
+      return parse(file.data(), file.size(), options);
+    }
+    std::ifstream stream(filename, std::ios::binary);
+    if (!stream) {
+      throw std::runtime_error("cannot open file " + filename);
+    }
+    return parseXml(stream, options);
+  }
+
+  std::shared_ptr<Document> ParseCache::parseXml(std::istream& stream,
+                                                 xml::ParserOptions options) {
+    std::vector<char> buffer((std::istreambuf_iterator<char>(stream)),
+                             std::istreambuf_iterator<char>());
+    if (stream.bad()) {
+      throw std::runtime_error("error reading stream");
+    }
+    auto size = buffer.size();
+    buffer.push_back('\0');
+    return parse(buffer.data(), size, options);
+  }
+
+  std::shared_ptr<Document> ParseCache::parseXml(const char* data,
+                                                 std::size_t size,
+                                                 xml::ParserOptions options) {
+    // parsing is done in place, so work on a copy
+    std::vector<char> buffer(data, data + size);
+    buffer.push_back('\0');
+    return parse(buffer.data(), size, options);
+  }
+
+  std::string ParseCache::entryPath(const char* data, std::size_t size,
+                                    xml::ParserOptions options) const {
+    return joinPath(directory_,
+                    entryName(detail::hashContent(data, size), options));
+  }
+
+  std::shared_ptr<Document> ParseCache::parse(char* data, std::size_t size,
+                                              xml::ParserOptions options) {
+    if (isSet(options, xml::ParserOptions::lazy_audio_block_formats)) {
+      ++misses_;
+      return adm::parseXml(data, size, options);
+    }
+
+    // the input must be hashed before it is parsed in place
+    auto hash = detail::hashContent(data, size);
+    auto path = joinPath(directory_, entryName(hash, options));
+    auto key = makeKey(hash, size, options);
+
+    std::vector<char> entry;
+    if (readEntry(path, entry)) {
+      if (auto document = loadEntry(entry, key)) {
+        ++hits_;
+        return document;
+      }
+    }
+
+    ++misses_;
+    auto document = adm::parseXml(data, size, options);
+    std::string payload;
+    try {
+      payload = detail::serializeDocument(*document);
+    } catch (const std::exception&) {
+      return document;
+    }
+    writeEntry(path, key, payload);
+    return document;
+  }
+
+}  // namespace adm
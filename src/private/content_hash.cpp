@@ -0,0 +1,143 @@
+#include "adm/private/content_hash.hpp"
+#include <cstring>
+
+namespace adm {
+  namespace detail {
+
+    namespace {
+      const std::uint64_t prime1 = 11400714785074694791ULL;
+      const std::uint64_t prime2 = 14029467366897019727ULL;
+      const std::uint64_t prime3 = 1609587929392839161ULL;
+      const std::uint64_t prime4 = 9650029242287828579ULL;
+      const std::uint64_t prime5 = 2870177450012600261ULL;
+
+      std::uint64_t rotateLeft(std::uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+      }
+
+      std::uint64_t read64(const char* data) {
+        std::uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+      }
+
+      std::uint32_t read32(const char* data) {
+        std::uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+      }
+
+      std::uint64_t round(std::uint64_t accumulator, std::uint64_t input) {
+        accumulator += input * prime2;
+        accumulator = rotateLeft(accumulator, 31);
+        return accumulator * prime1;
+      }
+
+      std::uint64_t mergeRound(std::uint64_t accumulator, std::uint64_t value) {
+        accumulator ^= round(0, value);
+        return accumulator * prime1 + prime4;
+      }
+
+      /// the state of an XXH64 hash over a number of 32 byte stripes
+      struct Lanes {
+        explicit Lanes(std::uint64_t seed)
+            : v1(seed + prime1 + prime2),
+              v2(seed + prime2),
+              v3(seed),
+              v4(seed - prime1) {}
+
+        void consume(const char* stripe) {
+          v1 = round(v1, read64(stripe));
+          v2 = round(v2, read64(stripe + 8));
+          v3 = round(v3, read64(stripe + 16));
+          v4 = round(v4, read64(stripe + 24));
+        }
+
+        std::uint64_t merge() const {
+          std::uint64_t hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) +
+                               rotateLeft(v3, 12) + rotateLeft(v4, 18);
+          hash = mergeRound(hash, v1);
+          hash = mergeRound(hash, v2);
+          hash = mergeRound(hash, v3);
+          return mergeRound(hash, v4);
+        }
+
+        std::uint64_t v1, v2, v3, v4;
+      };
+
+      /// process the bytes after the last whole stripe, and mix the result
+      std::uint64_t finish(std::uint64_t hash, const char* data,
+                           std::size_t size) {
+        while (size >= 8) {
+          hash ^= round(0, read64(data));
+          hash = rotateLeft(hash, 27) * prime1 + prime4;
+          data += 8;
+          size -= 8;
+        }
+        if (size >= 4) {
+          hash ^= static_cast<std::uint64_t>(read32(data)) * prime1;
+          hash = rotateLeft(hash, 23) * prime2 + prime3;
+          data += 4;
+          size -= 4;
+        }
+        while (size > 0) {
+          hash ^= static_cast<std::uint64_t>(
+                      static_cast<unsigned char>(*data)) *
+                  prime5;
+          hash = rotateLeft(hash, 11) * prime1;
+          ++data;
+          --size;
+        }
+
+        hash ^= hash >> 33;
+        hash *= prime2;
+        hash ^= hash >> 29;
+        hash *= prime3;
+        hash ^= hash >> 32;
+        return hash;
+      }
+
+      const std::uint64_t secondSeed = 0x9e3779b97f4a7c15ULL;
+    }  // namespace
+
+    std::uint64_t hash64(const char* data, std::size_t size,
+                         std::uint64_t seed) {
+      std::size_t stripes = size / 32;
+      std::uint64_t hash;
+      if (stripes > 0) {
+        Lanes lanes(seed);
+        for (std::size_t i = 0; i < stripes; ++i) {
+          lanes.consume(data + i * 32);
+        }
+        hash = lanes.merge();
+      } else {
+        hash = seed + prime5;
+      }
+      hash += static_cast<std::uint64_t>(size);
+      return finish(hash, data + stripes * 32, size - stripes * 32);
+    }
+
+    ContentHash hashContent(const char* data, std::size_t size) {
+      std::size_t stripes = size / 32;
+      std::uint64_t first = 0 + prime5;
+      std::uint64_t second = secondSeed + prime5;
+      if (stripes > 0) {
+        Lanes firstLanes(0);
+        Lanes secondLanes(secondSeed);
+        for (std::size_t i = 0; i < stripes; ++i) {
+          firstLanes.consume(data + i * 32);
+          secondLanes.consume(data + i * 32);
+        }
+        first = firstLanes.merge();
+        second = secondLanes.merge();
+      }
+      const char* tail = data + stripes * 32;
+      std::size_t tailSize = size - stripes * 32;
+      first += static_cast<std::uint64_t>(size);
+      second += static_cast<std::uint64_t>(size);
+      return ContentHash{finish(first, tail, tailSize),
+                         finish(second, tail, tailSize)};
+    }
+
+  }  // namespace detail
+}  // namespace adm
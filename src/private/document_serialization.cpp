@@ -0,0 +1,1199 @@
+#include "adm/private/document_serialization.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "adm/common_definitions.hpp"
+#include "adm/elements.hpp"
+
+namespace adm {
+  namespace detail {
+
+    namespace {
+
+      std::runtime_error malformed() {
+        return std::runtime_error("malformed serialized document");
+      }
+
+      class Writer {
+       public:
+        void unsignedInt(std::uint64_t value) {
+          while (value >= 0x80) {
+            data_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+          }
+          data_.push_back(static_cast<char>(value));
+        }
+
+        void signedInt(std::int64_t value) {
+          // zigzag encoding, so that small negative values are short too
+          unsignedInt((static_cast<std::uint64_t>(value) << 1) ^
+                       static_cast<std::uint64_t>(value >> 63));
+        }
+
+        void raw(const void* data, std::size_t size) {
+          data_.append(static_cast<const char*>(data), size);
+        }
+
+        std::string& data() { return data_; }
+
+       private:
+        std::string data_;
+      };
+
+      class Reader {
+       public:
+        Reader(const char* data, std::size_t size)
+            : position_(data), end_(data + size) {}
+
+        std::uint64_t unsignedInt() {
+          std::uint64_t value = 0;
+          for (int shift = 0; shift < 64; shift += 7) {
+            if (position_ == end_) {
+              throw malformed();
+            }
+            auto byte = static_cast<unsigned char>(*position_++);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+              return value;
+            }
+          }
+          throw malformed();
+        }
+
+        std::int64_t signedInt() {
+          auto value = unsignedInt();
+          return static_cast<std::int64_t>(value >> 1) ^
+                 -static_cast<std::int64_t>(value & 1);
+        }
+
+        void raw(void* data, std::size_t size) {
+          if (remaining() < size) {
+            throw malformed();
+          }
+          std::memcpy(data, position_, size);
+          position_ += size;
+        }
+
+        const char* take(std::size_t size) {
+          if (remaining() < size) {
+            throw malformed();
+          }
+          auto data = position_;
+          position_ += size;
+          return data;
+        }
+
+        /// read a count of items which take at least one byte each
+        std::size_t count() {
+          auto value = unsignedInt();
+          if (value > remaining()) {
+            throw malformed();
+          }
+          return static_cast<std::size_t>(value);
+        }
+
+        std::size_t remaining() const {
+          return static_cast<std::size_t>(end_ - position_);
+        }
+
+       private:
+        const char* position_;
+        const char* end_;
+      };
+
+      /// used to select the read overload for a type
+      template <typename T>
+      struct Type {};
+
+      template <typename... Parameters>
+      struct ParameterList {};
+
+      /**
+       * @brief The parameters of a compound type or element which are stored
+       *
+       * Specialisations define `type` as a ParameterList. Only parameters
+       * which have been set explicitly are stored, and they are set again
+       * in this order when reading, so parameters which affect others
+       * (like DialogueId and the content kinds) must come first.
+       */
+      template <typename T>
+      struct Stored;
+
+      // clang-format off
+      template <>
+      struct Stored<AudioProgramme> {
+        using type = ParameterList<AudioProgrammeLanguage, Start, End, MaxDuckingDepth, AudioProgrammeReferenceScreen, LoudnessMetadatas, Labels>;
+      };
+      template <>
+      struct Stored<AudioContent> {
+        using type = ParameterList<AudioContentLanguage, DialogueId, NonDialogueContentKind, DialogueContentKind, MixedContentKind, LoudnessMetadatas, Labels>;
+      };
+      template <>
+      struct Stored<AudioObject> {
+        using type = ParameterList<Start, Duration, DialogueId, Importance, Interact, DisableDucking, AudioObjectInteraction, Labels, AudioComplementaryObjectGroupLabels, Gain, HeadLocked, SphericalPositionOffset, CartesianPositionOffset, Mute>;
+      };
+      template <>
+      struct Stored<AudioPackFormat> {
+        using type = ParameterList<Importance, AbsoluteDistance>;
+      };
+      template <>
+      struct Stored<AudioPackFormatHoa> {
+        using type = ParameterList<Normalization, NfcRefDist, ScreenRef>;
+      };
+      template <>
+      struct Stored<AudioChannelFormat> {
+        using type = ParameterList<Frequency>;
+      };
+      template <>
+      struct Stored<AudioTrackUid> {
+        using type = ParameterList<SampleRate, BitDepth>;
+      };
+
+      template <>
+      struct Stored<AudioBlockFormatDirectSpeakers> {
+        using type = ParameterList<AudioBlockFormatId, Rtime, Duration, SphericalSpeakerPosition, CartesianSpeakerPosition, SpeakerLabels, HeadLocked, HeadphoneVirtualise, Gain, Importance>;
+      };
+      template <>
+      struct Stored<AudioBlockFormatMatrix> {
+        using type = ParameterList<AudioBlockFormatId, Rtime, Duration, OutputChannelFormatId, MatrixCoefficients, Gain, Importance>;
+      };
+      template <>
+      struct Stored<AudioBlockFormatObjects> {
+        using type = ParameterList<AudioBlockFormatId, Rtime, Duration, Cartesian, SphericalPosition, CartesianPosition, ScreenEdgeLock, Width, Height, Depth, Gain, Diffuse, ChannelLock, ObjectDivergence, JumpPosition, ScreenRef, Importance, HeadLocked, HeadphoneVirtualise>;
+      };
+      template <>
+      struct Stored<AudioBlockFormatHoa> {
+        using type = ParameterList<AudioBlockFormatId, Rtime, Duration, Order, Degree, NfcRefDist, ScreenRef, Normalization, Equation, HeadLocked, HeadphoneVirtualise, Gain, Importance>;
+      };
+      template <>
+      struct Stored<AudioBlockFormatBinaural> {
+        using type = ParameterList<AudioBlockFormatId, Rtime, Duration, Gain, Importance>;
+      };
+
+      template <>
+      struct Stored<LoudnessMetadata> {
+        using type = ParameterList<LoudnessMethod, LoudnessRecType, LoudnessCorrectionType, IntegratedLoudness, LoudnessRange, MaxTruePeak, MaxMomentary, MaxShortTerm, DialogueLoudness>;
+      };
+      template <>
+      struct Stored<Label> {
+        using type = ParameterList<LabelValue, LabelLanguage>;
+      };
+      template <>
+      struct Stored<AudioObjectInteraction> {
+        using type = ParameterList<OnOffInteract, GainInteract, PositionInteract, GainInteractionRange, PositionInteractionRange>;
+      };
+      template <>
+      struct Stored<GainInteractionRange> {
+        using type = ParameterList<GainInteractionMin, GainInteractionMax>;
+      };
+      template <>
+      struct Stored<PositionInteractionRange> {
+        using type = ParameterList<AzimuthInteractionMin, AzimuthInteractionMax, ElevationInteractionMin, ElevationInteractionMax, DistanceInteractionMin, DistanceInteractionMax, XInteractionMin, XInteractionMax, YInteractionMin, YInteractionMax, ZInteractionMin, ZInteractionMax>;
+      };
+      template <>
+      struct Stored<SphericalPositionOffset> {
+        using type = ParameterList<AzimuthOffset, ElevationOffset, DistanceOffset>;
+      };
+      template <>
+      struct Stored<CartesianPositionOffset> {
+        using type = ParameterList<XOffset, YOffset, ZOffset>;
+      };
+      template <>
+      struct Stored<Frequency> {
+        using type = ParameterList<LowPass, HighPass>;
+      };
+      template <>
+      struct Stored<SphericalSpeakerPosition> {
+        using type = ParameterList<Azimuth, AzimuthMin, AzimuthMax, Elevation, ElevationMin, ElevationMax, Distance, DistanceMin, DistanceMax, ScreenEdgeLock>;
+      };
+      template <>
+      struct Stored<CartesianSpeakerPosition> {
+        using type = ParameterList<X, XMin, XMax, Y, YMin, YMax, Z, ZMin, ZMax, ScreenEdgeLock>;
+      };
+      template <>
+      struct Stored<SphericalPosition> {
+        using type = ParameterList<Azimuth, Elevation, Distance, ScreenEdgeLock>;
+      };
+      template <>
+      struct Stored<CartesianPosition> {
+        using type = ParameterList<X, Y, Z, ScreenEdgeLock>;
+      };
+      template <>
+      struct Stored<ScreenEdgeLock> {
+        using type = ParameterList<HorizontalEdge, VerticalEdge>;
+      };
+      template <>
+      struct Stored<HeadphoneVirtualise> {
+        using type = ParameterList<Bypass, DirectToReverberantRatio>;
+      };
+      template <>
+      struct Stored<ChannelLock> {
+        using type = ParameterList<ChannelLockFlag, MaxDistance>;
+      };
+      template <>
+      struct Stored<ObjectDivergence> {
+        using type = ParameterList<Divergence, AzimuthRange, PositionRange>;
+      };
+      template <>
+      struct Stored<JumpPosition> {
+        using type = ParameterList<JumpPositionFlag, InterpolationLength>;
+      };
+      template <>
+      struct Stored<MatrixCoefficient> {
+        using type = ParameterList<AudioChannelFormatId, Gain, Phase, Delay>;
+      };
+      // clang-format on
+
+      // ---- values ---- //
+
+      void write(Writer& writer, bool value) {
+        writer.unsignedInt(value ? 1 : 0);
+      }
+      void write(Writer& writer, int value) { writer.signedInt(value); }
+      void write(Writer& writer, unsigned int value) {
+        writer.unsignedInt(value);
+      }
+      void write(Writer& writer, float value) {
+        writer.raw(&value, sizeof(value));
+      }
+      void write(Writer& writer, double value) {
+        writer.raw(&value, sizeof(value));
+      }
+      void write(Writer& writer, const std::string& value) {
+        writer.unsignedInt(value.size());
+        writer.raw(value.data(), value.size());
+      }
+      void write(Writer& writer, std::chrono::nanoseconds value) {
+        writer.signedInt(value.count());
+      }
+      void write(Writer& writer, const Time& time) {
+        write(writer, time.isFractional());
+        if (time.isFractional()) {
+          auto fractional = time.asFractional();
+          writer.signedInt(fractional.numerator());
+          writer.signedInt(fractional.denominator());
+        } else {
+          write(writer, time.asNanoseconds());
+        }
+      }
+      void write(Writer& writer, const Gain& gain) {
+        write(writer, gain.isDb());
+        write(writer, gain.isDb() ? gain.asDb() : gain.asLinear());
+      }
+      void write(Writer&, const AudioProgrammeReferenceScreen&) {}
+
+      bool read(Reader& reader, Type<bool>) {
+        auto value = reader.unsignedInt();
+        if (value > 1) {
+          throw malformed();
+        }
+        return value == 1;
+      }
+      int read(Reader& reader, Type<int>) {
+        auto value = reader.signedInt();
+        if (value < std::numeric_limits<int>::min() ||
+            value > std::numeric_limits<int>::max()) {
+          throw malformed();
+        }
+        return static_cast<int>(value);
+      }
+      unsigned int read(Reader& reader, Type<unsigned int>) {
+        auto value = reader.unsignedInt();
+        if (value > std::numeric_limits<unsigned int>::max()) {
+          throw malformed();
+        }
+        return static_cast<unsigned int>(value);
+      }
+      float read(Reader& reader, Type<float>) {
+        float value;
+        reader.raw(&value, sizeof(value));
+        return value;
+      }
+      double read(Reader& reader, Type<double>) {
+        double value;
+        reader.raw(&value, sizeof(value));
+        return value;
+      }
+      std::string read(Reader& reader, Type<std::string>) {
+        auto size = reader.count();
+        auto data = reader.take(size);
+        return std::string(data, size);
+      }
+      std::chrono::nanoseconds read(Reader& reader,
+                                    Type<std::chrono::nanoseconds>) {
+        return std::chrono::nanoseconds(reader.signedInt());
+      }
+      Time read(Reader& reader, Type<Time>) {
+        if (read(reader, Type<bool>())) {
+          auto numerator = reader.signedInt();
+          auto denominator = reader.signedInt();
+          return FractionalTime(numerator, denominator);
+        }
+        return read(reader, Type<std::chrono::nanoseconds>());
+      }
+      Gain read(Reader& reader, Type<Gain>) {
+        bool isDb = read(reader, Type<bool>());
+        double value = read(reader, Type<double>());
+        return isDb ? Gain::fromDb(value) : Gain::fromLinear(value);
+      }
+      AudioProgrammeReferenceScreen read(
+          Reader&, Type<AudioProgrammeReferenceScreen>) {
+        return AudioProgrammeReferenceScreen();
+      }
+
+      // ---- ids ---- //
+
+      template <typename T, typename Tag, typename Validator>
+      void write(Writer& writer, const NamedType<T, Tag, Validator>& value);
+      template <typename T, typename Tag, typename Validator>
+      NamedType<T, Tag, Validator> read(Reader& reader,
+                                        Type<NamedType<T, Tag, Validator>>);
+
+      void write(Writer& writer, const AudioProgrammeId& id) {
+        write(writer, id.get<AudioProgrammeIdValue>());
+      }
+      void write(Writer& writer, const AudioContentId& id) {
+        write(writer, id.get<AudioContentIdValue>());
+      }
+      void write(Writer& writer, const AudioObjectId& id) {
+        write(writer, id.get<AudioObjectIdValue>());
+      }
+      void write(Writer& writer, const AudioTrackUidId& id) {
+        write(writer, id.get<AudioTrackUidIdValue>());
+      }
+      void write(Writer& writer, const AudioPackFormatId& id) {
+        write(writer, id.get<TypeDescriptor>());
+        write(writer, id.get<AudioPackFormatIdValue>());
+      }
+      void write(Writer& writer, const AudioChannelFormatId& id) {
+        write(writer, id.get<TypeDescriptor>());
+        write(writer, id.get<AudioChannelFormatIdValue>());
+      }
+      void write(Writer& writer, const AudioStreamFormatId& id) {
+        write(writer, id.get<TypeDescriptor>());
+        write(writer, id.get<AudioStreamFormatIdValue>());
+      }
+      void write(Writer& writer, const AudioTrackFormatId& id) {
+        write(writer, id.get<TypeDescriptor>());
+        write(writer, id.get<AudioTrackFormatIdValue>());
+        write(writer, id.get<AudioTrackFormatIdCounter>());
+      }
+      void write(Writer& writer, const AudioBlockFormatId& id) {
+        write(writer, id.get<TypeDescriptor>());
+        write(writer, id.get<AudioBlockFormatIdValue>());
+        write(writer, id.get<AudioBlockFormatIdCounter>());
+      }
+
+      AudioProgrammeId read(Reader& reader, Type<AudioProgrammeId>) {
+        return AudioProgrammeId(read(reader, Type<AudioProgrammeIdValue>()));
+      }
+      AudioContentId read(Reader& reader, Type<AudioContentId>) {
+        return AudioContentId(read(reader, Type<AudioContentIdValue>()));
+      }
+      AudioObjectId read(Reader& reader, Type<AudioObjectId>) {
+        return AudioObjectId(read(reader, Type<AudioObjectIdValue>()));
+      }
+      AudioTrackUidId read(Reader& reader, Type<AudioTrackUidId>) {
+        return AudioTrackUidId(read(reader, Type<AudioTrackUidIdValue>()));
+      }
+      AudioPackFormatId read(Reader& reader, Type<AudioPackFormatId>) {
+        auto type = read(reader, Type<TypeDescriptor>());
+        auto value = read(reader, Type<AudioPackFormatIdValue>());
+        return AudioPackFormatId(type, value);
+      }
+      AudioChannelFormatId read(Reader& reader, Type<AudioChannelFormatId>) {
+        auto type = read(reader, Type<TypeDescriptor>());
+        auto value = read(reader, Type<AudioChannelFormatIdValue>());
+        return AudioChannelFormatId(type, value);
+      }
+      AudioStreamFormatId read(Reader& reader, Type<AudioStreamFormatId>) {
+        auto type = read(reader, Type<TypeDescriptor>());
+        auto value = read(reader, Type<AudioStreamFormatIdValue>());
+        return AudioStreamFormatId(type, value);
+      }
+      AudioTrackFormatId read(Reader& reader, Type<AudioTrackFormatId>) {
+        auto type = read(reader, Type<TypeDescriptor>());
+        auto value = read(reader, Type<AudioTrackFormatIdValue>());
+        auto counter = read(reader, Type<AudioTrackFormatIdCounter>());
+        return AudioTrackFormatId(type, value, counter);
+      }
+      AudioBlockFormatId read(Reader& reader, Type<AudioBlockFormatId>) {
+        auto type = read(reader, Type<TypeDescriptor>());
+        auto value = read(reader, Type<AudioBlockFormatIdValue>());
+        auto counter = read(reader, Type<AudioBlockFormatIdCounter>());
+        return AudioBlockFormatId(type, value, counter);
+      }
+
+      // ---- compound types ---- //
+
+      /// compound types to fill in when reading; some can not be
+      /// default-constructed
+      template <typename T>
+      T makeEmpty(Type<T>) {
+        return T{};
+      }
+      AudioObjectInteraction makeEmpty(Type<AudioObjectInteraction>) {
+        return AudioObjectInteraction(OnOffInteract(false));
+      }
+      AudioBlockFormatObjects makeEmpty(Type<AudioBlockFormatObjects>) {
+        return AudioBlockFormatObjects(SphericalPosition());
+      }
+      AudioBlockFormatHoa makeEmpty(Type<AudioBlockFormatHoa>) {
+        return AudioBlockFormatHoa(Order(), Degree());
+      }
+      MatrixCoefficient makeEmpty(Type<MatrixCoefficient>) {
+        return MatrixCoefficient(AudioChannelFormatId());
+      }
+
+      /// has the parameter been set explicitly, rather than being absent or
+      /// a default value
+      template <typename Parameter, typename T>
+      bool isSet(const T& element) {
+        return element.template has<Parameter>() &&
+               !element.template isDefault<Parameter>();
+      }
+
+      template <typename T, typename Parameter>
+      void setParameter(T& element, Parameter value) {
+        element.set(std::move(value));
+      }
+      void setParameter(AudioBlockFormatDirectSpeakers& block,
+                        SpeakerLabels labels) {
+        for (auto& label : labels) {
+          block.add(std::move(label));
+        }
+      }
+
+      template <typename T, typename Tag, typename Validator>
+      void write(Writer& writer, const NamedType<T, Tag, Validator>& value) {
+        write(writer, value.get());
+      }
+
+      template <typename T>
+      void write(Writer& writer, const std::vector<T>& values) {
+        writer.unsignedInt(values.size());
+        for (const auto& value : values) {
+          write(writer, value);
+        }
+      }
+
+      /// write a mask of the parameters which are set, followed by their
+      /// values
+      template <typename T, typename... Parameters>
+      void writeParameters(Writer& writer, const T& element,
+                           ParameterList<Parameters...>) {
+        std::uint64_t mask = 0;
+        std::uint64_t bit = 1;
+        int setMask[] = {
+            0, (mask |= (isSet<Parameters>(element) ? bit : 0), bit <<= 1,
+                0)...};
+        (void)setMask;
+        writer.unsignedInt(mask);
+
+        bit = 1;
+        int writeValues[] = {
+            0, ((mask & bit) ? write(writer, element.template get<Parameters>())
+                             : void(),
+                bit <<= 1, 0)...};
+        (void)writeValues;
+      }
+
+      template <typename T>
+      void write(Writer& writer, const T& element) {
+        writeParameters(writer, element, typename Stored<T>::type());
+      }
+
+      template <typename T, typename Tag, typename Validator>
+      NamedType<T, Tag, Validator> read(Reader& reader,
+                                        Type<NamedType<T, Tag, Validator>>) {
+        return NamedType<T, Tag, Validator>(read(reader, Type<T>()));
+      }
+
+      template <typename T>
+      std::vector<T> read(Reader& reader, Type<std::vector<T>>) {
+        auto size = reader.count();
+        std::vector<T> values;
+        values.reserve(size);
+        for (std::size_t i = 0; i < size; ++i) {
+          values.push_back(read(reader, Type<T>()));
+        }
+        return values;
+      }
+
+      template <typename T, typename... Parameters>
+      void readParameters(Reader& reader, T& element,
+                          ParameterList<Parameters...>) {
+        std::uint64_t mask = reader.unsignedInt();
+        if (mask >> sizeof...(Parameters)) {
+          throw malformed();
+        }
+        std::uint64_t bit = 1;
+        int readValues[] = {
+            0, ((mask & bit)
+                    ? setParameter(element, read(reader, Type<Parameters>()))
+                    : void(),
+                bit <<= 1, 0)...};
+        (void)readValues;
+      }
+
+      template <typename T>
+      T read(Reader& reader, Type<T>) {
+        T element = makeEmpty(Type<T>());
+        readParameters(reader, element, typename Stored<T>::type());
+        return element;
+      }
+
+      // ---- elements ---- //
+
+      void writeElement(Writer& writer, const AudioProgramme& programme) {
+        write(writer, programme.get<AudioProgrammeId>());
+        write(writer, programme.get<AudioProgrammeName>());
+        write(writer, programme);
+      }
+
+      void writeElement(Writer& writer, const AudioContent& content) {
+        write(writer, content.get<AudioContentId>());
+        write(writer, content.get<AudioContentName>());
+        write(writer, content);
+      }
+
+      void writeElement(Writer& writer, const AudioObject& object) {
+        write(writer, object.get<AudioObjectId>());
+        write(writer, object.get<AudioObjectName>());
+        write(writer, object);
+      }
+
+      void writeElement(Writer& writer, const AudioPackFormat& packFormat) {
+        write(writer, packFormat.get<AudioPackFormatId>());
+        write(writer, packFormat.get<AudioPackFormatName>());
+        write(writer, packFormat.get<TypeDescriptor>());
+        auto hoa = dynamic_cast<const AudioPackFormatHoa*>(&packFormat);
+        write(writer, hoa != nullptr);
+        write(writer, packFormat);
+        if (hoa) {
+          write(writer, *hoa);
+        }
+      }
+
+      template <typename AudioBlockFormat>
+      void writeBlockFormats(Writer& writer,
+                             const AudioChannelFormat& channelFormat) {
+        auto blockFormats =
+            channelFormat.getElements<AudioBlockFormat>();
+        writer.unsignedInt(blockFormats.size());
+        for (const auto& blockFormat : blockFormats) {
+          write(writer, blockFormat);
+        }
+      }
+
+      void writeElement(Writer& writer,
+                        const AudioChannelFormat& channelFormat) {
+        write(writer, channelFormat.get<AudioChannelFormatId>());
+        write(writer, channelFormat.get<AudioChannelFormatName>());
+        write(writer, channelFormat.get<TypeDescriptor>());
+        write(writer, channelFormat);
+        writeBlockFormats<AudioBlockFormatDirectSpeakers>(writer,
+                                                          channelFormat);
+        writeBlockFormats<AudioBlockFormatMatrix>(writer, channelFormat);
+        writeBlockFormats<AudioBlockFormatObjects>(writer, channelFormat);
+        writeBlockFormats<AudioBlockFormatHoa>(writer, channelFormat);
+        writeBlockFormats<AudioBlockFormatBinaural>(writer, channelFormat);
+      }
+
+      void writeElement(Writer& writer, const AudioStreamFormat& streamFormat) {
+        write(writer, streamFormat.get<AudioStreamFormatId>());
+        write(writer, streamFormat.get<AudioStreamFormatName>());
+        write(writer, streamFormat.get<FormatDescriptor>());
+      }
+
+      void writeElement(Writer& writer, const AudioTrackFormat& trackFormat) {
+        write(writer, trackFormat.get<AudioTrackFormatId>());
+        write(writer, trackFormat.get<AudioTrackFormatName>());
+        write(writer, trackFormat.get<FormatDescriptor>());
+      }
+
+      void writeElement(Writer& writer, const AudioTrackUid& trackUid) {
+        write(writer, trackUid.get<AudioTrackUidId>());
+        write(writer, trackUid);
+      }
+
+      std::shared_ptr<AudioProgramme> readElement(Reader& reader,
+                                                  Type<AudioProgramme>) {
+        auto id = read(reader, Type<AudioProgrammeId>());
+        auto name = read(reader, Type<AudioProgrammeName>());
+        auto programme = AudioProgramme::create(name, id);
+        readParameters(reader, *programme, Stored<AudioProgramme>::type());
+        return programme;
+      }
+
+      std::shared_ptr<AudioContent> readElement(Reader& reader,
+                                                Type<AudioContent>) {
+        auto id = read(reader, Type<AudioContentId>());
+        auto name = read(reader, Type<AudioContentName>());
+        auto content = AudioContent::create(name, id);
+        readParameters(reader, *content, Stored<AudioContent>::type());
+        return content;
+      }
+
+      std::shared_ptr<AudioObject> readElement(Reader& reader,
+                                               Type<AudioObject>) {
+        auto id = read(reader, Type<AudioObjectId>());
+        auto name = read(reader, Type<AudioObjectName>());
+        auto object = AudioObject::create(name, id);
+        readParameters(reader, *object, Stored<AudioObject>::type());
+        return object;
+      }
+
+      std::shared_ptr<AudioPackFormat> readElement(Reader& reader,
+                                                   Type<AudioPackFormat>) {
+        auto id = read(reader, Type<AudioPackFormatId>());
+        auto name = read(reader, Type<AudioPackFormatName>());
+        auto typeDescriptor = read(reader, Type<TypeDescriptor>());
+        if (read(reader, Type<bool>())) {
+          auto packFormat = AudioPackFormatHoa::create(name, id);
+          readParameters(reader, static_cast<AudioPackFormat&>(*packFormat),
+                         Stored<AudioPackFormat>::type());
+          readParameters(reader, *packFormat,
+                         Stored<AudioPackFormatHoa>::type());
+          return packFormat;
+        }
+        auto packFormat = AudioPackFormat::create(name, typeDescriptor, id);
+        readParameters(reader, *packFormat, Stored<AudioPackFormat>::type());
+        return packFormat;
+      }
+
+      template <typename AudioBlockFormat>
+      void readBlockFormats(Reader& reader,
+                            AudioChannelFormat& channelFormat) {
+        auto size = reader.count();
+        if (size) {
+          channelFormat.reserveAudioBlockFormats(size);
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+          channelFormat.add(read(reader, Type<AudioBlockFormat>()));
+        }
+      }
+
+      std::shared_ptr<AudioChannelFormat> readElement(
+          Reader& reader, Type<AudioChannelFormat>) {
+        auto id = read(reader, Type<AudioChannelFormatId>());
+        auto name = read(reader, Type<AudioChannelFormatName>());
+        auto typeDescriptor = read(reader, Type<TypeDescriptor>());
+        auto channelFormat =
+            AudioChannelFormat::create(name, typeDescriptor, id);
+        readParameters(reader, *channelFormat,
+                       Stored<AudioChannelFormat>::type());
+        readBlockFormats<AudioBlockFormatDirectSpeakers>(reader,
+                                                         *channelFormat);
+        readBlockFormats<AudioBlockFormatMatrix>(reader, *channelFormat);
+        readBlockFormats<AudioBlockFormatObjects>(reader, *channelFormat);
+        readBlockFormats<AudioBlockFormatHoa>(reader, *channelFormat);
+        readBlockFormats<AudioBlockFormatBinaural>(reader, *channelFormat);
+        return channelFormat;
+      }
+
+      std::shared_ptr<AudioStreamFormat> readElement(
+          Reader& reader, Type<AudioStreamFormat>) {
+        auto id = read(reader, Type<AudioStreamFormatId>());
+        auto name = read(reader, Type<AudioStreamFormatName>());
+        auto format = read(reader, Type<FormatDescriptor>());
+        return AudioStreamFormat::create(name, format, id);
+      }
+
+      std::shared_ptr<AudioTrackFormat> readElement(Reader& reader,
+                                                    Type<AudioTrackFormat>) {
+        auto id = read(reader, Type<AudioTrackFormatId>());
+        auto name = read(reader, Type<AudioTrackFormatName>());
+        auto format = read(reader, Type<FormatDescriptor>());
+        return AudioTrackFormat::create(name, format, id);
+      }
+
+      std::shared_ptr<AudioTrackUid> readElement(Reader& reader,
+                                                 Type<AudioTrackUid>) {
+        auto id = read(reader, Type<AudioTrackUidId>());
+        auto trackUid = AudioTrackUid::create(id);
+        readParameters(reader, *trackUid, Stored<AudioTrackUid>::type());
+        return trackUid;
+      }
+
+      /// make the stored parameters of target the same as those of source;
+      /// everything is unset first, so that parameters which affect others
+      /// are set in the same order as when reading
+      template <typename T, typename... Parameters>
+      void assignParameters(T& target, const T& source,
+                            ParameterList<Parameters...>) {
+        int unsetValues[] = {0, (target.template unset<Parameters>(), 0)...};
+        (void)unsetValues;
+        int setValues[] = {
+            0, (isSet<Parameters>(source)
+                    ? setParameter(target, source.template get<Parameters>())
+                    : void(),
+                0)...};
+        (void)setValues;
+      }
+
+      bool assign(AudioProgramme& target, const AudioProgramme& source) {
+        target.set(source.get<AudioProgrammeName>());
+        assignParameters(target, source, Stored<AudioProgramme>::type());
+        return true;
+      }
+
+      bool assign(AudioContent& target, const AudioContent& source) {
+        target.set(source.get<AudioContentName>());
+        assignParameters(target, source, Stored<AudioContent>::type());
+        return true;
+      }
+
+      bool assign(AudioObject& target, const AudioObject& source) {
+        target.set(source.get<AudioObjectName>());
+        assignParameters(target, source, Stored<AudioObject>::type());
+        return true;
+      }
+
+      bool assign(AudioPackFormat& target, const AudioPackFormat& source) {
+        auto targetHoa = dynamic_cast<AudioPackFormatHoa*>(&target);
+        auto sourceHoa = dynamic_cast<const AudioPackFormatHoa*>(&source);
+        if (target.get<TypeDescriptor>() != source.get<TypeDescriptor>() ||
+            (targetHoa == nullptr) != (sourceHoa == nullptr)) {
+          return false;
+        }
+        target.set(source.get<AudioPackFormatName>());
+        assignParameters(target, source, Stored<AudioPackFormat>::type());
+        if (targetHoa) {
+          assignParameters(*targetHoa, *sourceHoa,
+                           Stored<AudioPackFormatHoa>::type());
+        }
+        return true;
+      }
+
+      template <typename AudioBlockFormat>
+      void assignBlockFormats(AudioChannelFormat& target,
+                              const AudioChannelFormat& source) {
+        auto blockFormats = source.getElements<AudioBlockFormat>();
+        if (blockFormats.size()) {
+          target.reserveAudioBlockFormats(blockFormats.size());
+        }
+        for (const auto& blockFormat : blockFormats) {
+          target.add(blockFormat);
+        }
+      }
+
+      bool assign(AudioChannelFormat& target,
+                  const AudioChannelFormat& source) {
+        if (target.get<TypeDescriptor>() != source.get<TypeDescriptor>()) {
+          return false;
+        }
+        target.set(source.get<AudioChannelFormatName>());
+        assignParameters(target, source, Stored<AudioChannelFormat>::type());
+        target.clearAudioBlockFormats();
+        assignBlockFormats<AudioBlockFormatDirectSpeakers>(target, source);
+        assignBlockFormats<AudioBlockFormatMatrix>(target, source);
+        assignBlockFormats<AudioBlockFormatObjects>(target, source);
+        assignBlockFormats<AudioBlockFormatHoa>(target, source);
+        assignBlockFormats<AudioBlockFormatBinaural>(target, source);
+        return true;
+      }
+
+      bool assign(AudioStreamFormat& target, const AudioStreamFormat& source) {
+        if (target.get<FormatDescriptor>() != source.get<FormatDescriptor>()) {
+          return false;
+        }
+        target.set(source.get<AudioStreamFormatName>());
+        return true;
+      }
+
+      bool assign(AudioTrackFormat& target, const AudioTrackFormat& source) {
+        if (target.get<FormatDescriptor>() != source.get<FormatDescriptor>()) {
+          return false;
+        }
+        target.set(source.get<AudioTrackFormatName>());
+        return true;
+      }
+
+      bool assign(AudioTrackUid& target, const AudioTrackUid& source) {
+        assignParameters(target, source, Stored<AudioTrackUid>::type());
+        return true;
+      }
+
+      // ---- references ---- //
+
+      /**
+       * @brief The common definitions, as they appear in a new Document
+       *
+       * Copying the common definitions adds referenced elements first, so
+       * elements are not in the same order as in the snapshot; this is the
+       * order that parsed documents start with.
+       */
+      std::shared_ptr<const Document> copiedCommonDefinitions() {
+        static const std::shared_ptr<const Document> commonDefinitions =
+            getCommonDefinitions();
+        return commonDefinitions;
+      }
+
+      /// index of each element within the elements of its type in the
+      /// document
+      using ElementIndices = std::unordered_map<const void*, std::uint64_t>;
+
+      /**
+       * @brief Check that a document starts with the common definitions
+       *
+       * @returns the number of common definitions of type Element
+       */
+      template <typename Element>
+      std::size_t countCommonDefinitions(const Document& document,
+                                         const Document& commonDefinitions) {
+        using Id = typename Element::id_type;
+        auto elements = document.getElements<Element>();
+        auto common = commonDefinitions.getElements<Element>();
+        if (elements.size() < common.size()) {
+          throw std::runtime_error(
+              "document does not start with the common definitions");
+        }
+        for (std::size_t i = 0; i < common.size(); ++i) {
+          if (!(elements[i]->template get<Id>() ==
+                common[i]->template get<Id>())) {
+            throw std::runtime_error(
+                "document does not start with the common definitions");
+          }
+        }
+        return common.size();
+      }
+
+      /// write the elements of type Element after the common definitions,
+      /// and add all elements of that type to indices
+      template <typename Element>
+      void writeElements(Writer& writer, const Document& document,
+                         const Document& commonDefinitions,
+                         ElementIndices& indices) {
+        auto common =
+            countCommonDefinitions<Element>(document, commonDefinitions);
+        auto elements = document.getElements<Element>();
+        for (std::size_t i = 0; i < elements.size(); ++i) {
+          indices[elements[i].get()] = i;
+        }
+        writer.unsignedInt(elements.size() - common);
+        for (std::size_t i = common; i < elements.size(); ++i) {
+          writeElement(writer, *elements[i]);
+        }
+      }
+
+      template <typename Element>
+      void writeReference(Writer& writer,
+                          const std::shared_ptr<const Element>& reference,
+                          const ElementIndices& indices) {
+        writer.unsignedInt(reference ? indices.at(reference.get()) + 1 : 0);
+      }
+
+      template <typename Range>
+      void writeReferences(Writer& writer, const Range& references,
+                           const ElementIndices& indices) {
+        writer.unsignedInt(references.size());
+        for (const auto& reference : references) {
+          writer.unsignedInt(indices.at(reference.get()));
+        }
+      }
+
+      void writeReferences(Writer& writer, const AudioProgramme& programme,
+                           const ElementIndices& indices) {
+        writeReferences(writer, programme.getReferences<AudioContent>(),
+                        indices);
+      }
+
+      void writeReferences(Writer& writer, const AudioContent& content,
+                           const ElementIndices& indices) {
+        writeReferences(writer, content.getReferences<AudioObject>(),
+                        indices);
+      }
+
+      void writeReferences(Writer& writer, const AudioObject& object,
+                           const ElementIndices& indices) {
+        writeReferences(writer, object.getReferences<AudioObject>(), indices);
+        writeReferences(writer, object.getReferences<AudioPackFormat>(),
+                        indices);
+        writeReferences(writer, object.getReferences<AudioTrackUid>(),
+                        indices);
+        writeReferences(writer, object.getComplementaryObjects(), indices);
+      }
+
+      void writeReferences(Writer& writer, const AudioPackFormat& packFormat,
+                           const ElementIndices& indices) {
+        writeReferences(writer, packFormat.getReferences<AudioPackFormat>(),
+                        indices);
+        writeReferences(writer,
+                        packFormat.getReferences<AudioChannelFormat>(),
+                        indices);
+      }
+
+      void writeReferences(Writer& writer,
+                           const AudioStreamFormat& streamFormat,
+                           const ElementIndices& indices) {
+        writeReference(writer,
+                       streamFormat.getReference<AudioChannelFormat>(),
+                       indices);
+        writeReference(writer, streamFormat.getReference<AudioPackFormat>(),
+                       indices);
+        std::vector<std::shared_ptr<const AudioTrackFormat>> trackFormats;
+        for (const auto& weakReference :
+             streamFormat.getAudioTrackFormatReferences()) {
+          if (auto reference = weakReference.lock()) {
+            trackFormats.push_back(reference);
+          }
+        }
+        writeReferences(writer, trackFormats, indices);
+      }
+
+      void writeReferences(Writer& writer,
+                           const AudioTrackFormat& trackFormat,
+                           const ElementIndices& indices) {
+        writeReference(writer, trackFormat.getReference<AudioStreamFormat>(),
+                       indices);
+      }
+
+      void writeReferences(Writer& writer, const AudioTrackUid& trackUid,
+                           const ElementIndices& indices) {
+        writeReference(writer, trackUid.getReference<AudioTrackFormat>(),
+                       indices);
+        writeReference(writer, trackUid.getReference<AudioPackFormat>(),
+                       indices);
+        writeReference(writer, trackUid.getReference<AudioChannelFormat>(),
+                       indices);
+      }
+
+      /// write the references from the elements of type Element after the
+      /// common definitions
+      template <typename Element>
+      void writeAllReferences(Writer& writer, const Document& document,
+                           const Document& commonDefinitions,
+                           const ElementIndices& indices) {
+        auto common = commonDefinitions.getElements<Element>().size();
+        auto elements = document.getElements<Element>();
+        for (std::size_t i = common; i < elements.size(); ++i) {
+          writeReferences(writer, *elements[i], indices);
+        }
+      }
+
+      /// all elements of one type in the document being read, to look up
+      /// references by index
+      template <typename Element>
+      class ElementList {
+       public:
+        explicit ElementList(Document& document) {
+          for (const auto& element : document.getElements<Element>()) {
+            elements_.push_back(element);
+          }
+        }
+
+        std::shared_ptr<Element> reference(Reader& reader) const {
+          auto index = reader.unsignedInt();
+          if (index >= elements_.size()) {
+            throw malformed();
+          }
+          return elements_[static_cast<std::size_t>(index)];
+        }
+
+        /// read an optional reference, stored as the index plus one
+        std::shared_ptr<Element> optionalReference(Reader& reader) const {
+          auto index = reader.unsignedInt();
+          if (index == 0) {
+            return nullptr;
+          }
+          if (index > elements_.size()) {
+            throw malformed();
+          }
+          return elements_[static_cast<std::size_t>(index - 1)];
+        }
+
+        std::vector<std::shared_ptr<Element>> references(
+            Reader& reader) const {
+          auto size = reader.count();
+          std::vector<std::shared_ptr<Element>> result;
+          result.reserve(size);
+          for (std::size_t i = 0; i < size; ++i) {
+            result.push_back(reference(reader));
+          }
+          return result;
+        }
+
+        /// the elements after the common definitions
+        std::vector<std::shared_ptr<Element>> own(std::size_t common) const {
+          return std::vector<std::shared_ptr<Element>>(
+              elements_.begin() + static_cast<std::ptrdiff_t>(common),
+              elements_.end());
+        }
+
+       private:
+        std::vector<std::shared_ptr<Element>> elements_;
+      };
+
+      template <typename Element>
+      void readElements(Reader& reader, Document& document) {
+        auto size = reader.count();
+        for (std::size_t i = 0; i < size; ++i) {
+          document.add(readElement(reader, Type<Element>()));
+        }
+      }
+
+    }  // namespace
+
+    std::string serializeDocument(const Document& document) {
+      auto commonDefinitions = copiedCommonDefinitions();
+      const Document& common = *commonDefinitions;
+      Writer writer;
+      ElementIndices indices;
+      writeElements<AudioProgramme>(writer, document, common, indices);
+      writeElements<AudioContent>(writer, document, common, indices);
+      writeElements<AudioObject>(writer, document, common, indices);
+      writeElements<AudioPackFormat>(writer, document, common, indices);
+      writeElements<AudioChannelFormat>(writer, document, common, indices);
+      writeElements<AudioStreamFormat>(writer, document, common, indices);
+      writeElements<AudioTrackFormat>(writer, document, common, indices);
+      writeElements<AudioTrackUid>(writer, document, common, indices);
+
+      writeAllReferences<AudioProgramme>(writer, document, common, indices);
+      writeAllReferences<AudioContent>(writer, document, common, indices);
+      writeAllReferences<AudioObject>(writer, document, common, indices);
+      writeAllReferences<AudioPackFormat>(writer, document, common, indices);
+      writeAllReferences<AudioStreamFormat>(writer, document, common,
+                                            indices);
+      writeAllReferences<AudioTrackFormat>(writer, document, common, indices);
+      writeAllReferences<AudioTrackUid>(writer, document, common, indices);
+      return std::move(writer.data());
+    }
+
+    std::shared_ptr<Document> deserializeDocument(const char* data,
+                                                  std::size_t size) {
+      auto commonDefinitions = copiedCommonDefinitions();
+      auto document = getCommonDefinitions();
+      Reader reader(data, size);
+
+      readElements<AudioProgramme>(reader, *document);
+      readElements<AudioContent>(reader, *document);
+      readElements<AudioObject>(reader, *document);
+      readElements<AudioPackFormat>(reader, *document);
+      readElements<AudioChannelFormat>(reader, *document);
+      readElements<AudioStreamFormat>(reader, *document);
+      readElements<AudioTrackFormat>(reader, *document);
+      readElements<AudioTrackUid>(reader, *document);
+
+      ElementList<AudioProgramme> programmes(*document);
+      ElementList<AudioContent> contents(*document);
+      ElementList<AudioObject> objects(*document);
+      ElementList<AudioPackFormat> packFormats(*document);
+      ElementList<AudioChannelFormat> channelFormats(*document);
+      ElementList<AudioStreamFormat> streamFormats(*document);
+      ElementList<AudioTrackFormat> trackFormats(*document);
+      ElementList<AudioTrackUid> trackUids(*document);
+
+      for (const auto& programme : programmes.own(
+               commonDefinitions->getElements<AudioProgramme>().size())) {
+        for (const auto& content : contents.references(reader)) {
+          programme->addReference(content);
+        }
+      }
+      for (const auto& content : contents.own(
+               commonDefinitions->getElements<AudioContent>().size())) {
+        for (const auto& object : objects.references(reader)) {
+          content->addReference(object);
+        }
+      }
+      for (const auto& object : objects.own(
+               commonDefinitions->getElements<AudioObject>().size())) {
+        for (const auto& reference : objects.references(reader)) {
+          object->addReference(reference);
+        }
+        for (const auto& packFormat : packFormats.references(reader)) {
+          object->addReference(packFormat);
+        }
+        for (const auto& trackUid : trackUids.references(reader)) {
+          object->addReference(trackUid);
+        }
+        for (const auto& complementary : objects.references(reader)) {
+          object->addComplementary(complementary);
+        }
+      }
+      for (const auto& packFormat : packFormats.own(
+               commonDefinitions->getElements<AudioPackFormat>().size())) {
+        for (const auto& reference : packFormats.references(reader)) {
+          packFormat->addReference(reference);
+        }
+        for (const auto& channelFormat : channelFormats.references(reader)) {
+          packFormat->addReference(channelFormat);
+        }
+      }
+      // stream to track references come first, so that track references
+      // are listed in the same order as in the original
+      for (const auto& streamFormat : streamFormats.own(
+               commonDefinitions->getElements<AudioStreamFormat>().size())) {
+        if (auto channelFormat = channelFormats.optionalReference(reader)) {
+          streamFormat->setReference(channelFormat);
+        }
+        if (auto packFormat = packFormats.optionalReference(reader)) {
+          streamFormat->setReference(packFormat);
+        }
+        for (const auto& trackFormat : trackFormats.references(reader)) {
+          streamFormat->addReference(
+              std::weak_ptr<AudioTrackFormat>(trackFormat));
+        }
+      }
+      for (const auto& trackFormat : trackFormats.own(
+               commonDefinitions->getElements<AudioTrackFormat>().size())) {
+        if (auto streamFormat = streamFormats.optionalReference(reader)) {
+          trackFormat->setReference(streamFormat);
+        }
+      }
+      for (const auto& trackUid : trackUids.own(
+               commonDefinitions->getElements<AudioTrackUid>().size())) {
+        if (auto trackFormat = trackFormats.optionalReference(reader)) {
+          trackUid->setReference(trackFormat);
+        }
+        if (auto packFormat = packFormats.optionalReference(reader)) {
+          trackUid->setReference(packFormat);
+        }
+        if (auto channelFormat = channelFormats.optionalReference(reader)) {
+          trackUid->setReference(channelFormat);
+        }
+      }
+
+      if (reader.remaining() != 0) {
+        throw malformed();
+      }
+      return document;
+    }
+
+
+    template <typename Element>
+    std::string serializeElement(const Element& element) {
+      Writer writer;
+      writeElement(writer, element);
+      return std::move(writer.data());
+    }
+
+    template <typename Element>
+    bool assignElement(Element& target, const Element& source) {
+      return assign(target, source);
+    }
+
+    template std::string serializeElement(const AudioProgramme&);
+    template std::string serializeElement(const AudioContent&);
+    template std::string serializeElement(const AudioObject&);
+    template std::string serializeElement(const AudioPackFormat&);
+    template std::string serializeElement(const AudioChannelFormat&);
+    template std::string serializeElement(const AudioStreamFormat&);
+    template std::string serializeElement(const AudioTrackFormat&);
+    template std::string serializeElement(const AudioTrackUid&);
+
+    template bool assignElement(AudioProgramme&, const AudioProgramme&);
+    template bool assignElement(AudioContent&, const AudioContent&);
+    template bool assignElement(AudioObject&, const AudioObject&);
+    template bool assignElement(AudioPackFormat&, const AudioPackFormat&);
+    template bool assignElement(AudioChannelFormat&, const AudioChannelFormat&);
+    template bool assignElement(AudioStreamFormat&, const AudioStreamFormat&);
+    template bool assignElement(AudioTrackFormat&, const AudioTrackFormat&);
+    template bool assignElement(AudioTrackUid&, const AudioTrackUid&);
+
+  }  // namespace detail
+}  // namespace adm
@@ -0,0 +1,373 @@
+#include "adm/private/document_update.hpp"
+#include <boost/optional.hpp>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+#include "adm/detail/id_map.hpp"
+#include "adm/elements.hpp"
+#include "adm/private/document_serialization.hpp"
+
+namespace adm {
+  namespace detail {
+
+    namespace {
+
+      template <typename Element>
+      using IdOf = typename std::remove_const<Element>::type::id_type;
+
+      template <typename Element>
+      IdOf<Element> idOf(const std::shared_ptr<Element>& element) {
+        return element->template get<IdOf<Element>>();
+      }
+
+      /// the IDs of a range of references, in order
+      template <typename Range>
+      auto referenceIds(const Range& references) {
+        std::vector<decltype(idOf(*references.begin()))> ids;
+        for (const auto& reference : references) {
+          ids.push_back(idOf(reference));
+        }
+        return ids;
+      }
+
+      /// the ID of a single reference, if it is set
+      template <typename Element>
+      boost::optional<IdOf<Element>> referenceId(
+          const std::shared_ptr<Element>& reference) {
+        if (reference) {
+          return idOf(reference);
+        }
+        return boost::none;
+      }
+
+      std::vector<AudioTrackFormatId> trackFormatIds(
+          const AudioStreamFormat& streamFormat) {
+        std::vector<AudioTrackFormatId> ids;
+        for (const auto& weakTrackFormat :
+             streamFormat.getAudioTrackFormatReferences()) {
+          if (auto trackFormat = weakTrackFormat.lock()) {
+            ids.push_back(idOf(trackFormat));
+          }
+        }
+        return ids;
+      }
+
+      // ---- the references of each element type, by ID ---- //
+
+      auto references(const AudioProgramme& programme) {
+        return referenceIds(programme.getReferences<AudioContent>());
+      }
+
+      auto references(const AudioContent& content) {
+        return referenceIds(content.getReferences<AudioObject>());
+      }
+
+      auto references(const AudioObject& object) {
+        return std::make_tuple(
+            referenceIds(object.getReferences<AudioObject>()),
+            referenceIds(object.getReferences<AudioPackFormat>()),
+            referenceIds(object.getReferences<AudioTrackUid>()),
+            referenceIds(object.getComplementaryObjects()));
+      }
+
+      auto references(const AudioPackFormat& packFormat) {
+        return std::make_tuple(
+            referenceIds(packFormat.getReferences<AudioPackFormat>()),
+            referenceIds(packFormat.getReferences<AudioChannelFormat>()));
+      }
+
+      auto references(const AudioStreamFormat& streamFormat) {
+        return std::make_tuple(
+            referenceId(streamFormat.getReference<AudioChannelFormat>()),
+            referenceId(streamFormat.getReference<AudioPackFormat>()),
+            trackFormatIds(streamFormat));
+      }
+
+      auto references(const AudioTrackFormat& trackFormat) {
+        return referenceId(trackFormat.getReference<AudioStreamFormat>());
+      }
+
+      auto references(const AudioTrackUid& trackUid) {
+        return std::make_tuple(
+            referenceId(trackUid.getReference<AudioTrackFormat>()),
+            referenceId(trackUid.getReference<AudioPackFormat>()),
+            referenceId(trackUid.getReference<AudioChannelFormat>()));
+      }
+
+      /// a copy of source without references, to add to the document
+      template <typename Element>
+      std::shared_ptr<Element> copyElement(const Element& source) {
+        return source.copy();
+      }
+
+      /// AudioPackFormat::copy() does not keep the HOA parameters
+      std::shared_ptr<AudioPackFormat> copyElement(
+          const AudioPackFormat& source) {
+        if (dynamic_cast<const AudioPackFormatHoa*>(&source)) {
+          auto packFormat = AudioPackFormatHoa::create(
+              source.get<AudioPackFormatName>(),
+              source.get<AudioPackFormatId>());
+          assignElement<AudioPackFormat>(*packFormat, source);
+          return packFormat;
+        }
+        return source.copy();
+      }
+
+      /// an element of the source document, and the element of the target
+      /// document which it has been matched with or copied to
+      template <typename Element>
+      struct Match {
+        std::shared_ptr<Element> target;
+        std::shared_ptr<const Element> source;
+        bool added;
+        bool contentsChanged;
+        bool referencesChanged = false;
+      };
+
+      template <typename Element>
+      using Matches = std::vector<Match<Element>>;
+
+      class DocumentUpdater {
+       public:
+        DocumentUpdater(const std::shared_ptr<Document>& target)
+            : target_(target), idMap_(*target) {}
+
+        /// find the match for each element of source of one type, updating
+        /// the contents of existing elements or adding new ones
+        template <typename Element>
+        void matchElements(const Document& source) {
+          auto& matches = matches_.get<Element>();
+          auto elements = source.getElements<Element>();
+          matches.reserve(elements.size());
+          for (const auto& element : elements) {
+            auto id = idOf(element);
+            auto existing = idMap_.lookup(id);
+            bool contentsChanged = false;
+            if (existing &&
+                serializeElement(*existing) != serializeElement(*element)) {
+              if (assignElement(*existing, *element)) {
+                contentsChanged = true;
+              } else {
+                target_->remove(existing);
+                idMap_.remove(id);
+                existing.reset();
+                summary_.removed++;
+              }
+            }
+            bool added = false;
+            if (!existing) {
+              existing = copyElement(*element);
+              target_->add(existing);
+              idMap_.add(existing);
+              added = true;
+            }
+            matches.push_back(
+                Match<Element>{existing, element, added, contentsChanged});
+          }
+        }
+
+        /// find the matched elements of one type whose references differ
+        /// from those of their source; this must be done once all elements
+        /// have been matched, as replacing an element removes references to
+        /// it
+        template <typename Element>
+        void compareReferences() {
+          for (auto& match : matches_.get<Element>()) {
+            match.referencesChanged =
+                references(*match.target) != references(*match.source);
+          }
+        }
+
+        /// make the references of each matched element the same as those of
+        /// its source
+        template <typename Element>
+        void updateReferences() {
+          for (const auto& match : matches_.get<Element>()) {
+            if (match.referencesChanged) {
+              assignReferences(*match.target, *match.source);
+            }
+          }
+        }
+
+        /// remove the elements of one type which were not matched
+        template <typename Element>
+        void removeUnmatched() {
+          std::unordered_set<const Element*> matched;
+          for (const auto& match : matches_.get<Element>()) {
+            matched.insert(match.target.get());
+          }
+          std::vector<std::shared_ptr<Element>> unmatched;
+          for (const auto& element : target_->getElements<Element>()) {
+            if (!matched.count(element.get())) {
+              unmatched.push_back(element);
+            }
+          }
+          for (const auto& element : unmatched) {
+            target_->remove(element);
+          }
+          summary_.removed += unmatched.size();
+        }
+
+        /// count the matches of one type into the summary
+        template <typename Element>
+        void summarise() {
+          for (const auto& match : matches_.get<Element>()) {
+            if (match.added) {
+              summary_.added++;
+            } else if (match.contentsChanged || match.referencesChanged) {
+              summary_.updated++;
+            } else {
+              summary_.unchanged++;
+            }
+          }
+        }
+
+        const ReparseSummary& summary() const { return summary_; }
+
+       private:
+        template <typename Referenced, typename Element>
+        void assignReferences(Element& target, const Element& source) {
+          auto ids = referenceIds(source.template getReferences<Referenced>());
+          if (referenceIds(target.template getReferences<Referenced>()) ==
+              ids) {
+            return;
+          }
+          target.template clearReferences<Referenced>();
+          for (const auto& id : ids) {
+            target.addReference(idMap_.lookup(id));
+          }
+        }
+
+        template <typename Referenced, typename Element>
+        void assignReference(Element& target, const Element& source) {
+          auto id = referenceId(source.template getReference<Referenced>());
+          if (referenceId(target.template getReference<Referenced>()) == id) {
+            return;
+          }
+          if (id) {
+            target.setReference(idMap_.lookup(*id));
+          } else {
+            target.template removeReference<Referenced>();
+          }
+        }
+
+        void assignReferences(AudioProgramme& target,
+                              const AudioProgramme& source) {
+          assignReferences<AudioContent>(target, source);
+        }
+
+        void assignReferences(AudioContent& target,
+                              const AudioContent& source) {
+          assignReferences<AudioObject>(target, source);
+        }
+
+        void assignReferences(AudioObject& target, const AudioObject& source) {
+          assignReferences<AudioObject>(target, source);
+          assignReferences<AudioPackFormat>(target, source);
+          assignReferences<AudioTrackUid>(target, source);
+          auto ids = referenceIds(source.getComplementaryObjects());
+          if (referenceIds(target.getComplementaryObjects()) != ids) {
+            target.clearComplementaryObjects();
+            for (const auto& id : ids) {
+              target.addComplementary(idMap_.lookup(id));
+            }
+          }
+        }
+
+        void assignReferences(AudioPackFormat& target,
+                              const AudioPackFormat& source) {
+          assignReferences<AudioPackFormat>(target, source);
+          assignReferences<AudioChannelFormat>(target, source);
+        }
+
+        void assignReferences(AudioChannelFormat&, const AudioChannelFormat&) {
+        }
+
+        void assignReferences(AudioStreamFormat& target,
+                              const AudioStreamFormat& source) {
+          assignReference<AudioChannelFormat>(target, source);
+          assignReference<AudioPackFormat>(target, source);
+          // clearing is one-sided; track formats which are no longer
+          // referenced are disconnected when their own references are
+          // updated, or when they are removed
+          auto ids = trackFormatIds(source);
+          if (trackFormatIds(target) != ids) {
+            target.clearReferences<AudioTrackFormat>();
+            for (const auto& id : ids) {
+              target.addReference(
+                  std::weak_ptr<AudioTrackFormat>(idMap_.lookup(id)));
+            }
+          }
+        }
+
+        void assignReferences(AudioTrackFormat& target,
+                              const AudioTrackFormat& source) {
+          assignReference<AudioStreamFormat>(target, source);
+        }
+
+        void assignReferences(AudioTrackUid& target,
+                              const AudioTrackUid& source) {
+          assignReference<AudioTrackFormat>(target, source);
+          assignReference<AudioPackFormat>(target, source);
+          assignReference<AudioChannelFormat>(target, source);
+        }
+
+        std::shared_ptr<Document> target_;
+        IDMap idMap_;
+        ForEachElement<Matches> matches_;
+        ReparseSummary summary_;
+      };
+
+    }  // namespace
+
+    ReparseSummary updateDocument(const std::shared_ptr<Document>& target,
+                                  const Document& source) {
+      DocumentUpdater updater(target);
+      updater.matchElements<AudioProgramme>(source);
+      updater.matchElements<AudioContent>(source);
+      updater.matchElements<AudioObject>(source);
+      updater.matchElements<AudioPackFormat>(source);
+      updater.matchElements<AudioChannelFormat>(source);
+      updater.matchElements<AudioStreamFormat>(source);
+      updater.matchElements<AudioTrackFormat>(source);
+      updater.matchElements<AudioTrackUid>(source);
+
+      updater.compareReferences<AudioProgramme>();
+      updater.compareReferences<AudioContent>();
+      updater.compareReferences<AudioObject>();
+      updater.compareReferences<AudioPackFormat>();
+      updater.compareReferences<AudioStreamFormat>();
+      updater.compareReferences<AudioTrackFormat>();
+      updater.compareReferences<AudioTrackUid>();
+
+      updater.updateReferences<AudioProgramme>();
+      updater.updateReferences<AudioContent>();
+      updater.updateReferences<AudioObject>();
+      updater.updateReferences<AudioPackFormat>();
+      // stream to track references come first, as when deserializing
+      updater.updateReferences<AudioStreamFormat>();
+      updater.updateReferences<AudioTrackFormat>();
+      updater.updateReferences<AudioTrackUid>();
+
+      updater.removeUnmatched<AudioProgramme>();
+      updater.removeUnmatched<AudioContent>();
+      updater.removeUnmatched<AudioObject>();
+      updater.removeUnmatched<AudioPackFormat>();
+      updater.removeUnmatched<AudioChannelFormat>();
+      updater.removeUnmatched<AudioStreamFormat>();
+      updater.removeUnmatched<AudioTrackFormat>();
+      updater.removeUnmatched<AudioTrackUid>();
+
+      updater.summarise<AudioProgramme>();
+      updater.summarise<AudioContent>();
+      updater.summarise<AudioObject>();
+      updater.summarise<AudioPackFormat>();
+      updater.summarise<AudioChannelFormat>();
+      updater.summarise<AudioStreamFormat>();
+      updater.summarise<AudioTrackFormat>();
+      updater.summarise<AudioTrackUid>();
+      return updater.summary();
+    }
+
+  }  // namespace detail
+}  // namespace adm
@@ -0,0 +1,71 @@
+#include "adm/private/dom_pool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <new>
+
+namespace adm {
+  namespace xml {
+
+    namespace {
+      thread_local DomPool* currentPool = nullptr;
+
+      /// blocks are preceded by their size, padded to keep the alignment of
+      /// operator new
+      const std::size_t headerSize = alignof(std::max_align_t);
+
+      std::size_t& blockSize(void* block) {
+        return *static_cast<std::size_t*>(block);
+      }
+    }  // namespace
+
+    DomPool::~DomPool() {
+      for (void* block : blocks_) {
+        ::operator delete(block);
+      }
+    }
+
+    void DomPool::attach(rapidxml::xml_document<>& document) {
+      document.set_allocator(&DomPool::allocate, &DomPool::free);
+    }
+
+    DomPool::Use::Use(DomPool& pool) : previous_(currentPool) {
+      currentPool = &pool;
+    }
+
+    DomPool::Use::~Use() { currentPool = previous_; }
+
+    void* DomPool::allocate(std::size_t size) {
+      void* block = nullptr;
+      if (currentPool) {
+        auto& blocks = currentPool->blocks_;
+        // nearly all blocks are the same size, so the last one almost always
+        // fits
+        auto it = std::find_if(blocks.rbegin(), blocks.rend(),
+                               [size](void* b) { return blockSize(b) >= size; });
+        if (it != blocks.rend()) {
+          block = *it;
+          blocks.erase(std::next(it).base());
+        }
+      }
+      if (!block) {
+        block = ::operator new(headerSize + size);
+        blockSize(block) = size;
+      }
+      return static_cast<char*>(block) + headerSize;
+    }
+
+    void DomPool::free(void* memory) {
+      void* block = static_cast<char*>(memory) - headerSize;
+      if (currentPool) {
+        try {
+          currentPool->blocks_.push_back(block);
+          return;
+        } catch (const std::bad_alloc&) {
+        }
+      }
+      ::operator delete(block);
+    }
+
+  }  // namespace xml
+}  // namespace adm
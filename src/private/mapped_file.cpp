@@ -0,0 +1,178 @@
+#include "adm/private/mapped_file.hpp"
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace adm {
+  namespace xml {
+
+    namespace {
+      std::runtime_error openError(const std::string& filename) {
+        return std::runtime_error("cannot open file " + filename);
+      }
+
+#ifdef _WIN32
+      /// read the whole file and add a terminator, like rapidxml::file
+      std::vector<char> readFile(const std::string& filename) {
+        std::ifstream stream(filename, std::ios::binary);
+        if (!stream) {
+          throw openError(filename);
+        }
+        std::vector<char> buffer((std::istreambuf_iterator<char>(stream)),
+                                 std::istreambuf_iterator<char>());
+        if (stream.bad()) {
+          throw std::runtime_error("error reading stream");
+        }
+        buffer.push_back('\0');
+        return buffer;
+      }
+#else
+      /// read the rest of fd and add a terminator, for files which can not
+      /// be mapped
+      std::vector<char> readFile(int fd) {
+        std::vector<char> buffer;
+        char chunk[65536];
+        while (true) {
+          ssize_t count = read(fd, chunk, sizeof(chunk));
+          if (count < 0) {
+            if (errno == EINTR) {
+              continue;
+            }
+            throw std::runtime_error("error reading stream");
+          }
+          if (count == 0) {
+            break;
+          }
+          buffer.insert(buffer.end(), chunk, chunk + count);
+        }
+        buffer.push_back('\0');
+        return buffer;
+      }
+#endif
+    }  // namespace
+
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string& filename) {
+      HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ,
+                                FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+      if (file == INVALID_HANDLE_VALUE) {
+        throw openError(filename);
+      }
+      LARGE_INTEGER fileSize;
+      if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw openError(filename);
+      }
+      size_ = static_cast<std::size_t>(fileSize.QuadPart);
+
+      // the bytes after the end of the file in its last page read as zero
+      // and provide the terminator, so if there are none, fall back to
+      // reading the file
+      SYSTEM_INFO info;
+      GetSystemInfo(&info);
+      if (size_ % info.dwPageSize == 0) {
+        CloseHandle(file);
+        buffer_ = readFile(filename);
+        data_ = buffer_.data();
+        return;
+      }
+
+      HANDLE mapping =
+          CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+      CloseHandle(file);
+      if (!mapping) {
+        throw openError(filename);
+      }
+      // the view keeps the mapping open
+      void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+      CloseHandle(mapping);
+      if (!view) {
+        throw openError(filename);
+      }
+      data_ = static_cast<char*>(view);
+      mappedSize_ = size_;
+    }
+
+    MappedFile::~MappedFile() {
+      if (mappedSize_) {
+        UnmapViewOfFile(data_);
+      }
+    }
+#else
+    MappedFile::MappedFile(const std::string& filename) {
+      int fd = open(filename.c_str(), O_RDONLY);
+      if (fd < 0) {
+        throw openError(filename);
+      }
+      struct stat status;
+      if (fstat(fd, &status) != 0) {
+        close(fd);
+        throw openError(filename);
+      }
+
+      // pipes and devices have no size to map, so read them instead
+      if (!S_ISREG(status.st_mode)) {
+        try {
+          buffer_ = readFile(fd);
+        } catch (...) {
+          close(fd);
+          throw;
+        }
+        close(fd);
+        size_ = buffer_.size() - 1;
+        data_ = buffer_.data();
+        return;
+      }
+      size_ = static_cast<std::size_t>(status.st_size);
+
+      // reserve zeroed memory for the file and at least one more byte, then
+      // map the file over the start of it; whatever follows the file reads as
+      // zero and provides the terminator
+      auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+      mappedSize_ = (size_ / pageSize + 1) * pageSize;
+      void* base = mmap(nullptr, mappedSize_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANON, -1, 0);
+      if (base == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("cannot map file " + filename);
+      }
+      if (size_ > 0) {
+        void* mapped = mmap(base, size_, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_FIXED, fd, 0);
+        if (mapped == MAP_FAILED) {
+          munmap(base, mappedSize_);
+          close(fd);
+          throw std::runtime_error("cannot map file " + filename);
+        }
+        madvise(mapped, size_, MADV_SEQUENTIAL);
+      }
+      close(fd);
+      data_ = static_cast<char*>(base);
+    }
+
+    MappedFile::~MappedFile() {
+      if (mappedSize_) {
+        munmap(data_, mappedSize_);
+      }
+    }
+#endif
+
+  }  // namespace xml
+}  // namespace adm
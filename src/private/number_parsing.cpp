@@ -0,0 +1,220 @@
+#include "adm/private/number_parsing.hpp"
+#include <locale.h>
+#include <stdlib.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+#include <cerrno>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace adm {
+  namespace xml {
+    namespace detail {
+
+      namespace {
+        bool isWhitespace(char c) {
+          return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+        void trim(const char*& begin, const char*& end) {
+          while (begin != end && isWhitespace(*begin)) ++begin;
+          while (begin != end && isWhitespace(*(end - 1))) --end;
+        }
+
+        bool equal(const char* begin, const char* end, const char* str) {
+          std::size_t size = std::strlen(str);
+          return static_cast<std::size_t>(end - begin) == size &&
+                 std::memcmp(begin, str, size) == 0;
+        }
+
+        [[noreturn]] void invalid(const char* type, const char* begin,
+                                  const char* end) {
+          throw std::invalid_argument(std::string("invalid ") + type +
+                                      " value: '" + std::string(begin, end) +
+                                      "'");
+        }
+
+        [[noreturn]] void outOfRange(const char* type, const char* begin,
+                                     const char* end) {
+          throw std::out_of_range(std::string(type) + " value out of range: '" +
+                                  std::string(begin, end) + "'");
+        }
+
+        /// parse a sign and digits, giving the magnitude and whether the
+        /// sign was negative; returns false if the syntax is wrong or the
+        /// magnitude is greater than max
+        bool parseInteger(const char* begin, const char* end,
+                          unsigned long long max, unsigned long long& value,
+                          bool& negative, bool& overflow) {
+          negative = false;
+          overflow = false;
+          if (begin != end && (*begin == '+' || *begin == '-')) {
+            negative = *begin == '-';
+            ++begin;
+          }
+          if (begin == end) return false;
+          value = 0;
+          for (; begin != end; ++begin) {
+            if (!isDigit(*begin)) return false;
+            unsigned digit = static_cast<unsigned>(*begin - '0');
+            if (value > (max - digit) / 10) {
+              overflow = true;
+            } else {
+              value = value * 10 + digit;
+            }
+          }
+          return true;
+        }
+
+        /// check that [begin, end) is an xs:decimal, optionally with an
+        /// exponent as in xs:double
+        bool isDecimal(const char* begin, const char* end) {
+          const char* p = begin;
+          if (p != end && (*p == '+' || *p == '-')) ++p;
+          std::size_t digits = 0;
+          for (; p != end && isDigit(*p); ++p) ++digits;
+          if (p != end && *p == '.') {
+            for (++p; p != end && isDigit(*p); ++p) ++digits;
+          }
+          if (digits == 0) return false;
+          if (p != end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            if (p != end && (*p == '+' || *p == '-')) ++p;
+            if (p == end || !isDigit(*p)) return false;
+            while (p != end && isDigit(*p)) ++p;
+          }
+          return p == end;
+        }
+
+        // strtod is the only portable correctly-rounded conversion, but uses
+        // the decimal point of the global C locale, and reading that with
+        // localeconv() races with setlocale() in other threads; use the "C"
+        // locale explicitly instead. This is created once, and never freed.
+#ifdef _WIN32
+        _locale_t cLocale() {
+          static const _locale_t locale = _create_locale(LC_NUMERIC, "C");
+          return locale;
+        }
+
+        float convert(const char* str, char** end, float) {
+          return _strtof_l(str, end, cLocale());
+        }
+
+        double convert(const char* str, char** end, double) {
+          return _strtod_l(str, end, cLocale());
+        }
+#else
+        locale_t cLocale() {
+          static const locale_t locale =
+              newlocale(LC_NUMERIC_MASK, "C", static_cast<locale_t>(0));
+          return locale;
+        }
+
+        float convert(const char* str, char** end, float) {
+          return strtof_l(str, end, cLocale());
+        }
+
+        double convert(const char* str, char** end, double) {
+          return strtod_l(str, end, cLocale());
+        }
+#endif
+
+        template <typename T>
+        T parseFloatingPoint(const char* type, const char* begin,
+                             const char* end) {
+          trim(begin, end);
+          if (equal(begin, end, "INF") || equal(begin, end, "+INF")) {
+            return std::numeric_limits<T>::infinity();
+          }
+          if (equal(begin, end, "-INF")) {
+            return -std::numeric_limits<T>::infinity();
+          }
+          if (equal(begin, end, "NaN")) {
+            return std::numeric_limits<T>::quiet_NaN();
+          }
+          if (!isDecimal(begin, end)) invalid(type, begin, end);
+
+          // strtod needs a terminator, so convert a copy; only unusually
+          // long values need to allocate
+          std::size_t size = static_cast<std::size_t>(end - begin);
+          char stackBuffer[64];
+          std::string heapBuffer;
+          char* buffer = stackBuffer;
+          if (size >= sizeof(stackBuffer)) {
+            heapBuffer.resize(size + 1);
+            buffer = &heapBuffer[0];
+          }
+          std::memcpy(buffer, begin, size);
+          char* out = buffer + size;
+          *out = '\0';
+
+          char* converted = nullptr;
+          errno = 0;
+          T value = convert(buffer, &converted, T());
+          if (converted != out) invalid(type, begin, end);
+          if (errno == ERANGE && std::isinf(value)) {
+            outOfRange(type, begin, end);
+          }
+          return value;
+        }
+      }  // namespace
+
+      int parseInt(const char* begin, const char* end) {
+        trim(begin, end);
+        unsigned long long value;
+        bool negative, overflow;
+        unsigned long long max =
+            static_cast<unsigned long long>(std::numeric_limits<int>::max()) +
+            1;
+        if (!parseInteger(begin, end, max, value, negative, overflow)) {
+          invalid("integer", begin, end);
+        }
+        if (overflow || (!negative && value == max)) {
+          outOfRange("integer", begin, end);
+        }
+        if (negative) {
+          return static_cast<int>(-static_cast<long long>(value));
+        }
+        return static_cast<int>(value);
+      }
+
+      unsigned int parseUnsigned(const char* begin, const char* end) {
+        trim(begin, end);
+        unsigned long long value;
+        bool negative, overflow;
+        if (!parseInteger(begin, end, std::numeric_limits<unsigned>::max(),
+                          value, negative, overflow) ||
+            (negative && value != 0)) {
+          invalid("unsigned integer", begin, end);
+        }
+        if (overflow) outOfRange("unsigned integer", begin, end);
+        return static_cast<unsigned int>(value);
+      }
+
+      bool parseBool(const char* begin, const char* end) {
+        trim(begin, end);
+        if (equal(begin, end, "1") || equal(begin, end, "true")) {
+          return true;
+        }
+        if (equal(begin, end, "0") || equal(begin, end, "false")) {
+          return false;
+        }
+        invalid("boolean", begin, end);
+      }
+
+      float parseFloat(const char* begin, const char* end) {
+        return parseFloatingPoint<float>("float", begin, end);
+      }
+
+      double parseDouble(const char* begin, const char* end) {
+        return parseFloatingPoint<double>("double", begin, end);
+      }
+
+    }  // namespace detail
+  }  // namespace xml
+}  // namespace adm
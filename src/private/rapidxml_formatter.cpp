@@ -39,6 +39,10 @@ namespace adm {
         std::string value;
       };
 
+      std::string formatGainValue(const Gain &gain) {
+        return toString(gain.isDb() ? gain.asDb() : gain.asLinear());
+      }
+
       MultiElementAttributeFormatter formatMultiElementAttribute(
           const std::string &attribute, const std::string &value) {
         return MultiElementAttributeFormatter(attribute, value);
@@ -483,7 +487,30 @@ namespace adm {
       node.addAttribute<AudioBlockFormatId>(&audioBlock, "audioBlockFormatID");
       node.addOptionalAttribute<Rtime>(&audioBlock, "rtime");
       node.addOptionalAttribute<Duration>(&audioBlock, "duration");
-      // TODO: add missing matrix attributes and elements
+      node.addOptionalElement<OutputChannelFormatId>(&audioBlock, "outputChannelFormatIDRef");
+      node.addOptionalElement<MatrixCoefficients>(&audioBlock, "matrix", &formatMatrixCoefficients);
+      // clang-format on
+      node.addOptionalElement<Gain>(&audioBlock, "gain", &formatGain);
+      node.addOptionalElement<Importance>(&audioBlock, "importance");
+    }
+
+    void formatMatrixCoefficients(XmlNode &node,
+                                  const MatrixCoefficients &coefficients) {
+      for (auto &coefficient : coefficients) {
+        node.addElement(coefficient, "coefficient", &formatMatrixCoefficient);
+      }
+    }
+
+    void formatMatrixCoefficient(XmlNode &node,
+                                 const MatrixCoefficient &coefficient) {
+      // clang-format off
+      node.addOptionalAttribute<Gain>(&coefficient, "gain", &detail::formatGainValue);
+      if (coefficient.get<Gain>().isDb()) {
+        node.addAttribute("gainUnit", "dB");
+      }
+      node.addOptionalAttribute<Phase>(&coefficient, "phase");
+      node.addOptionalAttribute<Delay>(&coefficient, "delay");
+      node.setValue(coefficient.get<AudioChannelFormatId>());
       // clang-format on
     }
 
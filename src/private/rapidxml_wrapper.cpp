@@ -6,20 +6,11 @@ namespace adm {
     // ---- XML DOCUMENT WRAPPER ---- //
 
     XmlNode XmlDocument::addNode(const std::string &name) {
-      auto nameString = doc_.allocate_string(name.c_str());
-      auto childNode = doc_.allocate_node(rapidxml::node_element, nameString);
-      doc_.append_node(childNode);
-      return XmlNode(childNode, discardDefaultValues_);
+      auto handle = writer_.startElement(0, name);
+      return XmlNode(&writer_, 0, handle, discardDefaultValues_);
     }
 
-    XmlNode XmlDocument::addDeclaration() {
-      auto declaration = doc_.allocate_node(rapidxml::node_declaration);
-      declaration->append_attribute(doc_.allocate_attribute("version", "1.0"));
-      declaration->append_attribute(
-          doc_.allocate_attribute("encoding", "utf-8"));
-      doc_.append_node(declaration);
-      return XmlNode(declaration, discardDefaultValues_);
-    }
+    void XmlDocument::addDeclaration() { writer_.declaration(); }
 
     XmlNode XmlDocument::addItuStructure() {
       auto ituAdmNode = addNode("ituADM");
@@ -45,29 +36,25 @@ namespace adm {
 
     // ---- XML NODE WRAPPER ---- //
 
-    XmlNode::XmlNode(NodePtr node, bool discardDefaults)
-        : node_(node), discardDefaultValues_(discardDefaults){};
+    XmlNode::XmlNode(XmlStreamWriter *writer, std::size_t depth,
+                     XmlStreamWriter::Handle handle, bool discardDefaults)
+        : writer_(writer),
+          depth_(depth),
+          handle_(handle),
+          discardDefaultValues_(discardDefaults){};
 
     void XmlNode::setValue(const std::string &value) {
-      auto valueString = node_->document()->allocate_string(value.c_str());
-      node_->value(valueString);
+      writer_->setValue(depth_, handle_, value);
     }
 
     XmlNode XmlNode::addNode(const std::string &name) {
-      auto nameString = node_->document()->allocate_string(name.c_str());
-      auto childNode =
-          node_->document()->allocate_node(rapidxml::node_element, nameString);
-      node_->append_node(childNode);
-      return XmlNode(childNode, discardDefaultValues_);
+      auto handle = writer_->startElement(depth_ + 1, name);
+      return XmlNode(writer_, depth_ + 1, handle, discardDefaultValues_);
     }
 
     void XmlNode::addAttribute(const std::string &name,
                                const std::string &value) {
-      auto nameString = node_->document()->allocate_string(name.c_str());
-      auto valueString = node_->document()->allocate_string(value.c_str());
-      auto attribute =
-          node_->document()->allocate_attribute(nameString, valueString);
-      node_->append_attribute(attribute);
+      writer_->addAttribute(depth_, handle_, name, value);
     }
 
     void XmlNode::addElement(const std::string &name,
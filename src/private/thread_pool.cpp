@@ -0,0 +1,104 @@
+#include "adm/private/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace adm {
+  namespace detail {
+
+    ThreadPool::ThreadPool(unsigned threads) {
+      threads_.reserve(threads);
+      for (unsigned i = 0; i < threads; ++i) {
+        threads_.emplace_back([this]() { run(); });
+      }
+    }
+
+    ThreadPool::~ThreadPool() {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+      }
+      condition_.notify_all();
+      for (auto& thread : threads_) {
+        thread.join();
+      }
+    }
+
+    void ThreadPool::run() {
+      while (true) {
+        std::function<void()> task;
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          condition_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+          if (queue_.empty()) {
+            return;
+          }
+          task = std::move(queue_.front());
+          queue_.pop_front();
+        }
+        task();
+      }
+    }
+
+    namespace {
+      /// shared between the caller of parallelFor and the workers helping it;
+      /// workers may only get to their task after the caller has returned
+      struct ParallelForState {
+        ParallelForState(std::size_t n,
+                         const std::function<void(std::size_t)>& f)
+            : n(n), f(f) {}
+
+        /// run calls until there are none left
+        void work() {
+          std::size_t count = 0;
+          for (std::size_t i = next++; i < n; i = next++) {
+            f(i);
+            ++count;
+          }
+          if (count && (finished += count) == n) {
+            std::lock_guard<std::mutex> lock(mutex);
+            condition.notify_all();
+          }
+        }
+
+        const std::size_t n;
+        const std::function<void(std::size_t)>& f;
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> finished{0};
+        std::mutex mutex;
+        std::condition_variable condition;
+      };
+    }  // namespace
+
+    void ThreadPool::parallelFor(std::size_t n,
+                                 const std::function<void(std::size_t)>& f) {
+      if (n == 0) {
+        return;
+      }
+      auto state = std::make_shared<ParallelForState>(n, f);
+
+      std::size_t helpers = std::min<std::size_t>(threads_.size(), n - 1);
+      if (helpers) {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          for (std::size_t i = 0; i < helpers; ++i) {
+            queue_.emplace_back([state]() { state->work(); });
+          }
+        }
+        condition_.notify_all();
+      }
+
+      state->work();
+
+      std::unique_lock<std::mutex> lock(state->mutex);
+      state->condition.wait(lock, [&]() { return state->finished == n; });
+    }
+
+    ThreadPool& ThreadPool::shared() {
+      static ThreadPool pool(
+          std::max(std::thread::hardware_concurrency(), 1u) - 1);
+      return pool;
+    }
+
+  }  // namespace detail
+}  // namespace adm
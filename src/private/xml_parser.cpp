@@ -3,6 +3,18 @@
 #include "adm/private/xml_parser_helper.hpp"
 #include "adm/detail/named_type_validators.hpp"
 #include "adm/errors.hpp"
+#include "adm/elements/private/parent_attorneys.hpp"
+#include "adm/private/thread_pool.hpp"
+#include "adm/utilities/id_assignment.hpp"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
 namespace adm {
   namespace xml {
 
@@ -17,22 +29,234 @@ namespace adm {
       return static_cast<bool>(options & flag);
     }
 
-    XmlParser::XmlParser(rapidxml::file<> file, ParserOptions options,
-                         std::shared_ptr<Document> destDocument)
-        : xmlFile_(std::move(file)),
-          options_(options),
+    namespace {
+      /// called with the bytes read so far and the size of the input, or 0 if
+      /// that is not known
+      using ReadCallback =
+          std::function<void(std::size_t bytes, std::size_t totalBytes)>;
+
+      /// read the rest of a stream into buffer and add a terminator, like
+      /// rapidxml::file; this reads in blocks rather than a character at a
+      /// time, calling onRead (if set) after each one
+      void readStream(std::istream& stream, std::vector<char>& buffer,
+                      const ReadCallback& onRead = nullptr) {
+        if (stream.fail()) {
+          throw std::runtime_error("error reading stream");
+        }
+        const std::size_t blockSize = 64 * 1024;
+        std::size_t size = 0;
+        if (auto streamBuf = stream.rdbuf()) {
+          while (true) {
+            if (buffer.size() < size + blockSize) {
+              buffer.resize(std::max(size + blockSize, 2 * buffer.size()));
+            }
+            auto read = static_cast<std::size_t>(streamBuf->sgetn(
+                buffer.data() + size, static_cast<std::streamsize>(blockSize)));
+            size += read;
+            if (onRead) {
+              onRead(size, 0);
+            }
+            if (read < blockSize) {
+              break;
+            }
+          }
+        }
+        buffer.resize(size + 1);
+        buffer[size] = '\0';
+      }
+
+      /// read a whole file into buffer and add a terminator, like
+      /// rapidxml::file; this reads in blocks, calling onRead (if set) before
+      /// the first and after each one
+      void readFile(const std::string& filename, std::vector<char>& buffer,
+                    const ReadCallback& onRead = nullptr) {
+        std::ifstream stream(filename, std::ios::binary);
+        if (!stream) {
+          throw std::runtime_error(std::string("cannot open file ") +
+                                   filename);
+        }
+        // files which can not be seeked (pipes, devices) are read without
+        // knowing their size
+        std::streamoff end = -1;
+        if (stream.seekg(0, std::ios::end)) {
+          end = stream.tellg();
+        }
+        if (end < 0 || !stream.seekg(0)) {
+          stream.clear();
+          if (onRead) {
+            onRead(0, 0);
+          }
+          readStream(stream, buffer, onRead);
+          return;
+        }
+        const std::size_t blockSize = 1024 * 1024;
+        auto size = static_cast<std::size_t>(end);
+        buffer.resize(size + 1);
+        if (onRead) {
+          onRead(0, size);
+        }
+        std::size_t read = 0;
+        while (read < size) {
+          auto toRead = std::min(blockSize, size - read);
+          stream.read(buffer.data() + read,
+                      static_cast<std::streamsize>(toRead));
+          auto blockRead = static_cast<std::size_t>(stream.gcount());
+          read += blockRead;
+          if (onRead) {
+            onRead(read, size);
+          }
+          // the file may have been shortened since it was measured
+          if (blockRead < toRead) {
+            break;
+          }
+        }
+        buffer.resize(read + 1);
+        buffer[read] = '\0';
+      }
+
+      /// clear a document when leaving a scope, returning its memory to the
+      /// DomPool in use
+      class ClearOnExit {
+       public:
+        explicit ClearOnExit(rapidxml::xml_document<>& document)
+            : document_(document) {}
+        ClearOnExit(const ClearOnExit&) = delete;
+        ClearOnExit& operator=(const ClearOnExit&) = delete;
+        ~ClearOnExit() { document_.clear(); }
+
+       private:
+        rapidxml::xml_document<>& document_;
+      };
+    }  // namespace
+
+    ParserScratch::ParserScratch() { DomPool::attach(xmlDocument); }
+
+    void ParserScratch::clear() {
+      buffer.clear();
+      idMap.clear();
+      references.clear();
+    }
+
+    XmlParser::XmlParser(ParserOptions options,
+                         std::shared_ptr<Document> destDocument,
+                         ParserScratch* scratch)
+        : options_(options),
+          document_(destDocument),
+          ownScratch_(scratch ? nullptr : new ParserScratch),
+          scratch_(scratch ? *scratch : *ownScratch_),
+          references_(scratch_.references),
+          idMap_(scratch_.idMap) {
+      idMap_.update(*document_);
+    }
+
+    XmlParser::XmlParser(ParserOptions options,
+                         std::shared_ptr<Document> destDocument,
+                         adm::detail::IDMap& idMap)
+        : options_(options),
           document_(destDocument),
-          idMap_(*destDocument) {}
+          ownScratch_(new ParserScratch),
+          scratch_(*ownScratch_),
+          references_(scratch_.references),
+          idMap_(idMap) {}
+
+    XmlParser::~XmlParser() {
+      if (!ownScratch_) {
+        scratch_.clear();
+      }
+    }
 
     XmlParser::XmlParser(const std::string& filename, ParserOptions options,
-                         std::shared_ptr<Document> destDocument)
-        : XmlParser(rapidxml::file<>{filename.c_str()}, options,
-                    std::move(destDocument)) {}
+                         std::shared_ptr<Document> destDocument,
+                         ParserScratch* scratch)
+        : XmlParser(options, std::move(destDocument), scratch) {
+      if (isSet(options_, ParserOptions::streaming)) {
+        ownedStream_.reset(new std::ifstream(filename, std::ios::binary));
+        if (!*ownedStream_) {
+          throw std::runtime_error(std::string("cannot open file ") +
+                                   filename);
+        }
+        stream_ = ownedStream_.get();
+      } else if (isSet(options_, ParserOptions::memory_map)) {
+        mappedFile_.reset(new MappedFile(filename));
+        xmlData_ = mappedFile_->data();
+        xmlSize_ = mappedFile_->size();
+        if (isSet(options_, ParserOptions::lazy_audio_block_formats)) {
+          lazySource_ = std::make_shared<LazySource>(filename);
+        }
+      } else {
+        // read by parse(), so that reading can report progress and be
+        // cancelled
+        filename_ = filename;
+      }
+    }
 
     XmlParser::XmlParser(std::istream& stream, ParserOptions options,
-                         std::shared_ptr<Document> destDocument)
-        : XmlParser(rapidxml::file<>{stream}, options,
-                    std::move(destDocument)) {}
+                         std::shared_ptr<Document> destDocument,
+                         ParserScratch* scratch)
+        : XmlParser(options, std::move(destDocument), scratch) {
+      if (isSet(options_, ParserOptions::streaming)) {
+        stream_ = &stream;
+      } else {
+        readStream(stream, scratch_.buffer);
+        xmlData_ = scratch_.buffer.data();
+        xmlSize_ = scratch_.buffer.size() - 1;
+        if (isSet(options_, ParserOptions::lazy_audio_block_formats)) {
+          lazySource_ = std::make_shared<LazySource>(xmlData_, xmlSize_);
+        }
+      }
+    }
+
+    XmlParser::XmlParser(char* data, std::size_t size, ParserOptions options,
+                         std::shared_ptr<Document> destDocument,
+                         ParserScratch* scratch)
+        : XmlParser(options & ~(ParserOptions::streaming |
+                                ParserOptions::memory_map),
+                    std::move(destDocument), scratch) {
+      if (data[size] != '\0') {
+        throw std::invalid_argument(
+            "data to parse in place must be null-terminated");
+      }
+      xmlData_ = data;
+      xmlSize_ = size;
+      if (isSet(options_, ParserOptions::lazy_audio_block_formats)) {
+        lazySource_ = std::make_shared<LazySource>(xmlData_, xmlSize_);
+      }
+    }
+
+    XmlParser::XmlParser(const char* data, std::size_t size,
+                         ParserOptions options,
+                         std::shared_ptr<Document> destDocument,
+                         ParserScratch* scratch)
+        : XmlParser(options & ~(ParserOptions::streaming |
+                                ParserOptions::memory_map),
+                    std::move(destDocument), scratch) {
+      auto& buffer = scratch_.buffer;
+      buffer.reserve(size + 1);
+      buffer.assign(data, data + size);
+      buffer.push_back('\0');
+      xmlData_ = buffer.data();
+      xmlSize_ = size;
+      if (isSet(options_, ParserOptions::lazy_audio_block_formats)) {
+        lazySource_ = std::make_shared<LazySource>(xmlData_, xmlSize_);
+      }
+    }
+
+    XmlParser::XmlParser(std::istream& stream,
+                         std::shared_ptr<Document> destDocument,
+                         adm::detail::IDMap& idMap)
+        : XmlParser(ParserOptions::none, std::move(destDocument), idMap) {
+      readStream(stream, scratch_.buffer);
+      xmlData_ = scratch_.buffer.data();
+      xmlSize_ = scratch_.buffer.size() - 1;
+    }
+
+    LazySource::LazySource(const std::string& filename)
+        : mappedFile_(new MappedFile(filename)),
+          data_(mappedFile_->data()),
+          size_(mappedFile_->size()) {}
+
+    LazySource::LazySource(const char* data, std::size_t size)
+        : buffer_(data, data + size), data_(buffer_.data()), size_(size) {}
 
     template <typename Element>
     void XmlParser::add(std::shared_ptr<Element> el) {
@@ -40,63 +264,1176 @@ namespace adm {
       idMap_.add(std::move(el));
     }
 
+    void XmlParser::selectProgramme(const AudioProgrammeId& programmeId) {
+      programmeId_ = programmeId;
+    }
+
+    void XmlParser::collectDiagnostics(
+        std::vector<ParseDiagnostic>& diagnostics) {
+      diagnostics_ = &diagnostics;
+    }
+
+    void XmlParser::setProgressCallback(ProgressCallback progress) {
+      progress_ = std::move(progress);
+    }
+
+    void XmlParser::setCancellationToken(CancellationToken cancellation) {
+      cancellation_ = std::move(cancellation);
+    }
+
+    bool XmlParser::isCancelled() const {
+      return cancellation_ && cancellation_->isCancelled();
+    }
+
+    void XmlParser::checkCancelled() const {
+      if (isCancelled()) {
+        throw error::ParsingCancelled();
+      }
+    }
+
+    void XmlParser::reportProgress(ParsePhase phase, std::size_t bytes,
+                                   std::size_t totalBytes,
+                                   std::size_t elements,
+                                   std::size_t totalElements) const {
+      if (progress_) {
+        progress_(
+            ParseProgress{phase, bytes, totalBytes, elements, totalElements});
+      }
+    }
+
+    void XmlParser::referencesResolved(std::size_t count) {
+      if (count) {
+        referencesResolved_ += count;
+        reportProgress(ParsePhase::references, xmlSize_, xmlSize_,
+                       referencesResolved_, referencesTotal_);
+        checkCancelled();
+      }
+    }
+
     std::shared_ptr<Document> XmlParser::parse() {
+      checkCancelled();
+      if (isSet(options_, ParserOptions::streaming)) {
+        if (diagnostics_) {
+          throw std::invalid_argument(
+              "collecting diagnostics is not supported with "
+              "ParserOptions::streaming");
+        }
+        if (programmeId_) {
+          throw std::invalid_argument(
+              "selecting an audioProgramme is not supported with "
+              "ParserOptions::streaming");
+        }
+        return parseStreaming();
+      } else {
+        if (!filename_.empty()) {
+          readInputFile();
+        }
+        return parseDom();
+      }
+    }
+
+    void XmlParser::readInputFile() {
+      readFile(filename_, scratch_.buffer,
+               [this](std::size_t bytes, std::size_t totalBytes) {
+                 reportProgress(ParsePhase::read, bytes, totalBytes, 0, 0);
+                 checkCancelled();
+               });
+      xmlData_ = scratch_.buffer.data();
+      xmlSize_ = scratch_.buffer.size() - 1;
+      if (isSet(options_, ParserOptions::lazy_audio_block_formats)) {
+        // a copy of what was read, rather than a mapping, so that the blocks
+        // are the ones which were read even if the file changes
+        lazySource_ = std::make_shared<LazySource>(xmlData_, xmlSize_);
+      }
+    }
+
+    std::shared_ptr<Document> XmlParser::parseDom() {
+      DomPool::Use useDomPool(scratch_.domPool);
+      auto& xmlDocument = scratch_.xmlDocument;
+      ClearOnExit clearDocument(xmlDocument);
+      DocumentLineOffset lineOffset(&xmlDocument);
+
+      // when collecting diagnostics there may be many lines to find, so index
+      // the line breaks once; this must be done before parsing in place
+      if (diagnostics_) {
+        lineIndex_.reset(new LineIndex(xmlData_, xmlData_ + xmlSize_));
+      }
+
+      // find audioFormatExtended without building a DOM for the rest of the
+      // document, and parse only that; otherwise parse everything, which
+      // gives the same errors as before for documents that can not be
+      // scanned
+      const char* rootName = nullptr;
+      reportProgress(ParsePhase::dom, 0, xmlSize_, 0, 0);
+      try {
+        ElementSpan span = findAudioFormatExtendedSpan(
+            xmlData_, xmlData_ + xmlSize_,
+            isSet(options_, ParserOptions::recursive_node_search), rootName);
+        checkCancelled();
+        NodePtr root = nullptr;
+        if (span.begin) {
+          rootOffset_ = static_cast<std::size_t>(rootName - xmlData_);
+          lineOffset.set(countLines(rootName, span.begin));
+          char* begin = xmlData_ + (span.begin - xmlData_);
+          xmlData_[span.end - xmlData_] = '\0';
+          xmlDocument.parse<0>(begin);
+          root = xmlDocument.first_node();
+        } else {
+          xmlDocument.parse<0>(xmlData_);
+
+          if (!xmlDocument.first_node())
+            throw error::XmlParsingError("xml document is empty");
+          rootName = xmlDocument.first_node()->name();
+          rootOffset_ = static_cast<std::size_t>(rootName - xmlData_);
+
+          if (isSet(options_, ParserOptions::recursive_node_search)) {
+            root = findAudioFormatExtendedNodeFullRecursive(
+                xmlDocument.first_node());
+          } else {
+            root =
+                findAudioFormatExtendedNodeEbuCore(xmlDocument.first_node());
+          }
+        }
+        rootName_ = rootName;
+        if (lineIndex_) {
+          lineOffset.useIndex(*lineIndex_, rootName);
+        }
+        reportProgress(ParsePhase::dom, xmlSize_, xmlSize_, 0, 0);
+        checkCancelled();
+        if (root) {
+          // add ADM elements to ADM document
+          auto nodes = selectElements(root);
+          reportProgress(ParsePhase::elements, xmlSize_, xmlSize_, 0,
+                         nodes.size());
+          if (isSet(options_, ParserOptions::parallel) && !diagnostics_) {
+            parseElementsParallel(nodes);
+          } else {
+            for (std::size_t i = 0; i < nodes.size(); ++i) {
+              parseElement(nodes[i]);
+              reportProgress(ParsePhase::elements, xmlSize_, xmlSize_, i + 1,
+                             nodes.size());
+              checkCancelled();
+            }
+          }
+          resolveReferences();
+        } else {
+          throw error::XmlParsingError("audioFormatExtended node not found");
+        }
+      } catch (const rapidxml::parse_error& e) {
+        if (!diagnostics_) {
+          throw;
+        }
+        ParseDiagnostic diagnostic;
+        diagnostic.message = e.what();
+        diagnostic.line =
+            lineIndex_->linesBefore(e.where<char>()) -
+            lineIndex_->linesBefore(rootName ? rootName : xmlData_);
+        diagnostic.error = std::current_exception();
+        diagnostics_->push_back(std::move(diagnostic));
+        return nullptr;
+      } catch (const error::XmlParsingError&) {
+        // the document is empty, or the elements to parse can not be found
+        reportError(nullptr);
+        return nullptr;
+      }
+      return document_;
+    }
+
+    namespace {
+      /// the name of the ID attribute of a top-level element, or nullptr if
+      /// it is not an element that we parse
+      const char* idAttributeName(NodePtr node) {
+        std::string nodeName(node->name(), node->name_size());
+        if (nodeName == "audioProgramme") {
+          return "audioProgrammeID";
+        } else if (nodeName == "audioContent") {
+          return "audioContentID";
+        } else if (nodeName == "audioObject") {
+          return "audioObjectID";
+        } else if (nodeName == "audioTrackUID") {
+          return "UID";
+        } else if (nodeName == "audioPackFormat") {
+          return "audioPackFormatID";
+        } else if (nodeName == "audioChannelFormat") {
+          return "audioChannelFormatID";
+        } else if (nodeName == "audioStreamFormat") {
+          return "audioStreamFormatID";
+        } else if (nodeName == "audioTrackFormat") {
+          return "audioTrackFormatID";
+        }
+        return nullptr;
+      }
+
+      /// an ID as written in the document, with hex digits in upper case so
+      /// that it matches however it was written
+      std::string idKey(const char* id, std::size_t size) {
+        std::string key(id, size);
+        for (auto& c : key) {
+          if (c >= 'a' && c <= 'f') {
+            c = static_cast<char>(c - 'a' + 'A');
+          }
+        }
+        return key;
+      }
+
+      bool endsWith(const char* str, std::size_t size, const char* suffix) {
+        std::size_t suffixSize = std::strlen(suffix);
+        return size >= suffixSize &&
+               std::memcmp(str + size - suffixSize, suffix, suffixSize) == 0;
+      }
+
+      /**
+       * Find the children of root which are reachable from the programme with
+       * ID programmeKey by following the references written in the document
+       * (any child element with a name ending in `IDRef`), without parsing
+       * them.
+       */
+      std::vector<NodePtr> findProgrammeElements(
+          NodePtr root, const std::string& programmeKey) {
+        std::unordered_map<std::string, NodePtr> nodesById;
+        for (NodePtr node = root->first_node(); node;
+             node = node->next_sibling()) {
+          const char* attributeName = idAttributeName(node);
+          auto attribute =
+              attributeName ? node->first_attribute(attributeName) : nullptr;
+          if (attribute) {
+            nodesById.emplace(
+                idKey(attribute->value(), attribute->value_size()), node);
+          }
+        }
+
+        std::unordered_set<NodePtr> selected;
+        std::vector<NodePtr> toVisit;
+        auto programme = nodesById.find(programmeKey);
+        if (programme == nodesById.end() ||
+            std::strcmp(programme->second->name(), "audioProgramme") != 0) {
+          throw error::XmlParsingError("audioProgramme " + programmeKey +
+                                       " not found");
+        }
+        selected.insert(programme->second);
+        toVisit.push_back(programme->second);
+        while (!toVisit.empty()) {
+          NodePtr node = toVisit.back();
+          toVisit.pop_back();
+          for (NodePtr child = node->first_node(); child;
+               child = child->next_sibling()) {
+            if (!endsWith(child->name(), child->name_size(), "IDRef")) {
+              continue;
+            }
+            auto target =
+                nodesById.find(idKey(child->value(), child->value_size()));
+            if (target != nodesById.end() &&
+                selected.insert(target->second).second) {
+              toVisit.push_back(target->second);
+            }
+          }
+        }
+
+        std::vector<NodePtr> nodes;
+        for (NodePtr node = root->first_node(); node;
+             node = node->next_sibling()) {
+          if (selected.count(node)) {
+            nodes.push_back(node);
+          }
+        }
+        return nodes;
+      }
+    }  // namespace
+
+    std::vector<NodePtr> XmlParser::selectElements(NodePtr root) {
+      if (programmeId_) {
+        auto programmeKey = formatId(*programmeId_);
+        return findProgrammeElements(
+            root, idKey(programmeKey.data(), programmeKey.size()));
+      }
+      std::vector<NodePtr> nodes;
+      for (NodePtr node = root->first_node(); node;
+           node = node->next_sibling()) {
+        nodes.push_back(node);
+      }
+      return nodes;
+    }
+
+    bool XmlParser::keepAudioBlockFormat(std::size_t index) const {
+      if (isSet(options_, ParserOptions::skip_audio_block_formats)) {
+        return false;
+      }
+      if (isSet(options_, ParserOptions::first_audio_block_format_only)) {
+        return index == 0;
+      }
+      return true;
+    }
+
+    std::vector<NodePtr> XmlParser::findAudioBlockFormats(NodePtr node) const {
+      std::vector<NodePtr> elements;
+      for (NodePtr element = node->first_node("audioBlockFormat");
+           element && keepAudioBlockFormat(elements.size());
+           element = element->next_sibling("audioBlockFormat")) {
+        elements.push_back(element);
+      }
+      return elements;
+    }
+
+    namespace {
+      bool startsWith(const char* p, const char* end, const char* prefix) {
+        std::size_t size = std::strlen(prefix);
+        return static_cast<std::size_t>(end - p) >= size &&
+               std::memcmp(p, prefix, size) == 0;
+      }
+
+      /// the position after the next occurrence of terminator, or end
+      const char* skipPast(const char* p, const char* end,
+                           const char* terminator) {
+        std::size_t size = std::strlen(terminator);
+        while (p < end) {
+          p = static_cast<const char*>(std::memchr(p, terminator[0], end - p));
+          if (!p) {
+            return end;
+          } else if (startsWith(p, end, terminator)) {
+            return p + size;
+          }
+          ++p;
+        }
+        return end;
+      }
+
+      /// the position after the end of the tag starting at p, skipping over
+      /// quoted attribute values
+      const char* skipTag(const char* p, const char* end) {
+        char quote = 0;
+        for (++p; p < end && (quote || *p != '>'); ++p) {
+          if (quote) {
+            quote = *p == quote ? 0 : quote;
+          } else if (*p == '"' || *p == '\'') {
+            quote = *p;
+          }
+        }
+        return p < end ? p + 1 : end;
+      }
+
+      /// the position after the end of a DOCTYPE (or other `<!` markup)
+      /// starting at p, including any internal subset
+      const char* skipDeclaration(const char* p, const char* end) {
+        int depth = 0;
+        char quote = 0;
+        for (p += 2; p < end; ++p) {
+          if (quote) {
+            quote = *p == quote ? 0 : quote;
+          } else if (*p == '"' || *p == '\'') {
+            quote = *p;
+          } else if (*p == '[') {
+            ++depth;
+          } else if (*p == ']') {
+            --depth;
+          } else if (*p == '>' && depth <= 0) {
+            return p + 1;
+          }
+        }
+        return end;
+      }
+
+      /**
+       * Find the end of the element whose start tag begins at p, in XML which
+       * has not been parsed in place. The XML is assumed to be well-formed,
+       * as it has already been parsed once.
+       */
+      const char* findElementEnd(const char* p, const char* end) {
+        int depth = 0;
+        while (p < end) {
+          if (*p != '<') {
+            ++p;
+          } else if (startsWith(p, end, "<!--")) {
+            p = skipPast(p + 4, end, "-->");
+          } else if (startsWith(p, end, "<![CDATA[")) {
+            p = skipPast(p + 9, end, "]]>");
+          } else if (startsWith(p, end, "<?")) {
+            p = skipPast(p + 2, end, "?>");
+          } else if (startsWith(p, end, "</")) {
+            p = skipPast(p + 2, end, ">");
+            if (--depth == 0) {
+              return p;
+            }
+          } else {
+            p = skipTag(p, end);
+            bool empty = p[-2] == '/';
+            if (!empty) {
+              ++depth;
+            } else if (depth == 0) {
+              return p;
+            }
+          }
+        }
+        return end;
+      }
+
+      /// adds the audioBlockFormats in part of a LazySource to an
+      /// AudioChannelFormat
+      struct LazyAudioBlockFormats {
+        std::shared_ptr<const LazySource> source;
+        /// offset of the root element, from which lines are counted
+        std::size_t rootOffset;
+        /// range containing the audioBlockFormats
+        std::size_t begin;
+        std::size_t end;
+        /// number of audioBlockFormats to add
+        std::size_t count;
+
+        void operator()(AudioChannelFormat& audioChannelFormat) const {
+          const char* data = source->data();
+          XmlFragment fragment;
+          fragment.text() = "<audioChannelFormat>";
+          fragment.text().append(data + begin, data + end);
+          fragment.text() += "</audioChannelFormat>";
+          // counting lines takes time proportional to the offset of the
+          // blocks, so is only done if there is an error to report
+          const char* rootName = data + rootOffset;
+          const char* blocks = data + begin;
+          NodePtr node = fragment.parse(
+              [rootName, blocks]() { return countLines(rootName, blocks); });
+
+          audioChannelFormat.reserveAudioBlockFormats(count);
+          std::size_t added = 0;
+          for (NodePtr element = node->first_node("audioBlockFormat");
+               element && added < count;
+               element = element->next_sibling("audioBlockFormat"), ++added) {
+            addAudioBlockFormat(audioChannelFormat, element);
+          }
+        }
+      };
+    }  // namespace
+
+    bool XmlParser::deferAudioBlockFormats(
+        AudioChannelFormat& audioChannelFormat,
+        const std::vector<NodePtr>& blockNodes) {
+      if (!lazySource_ || blockNodes.empty()) {
+        return false;
+      }
+      // the start tags of elements are not moved when parsing in place
+      auto offset = [this](NodePtr node) {
+        return static_cast<std::size_t>(node->name() - 1 - xmlData_);
+      };
+      const char* data = lazySource_->data();
+      const char* lastEnd =
+          findElementEnd(data + offset(blockNodes.back()), data + xmlSize_);
+      AudioChannelFormatAttorney::setAudioBlockFormatLoader(
+          audioChannelFormat,
+          LazyAudioBlockFormats{lazySource_, rootOffset_,
+                                offset(blockNodes.front()),
+                                static_cast<std::size_t>(lastEnd - data),
+                                blockNodes.size()});
+      return true;
+    }
+
+    void XmlParser::parseFrame() {
       rapidxml::xml_document<> xmlDocument;
-      xmlDocument.parse<0>(xmlFile_.data());
+      xmlDocument.parse<0>(xmlData_);
 
       if (!xmlDocument.first_node())
         throw error::XmlParsingError("xml document is empty");
 
-      NodePtr root = nullptr;
-      if (isSet(options_, ParserOptions::recursive_node_search)) {
-        root =
-            findAudioFormatExtendedNodeFullRecursive(xmlDocument.first_node());
-      } else {
-        root = findAudioFormatExtendedNodeEbuCore(xmlDocument.first_node());
+      NodePtr root = findAudioFormatExtendedNodeFrame(xmlDocument.first_node());
+      if (!root) {
+        throw error::XmlParsingError("audioFormatExtended node not found");
       }
-      if (root) {
-        // add ADM elements to ADM document
-        for (NodePtr node = root->first_node(); node;
-             node = node->next_sibling()) {
-          std::string nodeName(node->name(), node->name_size());
+      // parse and check the audioBlockFormats to append to existing
+      // channels before changing anything, so that if they do not follow on
+      // from the document, none of them are added
+      std::vector<std::function<void()>> appends;
+      std::vector<NodePtr> nodes;
+      for (NodePtr node = root->first_node(); node;
+           node = node->next_sibling()) {
+        if (auto audioChannelFormat = knownAudioChannelFormat(node)) {
+          appends.push_back(
+              prepareAudioBlockFormats(*audioChannelFormat, node));
+        } else {
+          nodes.push_back(node);
+        }
+      }
+      for (const auto& append : appends) {
+        append();
+      }
+      for (NodePtr node : nodes) {
+        parseFrameElement(node);
+      }
+      resolveReferences();
+    }
+
+    std::shared_ptr<AudioChannelFormat> XmlParser::knownAudioChannelFormat(
+        NodePtr node) {
+      if (std::string(node->name(), node->name_size()) !=
+          "audioChannelFormat") {
+        return nullptr;
+      }
+      auto id = parseOptionalAttribute<AudioChannelFormatId>(
+          node, "audioChannelFormatID", &parseAudioChannelFormatId);
+      return id ? idMap_.lookup(*id) : nullptr;
+    }
+
+    template <typename Id, typename Parser>
+    bool XmlParser::isKnownId(NodePtr node, const char* attributeName,
+                              Parser parser) {
+      auto id = parseOptionalAttribute<Id>(node, attributeName, parser);
+      return id && idMap_.contains(*id);
+    }
+
+    void XmlParser::parseFrameElement(NodePtr node) {
+      std::string nodeName(node->name(), node->name_size());
+
+      bool known = false;
+      // clang-format off
+      if (nodeName == "audioProgramme") {
+        known = isKnownId<AudioProgrammeId>(node, "audioProgrammeID", &parseAudioProgrammeId);
+      } else if (nodeName == "audioContent") {
+        known = isKnownId<AudioContentId>(node, "audioContentID", &parseAudioContentId);
+      } else if (nodeName == "audioObject") {
+        known = isKnownId<AudioObjectId>(node, "audioObjectID", &parseAudioObjectId);
+      } else if (nodeName == "audioTrackUID") {
+        known = isKnownId<AudioTrackUidId>(node, "UID", &parseAudioTrackUidId);
+      } else if (nodeName == "audioPackFormat") {
+        known = isKnownId<AudioPackFormatId>(node, "audioPackFormatID", &parseAudioPackFormatId);
+      } else if (nodeName == "audioChannelFormat") {
+        // this is only known here if it was added earlier in the same frame
+        if (auto audioChannelFormat = knownAudioChannelFormat(node)) {
+          appendAudioBlockFormats(*audioChannelFormat, node);
+          known = true;
+        }
+      } else if (nodeName == "audioStreamFormat") {
+        known = isKnownId<AudioStreamFormatId>(node, "audioStreamFormatID", &parseAudioStreamFormatId);
+      } else if (nodeName == "audioTrackFormat") {
+        known = isKnownId<AudioTrackFormatId>(node, "audioTrackFormatID", &parseAudioTrackFormatId);
+      }
+      // clang-format on
+
+      if (!known) {
+        parseElement(node);
+      }
+    }
+
+    void XmlParser::parseElement(NodePtr node) {
+      if (!diagnostics_) {
+        parseElement(node, references_);
+        return;
+      }
+      elementReferences_.clear();
+      try {
+        parseElement(node, elementReferences_);
+        references_.merge(elementReferences_);
+      } catch (const std::exception&) {
+        reportError(node);
+      }
+    }
+
+    void XmlParser::parseElement(NodePtr node, PendingReferences& references) {
+      std::string nodeName(node->name(), node->name_size());
+
+      if (nodeName == "audioProgramme") {
+        add(parseAudioProgramme(node, references));
+      } else if (nodeName == "audioContent") {
+        add(parseAudioContent(node, references));
+      } else if (nodeName == "audioObject") {
+        add(parseAudioObject(node, references));
+      } else if (nodeName == "audioTrackUID") {
+        add(parseAudioTrackUid(node, references));
+      } else if (nodeName == "audioPackFormat") {
+        add(parseAudioPackFormat(node, references));
+      } else if (nodeName == "audioChannelFormat") {
+        add(parseAudioChannelFormat(node));
+      } else if (nodeName == "audioStreamFormat") {
+        add(parseAudioStreamFormat(node, references));
+      } else if (nodeName == "audioTrackFormat") {
+        add(parseAudioTrackFormat(node, references));
+      }
+    }
+
+    void XmlParser::reportError(NodePtr node) {
+      if (!diagnostics_) {
+        throw;
+      }
+      ParseDiagnostic diagnostic;
+      diagnostic.error = std::current_exception();
+      try {
+        throw;
+      } catch (const error::ParsingCancelled&) {
+        throw;
+      } catch (const error::XmlParsingError& e) {
+        diagnostic.message = e.what();
+        diagnostic.line = e.line();
+      } catch (const std::exception& e) {
+        diagnostic.message = e.what();
+      }
+      if (!diagnostic.line && node) {
+        diagnostic.line = getDocumentLine(node);
+      }
+      diagnostics_->push_back(std::move(diagnostic));
+    }
+
+    void XmlParser::unresolvedReference(const std::string& id,
+                                        const char* location) {
+      error::XmlParsingUnresolvedReference error(id);
+      if (!diagnostics_) {
+        throw error;
+      }
+      ParseDiagnostic diagnostic;
+      diagnostic.message = error.what();
+      diagnostic.line = referenceLine(location);
+      diagnostic.error = std::make_exception_ptr(error);
+      diagnostics_->push_back(std::move(diagnostic));
+    }
+
+    void XmlParser::reportReferenceError(const char* location) {
+      if (!diagnostics_) {
+        throw;
+      }
+      ParseDiagnostic diagnostic;
+      diagnostic.error = std::current_exception();
+      try {
+        throw;
+      } catch (const std::exception& e) {
+        diagnostic.message = e.what();
+      }
+      diagnostic.line = referenceLine(location);
+      diagnostics_->push_back(std::move(diagnostic));
+    }
+
+    boost::optional<int> XmlParser::referenceLine(const char* location) const {
+      // locations are only in xmlData_ when it was parsed into a DOM, which
+      // is when there is an index
+      if (!lineIndex_ || !location || !rootName_) {
+        return boost::none;
+      }
+      return lineIndex_->linesBefore(location) -
+             lineIndex_->linesBefore(rootName_);
+    }
+
+    void XmlParser::resolveReferences() {
+      referencesResolved_ = 0;
+      referencesTotal_ = references_.size();
+      reportProgress(ParsePhase::references, xmlSize_, xmlSize_, 0,
+                     referencesTotal_);
+      resolveReferences(references_.programmeContentRefs);
+      resolveReferences(references_.contentObjectRefs);
+      resolveReferences(references_.objectObjectRefs);
+      resolveReferences(references_.objectPackFormatRefs);
+      resolveReferences(references_.objectTrackUidRefs);
+      resolveReference(references_.trackUidTrackFormatRef);
+      resolveReference(references_.trackUidChannelFormatRef);
+      resolveReference(references_.trackUidPackFormatRef);
+      resolveReferences(references_.packFormatChannelFormatRefs);
+      resolveReferences(references_.packFormatPackFormatRefs);
+      resolveReference(references_.trackFormatStreamFormatRef);
+      resolveReference(references_.streamFormatChannelFormatRef);
+      resolveReference(references_.streamFormatPackFormatRef);
+      resolveReferences(references_.streamFormatTrackFormatRefs);
+    }
+
+    namespace {
+      template <typename Table>
+      void mergeReferences(Table& target, Table& source) {
+        target.insert(target.end(), std::make_move_iterator(source.begin()),
+                      std::make_move_iterator(source.end()));
+        source.clear();
+      }
+    }  // namespace
+
+    void PendingReferences::clear() {
+      programmeContentRefs.clear();
+      contentObjectRefs.clear();
+      objectObjectRefs.clear();
+      objectPackFormatRefs.clear();
+      objectTrackUidRefs.clear();
+      trackUidTrackFormatRef.clear();
+      trackUidChannelFormatRef.clear();
+      trackUidPackFormatRef.clear();
+      packFormatChannelFormatRefs.clear();
+      packFormatPackFormatRefs.clear();
+      trackFormatStreamFormatRef.clear();
+      streamFormatChannelFormatRef.clear();
+      streamFormatPackFormatRef.clear();
+      streamFormatTrackFormatRefs.clear();
+    }
+
+    std::size_t PendingReferences::size() const {
+      return programmeContentRefs.size() + contentObjectRefs.size() +
+             objectObjectRefs.size() + objectPackFormatRefs.size() +
+             objectTrackUidRefs.size() + trackUidTrackFormatRef.size() +
+             trackUidChannelFormatRef.size() + trackUidPackFormatRef.size() +
+             packFormatChannelFormatRefs.size() +
+             packFormatPackFormatRefs.size() +
+             trackFormatStreamFormatRef.size() +
+             streamFormatChannelFormatRef.size() +
+             streamFormatPackFormatRef.size() +
+             streamFormatTrackFormatRefs.size();
+    }
+
+    void PendingReferences::merge(PendingReferences& other) {
+      mergeReferences(programmeContentRefs, other.programmeContentRefs);
+      mergeReferences(contentObjectRefs, other.contentObjectRefs);
+      mergeReferences(objectObjectRefs, other.objectObjectRefs);
+      mergeReferences(objectPackFormatRefs, other.objectPackFormatRefs);
+      mergeReferences(objectTrackUidRefs, other.objectTrackUidRefs);
+      mergeReferences(trackUidTrackFormatRef, other.trackUidTrackFormatRef);
+      mergeReferences(trackUidChannelFormatRef, other.trackUidChannelFormatRef);
+      mergeReferences(trackUidPackFormatRef, other.trackUidPackFormatRef);
+      mergeReferences(packFormatChannelFormatRefs,
+                      other.packFormatChannelFormatRefs);
+      mergeReferences(packFormatPackFormatRefs, other.packFormatPackFormatRefs);
+      mergeReferences(trackFormatStreamFormatRef,
+                      other.trackFormatStreamFormatRef);
+      mergeReferences(streamFormatChannelFormatRef,
+                      other.streamFormatChannelFormatRef);
+      mergeReferences(streamFormatPackFormatRef,
+                      other.streamFormatPackFormatRef);
+      mergeReferences(streamFormatTrackFormatRefs,
+                      other.streamFormatTrackFormatRefs);
+    }
 
+    namespace {
+      /// number of audioBlockFormats parsed by each parallel task, and
+      /// between checks for cancellation
+      const std::size_t blockBatchSize = 256;
+
+      /// audioBlockFormats parsed ahead of being added to their channel;
+      /// only the vector for the type of the channel is used
+      struct ParsedBlocks {
+        std::vector<AudioBlockFormatDirectSpeakers> directSpeakers;
+        std::vector<AudioBlockFormatObjects> objects;
+        std::vector<AudioBlockFormatHoa> hoa;
+        std::vector<AudioBlockFormatBinaural> binaural;
+        std::vector<AudioBlockFormatMatrix> matrix;
+        std::exception_ptr error;
+      };
+
+      template <typename Block, typename Parse>
+      void parseBlocks(const NodePtr* begin, const NodePtr* end,
+                       std::vector<Block>& blocks, Parse parse) {
+        blocks.reserve(static_cast<std::size_t>(end - begin));
+        for (auto node = begin; node != end; ++node) {
+          blocks.push_back(parse(*node));
+        }
+      }
+
+      /// the parallel equivalent of addAudioBlockFormat(), first part
+      void parseAudioBlockFormats(TypeDescriptor type, const NodePtr* begin,
+                                  const NodePtr* end, ParsedBlocks& blocks) {
+        if (type == TypeDefinition::DIRECT_SPEAKERS) {
+          parseBlocks(begin, end, blocks.directSpeakers,
+                      &parseAudioBlockFormatDirectSpeakers);
+        } else if (type == TypeDefinition::OBJECTS) {
+          parseBlocks(begin, end, blocks.objects,
+                      &parseAudioBlockFormatObjects);
+        } else if (type == TypeDefinition::HOA) {
+          parseBlocks(begin, end, blocks.hoa, &parseAudioBlockFormatHoa);
+        } else if (type == TypeDefinition::BINAURAL) {
+          parseBlocks(begin, end, blocks.binaural,
+                      &parseAudioBlockFormatBinaural);
+        } else if (type == TypeDefinition::MATRIX) {
+          parseBlocks(begin, end, blocks.matrix, &parseAudioBlockFormatMatrix);
+        }
+      }
+
+      /// the parallel equivalent of addAudioBlockFormat(), second part
+      void addAudioBlockFormats(AudioChannelFormat& audioChannelFormat,
+                                ParsedBlocks& blocks) {
+        for (auto& block : blocks.directSpeakers) {
+          audioChannelFormat.add(std::move(block));
+        }
+        for (auto& block : blocks.objects) {
+          audioChannelFormat.add(std::move(block));
+        }
+        for (auto& block : blocks.hoa) {
+          audioChannelFormat.add(std::move(block));
+        }
+        for (auto& block : blocks.binaural) {
+          audioChannelFormat.add(std::move(block));
+        }
+        for (auto& block : blocks.matrix) {
+          audioChannelFormat.add(std::move(block));
+        }
+      }
+
+      /// a child of audioFormatExtended, parsed but not yet added
+      struct ParsedElement {
+        NodePtr node = nullptr;
+        /// check that the element ID is not already in use, then add the
+        /// element to the document; empty if the node is not an element that
+        /// we parse
+        std::function<void()> checkId;
+        std::function<void()> add;
+        PendingReferences references;
+        std::exception_ptr error;
+        /// for audioChannelFormats, the element and its audioBlockFormat
+        /// nodes, which are parsed separately
+        std::shared_ptr<AudioChannelFormat> audioChannelFormat;
+        std::vector<NodePtr> blockNodes;
+      };
+
+      /// a range of the blocks of one ParsedElement
+      struct BlockBatch {
+        std::size_t element;
+        std::size_t begin;
+        std::size_t end;
+        ParsedBlocks blocks;
+      };
+    }  // namespace
+
+    /*
+     * Each child of audioFormatExtended is parsed into its own
+     * PendingReferences while nothing is added to the document, then the
+     * audioBlockFormats of any audioChannelFormats are parsed in batches, so
+     * that a few large channels can still be spread across threads. The
+     * results are then added in document order, which is also when duplicate
+     * IDs can be detected.
+     *
+     * If anything fails, the failing element is parsed again as it would be
+     * by parseElement(), so that the error reported is the same as without
+     * ParserOptions::parallel.
+     */
+    void XmlParser::parseElementsParallel(const std::vector<NodePtr>& nodes) {
+      std::vector<ParsedElement> elements(nodes.size());
+      for (std::size_t i = 0; i < nodes.size(); ++i) {
+        elements[i].node = nodes[i];
+      }
+
+      auto deferAdd = [this](ParsedElement& parsed, auto element) {
+        using Element = typename decltype(element)::element_type;
+        NodePtr node = parsed.node;
+        parsed.checkId = [this, node, element]() {
+          auto id = element->template get<typename Element::id_type>();
+          if (idMap_.contains(id)) {
+            throw error::XmlParsingDuplicateId(formatId(id),
+                                               getDocumentLine(node));
+          }
+        };
+        parsed.add = [this, element]() { add(element); };
+      };
+
+      auto& pool = adm::detail::ThreadPool::shared();
+      pool.parallelFor(elements.size(), [&](std::size_t i) {
+        if (isCancelled()) {
+          return;
+        }
+        ParsedElement& parsed = elements[i];
+        NodePtr node = parsed.node;
+        std::string nodeName(node->name(), node->name_size());
+        try {
           if (nodeName == "audioProgramme") {
-            add(parseAudioProgramme(node));
+            deferAdd(parsed, parseAudioProgramme(node, parsed.references));
           } else if (nodeName == "audioContent") {
-            add(parseAudioContent(node));
+            deferAdd(parsed, parseAudioContent(node, parsed.references));
           } else if (nodeName == "audioObject") {
-            add(parseAudioObject(node));
+            deferAdd(parsed, parseAudioObject(node, parsed.references));
           } else if (nodeName == "audioTrackUID") {
-            add(parseAudioTrackUid(node));
+            deferAdd(parsed, parseAudioTrackUid(node, parsed.references));
           } else if (nodeName == "audioPackFormat") {
-            add(parseAudioPackFormat(node));
+            deferAdd(parsed, parseAudioPackFormat(node, parsed.references));
           } else if (nodeName == "audioChannelFormat") {
-            add(parseAudioChannelFormat(node));
+            parsed.audioChannelFormat = createAudioChannelFormat(node);
+            parsed.blockNodes = findAudioBlockFormats(node);
+            if (deferAudioBlockFormats(*parsed.audioChannelFormat,
+                                       parsed.blockNodes)) {
+              parsed.blockNodes.clear();
+            }
+            deferAdd(parsed, parsed.audioChannelFormat);
           } else if (nodeName == "audioStreamFormat") {
-            add(parseAudioStreamFormat(node));
+            deferAdd(parsed, parseAudioStreamFormat(node, parsed.references));
           } else if (nodeName == "audioTrackFormat") {
-            add(parseAudioTrackFormat(node));
-          }
-        }
-        resolveReferences(programmeContentRefs_);
-        resolveReferences(contentObjectRefs_);
-        resolveReferences(objectObjectRefs_);
-        resolveReferences(objectPackFormatRefs_);
-        resolveReferences(objectTrackUidRefs_);
-        resolveReference(trackUidTrackFormatRef_);
-        resolveReference(trackUidChannelFormatRef_);
-        resolveReference(trackUidPackFormatRef_);
-        resolveReferences(packFormatChannelFormatRefs_);
-        resolveReferences(packFormatPackFormatRefs_);
-        resolveReference(trackFormatStreamFormatRef_);
-        resolveReference(streamFormatChannelFormatRef_);
-        resolveReference(streamFormatPackFormatRef_);
-        resolveReferences(streamFormatTrackFormatRefs_);
-      } else {
+            deferAdd(parsed, parseAudioTrackFormat(node, parsed.references));
+          }
+        } catch (...) {
+          parsed.error = std::current_exception();
+        }
+      });
+
+      checkCancelled();
+
+      std::vector<BlockBatch> batches;
+      for (std::size_t i = 0; i < elements.size(); ++i) {
+        const ParsedElement& parsed = elements[i];
+        if (parsed.error) {
+          // nothing after this will be added
+          break;
+        }
+        for (std::size_t begin = 0; begin < parsed.blockNodes.size();
+             begin += blockBatchSize) {
+          std::size_t end =
+              std::min(begin + blockBatchSize, parsed.blockNodes.size());
+          batches.push_back(BlockBatch{i, begin, end, {}});
+        }
+      }
+
+      pool.parallelFor(batches.size(), [&](std::size_t i) {
+        if (isCancelled()) {
+          return;
+        }
+        BlockBatch& batch = batches[i];
+        ParsedElement& parsed = elements[batch.element];
+        try {
+          parseAudioBlockFormats(
+              parsed.audioChannelFormat->get<TypeDescriptor>(),
+              parsed.blockNodes.data() + batch.begin,
+              parsed.blockNodes.data() + batch.end, batch.blocks);
+        } catch (...) {
+          batch.blocks.error = std::current_exception();
+        }
+      });
+
+      checkCancelled();
+
+      auto batch = batches.begin();
+      std::size_t added = 0;
+      for (auto& parsed : elements) {
+        std::exception_ptr error = parsed.error;
+        auto firstBatch = batch;
+        while (batch != batches.end() &&
+               &elements[batch->element] == &parsed) {
+          if (!error) {
+            error = batch->blocks.error;
+          }
+          ++batch;
+        }
+
+        if (error) {
+          parseElement(parsed.node);
+          std::rethrow_exception(error);
+        }
+        if (parsed.add) {
+          parsed.checkId();
+          if (!parsed.blockNodes.empty()) {
+            parsed.audioChannelFormat->reserveAudioBlockFormats(
+                parsed.blockNodes.size());
+          }
+          for (auto it = firstBatch; it != batch; ++it) {
+            addAudioBlockFormats(*parsed.audioChannelFormat, it->blocks);
+          }
+          references_.merge(parsed.references);
+          parsed.add();
+        }
+        reportProgress(ParsePhase::elements, xmlSize_, xmlSize_, ++added,
+                       elements.size());
+        checkCancelled();
+      }
+    }
+
+    namespace {
+      using TokenType = XmlStreamReader::TokenType;
+
+      /// append the rest of the element started by the current token to
+      /// `text`, leaving the reader on its end tag
+      void readElement(XmlStreamReader& reader, std::string& text) {
+        text += reader.text();
+        int depth = reader.type() == TokenType::start_tag ? 1 : 0;
+        while (depth > 0) {
+          if (!reader.next()) {
+            throw error::XmlParsingError("unexpected end of XML document");
+          }
+          text += reader.text();
+          if (reader.type() == TokenType::start_tag) {
+            ++depth;
+          } else if (reader.type() == TokenType::end_tag) {
+            --depth;
+          }
+        }
+      }
+
+      /// skip the rest of the element started by the current token, leaving
+      /// the reader on its end tag
+      void skipElement(XmlStreamReader& reader) {
+        int depth = reader.type() == TokenType::start_tag ? 1 : 0;
+        while (depth > 0) {
+          if (!reader.next(false)) {
+            throw error::XmlParsingError("unexpected end of XML document");
+          }
+          if (reader.type() == TokenType::start_tag) {
+            ++depth;
+          } else if (reader.type() == TokenType::end_tag) {
+            --depth;
+          }
+        }
+      }
+
+      bool isTag(const XmlStreamReader& reader) {
+        return reader.type() == TokenType::start_tag ||
+               reader.type() == TokenType::empty_element_tag;
+      }
+    }  // namespace
+
+    /*
+     * Streaming parsing finds the same audioFormatExtended element as
+     * parseDom(), but only ever holds one element from it in memory: each
+     * child of audioFormatExtended is read into an XmlFragment and parsed on
+     * its own, apart from audioChannelFormats, which are built up one
+     * audioBlockFormat at a time.
+     */
+    std::shared_ptr<Document> XmlParser::parseStreaming() {
+      XmlStreamReader reader(*stream_);
+      bool recursive = isSet(options_, ParserOptions::recursive_node_search);
+
+      // names of the currently open elements
+      std::vector<std::string> path;
+      int rootLine = -1;
+      bool found = false;
+      // number of elements found at each level of
+      // ebuCoreMain/coreMetadata/format/audioFormatExtended; each must be
+      // unique
+      int ebuCoreCounts[3] = {0, 0, 0};
+      const char* ebuCorePath[4] = {"ebuCoreMain", "coreMetadata", "format",
+                                    "audioFormatExtended"};
+
+      while (reader.next(false)) {
+        if (!isTag(reader)) {
+          if (reader.type() == TokenType::end_tag && !path.empty()) {
+            path.pop_back();
+          }
+          continue;
+        }
+        if (rootLine < 0) {
+          rootLine = reader.line();
+        }
+
+        bool isAudioFormatExtended = false;
+        if (recursive) {
+          isAudioFormatExtended =
+              !found && reader.name() == "audioFormatExtended";
+        } else if (path.size() >= 1 && path.size() <= 3 &&
+                   path[0] == ebuCorePath[0]) {
+          bool onPath = true;
+          for (std::size_t i = 1; i < path.size(); ++i) {
+            onPath = onPath && path[i] == ebuCorePath[i];
+          }
+          if (onPath && reader.name() == ebuCorePath[path.size()]) {
+            ++ebuCoreCounts[path.size() - 1];
+            isAudioFormatExtended =
+                path.size() == 3 && !found && ebuCoreCounts[0] == 1 &&
+                ebuCoreCounts[1] == 1 && ebuCoreCounts[2] == 1;
+          }
+        }
+
+        if (isAudioFormatExtended) {
+          found = true;
+          if (reader.type() == TokenType::start_tag) {
+            parseAudioFormatExtended(reader, rootLine);
+          }
+        } else if (reader.type() == TokenType::start_tag) {
+          path.push_back(reader.name());
+        }
+      }
+
+      if (rootLine < 0) {
+        throw error::XmlParsingError("xml document is empty");
+      }
+      if (!path.empty()) {
+        throw error::XmlParsingError("unexpected end of XML document");
+      }
+      bool unique = recursive || (ebuCoreCounts[0] == 1 &&
+                                  ebuCoreCounts[1] == 1 &&
+                                  ebuCoreCounts[2] == 1);
+      if (!found || !unique) {
         throw error::XmlParsingError("audioFormatExtended node not found");
       }
+      resolveReferences();
       return document_;
-    }  // namespace xml
+    }
+
+    void XmlParser::parseAudioFormatExtended(XmlStreamReader& reader,
+                                             int rootLine) {
+      XmlFragment fragment;
+      std::size_t built = 0;
+      while (reader.next(false)) {
+        if (reader.type() == TokenType::end_tag) {
+          return;
+        }
+        if (!isTag(reader)) {
+          continue;
+        }
+        const std::string& name = reader.name();
+        if (name == "audioChannelFormat" &&
+            reader.type() == TokenType::start_tag) {
+          parseAudioChannelFormat(reader, rootLine);
+        } else if (name == "audioProgramme" || name == "audioContent" ||
+                   name == "audioObject" || name == "audioTrackUID" ||
+                   name == "audioPackFormat" ||
+                   name == "audioChannelFormat" ||
+                   name == "audioStreamFormat" ||
+                   name == "audioTrackFormat") {
+          int line = reader.line() - rootLine;
+          fragment.text().clear();
+          readElement(reader, fragment.text());
+          parseElement(fragment.parse(line));
+        } else {
+          skipElement(reader);
+          continue;
+        }
+        reportProgress(ParsePhase::dom, reader.offset(), 0, ++built, 0);
+        checkCancelled();
+      }
+      throw error::XmlParsingError("unexpected end of XML document");
+    }
+
+    void XmlParser::parseAudioChannelFormat(XmlStreamReader& reader,
+                                            int rootLine) {
+      // build the channel from its attributes alone, by turning the start tag
+      // into an empty element
+      XmlFragment fragment;
+      fragment.text() = reader.text();
+      fragment.text().insert(fragment.text().size() - 1, "/");
+      auto audioChannelFormat =
+          createAudioChannelFormat(fragment.parse(reader.line() - rootLine));
+
+      // frequency nodes are parsed together at the end, so each needs its own
+      // fragment
+      std::vector<std::unique_ptr<XmlFragment>> frequencyFragments;
+      std::vector<NodePtr> frequencyNodes;
+      std::size_t blockCount = 0;
+
+      while (reader.next(false)) {
+        if (reader.type() == TokenType::end_tag) {
+          if (!frequencyNodes.empty()) {
+            audioChannelFormat->set(parseFrequency(frequencyNodes));
+          }
+          add(audioChannelFormat);
+          return;
+        }
+        if (!isTag(reader)) {
+          continue;
+        }
+        int line = reader.line() - rootLine;
+        if (reader.name() == "audioBlockFormat" &&
+            keepAudioBlockFormat(blockCount++)) {
+          if (blockCount % blockBatchSize == 0) {
+            checkCancelled();
+          }
+          fragment.text().clear();
+          readElement(reader, fragment.text());
+          addAudioBlockFormat(*audioChannelFormat, fragment.parse(line));
+        } else if (reader.name() == "frequency") {
+          frequencyFragments.emplace_back(new XmlFragment);
+          readElement(reader, frequencyFragments.back()->text());
+          frequencyNodes.push_back(frequencyFragments.back()->parse(line));
+        } else {
+          skipElement(reader);
+        }
+      }
+      throw error::XmlParsingError("unexpected end of XML document");
+    }
+
+    /**
+     * @brief Find the audioFormatExtended node of a serial ADM frame
+     *
+     * This accepts a BS.2125 `frame` element containing audioFormatExtended,
+     * a bare audioFormatExtended element, or an ebuCoreMain document as
+     * accepted by findAudioFormatExtendedNodeEbuCore(). It returns a nullptr
+     * if no audioFormatExtended node could be found.
+     */
+    NodePtr findAudioFormatExtendedNodeFrame(NodePtr node) {
+      std::string name(node->name(), node->name_size());
+      if (name == "frame") {
+        return detail::findElement(node, "audioFormatExtended");
+      } else if (name == "audioFormatExtended") {
+        return node;
+      } else {
+        return findAudioFormatExtendedNodeEbuCore(node);
+      }
+    }
 
     /**
      * @brief Find the top level element 'audioFormatExtended'
@@ -151,8 +1488,112 @@ namespace adm {
       return nullptr;
     }
 
+    namespace {
+      bool nameEquals(const char* name, std::size_t size, const char* other) {
+        return std::strlen(other) == size && std::memcmp(name, other, size) == 0;
+      }
+    }  // namespace
+
+    ElementSpan findAudioFormatExtendedSpan(const char* p, const char* end,
+                                            bool recursive,
+                                            const char*& rootName) {
+      // names of the open elements
+      std::vector<std::pair<const char*, std::size_t>> open;
+      auto openIs = [&open](std::size_t depth, const char* name) {
+        return nameEquals(open[depth].first, open[depth].second, name);
+      };
+      rootName = nullptr;
+      ElementSpan found;
+      int coreMetadataCount = 0;
+      int formatCount = 0;
+      int audioFormatExtendedCount = 0;
+
+      while (p < end) {
+        p = static_cast<const char*>(std::memchr(p, '<', end - p));
+        if (!p || p + 1 == end) {
+          break;
+        } else if (p[1] == '!') {
+          if (startsWith(p, end, "<!--")) {
+            p = skipPast(p + 4, end, "-->");
+          } else if (startsWith(p, end, "<![CDATA[")) {
+            p = skipPast(p + 9, end, "]]>");
+          } else {
+            p = skipDeclaration(p, end);
+          }
+        } else if (p[1] == '?') {
+          p = skipPast(p + 2, end, "?>");
+        } else if (p[1] == '/') {
+          p = skipPast(p + 2, end, ">");
+          if (open.empty()) {
+            return {};
+          }
+          open.pop_back();
+          if (open.empty()) {
+            break;
+          }
+        } else {
+          const char* tagBegin = p;
+          const char* name = p + 1;
+          const char* nameEnd = name;
+          while (nameEnd < end && *nameEnd != ' ' && *nameEnd != '\t' &&
+                 *nameEnd != '\r' && *nameEnd != '\n' && *nameEnd != '/' &&
+                 *nameEnd != '>') {
+            ++nameEnd;
+          }
+          auto nameSize = static_cast<std::size_t>(nameEnd - name);
+          p = skipTag(p, end);
+          bool empty = p[-2] == '/';
+
+          if (open.empty()) {
+            if (rootName) {
+              return {};
+            }
+            rootName = name;
+            if (!recursive && !nameEquals(name, nameSize, "ebuCoreMain")) {
+              return {};
+            }
+          }
+
+          bool isAudioFormatExtended =
+              nameEquals(name, nameSize, "audioFormatExtended");
+          if (recursive) {
+            if (isAudioFormatExtended) {
+              return {tagBegin, empty ? p : findElementEnd(tagBegin, end)};
+            }
+          } else if (open.size() == 1 &&
+                     nameEquals(name, nameSize, "coreMetadata")) {
+            coreMetadataCount++;
+          } else if (open.size() == 2 && openIs(1, "coreMetadata") &&
+                     nameEquals(name, nameSize, "format")) {
+            formatCount++;
+          } else if (open.size() == 3 && openIs(1, "coreMetadata") &&
+                     openIs(2, "format") && isAudioFormatExtended) {
+            audioFormatExtendedCount++;
+            const char* elementEnd =
+                empty ? p : findElementEnd(tagBegin, end);
+            if (!found.begin) {
+              found = {tagBegin, elementEnd};
+            }
+            // the contents do not matter here
+            p = elementEnd;
+            continue;
+          }
+
+          if (!empty) {
+            open.emplace_back(name, nameSize);
+          }
+        }
+      }
+
+      if (coreMetadataCount == 1 && formatCount == 1 &&
+          audioFormatExtendedCount == 1) {
+        return found;
+      }
+      return {};
+    }
+
     std::shared_ptr<AudioProgramme> XmlParser::parseAudioProgramme(
-        NodePtr node) {
+        NodePtr node, PendingReferences& references) {
       // clang-format off
       auto name = parseAttribute<AudioProgrammeName>(node, "audioProgrammeName");
       AudioProgrammeId id = parseAttribute<AudioProgrammeId>(node, "audioProgrammeID", &parseAudioProgrammeId);
@@ -169,14 +1610,15 @@ namespace adm {
       setOptionalMultiElement<LoudnessMetadatas>(node, "loudnessMetadata", audioProgramme, &parseLoudnessMetadatas);
       setOptionalElement<AudioProgrammeReferenceScreen>(node, "audioProgrammeReferenceScreen", audioProgramme, &parseAudioProgrammeReferenceScreen);
 
-      addOptionalReferences<AudioContentId>(node, "audioContentIDRef", audioProgramme, programmeContentRefs_, &parseAudioContentId);
+      addOptionalReferences<AudioContentId>(node, "audioContentIDRef", audioProgramme, references.programmeContentRefs, &parseAudioContentId);
 
       addOptionalElements<Label>(node, "audioProgrammeLabel", audioProgramme, &parseLabel);
       // clang-format on
       return audioProgramme;
     }
 
-    std::shared_ptr<AudioContent> XmlParser::parseAudioContent(NodePtr node) {
+    std::shared_ptr<AudioContent> XmlParser::parseAudioContent(
+        NodePtr node, PendingReferences& references) {
       // clang-format off
       auto name = parseAttribute<AudioContentName>(node, "audioContentName");
       auto id = parseAttribute<AudioContentId>(node, "audioContentID", &parseAudioContentId);
@@ -190,14 +1632,15 @@ namespace adm {
       setOptionalMultiElement<LoudnessMetadatas>(node, "loudnessMetadata", audioContent, &parseLoudnessMetadatas);
       setOptionalElement<ContentKind>(node, "dialogue", audioContent, &parseContentKind);
 
-      addOptionalReferences<AudioObjectId>(node, "audioObjectIDRef", audioContent, contentObjectRefs_, &parseAudioObjectId);
+      addOptionalReferences<AudioObjectId>(node, "audioObjectIDRef", audioContent, references.contentObjectRefs, &parseAudioObjectId);
 
       addOptionalElements<Label>(node, "audioContentLabel", audioContent, &parseLabel);
       // clang-format on
       return audioContent;
     }
 
-    std::shared_ptr<AudioObject> XmlParser::parseAudioObject(NodePtr node) {
+    std::shared_ptr<AudioObject> XmlParser::parseAudioObject(
+        NodePtr node, PendingReferences& references) {
       // clang-format off
       auto name = parseAttribute<AudioObjectName>(node, "audioObjectName");
       auto id = parseAttribute<AudioObjectId>(node, "audioObjectID", &parseAudioObjectId);
@@ -213,9 +1656,9 @@ namespace adm {
       setOptionalAttribute<Interact>(node, "interact", audioObject);
       setOptionalAttribute<DisableDucking>(node, "disableDucking", audioObject);
 
-      addOptionalReferences<AudioObjectId>(node, "audioObjectIDRef", audioObject, objectObjectRefs_, &parseAudioObjectId);
-      addOptionalReferences<AudioPackFormatId>(node, "audioPackFormatIDRef", audioObject, objectPackFormatRefs_, &parseAudioPackFormatId);
-      addOptionalReferences<AudioTrackUidId>(node, "audioTrackUIDRef", audioObject, objectTrackUidRefs_, &parseAudioTrackUidId);
+      addOptionalReferences<AudioObjectId>(node, "audioObjectIDRef", audioObject, references.objectObjectRefs, &parseAudioObjectId);
+      addOptionalReferences<AudioPackFormatId>(node, "audioPackFormatIDRef", audioObject, references.objectPackFormatRefs, &parseAudioPackFormatId);
+      addOptionalReferences<AudioTrackUidId>(node, "audioTrackUIDRef", audioObject, references.objectTrackUidRefs, &parseAudioTrackUidId);
       setOptionalElement<AudioObjectInteraction>(node, "audioObjectInteraction", audioObject, &parseAudioObjectInteraction);
       addOptionalElements<Label>(node, "audioObjectLabel", audioObject, &parseLabel);
       addOptionalElements<AudioComplementaryObjectGroupLabel>(node, "audioComplementaryObjectGroupLabel", audioObject, &parseLabel);
@@ -300,7 +1743,7 @@ namespace adm {
     }
 
     std::shared_ptr<AudioPackFormat> XmlParser::parseAudioPackFormat(
-        NodePtr node) {
+        NodePtr node, PendingReferences& references) {
       // clang-format off
       auto name = parseAttribute<AudioPackFormatName>(node, "audioPackFormatName");
       auto id = parseAttribute<AudioPackFormatId>(node, "audioPackFormatID", &parseAudioPackFormatId);
@@ -315,31 +1758,61 @@ namespace adm {
 
       if(typeDescriptor == adm::TypeDefinition::HOA){
           auto audioPackFormat = AudioPackFormatHoa::create(std::move(name), id);
-          setCommonProperties(audioPackFormat, node);
+          setCommonProperties(audioPackFormat, node, references);
           setOptionalAttribute<Normalization>(node, "normalization", audioPackFormat);
           setOptionalAttribute<ScreenRef>(node, "screenRef", audioPackFormat);
           setOptionalAttribute<NfcRefDist>(node, "nfcRefDist", audioPackFormat);
           return audioPackFormat;
       } else {
           auto audioPackFormat = AudioPackFormat::create(std::move(name), typeDescriptor, id);
-          setCommonProperties(audioPackFormat, node);
+          setCommonProperties(audioPackFormat, node, references);
           return audioPackFormat;
       }
       // clang-format on
     }
 
     void XmlParser::setCommonProperties(
-        std::shared_ptr<AudioPackFormat> audioPackFormat, NodePtr node) {
+        std::shared_ptr<AudioPackFormat> audioPackFormat, NodePtr node,
+        PendingReferences& references) {
       // clang-format off
       setOptionalAttribute<Importance>(node, "importance", audioPackFormat);
       setOptionalAttribute<AbsoluteDistance>(node, "absoluteDistance", audioPackFormat);
-      addOptionalReferences<AudioChannelFormatId>(node, "audioChannelFormatIDRef", audioPackFormat, packFormatChannelFormatRefs_, &parseAudioChannelFormatId);
-      addOptionalReferences<AudioPackFormatId>(node, "audioPackFormatIDRef", audioPackFormat, packFormatPackFormatRefs_, &parseAudioPackFormatId);
+      addOptionalReferences<AudioChannelFormatId>(node, "audioChannelFormatIDRef", audioPackFormat, references.packFormatChannelFormatRefs, &parseAudioChannelFormatId);
+      addOptionalReferences<AudioPackFormatId>(node, "audioPackFormatIDRef", audioPackFormat, references.packFormatPackFormatRefs, &parseAudioPackFormatId);
       // clang-format on
     }
 
     std::shared_ptr<AudioChannelFormat> XmlParser::parseAudioChannelFormat(
         NodePtr node) {
+      auto audioChannelFormat = createAudioChannelFormat(node);
+      auto elements = findAudioBlockFormats(node);
+      if (!deferAudioBlockFormats(*audioChannelFormat, elements)) {
+        audioChannelFormat->reserveAudioBlockFormats(elements.size());
+        // once an audioBlockFormat has been left out, the counters of the
+        // ones after it do not follow on, but they are still kept
+        bool afterGap = false;
+        for (std::size_t i = 0; i < elements.size(); ++i) {
+          NodePtr element = elements[i];
+          if (i % blockBatchSize == blockBatchSize - 1) {
+            checkCancelled();
+          }
+          try {
+            if (afterGap) {
+              addAudioBlockFormatAfterGap(*audioChannelFormat, element);
+            } else {
+              addAudioBlockFormat(*audioChannelFormat, element);
+            }
+          } catch (const std::exception&) {
+            reportError(element);
+            afterGap = true;
+          }
+        }
+      }
+      return audioChannelFormat;
+    }
+
+    std::shared_ptr<AudioChannelFormat> XmlParser::createAudioChannelFormat(
+        NodePtr node) {
       // clang-format off
       auto name = parseAttribute<AudioChannelFormatName>(node, "audioChannelFormatName");
       auto id = parseAttribute<AudioChannelFormatId>(node, "audioChannelFormatID", &parseAudioChannelFormatId);
@@ -354,40 +1827,11 @@ namespace adm {
 
       setOptionalMultiElement<Frequency>(node, "frequency", audioChannelFormat, &parseFrequency);
       // clang-format on
-
-      auto elements = detail::findElements(node, "audioBlockFormat");
-
-      if (audioChannelFormat->get<TypeDescriptor>() ==
-          TypeDefinition::DIRECT_SPEAKERS) {
-        for (auto& element : elements) {
-          audioChannelFormat->add(parseAudioBlockFormatDirectSpeakers(element));
-        }
-      } else if (audioChannelFormat->get<TypeDescriptor>() ==
-                 TypeDefinition::MATRIX) {
-        // for (auto& element : elements) {
-        //    audioChannelFormat->add(parseAudioBlockFormatMatrix(element));
-        // }
-      } else if (audioChannelFormat->get<TypeDescriptor>() ==
-                 TypeDefinition::OBJECTS) {
-        for (auto& element : elements) {
-          audioChannelFormat->add(parseAudioBlockFormatObjects(element));
-        }
-      } else if (audioChannelFormat->get<TypeDescriptor>() ==
-                 TypeDefinition::HOA) {
-        for (auto& element : elements) {
-          audioChannelFormat->add(parseAudioBlockFormatHoa(element));
-        }
-      } else if (audioChannelFormat->get<TypeDescriptor>() ==
-                 TypeDefinition::BINAURAL) {
-        for (auto& element : elements) {
-          audioChannelFormat->add(parseAudioBlockFormatBinaural(element));
-        }
-      }
       return audioChannelFormat;
     }
 
     std::shared_ptr<AudioStreamFormat> XmlParser::parseAudioStreamFormat(
-        NodePtr node) {
+        NodePtr node, PendingReferences& references) {
       // clang-format off
       auto name = parseAttribute<AudioStreamFormatName>(node, "audioStreamFormatName");
       auto id = parseAttribute<AudioStreamFormatId>(node, "audioStreamFormatID", &parseAudioStreamFormatId);
@@ -400,15 +1844,15 @@ namespace adm {
       auto format = checkFormat(formatLabel, formatDefinition);
       auto audioStreamFormat = AudioStreamFormat::create(std::move(name), format, id);
 
-      setOptionalReference<AudioChannelFormatId>(node, "audioChannelFormatIDRef", audioStreamFormat, streamFormatChannelFormatRef_, &parseAudioChannelFormatId);
-      setOptionalReference<AudioPackFormatId>(node, "audioPackFormatIDRef", audioStreamFormat, streamFormatPackFormatRef_, &parseAudioPackFormatId);
-      addOptionalReferences<AudioTrackFormatId>(node, "audioTrackFormatIDRef", audioStreamFormat, streamFormatTrackFormatRefs_, &parseAudioTrackFormatId);
+      setOptionalReference<AudioChannelFormatId>(node, "audioChannelFormatIDRef", audioStreamFormat, references.streamFormatChannelFormatRef, &parseAudioChannelFormatId);
+      setOptionalReference<AudioPackFormatId>(node, "audioPackFormatIDRef", audioStreamFormat, references.streamFormatPackFormatRef, &parseAudioPackFormatId);
+      addOptionalReferences<AudioTrackFormatId>(node, "audioTrackFormatIDRef", audioStreamFormat, references.streamFormatTrackFormatRefs, &parseAudioTrackFormatId);
       // clang-format on
       return audioStreamFormat;
     }
 
     std::shared_ptr<AudioTrackFormat> XmlParser::parseAudioTrackFormat(
-        NodePtr node) {
+        NodePtr node, PendingReferences& references) {
       // clang-format off
       auto name = parseAttribute<AudioTrackFormatName>(node, "audioTrackFormatName");
       auto id = parseAttribute<AudioTrackFormatId>(node, "audioTrackFormatID", &parseAudioTrackFormatId);
@@ -422,12 +1866,13 @@ namespace adm {
 
       auto audioTrackFormat = AudioTrackFormat::create(std::move(name), format, id);
 
-      setOptionalReference<AudioStreamFormatId>(node, "audioStreamFormatIDRef", audioTrackFormat, trackFormatStreamFormatRef_, &parseAudioStreamFormatId);
+      setOptionalReference<AudioStreamFormatId>(node, "audioStreamFormatIDRef", audioTrackFormat, references.trackFormatStreamFormatRef, &parseAudioStreamFormatId);
       // clang-format on
       return audioTrackFormat;
     }
 
-    std::shared_ptr<AudioTrackUid> XmlParser::parseAudioTrackUid(NodePtr node) {
+    std::shared_ptr<AudioTrackUid> XmlParser::parseAudioTrackUid(
+        NodePtr node, PendingReferences& references) {
       // clang-format off
       auto id = parseAttribute<AudioTrackUidId>(node, "UID", &parseAudioTrackUidId);
       if(idMap_.contains(id)) {
@@ -438,27 +1883,243 @@ namespace adm {
       setOptionalAttribute<SampleRate>(node, "sampleRate", audioTrackUid);
       setOptionalAttribute<BitDepth>(node, "bitDepth", audioTrackUid);
 
-      setOptionalReference<AudioChannelFormatId>(node, "audioChannelFormatIDRef", audioTrackUid, trackUidChannelFormatRef_, &parseAudioChannelFormatId);
-      setOptionalReference<AudioTrackFormatId>(node, "audioTrackFormatIDRef", audioTrackUid, trackUidTrackFormatRef_, &parseAudioTrackFormatId);
-      setOptionalReference<AudioPackFormatId>(node, "audioPackFormatIDRef", audioTrackUid, trackUidPackFormatRef_, &parseAudioPackFormatId);
+      setOptionalReference<AudioChannelFormatId>(node, "audioChannelFormatIDRef", audioTrackUid, references.trackUidChannelFormatRef, &parseAudioChannelFormatId);
+      setOptionalReference<AudioTrackFormatId>(node, "audioTrackFormatIDRef", audioTrackUid, references.trackUidTrackFormatRef, &parseAudioTrackFormatId);
+      setOptionalReference<AudioPackFormatId>(node, "audioPackFormatIDRef", audioTrackUid, references.trackUidPackFormatRef, &parseAudioPackFormatId);
       // clang-format on
       return audioTrackUid;
     }
 
+    /// parse an audioBlockFormat of the same type as audioChannelFormat and
+    /// add it
+    namespace {
+      /// parse node as an audioBlockFormat of the type of
+      /// audioChannelFormat, and pass it to add
+      template <typename Add>
+      void parseAudioBlockFormat(const AudioChannelFormat& audioChannelFormat,
+                                 NodePtr node, Add add) {
+        auto type = audioChannelFormat.get<TypeDescriptor>();
+        if (type == TypeDefinition::DIRECT_SPEAKERS) {
+          add(parseAudioBlockFormatDirectSpeakers(node));
+        } else if (type == TypeDefinition::MATRIX) {
+          add(parseAudioBlockFormatMatrix(node));
+        } else if (type == TypeDefinition::OBJECTS) {
+          add(parseAudioBlockFormatObjects(node));
+        } else if (type == TypeDefinition::HOA) {
+          add(parseAudioBlockFormatHoa(node));
+        } else if (type == TypeDefinition::BINAURAL) {
+          add(parseAudioBlockFormatBinaural(node));
+        }
+      }
+    }  // namespace
+
+    void addAudioBlockFormat(AudioChannelFormat& audioChannelFormat,
+                             NodePtr node) {
+      parseAudioBlockFormat(audioChannelFormat, node, [&](auto blockFormat) {
+        audioChannelFormat.add(std::move(blockFormat));
+      });
+    }
+
+    void XmlParser::addAudioBlockFormatAfterGap(
+        AudioChannelFormat& audioChannelFormat, NodePtr node) {
+      parseAudioBlockFormat(audioChannelFormat, node, [&](auto blockFormat) {
+        AudioChannelFormatAttorney::addAfterGap(audioChannelFormat,
+                                                std::move(blockFormat));
+      });
+    }
+
+    /*
+     * The audioBlockFormat parsers below find all the attributes and elements
+     * they need in a single pass with a ChildTable, then convert them in a
+     * fixed order, so that the first error reported does not depend on the
+     * order in the document.
+     */
+    namespace {
+      struct DirectSpeakersChildren {
+        AttributePtr audioBlockFormatId;
+        AttributePtr rtime;
+        AttributePtr duration;
+        std::vector<NodePtr> position;
+        std::vector<NodePtr> speakerLabel;
+        NodePtr headLocked;
+        NodePtr headphoneVirtualise;
+        NodePtr gain;
+        NodePtr importance;
+      };
+
+      struct ObjectsChildren {
+        AttributePtr audioBlockFormatId;
+        AttributePtr rtime;
+        AttributePtr duration;
+        NodePtr cartesian;
+        std::vector<NodePtr> position;
+        NodePtr width;
+        NodePtr height;
+        NodePtr depth;
+        NodePtr gain;
+        NodePtr diffuse;
+        NodePtr channelLock;
+        NodePtr objectDivergence;
+        NodePtr jumpPosition;
+        NodePtr screenRef;
+        NodePtr importance;
+        NodePtr headLocked;
+        NodePtr headphoneVirtualise;
+      };
+
+      struct HoaChildren {
+        AttributePtr audioBlockFormatId;
+        AttributePtr rtime;
+        AttributePtr duration;
+        NodePtr order;
+        NodePtr degree;
+        NodePtr nfcRefDist;
+        NodePtr screenRef;
+        NodePtr normalization;
+        NodePtr equation;
+        NodePtr headLocked;
+        NodePtr headphoneVirtualise;
+        NodePtr gain;
+        NodePtr importance;
+      };
+
+      struct BinauralChildren {
+        AttributePtr audioBlockFormatId;
+        AttributePtr rtime;
+        AttributePtr duration;
+        NodePtr gain;
+        NodePtr importance;
+      };
+
+      struct MatrixChildren {
+        AttributePtr audioBlockFormatId;
+        AttributePtr rtime;
+        AttributePtr duration;
+        NodePtr outputChannelFormatIdRef;
+        NodePtr matrix;
+        NodePtr gain;
+        NodePtr importance;
+      };
+
+      struct CoefficientChildren {
+        AttributePtr gain;
+        AttributePtr gainUnit;
+        AttributePtr phase;
+        AttributePtr delay;
+      };
+    }  // namespace
+
+    namespace {
+      /// throw if a new audioBlockFormat with the given ID can not be added
+      /// to audioChannelFormat as the block with the expected counter
+      void checkAppendedBlockId(const AudioChannelFormat& audioChannelFormat,
+                                const AudioBlockFormatId& id,
+                                unsigned expectedCounter, NodePtr node) {
+        auto channelId = audioChannelFormat.get<AudioChannelFormatId>();
+        if (id.get<TypeDescriptor>() !=
+                audioChannelFormat.get<TypeDescriptor>() ||
+            id.get<AudioBlockFormatIdValue>().get() !=
+                channelId.get<AudioChannelFormatIdValue>().get() ||
+            id.get<AudioBlockFormatIdCounter>().get() != expectedCounter) {
+          throw error::XmlParsingError(
+              "audioBlockFormat " + formatId(id) +
+                  " does not follow on from the audioBlockFormats of " +
+                  formatId(channelId),
+              getDocumentLine(node));
+        }
+      }
+
+      template <typename Block, typename Parse>
+      std::function<void()> prepareBlocks(
+          AudioChannelFormat& audioChannelFormat, NodePtr node, Parse parse) {
+        auto existing = audioChannelFormat.getElements<Block>();
+        unsigned lastCounter = 0;
+        if (!existing.empty()) {
+          lastCounter = existing.back()
+                            .template get<AudioBlockFormatId>()
+                            .template get<AudioBlockFormatIdCounter>()
+                            .get();
+        }
+        auto blocks = std::make_shared<std::vector<Block>>();
+        for (NodePtr element = node->first_node("audioBlockFormat"); element;
+             element = element->next_sibling("audioBlockFormat")) {
+          auto block = parse(element);
+          auto id = block.template get<AudioBlockFormatId>();
+          if (!isUndefined(id)) {
+            if (id.template get<AudioBlockFormatIdCounter>().get() <=
+                lastCounter) {
+              continue;
+            }
+            checkAppendedBlockId(
+                audioChannelFormat, id,
+                lastCounter + static_cast<unsigned>(blocks->size()) + 1,
+                element);
+          }
+          blocks->push_back(std::move(block));
+        }
+        return [&audioChannelFormat, blocks]() {
+          for (auto& block : *blocks) {
+            audioChannelFormat.add(std::move(block));
+          }
+        };
+      }
+    }  // namespace
+
+    std::function<void()> prepareAudioBlockFormats(
+        AudioChannelFormat& audioChannelFormat, NodePtr node) {
+      auto type = audioChannelFormat.get<TypeDescriptor>();
+      if (type == TypeDefinition::DIRECT_SPEAKERS) {
+        return prepareBlocks<AudioBlockFormatDirectSpeakers>(
+            audioChannelFormat, node, &parseAudioBlockFormatDirectSpeakers);
+      } else if (type == TypeDefinition::OBJECTS) {
+        return prepareBlocks<AudioBlockFormatObjects>(
+            audioChannelFormat, node, &parseAudioBlockFormatObjects);
+      } else if (type == TypeDefinition::HOA) {
+        return prepareBlocks<AudioBlockFormatHoa>(audioChannelFormat, node,
+                                                  &parseAudioBlockFormatHoa);
+      } else if (type == TypeDefinition::BINAURAL) {
+        return prepareBlocks<AudioBlockFormatBinaural>(
+            audioChannelFormat, node, &parseAudioBlockFormatBinaural);
+      } else if (type == TypeDefinition::MATRIX) {
+        return prepareBlocks<AudioBlockFormatMatrix>(
+            audioChannelFormat, node, &parseAudioBlockFormatMatrix);
+      }
+      return []() {};
+    }
+
+    void appendAudioBlockFormats(AudioChannelFormat& audioChannelFormat,
+                                 NodePtr node) {
+      prepareAudioBlockFormats(audioChannelFormat, node)();
+    }
+
     AudioBlockFormatDirectSpeakers parseAudioBlockFormatDirectSpeakers(
         NodePtr node) {
-      AudioBlockFormatDirectSpeakers audioBlockFormat;
+      using C = DirectSpeakersChildren;
       // clang-format off
-      setOptionalAttribute<AudioBlockFormatId>(node, "audioBlockFormatID", audioBlockFormat, &parseAudioBlockFormatId);
-      setOptionalAttribute<Rtime>(node, "rtime", audioBlockFormat, &parseTimecode);
-      setOptionalAttribute<Duration>(node, "duration", audioBlockFormat, &parseTimecode);
-      setMultiElement<SpeakerPosition>(node, "position", audioBlockFormat, &parseSpeakerPosition);
-      addOptionalElements<SpeakerLabel>(node, "speakerLabel", audioBlockFormat, &parseSpeakerLabel);
-      setOptionalElement<HeadLocked>(node, "headLocked", audioBlockFormat);
-      setOptionalElement<HeadphoneVirtualise>(node, "headphoneVirtualise", audioBlockFormat, &parseHeadphoneVirtualise);
+      static const ChildTable<C> table{
+          {{"audioBlockFormatID", &C::audioBlockFormatId},
+           {"rtime", &C::rtime},
+           {"duration", &C::duration}},
+          {{"position", nullptr, &C::position},
+           {"speakerLabel", nullptr, &C::speakerLabel},
+           {"headLocked", &C::headLocked},
+           {"headphoneVirtualise", &C::headphoneVirtualise},
+           {"gain", &C::gain},
+           {"importance", &C::importance}}};
+      C children{};
+      table.find(node, children);
+
+      AudioBlockFormatDirectSpeakers audioBlockFormat;
+      setFromAttribute<AudioBlockFormatId>(children.audioBlockFormatId, audioBlockFormat, &parseAudioBlockFormatId);
+      setFromAttribute<Rtime>(children.rtime, audioBlockFormat, &parseTimecode);
+      setFromAttribute<Duration>(children.duration, audioBlockFormat, &parseTimecode);
+      setFromMultiElement<SpeakerPosition>(node, "position", children.position, audioBlockFormat, &parseSpeakerPosition);
+      addFromElements<SpeakerLabel>(children.speakerLabel, audioBlockFormat, &parseSpeakerLabel);
+      setFromElement<HeadLocked>(children.headLocked, audioBlockFormat);
+      setFromElement<HeadphoneVirtualise>(children.headphoneVirtualise, audioBlockFormat, &parseHeadphoneVirtualise);
+      setFromElement<Gain>(children.gain, audioBlockFormat, &parseGain);
+      setFromElement<Importance>(children.importance, audioBlockFormat);
       // clang-format on
-      setOptionalElement<Gain>(node, "gain", audioBlockFormat, &parseGain);
-      setOptionalElement<Importance>(node, "importance", audioBlockFormat);
       return audioBlockFormat;
     }
 
@@ -616,41 +2277,65 @@ namespace adm {
     }
 
     AudioBlockFormatObjects parseAudioBlockFormatObjects(NodePtr node) {
-      AudioBlockFormatObjects audioBlockFormat{SphericalPosition()};
+      using C = ObjectsChildren;
       // clang-format off
-      setOptionalAttribute<AudioBlockFormatId>(node, "audioBlockFormatID", audioBlockFormat, &parseAudioBlockFormatId);
-      setOptionalAttribute<Rtime>(node, "rtime", audioBlockFormat, &parseTimecode);
-      setOptionalAttribute<Duration>(node, "duration", audioBlockFormat, &parseTimecode);
+      static const ChildTable<C> table{
+          {{"audioBlockFormatID", &C::audioBlockFormatId},
+           {"rtime", &C::rtime},
+           {"duration", &C::duration}},
+          {{"cartesian", &C::cartesian},
+           {"position", nullptr, &C::position},
+           {"width", &C::width},
+           {"height", &C::height},
+           {"depth", &C::depth},
+           {"gain", &C::gain},
+           {"diffuse", &C::diffuse},
+           {"channelLock", &C::channelLock},
+           {"objectDivergence", &C::objectDivergence},
+           {"jumpPosition", &C::jumpPosition},
+           {"screenRef", &C::screenRef},
+           {"importance", &C::importance},
+           {"headLocked", &C::headLocked},
+           {"headphoneVirtualise", &C::headphoneVirtualise}}};
+      C children{};
+      children.position.reserve(3);
+      table.find(node, children);
+
+      AudioBlockFormatObjects audioBlockFormat{SphericalPosition()};
+      setFromAttribute<AudioBlockFormatId>(children.audioBlockFormatId, audioBlockFormat, &parseAudioBlockFormatId);
+      setFromAttribute<Rtime>(children.rtime, audioBlockFormat, &parseTimecode);
+      setFromAttribute<Duration>(children.duration, audioBlockFormat, &parseTimecode);
 
-      setOptionalElement<Cartesian>(node, "cartesian", audioBlockFormat);
-      auto cartesianGuess = guessCartesianFlag(node, "position");
+      setFromElement<Cartesian>(children.cartesian, audioBlockFormat);
+      auto cartesianGuess = guessCartesianFlag(children.position.empty() ? nullptr : children.position.front());
       if(audioBlockFormat.get<Cartesian>() != cartesianGuess) {
         audioBlockFormat.set(cartesianGuess);
       }
       if(audioBlockFormat.get<Cartesian>() == false) {
-        setMultiElement<SphericalPosition>(node, "position", audioBlockFormat, &parseSphericalPosition);
+        setFromMultiElement<SphericalPosition>(node, "position", children.position, audioBlockFormat, &parseSphericalPosition);
       } else {
-        setMultiElement<CartesianPosition>(node, "position", audioBlockFormat, &parseCartesianPosition);
-      }
-      setOptionalElement<Width>(node, "width", audioBlockFormat);
-      setOptionalElement<Height>(node, "height", audioBlockFormat);
-      setOptionalElement<Depth>(node, "depth", audioBlockFormat);
-      setOptionalElement<Gain>(node, "gain", audioBlockFormat, &parseGain);
-      setOptionalElement<Diffuse>(node, "diffuse", audioBlockFormat);
-      setOptionalElement<ChannelLock>(node, "channelLock", audioBlockFormat, &parseChannelLock);
-      setOptionalElement<ObjectDivergence>(node, "objectDivergence", audioBlockFormat, &parseObjectDivergence);
-      setOptionalElement<JumpPosition>(node, "jumpPosition", audioBlockFormat, &parseJumpPosition);
-      setOptionalElement<ScreenRef>(node, "screenRef", audioBlockFormat);
-      setOptionalElement<Importance>(node, "importance", audioBlockFormat);
-      setOptionalElement<HeadLocked>(node, "headLocked", audioBlockFormat);
-      setOptionalElement<HeadphoneVirtualise>(node, "headphoneVirtualise", audioBlockFormat, &parseHeadphoneVirtualise);
+        setFromMultiElement<CartesianPosition>(node, "position", children.position, audioBlockFormat, &parseCartesianPosition);
+      }
+      setFromElement<Width>(children.width, audioBlockFormat);
+      setFromElement<Height>(children.height, audioBlockFormat);
+      setFromElement<Depth>(children.depth, audioBlockFormat);
+      setFromElement<Gain>(children.gain, audioBlockFormat, &parseGain);
+      setFromElement<Diffuse>(children.diffuse, audioBlockFormat);
+      setFromElement<ChannelLock>(children.channelLock, audioBlockFormat, &parseChannelLock);
+      setFromElement<ObjectDivergence>(children.objectDivergence, audioBlockFormat, &parseObjectDivergence);
+      setFromElement<JumpPosition>(children.jumpPosition, audioBlockFormat, &parseJumpPosition);
+      setFromElement<ScreenRef>(children.screenRef, audioBlockFormat);
+      setFromElement<Importance>(children.importance, audioBlockFormat);
+      setFromElement<HeadLocked>(children.headLocked, audioBlockFormat);
+      setFromElement<HeadphoneVirtualise>(children.headphoneVirtualise, audioBlockFormat, &parseHeadphoneVirtualise);
       // clang-format on
       return audioBlockFormat;
     }
 
     Gain parseGain(NodePtr node) {
       auto unitAttr = node->first_attribute("gainUnit");
-      double value = std::stod(node->value());
+      double value = detail::parseDouble(
+          node->value(), node->value() + node->value_size());
       if (unitAttr) {
         std::string unitAttrStr{unitAttr->value()};
         if (unitAttrStr == "linear")
@@ -702,9 +2387,12 @@ namespace adm {
     }
 
     Cartesian guessCartesianFlag(NodePtr node, const char* elementName) {
-      auto element = detail::findElement(node, elementName);
-      if (element) {
-        auto coordinate = element->first_attribute("coordinate");
+      return guessCartesianFlag(detail::findElement(node, elementName));
+    }
+
+    Cartesian guessCartesianFlag(NodePtr position) {
+      if (position) {
+        auto coordinate = position->first_attribute("coordinate");
         if (coordinate) {
           auto coordinateStr = std::string(coordinate->value());
           if (coordinateStr == "X" || coordinateStr == "Y" ||
@@ -826,7 +2514,8 @@ namespace adm {
     }
 
     DialogueId parseDialogueId(NodePtr node) {
-      return DialogueId(std::stoi(node->value()));
+      return DialogueId(detail::parseInt(
+          node->value(), node->value() + node->value_size()));
     }
 
     ContentKind parseContentKind(NodePtr node) {
@@ -852,36 +2541,142 @@ namespace adm {
     }
 
     AudioBlockFormatHoa parseAudioBlockFormatHoa(NodePtr node) {
-      AudioBlockFormatHoa audioBlockFormat{Order(), Degree()};
+      using C = HoaChildren;
       // clang-format off
-      setOptionalAttribute<AudioBlockFormatId>(node, "audioBlockFormatID", audioBlockFormat, &parseAudioBlockFormatId);
-      setOptionalAttribute<Rtime>(node, "rtime", audioBlockFormat, &parseTimecode);
-      setOptionalAttribute<Duration>(node, "duration", audioBlockFormat, &parseTimecode);
-      setOptionalElement<Order>(node, "order", audioBlockFormat);
-      setOptionalElement<Degree>(node, "degree", audioBlockFormat);
-      setOptionalElement<NfcRefDist>(node, "nfcRefDist", audioBlockFormat);
-      setOptionalElement<ScreenRef>(node, "screenRef", audioBlockFormat);
-      setOptionalElement<Normalization>(node, "normalization", audioBlockFormat);
-      setOptionalElement<Equation>(node, "equation", audioBlockFormat);
-      setOptionalElement<HeadLocked>(node, "headLocked", audioBlockFormat);
-      setOptionalElement<HeadphoneVirtualise>(node, "headphoneVirtualise", audioBlockFormat, &parseHeadphoneVirtualise);
-      setOptionalElement<Gain>(node, "gain", audioBlockFormat, &parseGain);
-      setOptionalElement<Importance>(node, "importance", audioBlockFormat);
+      static const ChildTable<C> table{
+          {{"audioBlockFormatID", &C::audioBlockFormatId},
+           {"rtime", &C::rtime},
+           {"duration", &C::duration}},
+          {{"order", &C::order},
+           {"degree", &C::degree},
+           {"nfcRefDist", &C::nfcRefDist},
+           {"screenRef", &C::screenRef},
+           {"normalization", &C::normalization},
+           {"equation", &C::equation},
+           {"headLocked", &C::headLocked},
+           {"headphoneVirtualise", &C::headphoneVirtualise},
+           {"gain", &C::gain},
+           {"importance", &C::importance}}};
+      C children{};
+      table.find(node, children);
+
+      AudioBlockFormatHoa audioBlockFormat{Order(), Degree()};
+      setFromAttribute<AudioBlockFormatId>(children.audioBlockFormatId, audioBlockFormat, &parseAudioBlockFormatId);
+      setFromAttribute<Rtime>(children.rtime, audioBlockFormat, &parseTimecode);
+      setFromAttribute<Duration>(children.duration, audioBlockFormat, &parseTimecode);
+      setFromElement<Order>(children.order, audioBlockFormat);
+      setFromElement<Degree>(children.degree, audioBlockFormat);
+      setFromElement<NfcRefDist>(children.nfcRefDist, audioBlockFormat);
+      setFromElement<ScreenRef>(children.screenRef, audioBlockFormat);
+      setFromElement<Normalization>(children.normalization, audioBlockFormat);
+      setFromElement<Equation>(children.equation, audioBlockFormat);
+      setFromElement<HeadLocked>(children.headLocked, audioBlockFormat);
+      setFromElement<HeadphoneVirtualise>(children.headphoneVirtualise, audioBlockFormat, &parseHeadphoneVirtualise);
+      setFromElement<Gain>(children.gain, audioBlockFormat, &parseGain);
+      setFromElement<Importance>(children.importance, audioBlockFormat);
       // clang-format on
       return audioBlockFormat;
     }
 
     AudioBlockFormatBinaural parseAudioBlockFormatBinaural(NodePtr node) {
-      AudioBlockFormatBinaural audioBlockFormat;
+      using C = BinauralChildren;
+      // clang-format off
+      static const ChildTable<C> table{
+          {{"audioBlockFormatID", &C::audioBlockFormatId},
+           {"rtime", &C::rtime},
+           {"duration", &C::duration}},
+          {{"gain", &C::gain},
+           {"importance", &C::importance}}};
+      // clang-format on
+      C children{};
+      table.find(node, children);
 
-      setOptionalAttribute<Rtime>(node, "rtime", audioBlockFormat,
-                                  &parseTimecode);
-      setOptionalAttribute<Duration>(node, "duration", audioBlockFormat,
-                                     &parseTimecode);
-      setOptionalElement<Gain>(node, "gain", audioBlockFormat, &parseGain);
-      setOptionalElement<Importance>(node, "importance", audioBlockFormat);
+      AudioBlockFormatBinaural audioBlockFormat;
+      setFromAttribute<AudioBlockFormatId>(children.audioBlockFormatId,
+                                           audioBlockFormat,
+                                           &parseAudioBlockFormatId);
+      setFromAttribute<Rtime>(children.rtime, audioBlockFormat,
+                              &parseTimecode);
+      setFromAttribute<Duration>(children.duration, audioBlockFormat,
+                                 &parseTimecode);
+      setFromElement<Gain>(children.gain, audioBlockFormat, &parseGain);
+      setFromElement<Importance>(children.importance, audioBlockFormat);
+      return audioBlockFormat;
+    }
 
+    AudioBlockFormatMatrix parseAudioBlockFormatMatrix(NodePtr node) {
+      using C = MatrixChildren;
+      // clang-format off
+      static const ChildTable<C> table{
+          {{"audioBlockFormatID", &C::audioBlockFormatId},
+           {"rtime", &C::rtime},
+           {"duration", &C::duration}},
+          {{"outputChannelFormatIDRef", &C::outputChannelFormatIdRef},
+           {"matrix", &C::matrix},
+           {"gain", &C::gain},
+           {"importance", &C::importance}}};
+      C children{};
+      table.find(node, children);
+
+      AudioBlockFormatMatrix audioBlockFormat;
+      setFromAttribute<AudioBlockFormatId>(children.audioBlockFormatId, audioBlockFormat, &parseAudioBlockFormatId);
+      setFromAttribute<Rtime>(children.rtime, audioBlockFormat, &parseTimecode);
+      setFromAttribute<Duration>(children.duration, audioBlockFormat, &parseTimecode);
+      if (children.outputChannelFormatIdRef) {
+        audioBlockFormat.set(OutputChannelFormatId(parseAudioChannelFormatId(children.outputChannelFormatIdRef->value())));
+      }
+      setFromElement<MatrixCoefficients>(children.matrix, audioBlockFormat, &parseMatrixCoefficients);
+      setFromElement<Gain>(children.gain, audioBlockFormat, &parseGain);
+      setFromElement<Importance>(children.importance, audioBlockFormat);
+      // clang-format on
       return audioBlockFormat;
     }
+
+    MatrixCoefficients parseMatrixCoefficients(NodePtr node) {
+      using C = CoefficientChildren;
+      static const ChildTable<C> table{{{"gain", &C::gain},
+                                        {"gainUnit", &C::gainUnit},
+                                        {"phase", &C::phase},
+                                        {"delay", &C::delay}},
+                                       {}};
+
+      std::size_t count = 0;
+      for (NodePtr element = node->first_node("coefficient"); element;
+           element = element->next_sibling("coefficient")) {
+        ++count;
+      }
+
+      // built in one go rather than with add(), which checks each
+      // coefficient against those already added
+      MatrixCoefficients coefficients;
+      coefficients.reserve(count);
+      for (NodePtr element = node->first_node("coefficient"); element;
+           element = element->next_sibling("coefficient")) {
+        C children{};
+        table.find(element, children);
+
+        MatrixCoefficient coefficient(
+            parseAudioChannelFormatId(element->value()));
+        if (children.gain) {
+          double value = detail::parseDouble(
+              children.gain->value(),
+              children.gain->value() + children.gain->value_size());
+          std::string unit = children.gainUnit ? children.gainUnit->value()
+                                                : std::string("linear");
+          if (unit == "linear") {
+            coefficient.set(Gain::fromLinear(value));
+          } else if (unit == "dB") {
+            coefficient.set(Gain::fromDb(value));
+          } else {
+            throw error::XmlParsingUnexpectedAttrError(
+                "gainUnit", unit, getDocumentLine(children.gainUnit));
+          }
+        }
+        setFromAttribute<Phase>(children.phase, coefficient);
+        setFromAttribute<Delay>(children.delay, coefficient);
+        coefficients.push_back(coefficient);
+      }
+      return coefficients;
+    }
   }  // namespace xml
 }  // namespace adm
@@ -0,0 +1,185 @@
+#include "adm/private/xml_stream_reader.hpp"
+#include <cstring>
+#include <istream>
+#include "adm/errors.hpp"
+
+namespace adm {
+  namespace xml {
+
+    namespace {
+      const std::size_t CHUNK_SIZE = 64 * 1024;
+
+      bool isNameChar(int c) {
+        return c != EOF && !std::strchr(" \t\r\n/>", c);
+      }
+    }  // namespace
+
+    XmlStreamReader::XmlStreamReader(std::istream& stream)
+        : stream_(stream), buffer_(CHUNK_SIZE) {}
+
+    bool XmlStreamReader::fill() {
+      if (position_ < size_) {
+        return true;
+      }
+      // read from the streambuf directly, so that reaching the end only sets
+      // eofbit (as when reading the whole stream), and the stream can be
+      // rewound and read again
+      size_ = static_cast<std::size_t>(stream_.rdbuf()->sgetn(
+          buffer_.data(), static_cast<std::streamsize>(CHUNK_SIZE)));
+      position_ = 0;
+      read_ += size_;
+      if (size_ == 0) {
+        stream_.setstate(std::ios::eofbit);
+      }
+      return size_ != 0;
+    }
+
+    int XmlStreamReader::peek() {
+      if (!fill()) {
+        return EOF;
+      }
+      return static_cast<unsigned char>(buffer_[position_]);
+    }
+
+    int XmlStreamReader::get() {
+      if (!fill()) {
+        throw error::XmlParsingError("unexpected end of XML document");
+      }
+      char c = buffer_[position_++];
+      if (c == '\n') {
+        ++lines_;
+      }
+      text_.push_back(c);
+      return static_cast<unsigned char>(c);
+    }
+
+    bool XmlStreamReader::next(bool keepText) {
+      text_.clear();
+      name_.clear();
+      line_ = lines_;
+
+      int c = peek();
+      if (c == EOF) {
+        return false;
+      }
+
+      if (c != '<') {
+        type_ = TokenType::text;
+        while (fill()) {
+          const char* begin = buffer_.data() + position_;
+          std::size_t available = size_ - position_;
+          auto end = static_cast<const char*>(std::memchr(begin, '<', available));
+          std::size_t length = end ? end - begin : available;
+          lines_ += countLines(begin, begin + length);
+          if (keepText) {
+            text_.append(begin, length);
+          }
+          position_ += length;
+          if (end) {
+            break;
+          }
+        }
+        return true;
+      }
+
+      get();
+      c = peek();
+      if (c == '/') {
+        type_ = TokenType::end_tag;
+        get();
+        readTag();
+      } else if (c == '?') {
+        type_ = TokenType::other;
+        readUntil("?>");
+      } else if (c == '!') {
+        type_ = TokenType::other;
+        get();
+        if (peek() == '-') {
+          readUntil("--");
+          readUntil("-->");
+        } else if (peek() == '[') {
+          readUntil("]]>");
+        } else {
+          readDoctype();
+        }
+      } else {
+        readTag();
+        type_ = text_[text_.size() - 2] == '/' ? TokenType::empty_element_tag
+                                               : TokenType::start_tag;
+      }
+      return true;
+    }
+
+    void XmlStreamReader::readTag() {
+      while (isNameChar(peek())) {
+        name_.push_back(static_cast<char>(get()));
+      }
+      if (name_.empty()) {
+        throw error::XmlParsingError("expected element name");
+      }
+      char quote = 0;
+      int c;
+      do {
+        c = get();
+        if (quote) {
+          if (c == quote) {
+            quote = 0;
+          }
+        } else if (c == '"' || c == '\'') {
+          quote = static_cast<char>(c);
+        }
+      } while (quote || c != '>');
+    }
+
+    void XmlStreamReader::readUntil(const char* terminator) {
+      std::size_t length = std::strlen(terminator);
+      do {
+        get();
+      } while (text_.size() < length ||
+               text_.compare(text_.size() - length, length, terminator) != 0);
+    }
+
+    void XmlStreamReader::readDoctype() {
+      int depth = 0;
+      char quote = 0;
+      int c;
+      do {
+        c = get();
+        if (quote) {
+          if (c == quote) {
+            quote = 0;
+          }
+        } else if (c == '"' || c == '\'') {
+          quote = static_cast<char>(c);
+        } else if (c == '[') {
+          ++depth;
+        } else if (c == ']') {
+          --depth;
+        }
+      } while (quote || depth > 0 || c != '>');
+    }
+
+    XmlFragment::XmlFragment() : lineOffset_(&document_) {}
+
+    rapidxml::xml_node<>* XmlFragment::parse(int line) {
+      // clearing releases the memory used by the previous parse, so that
+      // fragments can be reused without growing
+      document_.clear();
+      text_.push_back('\0');
+      document_.parse<0>(&text_[0]);
+      lineOffset_.set(line);
+      auto node = document_.first_node();
+      if (!node) {
+        throw error::XmlParsingError("xml document is empty");
+      }
+      return node;
+    }
+
+    rapidxml::xml_node<>* XmlFragment::parse(std::function<int()> findLine) {
+      auto node = parse(0);
+      lineOffset_.setDeferred(std::move(findLine));
+      return node;
+    }
+
+  }  // namespace xml
+}  // namespace adm
@@ -0,0 +1,182 @@
+#include "adm/private/xml_stream_writer.hpp"
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+namespace adm {
+  namespace xml {
+
+    namespace {
+      /// size of the output buffer; it is written to the stream once it is
+      /// this full
+      const std::size_t bufferSize = 64 * 1024;
+
+      /// the size of a string up to the first null character, which is where
+      /// rapidxml::memory_pool::allocate_string() stops copying
+      std::size_t stringSize(const std::string& string) {
+        return std::strlen(string.c_str());
+      }
+    }  // namespace
+
+    XmlStreamWriter::XmlStreamWriter(std::ostream& stream) : stream_(stream) {
+      buffer_.reserve(bufferSize + 1024);
+    }
+
+    void XmlStreamWriter::declaration() {
+      buffer_ += "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+    }
+
+    XmlStreamWriter::Handle XmlStreamWriter::startElement(
+        std::size_t depth, const std::string& name) {
+      if (depth > openCount_) {
+        throw std::logic_error("XML element started below a closed element");
+      }
+      closeTo(depth);
+      if (depth > 0) {
+        auto& parent = open_[depth - 1];
+        if (!parent.hasChildren) {
+          buffer_ += ">\n";
+          parent.hasChildren = true;
+        }
+      }
+      flushIfFull();
+
+      if (open_.size() == openCount_) {
+        open_.emplace_back();
+      }
+      // entries are reused, so that their strings keep their memory
+      auto& element = open_[openCount_++];
+      element.name.assign(name.c_str(), stringSize(name));
+      element.handle = nextHandle_++;
+      element.hasChildren = false;
+      element.value.clear();
+
+      indent(depth);
+      buffer_ += '<';
+      buffer_ += element.name;
+      return element.handle;
+    }
+
+    void XmlStreamWriter::addAttribute(std::size_t depth, Handle handle,
+                                       const std::string& name,
+                                       const std::string& value) {
+      if (element(depth, handle).hasChildren) {
+        throw std::logic_error(
+            "XML attribute added after the children of its element");
+      }
+      buffer_ += ' ';
+      buffer_.append(name.c_str(), stringSize(name));
+      buffer_ += '=';
+      // as rapidxml, use single quotes if the value contains double quotes
+      if (std::strchr(value.c_str(), '"')) {
+        buffer_ += '\'';
+        appendEscaped(value, '"');
+        buffer_ += '\'';
+      } else {
+        buffer_ += '"';
+        appendEscaped(value, '\'');
+        buffer_ += '"';
+      }
+    }
+
+    void XmlStreamWriter::setValue(std::size_t depth, Handle handle,
+                                   const std::string& value) {
+      element(depth, handle).value.assign(value.c_str(), stringSize(value));
+    }
+
+    void XmlStreamWriter::finish() {
+      closeTo(0);
+      // rapidxml ends the document node with a line break too
+      buffer_ += '\n';
+      stream_.write(buffer_.data(),
+                    static_cast<std::streamsize>(buffer_.size()));
+      buffer_.clear();
+    }
+
+    void XmlStreamWriter::closeTo(std::size_t depth) {
+      while (openCount_ > depth) {
+        close();
+      }
+    }
+
+    void XmlStreamWriter::close() {
+      auto& element = open_[--openCount_];
+      if (element.hasChildren) {
+        indent(openCount_);
+        buffer_ += "</";
+        buffer_ += element.name;
+        buffer_ += ">\n";
+      } else if (element.value.empty()) {
+        buffer_ += "/>\n";
+      } else {
+        buffer_ += '>';
+        appendEscaped(element.value, '\0');
+        buffer_ += "</";
+        buffer_ += element.name;
+        buffer_ += ">\n";
+      }
+      flushIfFull();
+    }
+
+    XmlStreamWriter::OpenElement& XmlStreamWriter::element(std::size_t depth,
+                                                           Handle handle) {
+      if (depth < openCount_) {
+        closeTo(depth + 1);
+      }
+      if (depth + 1 != openCount_ || open_[depth].handle != handle) {
+        throw std::logic_error("XML element changed after it was closed");
+      }
+      return open_[depth];
+    }
+
+    void XmlStreamWriter::indent(std::size_t depth) {
+      buffer_.append(depth, '\t');
+    }
+
+    void XmlStreamWriter::appendEscaped(const std::string& text,
+                                        char noExpand) {
+      const char* position = text.c_str();
+      const char* end = position + stringSize(text);
+      while (position != end) {
+        // copy runs of characters which do not need escaping in one go
+        const char* run = position;
+        while (run != end && ((*run != '<' && *run != '>' && *run != '&' &&
+                               *run != '"' && *run != '\'') ||
+                              *run == noExpand)) {
+          ++run;
+        }
+        buffer_.append(position, run);
+        if (run == end) {
+          break;
+        }
+        switch (*run) {
+          case '<':
+            buffer_ += "&lt;";
+            break;
+          case '>':
+            buffer_ += "&gt;";
+            break;
+          case '&':
+            buffer_ += "&amp;";
+            break;
+          case '"':
+            buffer_ += "&quot;";
+            break;
+          default:
+            buffer_ += "&apos;";
+            break;
+        }
+        position = run + 1;
+      }
+    }
+
+    void XmlStreamWriter::flushIfFull() {
+      if (buffer_.size() >= bufferSize) {
+        stream_.write(buffer_.data(),
+                      static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+      }
+    }
+
+  }  // namespace xml
+}  // namespace adm
@@ -2,9 +2,6 @@
 #include "adm/elements.hpp"
 #include "adm/document.hpp"
 #include "adm/private/rapidxml_formatter.hpp"
-#include "rapidxml/rapidxml.hpp"
-#include "rapidxml/rapidxml_print.hpp"
-#include "rapidxml/rapidxml_utils.hpp"
 #include "adm/private/rapidxml_wrapper.hpp"
 
 namespace adm {
@@ -21,13 +18,11 @@ namespace adm {
       return static_cast<bool>(options & flag);
     }
 
-    using NodePtr = rapidxml::xml_node<>*;
-
     XmlWriter::XmlWriter(WriterOptions options) : options_(options) {}
 
     std::ostream& XmlWriter::write(std::shared_ptr<const Document> document,
                                    std::ostream& stream) {
-      XmlDocument xmlDocument;
+      XmlDocument xmlDocument(stream);
       xmlDocument.setDiscardDefaults(
           !isSet(options_, WriterOptions::write_default_values));
       xmlDocument.addDeclaration();
@@ -47,7 +42,8 @@ namespace adm {
       root.addBaseElements<AudioTrackFormat, AudioTrackFormatId>(document, "audioTrackFormat", &formatAudioTrackFormat);
       root.addBaseElements<AudioTrackUid, AudioTrackUidId>(document, "audioTrackUID", &formatAudioTrackUid);
       // clang-format on
-      return stream << xmlDocument;
+      xmlDocument.finish();
+      return stream;
     }
 
   }  // namespace xml
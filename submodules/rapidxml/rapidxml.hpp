@@ -13,6 +13,28 @@
     #include <new>          // For placement new
 #endif
 
+// Text is scanned 16 (SSE2) or 32 (AVX2) characters at a time when compiling for x86, 
+// choosing the instruction set when the program starts, see set_simd_level().
+// Define RAPIDXML_NO_SIMD to always scan one character at a time.
+#if !defined(RAPIDXML_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define RAPIDXML_SSE2
+    #include <cstdint>      // For std::uintptr_t
+    #include <emmintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h> // For _BitScanForward
+    #endif
+    #if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        #define RAPIDXML_AVX2
+        #include <immintrin.h>
+    #endif
+    // Aligned loads may read past the terminating zero, but never into the next page
+    #if defined(__clang__) || defined(__GNUC__)
+        #define RAPIDXML_NO_SANITIZE __attribute__((no_sanitize_address))
+    #else
+        #define RAPIDXML_NO_SANITIZE
+    #endif
+#endif
+
 // On MSVC, disable "conditional expression is constant" warning (level 4). 
 // This warning is almost impossible to avoid with certain types of templated code
 #ifdef _MSC_VER
@@ -335,9 +357,178 @@ namespace rapidxml
             }
             return true;
         }
+
+        // Instruction set used to scan text, as a simd_level
+        // It must be a template to allow correct linking (because it has static data members, which are defined in a header file).
+        // Before it is initialised it is zero, so text is scanned one character at a time.
+        template<int Dummy>
+        struct simd_state
+        {
+            static int level;
+            static int detect();
+        };
+
+        template<int Dummy>
+        int simd_state<Dummy>::level = simd_state<Dummy>::detect();
+
+        template<int Dummy>
+        int simd_state<Dummy>::detect()
+        {
+#if defined(RAPIDXML_AVX2)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return 2;
+#endif
+#if defined(RAPIDXML_SSE2)
+            return 1;
+#else
+            return 0;
+#endif
+        }
+
+        // Find the first of chars from text, which must include the terminating zero, as blocks are
+        // read up to the one containing it. Blocks are aligned, so are never read from the next page.
+        // The generic version does nothing, leaving the caller to test one character at a time.
+        template<class Ch, class... Chars>
+        inline Ch *scan(Ch *text, Chars...)
+        {
+            return text;
+        }
+
+#if defined(RAPIDXML_SSE2)
+
+        // Index of the lowest set bit in a non-zero mask
+        inline unsigned lowest_bit(unsigned mask)
+        {
+    #if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+    #else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+    #endif
+        }
+
+        // Bytes of block which equal any of chars
+        inline __m128i sse2_equal_any(__m128i)
+        {
+            return _mm_setzero_si128();
+        }
+
+        template<class... Chars>
+        inline __m128i sse2_equal_any(__m128i block, char ch, Chars... chars)
+        {
+            return _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(ch)), sse2_equal_any(block, chars...));
+        }
+
+        // Mask of the characters in an aligned block of 16 which equal any of chars
+        template<class... Chars>
+        RAPIDXML_NO_SANITIZE inline unsigned sse2_find(const char *block, Chars... chars)
+        {
+            __m128i data = _mm_load_si128(reinterpret_cast<const __m128i *>(block));
+            return static_cast<unsigned>(_mm_movemask_epi8(sse2_equal_any(data, chars...)));
+        }
+
+        template<class... Chars>
+        inline char *sse2_scan(char *text, Chars... chars)
+        {
+            unsigned offset = static_cast<unsigned>(reinterpret_cast<std::uintptr_t>(text) & 15);
+            char *block = text - offset;
+            unsigned mask = sse2_find(block, chars...) >> offset << offset;
+            while (!mask)
+            {
+                block += 16;
+                mask = sse2_find(block, chars...);
+            }
+            return block + lowest_bit(mask);
+        }
+
+    #if defined(RAPIDXML_AVX2)
+
+        __attribute__((target("avx2"))) inline __m256i avx2_equal_any(__m256i)
+        {
+            return _mm256_setzero_si256();
+        }
+
+        template<class... Chars>
+        __attribute__((target("avx2"))) inline __m256i avx2_equal_any(__m256i block, char ch, Chars... chars)
+        {
+            return _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(ch)), avx2_equal_any(block, chars...));
+        }
+
+        // Mask of the characters in an aligned block of 32 which equal any of chars
+        template<class... Chars>
+        __attribute__((target("avx2"))) RAPIDXML_NO_SANITIZE inline unsigned avx2_find(const char *block, Chars... chars)
+        {
+            __m256i data = _mm256_load_si256(reinterpret_cast<const __m256i *>(block));
+            return static_cast<unsigned>(_mm256_movemask_epi8(avx2_equal_any(data, chars...)));
+        }
+
+        template<class... Chars>
+        __attribute__((target("avx2"))) inline char *avx2_scan(char *text, Chars... chars)
+        {
+            unsigned offset = static_cast<unsigned>(reinterpret_cast<std::uintptr_t>(text) & 31);
+            char *block = text - offset;
+            unsigned mask = avx2_find(block, chars...) >> offset << offset;
+            while (!mask)
+            {
+                block += 32;
+                mask = avx2_find(block, chars...);
+            }
+            return block + lowest_bit(mask);
+        }
+
+    #endif
+
+        template<class... Chars>
+        inline char *scan(char *text, Chars... chars)
+        {
+    #if defined(RAPIDXML_AVX2)
+            if (simd_state<0>::level >= 2)
+                return avx2_scan(text, chars...);
+    #endif
+            if (simd_state<0>::level >= 1)
+                return sse2_scan(text, chars...);
+            return text;
+        }
+
+#endif
     }
     //! \endcond
 
+    ///////////////////////////////////////////////////////////////////////
+    // SIMD
+
+    //! Instruction sets which the parser can use to scan text, see set_simd_level().
+    enum simd_level
+    {
+        simd_none = 0,  //!< Scan one character at a time
+        simd_sse2 = 1,  //!< Scan 16 characters at a time using SSE2
+        simd_avx2 = 2   //!< Scan 32 characters at a time using AVX2
+    };
+
+    //! Returns the fastest instruction set supported by both the compiler and the CPU.
+    //! This is the level used unless set_simd_level() is called.
+    inline simd_level max_simd_level()
+    {
+        return static_cast<simd_level>(internal::simd_state<0>::detect());
+    }
+
+    //! Returns the instruction set used to scan text.
+    inline simd_level get_simd_level()
+    {
+        return static_cast<simd_level>(internal::simd_state<0>::level);
+    }
+
+    //! Sets the instruction set used to scan text by all documents; it is limited to max_simd_level(). 
+    //! Parsing gives the same results at every level. 
+    //! This must not be called while any document is being parsed.
+    //! \param level Instruction set to use.
+    inline void set_simd_level(simd_level level)
+    {
+        internal::simd_state<0>::level = level < max_simd_level() ? level : max_simd_level();
+    }
+
     ///////////////////////////////////////////////////////////////////////
     // Memory pool
     
@@ -1458,6 +1649,10 @@ namespace rapidxml
             {
                 return internal::lookup_tables<0>::lookup_text[static_cast<unsigned char>(ch)];
             }
+            static Ch *scan(Ch *text)
+            {
+                return internal::scan(text, Ch('\0'), Ch('<'));
+            }
         };
 
         // Detect text character (PCDATA) that does not require processing
@@ -1467,6 +1662,10 @@ namespace rapidxml
             {
                 return internal::lookup_tables<0>::lookup_text_pure_no_ws[static_cast<unsigned char>(ch)];
             }
+            static Ch *scan(Ch *text)
+            {
+                return internal::scan(text, Ch('\0'), Ch('&'), Ch('<'));
+            }
         };
 
         // Detect text character (PCDATA) that does not require processing
@@ -1476,6 +1675,10 @@ namespace rapidxml
             {
                 return internal::lookup_tables<0>::lookup_text_pure_with_ws[static_cast<unsigned char>(ch)];
             }
+            static Ch *scan(Ch *text)
+            {
+                return internal::scan(text, Ch('\0'), Ch(' '), Ch('\t'), Ch('\n'), Ch('\r'), Ch('&'), Ch('<'));
+            }
         };
 
         // Detect attribute value character
@@ -1490,6 +1693,10 @@ namespace rapidxml
                     return internal::lookup_tables<0>::lookup_attribute_data_2[static_cast<unsigned char>(ch)];
                 return 0;       // Should never be executed, to avoid warnings on Comeau
             }
+            static Ch *scan(Ch *text)
+            {
+                return internal::scan(text, Ch('\0'), Quote);
+            }
         };
 
         // Detect attribute value character
@@ -1504,6 +1711,10 @@ namespace rapidxml
                     return internal::lookup_tables<0>::lookup_attribute_data_2_pure[static_cast<unsigned char>(ch)];
                 return 0;       // Should never be executed, to avoid warnings on Comeau
             }
+            static Ch *scan(Ch *text)
+            {
+                return internal::scan(text, Ch('\0'), Quote, Ch('&'));
+            }
         };
 
         // Insert coded character, using UTF8 or 8-bit ASCII
@@ -1563,6 +1774,27 @@ namespace rapidxml
             text = tmp;
         }
 
+        // Skip characters until predicate evaluates to true, as skip(), but scanning blocks of 
+        // characters with StopPred::scan() once the run is long. Used for text and attribute values.
+        template<class StopPred, int Flags>
+        static void skip_long(Ch *&text)
+        {
+            Ch *tmp = text;
+            for (int i = 0; i < 16; ++i)
+            {
+                if (!StopPred::test(*tmp))
+                {
+                    text = tmp;
+                    return;
+                }
+                ++tmp;
+            }
+            tmp = StopPred::scan(tmp);
+            while (StopPred::test(*tmp))
+                ++tmp;
+            text = tmp;
+        }
+
         // Skip characters until predicate evaluates to true while doing the following:
         // - replacing XML character entity references with proper characters (&apos; &amp; &quot; &lt; &gt; &#...;)
         // - condensing whitespace sequences to single space character
@@ -1574,12 +1806,12 @@ namespace rapidxml
                 !(Flags & parse_normalize_whitespace) &&
                 !(Flags & parse_trim_whitespace))
             {
-                skip<StopPred, Flags>(text);
+                skip_long<StopPred, Flags>(text);
                 return text;
             }
             
             // Use simple skip until first modification is detected
-            skip<StopPredPure, Flags>(text);
+            skip_long<StopPredPure, Flags>(text);
 
             // Use translation skip
             Ch *src = text;
@@ -2587,6 +2819,7 @@ namespace rapidxml
 
 // Undefine internal macros
 #undef RAPIDXML_PARSE_ERROR
+#undef RAPIDXML_NO_SANITIZE
 
 // On MSVC, restore warnings state
 #ifdef _MSC_VER
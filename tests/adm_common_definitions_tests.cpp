@@ -1,5 +1,8 @@
 #include <catch2/catch.hpp>
+#include <fstream>
 #include "adm/common_definitions.hpp"
+#include "rapidxml/rapidxml.hpp"
+#include "rapidxml/rapidxml_utils.hpp"
 
 TEST_CASE("basic_document") {
   using namespace adm;
@@ -52,3 +55,206 @@ TEST_CASE("HOA Track Lookup") {
     auto label_FuMa = formatId(audioTrackFormatId_FuMa);
     REQUIRE(label_FuMa == "AT_0004020c_01");
 }
+
+namespace {
+  using NodePtr = rapidxml::xml_node<>*;
+
+  std::string attribute(NodePtr node, const char* name) {
+    auto attr = node->first_attribute(name);
+    return attr ? attr->value() : "";
+  }
+
+  std::vector<std::string> childValues(NodePtr node, const char* name) {
+    std::vector<std::string> values;
+    for (auto child = node->first_node(name); child;
+         child = child->next_sibling(name)) {
+      values.push_back(child->value());
+    }
+    return values;
+  }
+
+  template <typename Id, typename Range>
+  std::vector<std::string> formatIds(const Range& elements) {
+    std::vector<std::string> ids;
+    for (const auto& element : elements) {
+      ids.push_back(adm::formatId(element->template get<Id>()));
+    }
+    return ids;
+  }
+
+  template <typename Id, typename Element>
+  std::vector<std::string> formatOptionalId(
+      std::shared_ptr<const Element> element) {
+    if (element) {
+      return {adm::formatId(element->template get<Id>())};
+    }
+    return {};
+  }
+}  // namespace
+
+TEST_CASE("common definitions match common_definitions.xml") {
+  using namespace adm;
+
+  // the common definitions are compiled into tables during the build; check
+  // that nothing was lost along the way by comparing against the source
+  std::ifstream stream("common_definitions.xml");
+  REQUIRE(stream.good());
+  rapidxml::file<> xmlFile(stream);
+  rapidxml::xml_document<> xmlDocument;
+  xmlDocument.parse<0>(xmlFile.data());
+  NodePtr root = xmlDocument.first_node("ituADM")
+                     ->first_node("coreMetadata")
+                     ->first_node("format")
+                     ->first_node("audioFormatExtended");
+  REQUIRE(root);
+
+  auto document = getCommonDefinitions();
+  std::size_t packFormatCount = 0;
+  std::size_t channelFormatCount = 0;
+  std::size_t streamFormatCount = 0;
+  std::size_t trackFormatCount = 0;
+
+  for (auto node = root->first_node("audioPackFormat"); node;
+       node = node->next_sibling("audioPackFormat")) {
+    ++packFormatCount;
+    auto id = attribute(node, "audioPackFormatID");
+    INFO(id);
+    auto packFormat = document->lookup(parseAudioPackFormatId(id));
+    REQUIRE(packFormat);
+    CHECK(packFormat->get<AudioPackFormatName>() ==
+          attribute(node, "audioPackFormatName"));
+    CHECK(formatTypeDefinition(packFormat->get<TypeDescriptor>()) ==
+          attribute(node, "typeDefinition"));
+    CHECK(formatIds<AudioChannelFormatId>(
+              packFormat->getReferences<AudioChannelFormat>()) ==
+          childValues(node, "audioChannelFormatIDRef"));
+    CHECK(formatIds<AudioPackFormatId>(
+              packFormat->getReferences<AudioPackFormat>()) ==
+          childValues(node, "audioPackFormatIDRef"));
+  }
+
+  for (auto node = root->first_node("audioChannelFormat"); node;
+       node = node->next_sibling("audioChannelFormat")) {
+    ++channelFormatCount;
+    auto id = attribute(node, "audioChannelFormatID");
+    INFO(id);
+    auto channelFormat = document->lookup(parseAudioChannelFormatId(id));
+    REQUIRE(channelFormat);
+    CHECK(channelFormat->get<AudioChannelFormatName>() ==
+          attribute(node, "audioChannelFormatName"));
+    CHECK(formatTypeDefinition(channelFormat->get<TypeDescriptor>()) ==
+          attribute(node, "typeDefinition"));
+
+    auto frequency = node->first_node("frequency");
+    REQUIRE(channelFormat->has<Frequency>() == (frequency != nullptr));
+    if (frequency) {
+      CHECK(channelFormat->get<Frequency>().get<LowPass>() ==
+            std::stof(frequency->value()));
+    }
+
+    auto blockNode = node->first_node("audioBlockFormat");
+    REQUIRE(blockNode);
+    REQUIRE(!blockNode->next_sibling("audioBlockFormat"));
+    auto blockId = attribute(blockNode, "audioBlockFormatID");
+    auto type = channelFormat->get<TypeDescriptor>();
+    if (type == TypeDefinition::DIRECT_SPEAKERS) {
+      auto blocks =
+          channelFormat->getElements<AudioBlockFormatDirectSpeakers>();
+      REQUIRE(blocks.size() == 1);
+      auto& block = blocks[0];
+      CHECK(formatId(block.get<AudioBlockFormatId>()) == blockId);
+      std::vector<std::string> labels;
+      for (auto& label : block.get<SpeakerLabels>()) {
+        labels.push_back(label.get());
+      }
+      CHECK(labels == childValues(blockNode, "speakerLabel"));
+
+      auto position = block.get<SphericalSpeakerPosition>();
+      for (auto coordinate = blockNode->first_node("position"); coordinate;
+           coordinate = coordinate->next_sibling("position")) {
+        auto axis = attribute(coordinate, "coordinate");
+        auto value = std::stof(coordinate->value());
+        auto screenEdgeLock = attribute(coordinate, "screenEdgeLock");
+        if (axis == "azimuth") {
+          CHECK(position.get<Azimuth>() == value);
+          CHECK(position.get<ScreenEdgeLock>().has<HorizontalEdge>() ==
+                !screenEdgeLock.empty());
+          if (!screenEdgeLock.empty()) {
+            CHECK(position.get<ScreenEdgeLock>().get<HorizontalEdge>() ==
+                  screenEdgeLock);
+          }
+        } else if (axis == "elevation") {
+          CHECK(position.get<Elevation>() == value);
+        } else if (axis == "distance") {
+          CHECK(position.get<Distance>() == value);
+        }
+      }
+    } else if (type == TypeDefinition::HOA) {
+      auto blocks = channelFormat->getElements<AudioBlockFormatHoa>();
+      REQUIRE(blocks.size() == 1);
+      auto& block = blocks[0];
+      CHECK(formatId(block.get<AudioBlockFormatId>()) == blockId);
+      CHECK(block.get<Order>() ==
+            std::stoi(blockNode->first_node("order")->value()));
+      CHECK(block.get<Degree>() ==
+            std::stoi(blockNode->first_node("degree")->value()));
+      CHECK(block.get<Normalization>() ==
+            blockNode->first_node("normalization")->value());
+    } else if (type == TypeDefinition::BINAURAL) {
+      auto blocks = channelFormat->getElements<AudioBlockFormatBinaural>();
+      REQUIRE(blocks.size() == 1);
+      CHECK(formatId(blocks[0].get<AudioBlockFormatId>()) == blockId);
+    } else {
+      FAIL("unexpected audioChannelFormat type");
+    }
+  }
+
+  for (auto node = root->first_node("audioStreamFormat"); node;
+       node = node->next_sibling("audioStreamFormat")) {
+    ++streamFormatCount;
+    auto id = attribute(node, "audioStreamFormatID");
+    INFO(id);
+    auto streamFormat = document->lookup(parseAudioStreamFormatId(id));
+    REQUIRE(streamFormat);
+    CHECK(streamFormat->get<AudioStreamFormatName>() ==
+          attribute(node, "audioStreamFormatName"));
+    CHECK(formatFormatDefinition(streamFormat->get<FormatDescriptor>()) ==
+          attribute(node, "formatDefinition"));
+    std::shared_ptr<const AudioStreamFormat> constStreamFormat = streamFormat;
+    CHECK(formatOptionalId<AudioChannelFormatId>(
+              constStreamFormat->getReference<AudioChannelFormat>()) ==
+          childValues(node, "audioChannelFormatIDRef"));
+    CHECK(formatOptionalId<AudioPackFormatId>(
+              constStreamFormat->getReference<AudioPackFormat>()) ==
+          childValues(node, "audioPackFormatIDRef"));
+    std::vector<std::string> trackFormatIds;
+    for (auto& trackFormat :
+         constStreamFormat->getAudioTrackFormatReferences()) {
+      trackFormatIds.push_back(
+          formatId(trackFormat.lock()->get<AudioTrackFormatId>()));
+    }
+    CHECK(trackFormatIds == childValues(node, "audioTrackFormatIDRef"));
+  }
+
+  for (auto node = root->first_node("audioTrackFormat"); node;
+       node = node->next_sibling("audioTrackFormat")) {
+    ++trackFormatCount;
+    auto id = attribute(node, "audioTrackFormatID");
+    INFO(id);
+    auto trackFormat = document->lookup(parseAudioTrackFormatId(id));
+    REQUIRE(trackFormat);
+    CHECK(trackFormat->get<AudioTrackFormatName>() ==
+          attribute(node, "audioTrackFormatName"));
+    std::shared_ptr<const AudioTrackFormat> constTrackFormat = trackFormat;
+    CHECK(formatOptionalId<AudioStreamFormatId>(
+              constTrackFormat->getReference<AudioStreamFormat>()) ==
+          childValues(node, "audioStreamFormatIDRef"));
+  }
+
+  CHECK(document->getElements<AudioPackFormat>().size() == packFormatCount);
+  CHECK(document->getElements<AudioChannelFormat>().size() ==
+        channelFormatCount);
+  CHECK(document->getElements<AudioStreamFormat>().size() ==
+        streamFormatCount);
+  CHECK(document->getElements<AudioTrackFormat>().size() == trackFormatCount);
+}
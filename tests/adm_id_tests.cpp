@@ -1,4 +1,5 @@
 #include <catch2/catch.hpp>
+#include <unordered_set>
 #include "adm/elements/audio_block_format_id.hpp"
 #include "adm/elements/audio_channel_format_id.hpp"
 #include "adm/elements/audio_content_id.hpp"
@@ -319,3 +320,43 @@ TEST_CASE("audio_block_format_id") {
 
   REQUIRE_THROWS(parseAudioBlockFormatId("AT_0001001"));
 }
+
+namespace {
+  template <typename Id>
+  void checkHash(const Id& a, const Id& aCopy, const Id& b) {
+    REQUIRE(std::hash<Id>()(a) == std::hash<Id>()(aCopy));
+    std::unordered_set<Id> ids{a, b};
+    REQUIRE(ids.size() == 2);
+    REQUIRE(ids.count(aCopy) == 1);
+    REQUIRE(ids.count(Id()) == 0);
+  }
+}  // namespace
+
+TEST_CASE("id_hash") {
+  using namespace adm;
+  checkHash(parseAudioProgrammeId("APR_1001"),
+            parseAudioProgrammeId("APR_1001"),
+            parseAudioProgrammeId("APR_1002"));
+  checkHash(parseAudioContentId("ACO_1001"), parseAudioContentId("ACO_1001"),
+            parseAudioContentId("ACO_1002"));
+  checkHash(parseAudioObjectId("AO_1001"), parseAudioObjectId("AO_1001"),
+            parseAudioObjectId("AO_1002"));
+  checkHash(parseAudioTrackUidId("ATU_00000001"),
+            parseAudioTrackUidId("ATU_00000001"),
+            parseAudioTrackUidId("ATU_00000002"));
+  checkHash(parseAudioPackFormatId("AP_00011001"),
+            parseAudioPackFormatId("AP_00011001"),
+            parseAudioPackFormatId("AP_00031001"));
+  checkHash(parseAudioChannelFormatId("AC_00011001"),
+            parseAudioChannelFormatId("AC_00011001"),
+            parseAudioChannelFormatId("AC_00031001"));
+  checkHash(parseAudioStreamFormatId("AS_00011001"),
+            parseAudioStreamFormatId("AS_00011001"),
+            parseAudioStreamFormatId("AS_00011002"));
+  checkHash(parseAudioTrackFormatId("AT_00011001_01"),
+            parseAudioTrackFormatId("AT_00011001_01"),
+            parseAudioTrackFormatId("AT_00011001_02"));
+  checkHash(parseAudioBlockFormatId("AB_00010001_00000001"),
+            parseAudioBlockFormatId("AB_00010001_00000001"),
+            parseAudioBlockFormatId("AB_00010001_00000002"));
+}
@@ -83,6 +83,21 @@ TEST_CASE("construction") {
           std::chrono::nanoseconds{1000000000});
 }
 
+TEST_CASE("parse timecode") {
+  REQUIRE(parseTimecode("12:34:56.7") ==
+          Time(std::chrono::hours(12) + std::chrono::minutes(34) +
+               std::chrono::seconds(56) + std::chrono::milliseconds(700)));
+  REQUIRE(parseTimecode("00:00:01.123456789") ==
+          Time(std::chrono::nanoseconds(1123456789)));
+  // any separator is accepted before the fraction
+  REQUIRE(parseTimecode("00:00:01,5") ==
+          Time(std::chrono::milliseconds(1500)));
+  REQUIRE(parseTimecode("00:00:00.0000000001S1000000000") ==
+          Time(FractionalTime{1, 1000000000}));
+  REQUIRE(parseTimecode("99:59:59.3S4") ==
+          Time(FractionalTime{(99 * 3600 + 59 * 60 + 59) * 4 + 3, 4}));
+}
+
 TEST_CASE("Exceptions") {
   REQUIRE_THROWS_WITH(parseTimecode("foo"),
                       Catch::Contains("invalid timecode"));
@@ -94,6 +109,17 @@ TEST_CASE("Exceptions") {
                       Catch::Contains("invalid timecode") &&
                           Catch::Contains("zero denominator"));
 
+  for (std::string timecode :
+       {"", "00:00:00", "00:00:00.", "0:00:00.0", "00:00:00.0000000000",
+        "00:00:00.1S", "00:00:00.S1", "00:00:00.1X1", "00:00:00.1S1 ",
+        "00:00:00\n1", "00-00:00.0", "00:0a:00.0"}) {
+    INFO("'" << timecode << "'");
+    REQUIRE_THROWS_WITH(parseTimecode(timecode),
+                        Catch::Equals("invalid timecode: " + timecode));
+  }
+  REQUIRE_THROWS_AS(parseTimecode("00:00:00.1S99999999999"),
+                    std::out_of_range);
+
   REQUIRE_THROWS_WITH(FractionalTime(0, 0),
                       Catch::Contains("denominator must be positive"));
   REQUIRE_THROWS_WITH(FractionalTime(0, -1),
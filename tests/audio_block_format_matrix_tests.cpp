@@ -37,3 +37,65 @@ TEST_CASE("audio_block_format_matrix") {
     REQUIRE(blockFormat.isDefault<Rtime>() == true);
   }
 }
+
+TEST_CASE("matrix_coefficient") {
+  using namespace adm;
+  auto input = parseAudioChannelFormatId("AC_00010001");
+  MatrixCoefficient coefficient(input);
+
+  REQUIRE(coefficient.get<AudioChannelFormatId>() == input);
+  REQUIRE(coefficient.isDefault<Gain>() == true);
+  REQUIRE(coefficient.isDefault<Phase>() == true);
+  REQUIRE(coefficient.isDefault<Delay>() == true);
+  REQUIRE(coefficient.get<Gain>().asLinear() == 1.0);
+  REQUIRE(coefficient.get<Phase>() == 0.0f);
+  REQUIRE(coefficient.get<Delay>() == 0.0f);
+
+  coefficient.set(Gain::fromDb(-6.0));
+  coefficient.set(Phase(90.0f));
+  coefficient.set(Delay(1.5f));
+  REQUIRE(coefficient.isDefault<Gain>() == false);
+  REQUIRE(coefficient.get<Gain>().isDb());
+  REQUIRE(coefficient.get<Gain>().asDb() == -6.0);
+  REQUIRE(coefficient.get<Phase>() == 90.0f);
+  REQUIRE(coefficient.get<Delay>() == 1.5f);
+  REQUIRE(coefficient != MatrixCoefficient(input));
+
+  coefficient.set(Gain::fromLinear(0.5));
+  REQUIRE(coefficient.get<Gain>().isLinear());
+  REQUIRE(coefficient.get<Gain>().asLinear() == 0.5);
+
+  coefficient.unset<Gain>();
+  coefficient.unset<Phase>();
+  coefficient.unset<Delay>();
+  REQUIRE(coefficient.isDefault<Gain>() == true);
+  REQUIRE(coefficient.isDefault<Phase>() == true);
+  REQUIRE(coefficient.isDefault<Delay>() == true);
+  REQUIRE(coefficient == MatrixCoefficient(input));
+}
+
+TEST_CASE("audio_block_format_matrix coefficients") {
+  using namespace adm;
+  AudioBlockFormatMatrix blockFormat;
+  REQUIRE(blockFormat.has<MatrixCoefficients>() == false);
+  REQUIRE(blockFormat.has<OutputChannelFormatId>() == false);
+
+  auto left = parseAudioChannelFormatId("AC_00010001");
+  auto centre = parseAudioChannelFormatId("AC_00010003");
+  REQUIRE(blockFormat.add(MatrixCoefficient(left)) == true);
+  REQUIRE(blockFormat.add(MatrixCoefficient(left)) == false);
+  REQUIRE(blockFormat.add(MatrixCoefficient(centre, Gain(0.5))) == true);
+  REQUIRE(blockFormat.get<MatrixCoefficients>().size() == 2);
+
+  blockFormat.remove(MatrixCoefficient(left));
+  REQUIRE(blockFormat.get<MatrixCoefficients>().size() == 1);
+  auto coefficients = blockFormat.get<MatrixCoefficients>();
+  REQUIRE(coefficients[0].get<AudioChannelFormatId>() == centre);
+
+  blockFormat.set(OutputChannelFormatId(left));
+  REQUIRE(blockFormat.get<OutputChannelFormatId>().get() == left);
+  blockFormat.unset<OutputChannelFormatId>();
+  REQUIRE(blockFormat.has<OutputChannelFormatId>() == false);
+  blockFormat.unset<MatrixCoefficients>();
+  REQUIRE(blockFormat.has<MatrixCoefficients>() == false);
+}
@@ -1,9 +1,15 @@
 #include <catch2/catch.hpp>
 #include "adm/common_definitions.hpp"
 #include "adm/utilities/copy.hpp"
+#include "adm/utilities/object_creation.hpp"
 #include "adm/parse.hpp"
 #include "adm/write.hpp"
+#include "helper/temporary_directory.hpp"
+#include <fstream>
+#include <iomanip>
 #include <sstream>
+#include <string>
+#include <vector>
 
 using namespace adm;
 
@@ -14,6 +20,27 @@ TEST_CASE("common_definitions") {
   BENCHMARK("copy") { return adm::deepCopy(common_defs); };
 }
 
+TEST_CASE("small document") {
+  auto document = Document::create();
+  addCommonDefinitionsTo(document);
+  addSimpleObjectTo(document, "object");
+  addSimpleCommonDefinitionsObjectTo(document, "bed", "0+5+0");
+
+  std::stringstream stream;
+  writeXml(stream, document);
+
+  BENCHMARK("parse") {
+    stream.seekg(0);
+    return parseXml(stream);
+  };
+
+  ParserContext context;
+  BENCHMARK("parse with context") {
+    stream.seekg(0);
+    return context.parseXml(stream);
+  };
+}
+
 TEST_CASE("lots of blocks") {
   auto generate = []() {
     auto doc = Document::create();
@@ -48,6 +75,143 @@ TEST_CASE("lots of blocks") {
     stream.seekg(0);
     return parseXml(stream);
   };
+
+  BENCHMARK("parse parallel") {
+    stream.seekg(0);
+    return parseXml(stream, xml::ParserOptions::parallel);
+  };
+
+  ParserContext context;
+  BENCHMARK("parse with context") {
+    stream.seekg(0);
+    return context.parseXml(stream);
+  };
+
+  BENCHMARK("parse streaming") {
+    stream.seekg(0);
+    return parseXml(stream, xml::ParserOptions::streaming);
+  };
+
+  BENCHMARK("parse skipping blocks") {
+    stream.seekg(0);
+    return parseXml(stream, xml::ParserOptions::skip_audio_block_formats);
+  };
+
+  const std::string xml = stream.str();
+
+  BENCHMARK("parse buffer") {
+    return parseXml(xml.data(), xml.size());
+  };
+
+  BENCHMARK_ADVANCED("parse buffer in place")
+  (Catch::Benchmark::Chronometer meter) {
+    // the terminator is copied too
+    std::vector<char> buffer(xml.c_str(), xml.c_str() + xml.size() + 1);
+    std::vector<std::vector<char>> buffers(meter.runs(), buffer);
+    meter.measure(
+        [&](int i) { return parseXml(buffers[i].data(), xml.size()); });
+  };
+
+  TemporaryDirectory directory;
+  const std::string filename = directory.file("lots_of_blocks.xml");
+  {
+    std::ofstream file(filename, std::ios::binary);
+    writeXml(file, document);
+  }
+
+  BENCHMARK("parse file") { return parseXml(filename); };
+
+  BENCHMARK("parse file memory mapped") {
+    return parseXml(filename, xml::ParserOptions::memory_map);
+  };
+
+  TemporaryDirectory cacheDirectory;
+  ParseCache cache(cacheDirectory.path());
+  cache.parseXml(filename);
+  BENCHMARK("parse file from cache") { return cache.parseXml(filename); };
+}
+
+TEST_CASE("large ebuCore wrapper") {
+  // a small audioFormatExtended inside lots of other metadata
+  auto document = Document::create();
+  addSimpleObjectTo(document, "object");
+  std::stringstream adm;
+  writeXml(adm, document);
+  std::string admXml = adm.str();
+  std::size_t begin = admXml.find("<audioFormatExtended");
+  std::size_t end = admXml.find("</audioFormatExtended>") + 22;
+
+  std::ostringstream xml;
+  xml << "<ebuCoreMain><coreMetadata>\n";
+  for (unsigned i = 0; i < 100000; i++)
+    xml << "<title typeLabel=\"t\" note=\"" << i << "\">title " << i
+        << "</title>\n";
+  xml << "<format>" << admXml.substr(begin, end - begin) << "</format>\n";
+  xml << "</coreMetadata></ebuCoreMain>\n";
+  std::istringstream stream(xml.str());
+
+  BENCHMARK("parse") {
+    stream.seekg(0);
+    return parseXml(stream);
+  };
+}
+
+TEST_CASE("lots of track uids") {
+  // many elements and references between them; written out directly, as
+  // building this through the Document API is slow
+  const unsigned n = 2000;
+  std::ostringstream xml;
+  xml << std::hex << std::setfill('0');
+  xml << "<ituADM><coreMetadata><format><audioFormatExtended>\n";
+  xml << "<audioContent audioContentID=\"ACO_1001\" "
+         "audioContentName=\"content\">\n";
+  for (unsigned i = 0; i < n; i++)
+    xml << "<audioObjectIDRef>AO_" << std::setw(4) << 0x1001 + i
+        << "</audioObjectIDRef>\n";
+  xml << "</audioContent>\n";
+  for (unsigned i = 0; i < n; i++) {
+    xml << "<audioObject audioObjectID=\"AO_" << std::setw(4) << 0x1001 + i
+        << "\" audioObjectName=\"object\">"
+        << "<audioPackFormatIDRef>AP_00010001</audioPackFormatIDRef>"
+        << "<audioTrackUIDRef>ATU_" << std::setw(8) << i + 1
+        << "</audioTrackUIDRef></audioObject>\n";
+    xml << "<audioTrackUID UID=\"ATU_" << std::setw(8) << i + 1 << "\">"
+        << "<audioTrackFormatIDRef>AT_00010003_01</audioTrackFormatIDRef>"
+        << "<audioPackFormatIDRef>AP_00010001</audioPackFormatIDRef>"
+        << "</audioTrackUID>\n";
+  }
+  xml << "</audioFormatExtended></format></coreMetadata></ituADM>\n";
+  std::istringstream stream(xml.str());
+
+  BENCHMARK("parse") {
+    stream.seekg(0);
+    return parseXml(stream, xml::ParserOptions::recursive_node_search);
+  };
+}
+
+TEST_CASE("many documents") {
+  // a batch of small documents, as when checking an archive
+  auto document = Document::create();
+  for (int i = 0; i < 20; i++)
+    addSimpleObjectTo(document, "object " + std::to_string(i));
+  std::stringstream stream;
+  writeXml(stream, document);
+  std::string xml = stream.str();
+  std::vector<XmlBuffer> buffers(32, XmlBuffer{xml.data(), xml.size()});
+
+  BENCHMARK("parse one at a time") {
+    std::vector<std::shared_ptr<Document>> documents;
+    for (auto& buffer : buffers)
+      documents.push_back(parseXml(buffer.data, buffer.size));
+    return documents;
+  };
+
+  for (unsigned threads : {1u, 2u, 4u, 8u}) {
+    BatchParser parser(threads);
+    BENCHMARK("parse batch, " + std::to_string(threads) + " threads") {
+      return parser.parseXml(buffers);
+    };
+  }
 }
 
 TEST_CASE("IDs") {
@@ -59,3 +223,13 @@ TEST_CASE("IDs") {
 
   BENCHMARK("parse") { return parseAudioBlockFormatId(bfIdStr); };
 }
+
+TEST_CASE("timecodes") {
+  BENCHMARK("parse") { return parseTimecode("01:23:45.67890"); };
+  BENCHMARK("parse fractional") {
+    return parseTimecode("01:23:45.12345S48000");
+  };
+
+  Time time = parseTimecode("01:23:45.67890");
+  BENCHMARK("format") { return formatTimecode(time); };
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "adm/bw64.hpp"
+#include "adm/document.hpp"
+#include "adm/errors.hpp"
+
+namespace {
+  std::string le(std::uint64_t value, std::size_t bytes) {
+    std::string result;
+    for (std::size_t i = 0; i < bytes; i++) {
+      result.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+    return result;
+  }
+
+  std::string chunk(const std::string& id, const std::string& data) {
+    std::string result = id + le(data.size(), 4) + data;
+    if (data.size() % 2) {
+      result.push_back('\0');
+    }
+    return result;
+  }
+
+  std::string chnaEntry(std::uint16_t track, const std::string& uid,
+                        const std::string& trackRef,
+                        const std::string& packRef) {
+    return le(track, 2) + uid + trackRef + packRef + std::string(1, '\0');
+  }
+
+  const std::string chna =
+      chunk("chna", le(1, 2) + le(2, 2) +
+                        chnaEntry(1, "ATU_00000001", "AT_00031001_01",
+                                  "AP_00031001") +
+                        chnaEntry(1, "ATU_00000002", "AT_00031002_01",
+                                  "AP_00031001"));
+
+  // odd length, to check padding
+  const std::string axml = chunk(
+      "axml",
+      "<ituADM><coreMetadata><format><audioFormatExtended>"
+      "<audioObject audioObjectID=\"AO_1001\" audioObjectName=\"object\"/>"
+      "</audioFormatExtended></format></coreMetadata></ituADM>\n");
+
+  const std::string fmt = chunk(
+      "fmt ", le(1, 2) + le(1, 2) + le(48000, 4) + le(96000, 4) + le(2, 2) +
+                  le(16, 2));
+
+  std::string riff(const std::string& chunks) {
+    return "RIFF" + le(chunks.size() + 4, 4) + "WAVE" + chunks;
+  }
+
+  void checkMetadata(const adm::Bw64Metadata& metadata) {
+    REQUIRE(metadata.document);
+    CHECK(metadata.document->lookup(adm::parseAudioObjectId("AO_1001")));
+    REQUIRE(metadata.chna.size() == 2);
+    CHECK(metadata.chna[1].trackIndex == 1);
+    CHECK(metadata.chna[1].audioTrackUid == "ATU_00000002");
+    CHECK(metadata.chna[1].trackRef == "AT_00031002_01");
+    CHECK(metadata.chna[1].packRef == "AP_00031001");
+  }
+}  // namespace
+
+TEST_CASE("bw64 riff") {
+  std::istringstream stream(
+      riff(fmt + chunk("data", std::string(15, 'x')) + chna + axml));
+  checkMetadata(adm::parseBw64(stream,
+                               adm::xml::ParserOptions::recursive_node_search));
+}
+
+TEST_CASE("bw64 with ds64") {
+  // the data chunk size is only in the ds64 chunk
+  std::string data(6, 'x');
+  std::string ds64 = chunk("ds64", le(0, 8) + le(data.size(), 8) +
+                                       le(3, 8) + le(0, 4));
+  std::string chunks = ds64 + fmt + "data" + le(0xFFFFFFFF, 4) + data +
+                       axml + chna;
+  std::string file = "BW64" + le(0xFFFFFFFF, 4) + "WAVE" + chunks;
+
+  SECTION("stream") {
+    std::istringstream stream(file);
+    checkMetadata(adm::parseBw64(
+        stream, adm::xml::ParserOptions::recursive_node_search));
+  }
+  SECTION("file") {
+    {
+      std::ofstream out("bw64_ds64.wav", std::ios::binary);
+      out << file;
+    }
+    checkMetadata(adm::parseBw64(
+        "bw64_ds64.wav", adm::xml::ParserOptions::recursive_node_search));
+  }
+}
+
+TEST_CASE("bw64 without adm chunks") {
+  std::istringstream stream(riff(fmt + chunk("data", "xx")));
+  auto metadata = adm::parseBw64(stream);
+  CHECK(!metadata.document);
+  CHECK(metadata.chna.empty());
+}
+
+TEST_CASE("bw64 errors") {
+  SECTION("not a wave file") {
+    std::istringstream stream("<ituADM/>");
+    REQUIRE_THROWS_AS(adm::parseBw64(stream), std::runtime_error);
+  }
+  SECTION("truncated") {
+    std::string file = riff(fmt + axml);
+    std::istringstream stream(file.substr(0, file.size() - 20));
+    REQUIRE_THROWS_AS(adm::parseBw64(stream), std::runtime_error);
+  }
+  SECTION("chunk sizes larger than the file") {
+    // these must not be used to allocate before reading
+    std::string header = "axml";
+    SECTION("axml") {}
+    SECTION("chna") { header = "chna"; }
+    SECTION("other") { header = "junk"; }
+    std::istringstream stream(riff(fmt + header + le(0xFFFFFFF0, 4) + "<"));
+    REQUIRE_THROWS_AS(adm::parseBw64(stream), std::runtime_error);
+  }
+  SECTION("ds64 size larger than the file") {
+    std::string ds64 =
+        chunk("ds64", le(0, 8) + le(0, 8) + le(0, 8) + le(1, 4) + "axml" +
+                          le(0xFFFFFFFFFFFFFFF0, 8));
+    std::string file = "BW64" + le(0xFFFFFFFF, 4) + "WAVE" + ds64 + fmt +
+                       "axml" + le(0xFFFFFFFF, 4) + "<";
+    std::istringstream stream(file);
+    REQUIRE_THROWS_AS(adm::parseBw64(stream), std::runtime_error);
+  }
+  SECTION("missing file") {
+    REQUIRE_THROWS_AS(adm::parseBw64("bw64_missing.wav"), std::runtime_error);
+  }
+  SECTION("bad axml") {
+    std::istringstream stream(riff(chunk("axml", "<ituADM></ituADM>")));
+    REQUIRE_THROWS_AS(adm::parseBw64(stream), adm::error::XmlParsingError);
+  }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief A uniquely named directory in the temporary directory, which is
+ * removed along with the files in it when this goes out of scope
+ *
+ * Only files directly in the directory are removed, not subdirectories.
+ */
+class TemporaryDirectory {
+ public:
+  TemporaryDirectory() {
+#ifdef _WIN32
+    char base[MAX_PATH + 1];
+    if (!GetTempPathA(sizeof(base), base)) {
+      throw std::runtime_error("cannot find the temporary directory");
+    }
+    static std::atomic<unsigned> counter{0};
+    for (int attempt = 0; attempt < 100; ++attempt) {
+      std::ostringstream path;
+      path << base << "libadm_tests_" << GetCurrentProcessId() << "_"
+           << counter++;
+      if (CreateDirectoryA(path.str().c_str(), nullptr)) {
+        path_ = path.str();
+        return;
+      }
+    }
+    throw std::runtime_error("cannot make a temporary directory");
+#else
+    std::string base = "/tmp";
+    if (const char* directory = std::getenv("TMPDIR")) {
+      base = directory;
+    }
+    std::string pattern = base + "/libadm_tests_XXXXXX";
+    std::vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+    if (!mkdtemp(path.data())) {
+      throw std::runtime_error("cannot make a temporary directory");
+    }
+    path_ = path.data();
+#endif
+  }
+  TemporaryDirectory(const TemporaryDirectory&) = delete;
+  TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+  ~TemporaryDirectory() {
+#ifdef _WIN32
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA((path_ + "\\*").c_str(), &entry);
+    if (find != INVALID_HANDLE_VALUE) {
+      do {
+        if (!(entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+          DeleteFileA(file(entry.cFileName).c_str());
+        }
+      } while (FindNextFileA(find, &entry));
+      FindClose(find);
+    }
+    RemoveDirectoryA(path_.c_str());
+#else
+    if (DIR* directory = opendir(path_.c_str())) {
+      while (dirent* entry = readdir(directory)) {
+        std::string name = entry->d_name;
+        if (name != "." && name != "..") {
+          std::remove(file(name).c_str());
+        }
+      }
+      closedir(directory);
+    }
+    rmdir(path_.c_str());
+#endif
+  }
+
+  const std::string& path() const { return path_; }
+
+  /// the path of a file called name in this directory
+  std::string file(const std::string& name) const {
+    return path_ + "/" + name;
+  }
+
+ private:
+  std::string path_;
+};
@@ -39,3 +39,15 @@ TEST_CASE("jump_position") {
     REQUIRE(isEnabled(jumpPosition) == false);
   }
 }
+
+TEST_CASE("parse interpolationLength") {
+  using namespace adm;
+  REQUIRE(parseInterpolationLength("1.5").get() ==
+          std::chrono::milliseconds(1500));
+  REQUIRE(parseInterpolationLength(" 0.25 ").get() ==
+          std::chrono::milliseconds(250));
+  // the decimal separator is always a point, whatever the locale
+  REQUIRE_THROWS_AS(parseInterpolationLength("1,5"), std::invalid_argument);
+  REQUIRE_THROWS_AS(parseInterpolationLength("1.5s"), std::invalid_argument);
+  REQUIRE_THROWS_AS(parseInterpolationLength(""), std::invalid_argument);
+}
@@ -54,6 +54,17 @@ TEST_CASE("NamedType_range_check") {
   REQUIRE_THROWS_AS(NamedIntegerRange(-1), OutOfRangeError);
 }
 
+TEST_CASE("NamedType_trusted") {
+  using namespace adm;
+  using NamedIntegerRange = detail::NamedType<int, struct NamedIntegerRangeTag,
+                                              detail::RangeValidator<0, 10> >;
+  // the trusted constructor does not check; the others still do
+  NamedIntegerRange trusted(12, detail::TrustedTag{});
+  REQUIRE(trusted.get() == 12);
+  REQUIRE(NamedIntegerRange(trusted) == 12);
+  REQUIRE_THROWS_AS(NamedIntegerRange(trusted.get()), OutOfRangeError);
+}
+
 TEST_CASE("screen_edge_validator") {
   using namespace adm;
   struct ScreenEdgeLockTag {};
@@ -81,3 +81,57 @@ TEST_CASE("xml_parser/audio_block_format_objects_gain_unit_error") {
       parseXml("xml_parser/audio_block_format_objects_gain_unit_error.xml"),
       error::XmlParsingUnexpectedAttrError);
 }
+
+namespace {
+  std::shared_ptr<Document> parseObjectsBlock(const std::string& block) {
+    std::istringstream xml(
+        "<ebuCoreMain><coreMetadata><format><audioFormatExtended>"
+        "<audioChannelFormat audioChannelFormatID=\"AC_00031001\" "
+        "audioChannelFormatName=\"MyChannelFormat\">" +
+        block +
+        "</audioChannelFormat>"
+        "</audioFormatExtended></format></coreMetadata></ebuCoreMain>");
+    return parseXml(xml);
+  }
+}  // namespace
+
+TEST_CASE("xml_parser/audio_block_format_objects_child_order") {
+  SECTION("children in any order, first of each kept") {
+    auto document = parseObjectsBlock(
+        "<audioBlockFormat rtime=\"00:00:01.00000\" "
+        "audioBlockFormatID=\"AB_00031001_00000001\">"
+        "<width>10</width>"
+        "<position coordinate=\"Z\">0.25</position>"
+        "<gain>0.5</gain>"
+        "<position coordinate=\"X\">-1</position>"
+        "<width>20</width>"
+        "<cartesian>1</cartesian>"
+        "<position coordinate=\"Y\">0.5</position>"
+        "</audioBlockFormat>");
+    auto channelFormat =
+        document->lookup(parseAudioChannelFormatId("AC_00031001"));
+    auto block = *channelFormat->getElements<AudioBlockFormatObjects>().begin();
+    CHECK(block.get<Rtime>().get() == std::chrono::seconds(1));
+    CHECK(block.get<Width>() == Approx(10.0f));
+    CHECK(block.get<Gain>().asLinear() == Approx(0.5f));
+    CHECK(block.get<Cartesian>() == true);
+    auto position = block.get<CartesianPosition>();
+    CHECK(position.get<X>() == Approx(-1.0f));
+    CHECK(position.get<Y>() == Approx(0.5f));
+    CHECK(position.get<Z>() == Approx(0.25f));
+  }
+
+  SECTION("errors do not depend on child order") {
+    // rtime is converted before gain, wherever they appear
+    REQUIRE_THROWS_WITH(
+        parseObjectsBlock("<audioBlockFormat rtime=\"invalid\">"
+                          "<gain gainUnit=\"invalid\">1</gain>"
+                          "<position coordinate=\"azimuth\">0</position>"
+                          "</audioBlockFormat>"),
+        Catch::Contains("invalid timecode"));
+    REQUIRE_THROWS_WITH(
+        parseObjectsBlock("<audioBlockFormat><width>1</width>"
+                          "</audioBlockFormat>"),
+        Catch::Contains("mandatory element 'position' not found"));
+  }
+}
@@ -0,0 +1,259 @@
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "adm/document.hpp"
+#include "adm/elements.hpp"
+#include "adm/errors.hpp"
+#include "adm/parse.hpp"
+#include "adm/write.hpp"
+
+namespace {
+  using adm::ParsePhase;
+  using adm::ParseProgress;
+  using adm::xml::ParserOptions;
+
+  std::string write(std::shared_ptr<adm::Document> document) {
+    std::ostringstream result;
+    adm::writeXml(result, document);
+    return result.str();
+  }
+
+  /// a document with one channel with a number of audioBlockFormats, and a
+  /// number of audioObjects referencing it through a pack
+  std::string makeDocument(int objects, int blocks) {
+    std::ostringstream xml;
+    xml << "<ebuCoreMain><coreMetadata><format><audioFormatExtended>\n"
+           "<audioChannelFormat audioChannelFormatID=\"AC_00031001\" "
+           "audioChannelFormatName=\"channel\" typeLabel=\"0003\" "
+           "typeDefinition=\"Objects\">\n";
+    for (int i = 0; i < blocks; ++i) {
+      xml << "<audioBlockFormat audioBlockFormatID=\"AB_00031001_"
+          << std::hex << 0x10000000 + i << std::dec << "\">"
+          << "<position coordinate=\"azimuth\">" << i % 360 - 180
+          << "</position>"
+          << "<position coordinate=\"elevation\">0</position>"
+          << "</audioBlockFormat>\n";
+    }
+    xml << "</audioChannelFormat>\n"
+           "<audioPackFormat audioPackFormatID=\"AP_00031001\" "
+           "audioPackFormatName=\"pack\" typeLabel=\"0003\" "
+           "typeDefinition=\"Objects\">\n"
+           "<audioChannelFormatIDRef>AC_00031001</audioChannelFormatIDRef>\n"
+           "</audioPackFormat>\n";
+    for (int i = 0; i < objects; ++i) {
+      xml << "<audioObject audioObjectID=\"AO_" << std::hex << 0x1001 + i
+          << std::dec << "\" audioObjectName=\"object\">\n"
+          << "<audioPackFormatIDRef>AP_00031001</audioPackFormatIDRef>\n"
+          << "</audioObject>\n";
+    }
+    xml << "</audioFormatExtended></format></coreMetadata></ebuCoreMain>\n";
+    return xml.str();
+  }
+
+  /// parse xml on another thread; buffers are never streamed, so with
+  /// ParserOptions::streaming this goes through a file
+  std::future<std::shared_ptr<adm::Document>> parseAsync(
+      const std::string& xml, ParserOptions options,
+      adm::ProgressCallback progress = nullptr,
+      adm::CancellationToken cancellation = adm::CancellationToken()) {
+    if (options == ParserOptions::streaming) {
+      std::ofstream("async_streaming.xml", std::ios::binary) << xml;
+      return adm::parseXmlAsync("async_streaming.xml", options, progress,
+                                cancellation);
+    }
+    return adm::parseXmlAsync(xml.data(), xml.size(), options, progress,
+                              cancellation);
+  }
+}  // namespace
+
+TEST_CASE("async parse matches parseXml") {
+  auto options = GENERATE(ParserOptions::none, ParserOptions::parallel,
+                          ParserOptions::streaming);
+  std::string xml = makeDocument(20, 1000);
+  std::istringstream stream(xml);
+  std::string expected = write(adm::parseXml(stream));
+
+  auto result = parseAsync(xml, options);
+  CHECK(write(result.get()) == expected);
+
+  auto fromFile = adm::parseXmlAsync(
+      "xml_parser/audio_block_format_objects.xml", options);
+  CHECK(write(fromFile.get()) ==
+        write(adm::parseXml("xml_parser/audio_block_format_objects.xml")));
+}
+
+TEST_CASE("async parse errors are returned through the future") {
+  std::string xml = makeDocument(2, 2);
+  xml.replace(xml.find("AO_1002"), 7, "AO_1001");
+  auto result = adm::parseXmlAsync(xml.data(), xml.size());
+  REQUIRE_THROWS_AS(result.get(), adm::error::XmlParsingDuplicateId);
+}
+
+TEST_CASE("async parse progress") {
+  std::string xml = makeDocument(20, 1000);
+  std::vector<ParseProgress> reports;
+  auto recordProgress = [&reports](const ParseProgress& progress) {
+    reports.push_back(progress);
+  };
+
+  SECTION("dom") {
+    auto options = GENERATE(ParserOptions::none, ParserOptions::parallel);
+    adm::parseXmlAsync(xml.data(), xml.size(), options, recordProgress)
+        .get();
+
+    REQUIRE(reports.size() > 2);
+    CHECK(reports.front().phase == ParsePhase::dom);
+    CHECK(reports.front().bytes == 0);
+    CHECK(reports.front().totalBytes == xml.size());
+
+    // phases are in order, and counts never go backwards within a phase
+    for (std::size_t i = 1; i < reports.size(); ++i) {
+      const auto& previous = reports[i - 1];
+      const auto& current = reports[i];
+      REQUIRE(current.phase >= previous.phase);
+      if (current.phase == previous.phase) {
+        CHECK(current.bytes >= previous.bytes);
+        CHECK(current.elements >= previous.elements);
+      }
+      if (current.phase != ParsePhase::dom) {
+        CHECK(current.elements <= current.totalElements);
+      }
+    }
+
+    auto lastOf = [&reports](ParsePhase phase) {
+      ParseProgress last{};
+      for (const auto& report : reports) {
+        if (report.phase == phase) {
+          last = report;
+        }
+      }
+      return last;
+    };
+    CHECK(lastOf(ParsePhase::dom).bytes == xml.size());
+    // 20 objects, one pack and one channel
+    CHECK(lastOf(ParsePhase::elements).elements == 22);
+    CHECK(lastOf(ParsePhase::elements).totalElements == 22);
+    // a pack reference from each object, and a channel reference
+    CHECK(lastOf(ParsePhase::references).elements == 21);
+    CHECK(lastOf(ParsePhase::references).totalElements == 21);
+  }
+
+  SECTION("reading a file") {
+    std::ofstream("async_read.xml", std::ios::binary) << xml;
+    adm::parseXmlAsync("async_read.xml", ParserOptions::none, recordProgress)
+        .get();
+    std::remove("async_read.xml");
+
+    REQUIRE(reports.size() > 2);
+    CHECK(reports.front().phase == ParsePhase::read);
+    CHECK(reports.front().bytes == 0);
+    CHECK(reports.front().totalBytes == xml.size());
+    std::size_t i = 0;
+    while (reports[i].phase == ParsePhase::read) {
+      CHECK(reports[i].totalBytes == xml.size());
+      ++i;
+    }
+    CHECK(reports[i - 1].bytes == xml.size());
+    CHECK(reports[i].phase == ParsePhase::dom);
+    CHECK(reports[i].bytes == 0);
+  }
+
+  SECTION("streaming") {
+    parseAsync(xml, ParserOptions::streaming, recordProgress).get();
+
+    std::size_t domReports = 0;
+    for (const auto& report : reports) {
+      if (report.phase == ParsePhase::dom) {
+        ++domReports;
+        CHECK(report.elements == domReports);
+        CHECK(report.bytes <= xml.size());
+      }
+    }
+    CHECK(domReports == 22);
+    CHECK(reports.back().phase == ParsePhase::references);
+  }
+}
+
+TEST_CASE("async parse cancellation") {
+  auto options = GENERATE(ParserOptions::none, ParserOptions::parallel,
+                          ParserOptions::streaming);
+  std::string xml = makeDocument(100, 1000);
+
+  SECTION("before starting") {
+    adm::CancellationToken token;
+    token.cancel();
+    bool called = false;
+    auto result = parseAsync(
+        xml, options, [&called](const ParseProgress&) { called = true; },
+        token);
+    REQUIRE_THROWS_AS(result.get(), adm::error::ParsingCancelled);
+    CHECK_FALSE(called);
+  }
+
+  SECTION("between elements") {
+    adm::CancellationToken token;
+    ParseProgress last{};
+    auto result = parseAsync(
+        xml, options,
+        [&](const ParseProgress& progress) {
+          last = progress;
+          if (progress.elements == 10) {
+            token.cancel();
+          }
+        },
+        token);
+    REQUIRE_THROWS_AS(result.get(), adm::error::ParsingCancelled);
+    CHECK(last.phase != ParsePhase::references);
+    CHECK(last.elements == 10);
+  }
+
+  SECTION("while reading a file") {
+    if (options == ParserOptions::streaming) {
+      return;
+    }
+    // large enough to be read in several blocks
+    std::string large = makeDocument(0, 20000);
+    std::ofstream("async_read.xml", std::ios::binary) << large;
+    adm::CancellationToken token;
+    ParseProgress last{};
+    auto result = adm::parseXmlAsync(
+        "async_read.xml", options,
+        [&](const ParseProgress& progress) {
+          last = progress;
+          if (progress.bytes > 0) {
+            token.cancel();
+          }
+        },
+        token);
+    REQUIRE_THROWS_AS(result.get(), adm::error::ParsingCancelled);
+    std::remove("async_read.xml");
+    CHECK(last.phase == ParsePhase::read);
+    CHECK(last.bytes > 0);
+    CHECK(last.bytes < large.size());
+  }
+
+  SECTION("within an audioChannelFormat") {
+    if (options == ParserOptions::streaming) {
+      return;
+    }
+    // the channel is the first element, and is cancelled before it has
+    // been added
+    adm::CancellationToken token;
+    std::string large = makeDocument(0, 10000);
+    std::size_t lastElements = 0;
+    auto result = parseAsync(
+        large, options,
+        [&](const ParseProgress& progress) {
+          lastElements = progress.elements;
+          if (progress.phase == ParsePhase::elements) {
+            token.cancel();
+          }
+        },
+        token);
+    REQUIRE_THROWS_AS(result.get(), adm::error::ParsingCancelled);
+    CHECK(lastElements == 0);
+  }
+}
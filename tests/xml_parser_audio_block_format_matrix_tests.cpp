@@ -0,0 +1,83 @@
+#include <sstream>
+#include <catch2/catch.hpp>
+#include "adm/document.hpp"
+#include "adm/elements/audio_channel_format.hpp"
+#include "adm/parse.hpp"
+#include "adm/write.hpp"
+
+using namespace adm;
+
+TEST_CASE("xml_parser/audio_block_format_matrix") {
+  auto document = parseXml("xml_parser/audio_block_format_matrix.xml");
+  auto channelFormat =
+      document->lookup(parseAudioChannelFormatId("AC_00021001"));
+  REQUIRE(channelFormat->get<TypeDescriptor>() == TypeDefinition::MATRIX);
+
+  auto blockFormats = channelFormat->getElements<AudioBlockFormatMatrix>();
+  REQUIRE(blockFormats.size() == 2);
+
+  auto firstBlockFormat = blockFormats[0];
+  CHECK(firstBlockFormat.get<AudioBlockFormatId>() ==
+        parseAudioBlockFormatId("AB_00021001_00000001"));
+  CHECK(firstBlockFormat.get<Duration>().get() == std::chrono::seconds(1));
+  CHECK(firstBlockFormat.get<OutputChannelFormatId>().get() ==
+        parseAudioChannelFormatId("AC_00010001"));
+  CHECK(firstBlockFormat.get<Gain>().asLinear() == 0.5);
+  CHECK(firstBlockFormat.get<Importance>() == 5);
+
+  auto coefficients = firstBlockFormat.get<MatrixCoefficients>();
+  REQUIRE(coefficients.size() == 3);
+  CHECK(coefficients[0].get<AudioChannelFormatId>() ==
+        parseAudioChannelFormatId("AC_00010001"));
+  CHECK(coefficients[0].isDefault<Gain>());
+  CHECK(coefficients[0].isDefault<Phase>());
+  CHECK(coefficients[0].isDefault<Delay>());
+  CHECK(coefficients[0].get<Gain>().asLinear() == 1.0);
+
+  CHECK(coefficients[1].get<AudioChannelFormatId>() ==
+        parseAudioChannelFormatId("AC_00010003"));
+  CHECK(coefficients[1].get<Gain>().asLinear() == Approx(0.707107));
+
+  CHECK(coefficients[2].get<Gain>().isDb());
+  CHECK(coefficients[2].get<Gain>().asDb() == -3.0);
+  CHECK(coefficients[2].get<Phase>() == 180.0f);
+  CHECK(coefficients[2].get<Delay>() == 2.5f);
+
+  auto secondBlockFormat = blockFormats[1];
+  CHECK(secondBlockFormat.get<Rtime>().get() == std::chrono::seconds(1));
+  CHECK_FALSE(secondBlockFormat.has<OutputChannelFormatId>());
+  CHECK(secondBlockFormat.isDefault<Gain>());
+  REQUIRE(secondBlockFormat.get<MatrixCoefficients>().size() == 1);
+}
+
+TEST_CASE("xml_parser/audio_block_format_matrix round trip") {
+  auto document = parseXml("xml_parser/audio_block_format_matrix.xml");
+  std::stringstream xml;
+  writeXml(xml, document);
+  auto reparsed = parseXml(xml);
+
+  auto channelFormat =
+      document->lookup(parseAudioChannelFormatId("AC_00021001"));
+  auto reparsedChannelFormat =
+      reparsed->lookup(parseAudioChannelFormatId("AC_00021001"));
+  auto blockFormats = channelFormat->getElements<AudioBlockFormatMatrix>();
+  auto reparsedBlockFormats =
+      reparsedChannelFormat->getElements<AudioBlockFormatMatrix>();
+  REQUIRE(reparsedBlockFormats.size() == blockFormats.size());
+  for (std::size_t i = 0; i < blockFormats.size(); ++i) {
+    CHECK(reparsedBlockFormats[i].get<MatrixCoefficients>() ==
+          blockFormats[i].get<MatrixCoefficients>());
+    CHECK(reparsedBlockFormats[i].has<OutputChannelFormatId>() ==
+          blockFormats[i].has<OutputChannelFormatId>());
+  }
+}
+
+TEST_CASE("xml_parser/audio_block_format_matrix parallel") {
+  auto document = parseXml("xml_parser/audio_block_format_matrix.xml",
+                           xml::ParserOptions::parallel);
+  auto channelFormat =
+      document->lookup(parseAudioChannelFormatId("AC_00021001"));
+  auto blockFormats = channelFormat->getElements<AudioBlockFormatMatrix>();
+  REQUIRE(blockFormats.size() == 2);
+  CHECK(blockFormats[0].get<MatrixCoefficients>().size() == 3);
+}
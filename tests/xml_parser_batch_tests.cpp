@@ -0,0 +1,99 @@
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "adm/document.hpp"
+#include "adm/errors.hpp"
+#include "adm/parse.hpp"
+#include "adm/write.hpp"
+
+namespace {
+  std::string write(std::shared_ptr<adm::Document> document) {
+    std::ostringstream result;
+    adm::writeXml(result, document);
+    return result.str();
+  }
+
+  std::string readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file),
+                       std::istreambuf_iterator<char>());
+  }
+
+  const std::vector<std::string> filenames = {
+      "xml_parser/audio_block_format_objects.xml",
+      "xml_parser/audio_object.xml",
+      "xml_parser/audio_object_duplicate_id.xml",
+      "xml_parser/with_common_definitions.xml",
+      "xml_parser/does_not_exist.xml",
+      "xml_parser/audio_programme.xml",
+  };
+}  // namespace
+
+TEST_CASE("batch parse matches parseXml") {
+  unsigned threads = GENERATE(1u, 2u, 4u);
+  adm::BatchParser parser(threads);
+  CHECK(parser.threads() == threads);
+
+  std::vector<std::string> xml;
+  std::vector<adm::XmlBuffer> buffers;
+  for (auto& filename : filenames) {
+    xml.push_back(readFile(filename));
+  }
+  for (auto& text : xml) {
+    buffers.push_back({text.data(), text.size()});
+  }
+
+  // parse more than once, to check that the parser storage is reused
+  // correctly
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    auto fromFiles = parser.parseXml(filenames);
+    auto fromBuffers = parser.parseXml(buffers);
+    REQUIRE(fromFiles.size() == filenames.size());
+    REQUIRE(fromBuffers.size() == filenames.size());
+
+    for (std::size_t i = 0; i < filenames.size(); ++i) {
+      INFO(filenames[i]);
+      std::shared_ptr<adm::Document> expected;
+      try {
+        expected = adm::parseXml(filenames[i]);
+      } catch (const std::exception&) {
+      }
+
+      if (expected) {
+        REQUIRE(fromFiles[i].document);
+        CHECK_FALSE(fromFiles[i].error);
+        CHECK(write(fromFiles[i].document) == write(expected));
+        REQUIRE(fromBuffers[i].document);
+        CHECK(write(fromBuffers[i].document) == write(expected));
+      } else {
+        CHECK_FALSE(fromFiles[i].document);
+        CHECK(fromFiles[i].error);
+      }
+    }
+  }
+}
+
+TEST_CASE("batch parse errors") {
+  adm::BatchParser parser(2);
+  auto results = parser.parseXml(filenames);
+  REQUIRE_THROWS_AS(std::rethrow_exception(results[2].error),
+                    adm::error::XmlParsingDuplicateId);
+  REQUIRE_THROWS_AS(std::rethrow_exception(results[4].error),
+                    std::runtime_error);
+
+  std::string bad = "<ebuCoreMain>";
+  auto bufferResults = parser.parseXml(
+      std::vector<adm::XmlBuffer>{{bad.data(), bad.size()}});
+  REQUIRE(bufferResults.size() == 1);
+  CHECK(bufferResults[0].error);
+}
+
+TEST_CASE("batch parse with no inputs") {
+  adm::BatchParser parser;
+  CHECK(parser.threads() >= 1);
+  CHECK(parser.parseXml(std::vector<std::string>{}).empty());
+}
@@ -0,0 +1,70 @@
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "adm/document.hpp"
+#include "adm/errors.hpp"
+#include "adm/parse.hpp"
+#include "adm/write.hpp"
+
+namespace {
+  using adm::xml::ParserOptions;
+
+  std::string write(std::shared_ptr<adm::Document> document) {
+    std::ostringstream result;
+    adm::writeXml(result, document);
+    return result.str();
+  }
+
+  std::string readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file),
+                       std::istreambuf_iterator<char>());
+  }
+}  // namespace
+
+TEST_CASE("buffer parse matches file parse") {
+  auto filename = GENERATE(as<std::string>{},
+                           "xml_parser/audio_block_format_objects.xml",
+                           "xml_parser/audio_object.xml",
+                           "xml_parser/with_common_definitions.xml");
+  INFO(filename);
+  auto options = GENERATE(ParserOptions::recursive_node_search,
+                          ParserOptions::recursive_node_search |
+                              ParserOptions::streaming,
+                          ParserOptions::recursive_node_search |
+                              ParserOptions::lazy_audio_block_formats);
+  std::string expected =
+      write(adm::parseXml(filename, ParserOptions::recursive_node_search));
+  std::string xml = readFile(filename);
+
+  SECTION("in place") {
+    std::vector<char> buffer(xml.begin(), xml.end());
+    buffer.push_back('\0');
+    CHECK(write(adm::parseXml(buffer.data(), xml.size(), options)) ==
+          expected);
+  }
+  SECTION("copy") {
+    // no terminator, and the input must not be changed
+    std::vector<char> buffer(xml.begin(), xml.end());
+    const char* data = buffer.data();
+    CHECK(write(adm::parseXml(data, buffer.size(), options)) == expected);
+    CHECK(std::string(buffer.begin(), buffer.end()) == xml);
+  }
+}
+
+TEST_CASE("buffer parse errors") {
+  SECTION("empty") {
+    char empty[] = "";
+    REQUIRE_THROWS_AS(adm::parseXml(empty, 0), adm::error::XmlParsingError);
+    const char* constEmpty = empty;
+    REQUIRE_THROWS_AS(adm::parseXml(constEmpty, 0),
+                      adm::error::XmlParsingError);
+  }
+  SECTION("not null-terminated") {
+    char xml[] = "<ituADM/>";
+    REQUIRE_THROWS_AS(adm::parseXml(xml, 5), std::invalid_argument);
+  }
+}
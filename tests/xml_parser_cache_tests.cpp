@@ -0,0 +1,237 @@
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "adm/document.hpp"
+#include "adm/elements.hpp"
+#include "adm/parse.hpp"
+#include "adm/write.hpp"
+#include "helper/temporary_directory.hpp"
+
+namespace {
+  using adm::xml::ParserOptions;
+
+  std::string write(std::shared_ptr<adm::Document> document) {
+    std::ostringstream result;
+    adm::writeXml(result, document);
+    return result.str();
+  }
+
+  std::string readFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file),
+                       std::istreambuf_iterator<char>());
+  }
+
+  /// parse xml without the cache; this leaves xml unchanged
+  std::string parseAndWrite(const std::string& xml) {
+    std::istringstream stream(xml);
+    return write(adm::parseXml(stream));
+  }
+
+  const std::vector<std::string> filenames = {
+      "xml_parser/audio_block_format_binaural.xml",
+      "xml_parser/audio_block_format_direct_speakers.xml",
+      "xml_parser/audio_block_format_direct_speakers_cartesian.xml",
+      "xml_parser/audio_block_format_hoa.xml",
+      "xml_parser/audio_block_format_matrix.xml",
+      "xml_parser/audio_block_format_objects.xml",
+      "xml_parser/audio_channel_format.xml",
+      "xml_parser/audio_content.xml",
+      "xml_parser/audio_object.xml",
+      "xml_parser/audio_object_interaction.xml",
+      "xml_parser/audio_object_position_offset.xml",
+      "xml_parser/audio_pack_format.xml",
+      "xml_parser/audio_pack_format_hoa.xml",
+      "xml_parser/audio_programme.xml",
+      "xml_parser/audio_stream_format.xml",
+      "xml_parser/audio_track_format.xml",
+      "xml_parser/audio_track_uid.xml",
+      "xml_parser/audio_track_uid_channel_format_reference.xml",
+      "xml_parser/audio_track_uid_track_format_reference.xml",
+      "xml_parser/labels.xml",
+      "xml_parser/loudness_metadata.xml",
+      "xml_parser/time_format.xml",
+      "xml_parser/with_common_definitions.xml",
+  };
+
+  const char* cartesianObjects = R"(<?xml version="1.0" encoding="utf-8"?>
+<ebuCoreMain>
+  <coreMetadata>
+    <format>
+      <audioFormatExtended>
+        <audioChannelFormat audioChannelFormatID="AC_00031001" audioChannelFormatName="channel" typeLabel="0003" typeDefinition="Objects">
+          <audioBlockFormat audioBlockFormatID="AB_00031001_00000001" rtime="00:00:00.00000" duration="00:00:01.00000">
+            <cartesian>1</cartesian>
+            <position coordinate="X">0.5</position>
+            <position coordinate="Y">-0.25</position>
+            <position coordinate="Z" screenEdgeLock="top">0.0</position>
+            <gain gainUnit="dB">-3</gain>
+          </audioBlockFormat>
+          <audioBlockFormat audioBlockFormatID="AB_00031001_00000002" rtime="00:00:01.00000S48000" duration="00:00:01.48000S48000">
+            <cartesian>0</cartesian>
+            <position coordinate="azimuth">30.0</position>
+            <position coordinate="elevation">0.0</position>
+            <jumpPosition interpolationLength="0.25">1</jumpPosition>
+          </audioBlockFormat>
+          <audioBlockFormat audioBlockFormatID="AB_00031001_00000003">
+            <position coordinate="azimuth">-30.0</position>
+            <position coordinate="elevation">10.0</position>
+          </audioBlockFormat>
+        </audioChannelFormat>
+      </audioFormatExtended>
+    </format>
+  </coreMetadata>
+</ebuCoreMain>
+)";
+}  // namespace
+
+TEST_CASE("parse cache matches parseXml") {
+  TemporaryDirectory directory;
+  adm::ParseCache cache(directory.path());
+  for (const auto& filename : filenames) {
+    INFO(filename);
+    auto xml = readFile(filename);
+    REQUIRE_FALSE(xml.empty());
+    auto expected = write(adm::parseXml(filename));
+
+    auto misses = cache.misses();
+    CHECK(write(cache.parseXml(filename)) == expected);
+    CHECK(cache.misses() == misses + 1);
+
+    auto hits = cache.hits();
+    CHECK(write(cache.parseXml(filename)) == expected);
+    CHECK(write(cache.parseXml(xml.data(), xml.size())) == expected);
+    std::istringstream stream(xml);
+    CHECK(write(cache.parseXml(stream)) == expected);
+    CHECK(cache.hits() == hits + 3);
+  }
+}
+
+TEST_CASE("parse cache restores parameters which are not written") {
+  using namespace adm;
+  TemporaryDirectory directory;
+  ParseCache cache(directory.path());
+  auto xml = readFile("xml_parser/audio_pack_format_hoa.xml");
+  cache.parseXml(xml.data(), xml.size());
+  auto document = cache.parseXml(xml.data(), xml.size());
+  REQUIRE(cache.hits() == 1);
+
+  auto packFormat = std::dynamic_pointer_cast<AudioPackFormatHoa>(
+      document->lookup(parseAudioPackFormatId("AP_00041001")));
+  REQUIRE(packFormat);
+  CHECK(packFormat->get<Importance>() == 10);
+  CHECK(packFormat->get<Normalization>() == "N3D");
+  CHECK(packFormat->get<ScreenRef>() == true);
+  CHECK(packFormat->get<NfcRefDist>() == 2.0f);
+  CHECK_FALSE(packFormat->isDefault<Normalization>());
+}
+
+TEST_CASE("parse cache keeps block format coordinate systems") {
+  using namespace adm;
+  TemporaryDirectory directory;
+  ParseCache cache(directory.path());
+  std::string xml = cartesianObjects;
+  auto expected = cache.parseXml(xml.data(), xml.size());
+  auto cached = cache.parseXml(xml.data(), xml.size());
+  REQUIRE(cache.hits() == 1);
+  CHECK(write(cached) == write(expected));
+
+  auto channel = cached->lookup(parseAudioChannelFormatId("AC_00031001"));
+  REQUIRE(channel);
+  auto blocks = channel->getElements<AudioBlockFormatObjects>();
+  REQUIRE(blocks.size() == 3);
+
+  CHECK(blocks[0].get<Cartesian>() == true);
+  CHECK_FALSE(blocks[0].isDefault<Cartesian>());
+  CHECK(blocks[0].get<CartesianPosition>().get<X>() == 0.5f);
+  CHECK(blocks[0].get<Gain>().isDb());
+  CHECK(blocks[0].get<Gain>().asDb() == -3.0);
+
+  CHECK(blocks[1].get<Cartesian>() == false);
+  CHECK_FALSE(blocks[1].isDefault<Cartesian>());
+  CHECK(blocks[1].has<SphericalPosition>());
+  CHECK(blocks[1].get<Rtime>().get().isFractional());
+  CHECK(blocks[1].get<JumpPosition>().get<InterpolationLength>().get() ==
+        std::chrono::milliseconds(250));
+
+  CHECK(blocks[2].isDefault<Cartesian>());
+  CHECK(blocks[2].isDefault<Rtime>());
+  CHECK_FALSE(blocks[2].has<Duration>());
+}
+
+TEST_CASE("parse cache invalidation") {
+  TemporaryDirectory directory;
+  adm::ParseCache cache(directory.path());
+  std::string xml = cartesianObjects;
+  cache.parseXml(xml.data(), xml.size());
+  REQUIRE(cache.misses() == 1);
+
+  SECTION("modified input") {
+    std::string modified = xml;
+    modified.replace(modified.find("30.0"), 4, "45.0");
+    auto document = cache.parseXml(modified.data(), modified.size());
+    CHECK(cache.misses() == 2);
+    CHECK(write(document) != write(cache.parseXml(xml.data(), xml.size())));
+    CHECK(cache.hits() == 1);
+  }
+
+  SECTION("different options") {
+    CHECK(cache.entryPath(xml.data(), xml.size()) !=
+          cache.entryPath(xml.data(), xml.size(), ParserOptions::parallel));
+    cache.parseXml(xml.data(), xml.size(), ParserOptions::parallel);
+    CHECK(cache.misses() == 2);
+    cache.parseXml(xml.data(), xml.size(), ParserOptions::parallel);
+    CHECK(cache.hits() == 1);
+  }
+
+  SECTION("corrupt entry") {
+    auto path = cache.entryPath(xml.data(), xml.size());
+    auto entry = readFile(path);
+    REQUIRE(entry.size() > 100);
+    std::string corrupt = entry;
+    corrupt[corrupt.size() - 10] ^= 0x55;
+    std::ofstream(path, std::ios::binary) << corrupt;
+
+    auto expected = parseAndWrite(xml);
+    CHECK(write(cache.parseXml(xml.data(), xml.size())) == expected);
+    CHECK(cache.misses() == 2);
+    // the entry is replaced
+    CHECK(readFile(path) == entry);
+    CHECK(write(cache.parseXml(xml.data(), xml.size())) == expected);
+    CHECK(cache.hits() == 1);
+  }
+
+  SECTION("truncated entry") {
+    auto path = cache.entryPath(xml.data(), xml.size());
+    auto entry = readFile(path);
+    std::ofstream(path, std::ios::binary) << entry.substr(0, entry.size() / 2);
+    cache.parseXml(xml.data(), xml.size());
+    CHECK(cache.misses() == 2);
+    CHECK(readFile(path) == entry);
+  }
+}
+
+TEST_CASE("parse cache with lazy audioBlockFormats") {
+  TemporaryDirectory directory;
+  adm::ParseCache cache(directory.path());
+  std::string xml = cartesianObjects;
+  auto options = ParserOptions::lazy_audio_block_formats;
+  auto expected = parseAndWrite(xml);
+  CHECK(write(cache.parseXml(xml.data(), xml.size(), options)) == expected);
+  CHECK(write(cache.parseXml(xml.data(), xml.size(), options)) == expected);
+  CHECK(cache.hits() == 0);
+  CHECK(cache.misses() == 2);
+}
+
+TEST_CASE("parse cache errors") {
+  TemporaryDirectory directory;
+  adm::ParseCache cache(directory.path());
+  REQUIRE_THROWS_AS(cache.parseXml("xml_parser/does_not_exist.xml"),
+                    std::runtime_error);
+  std::string bad = "<ebuCoreMain>";
+  REQUIRE_THROWS(cache.parseXml(bad.data(), bad.size()));
+  REQUIRE_THROWS(cache.parseXml(bad.data(), bad.size()));
+}
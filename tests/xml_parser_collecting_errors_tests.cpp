@@ -0,0 +1,294 @@
+#include <catch2/catch.hpp>
+#include <boost/optional/optional_io.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "adm/document.hpp"
+#include "adm/elements.hpp"
+#include "adm/errors.hpp"
+#include "adm/parse.hpp"
+
+namespace {
+  using adm::xml::ParserOptions;
+
+  const char* problems = R"(<?xml version="1.0" encoding="utf-8"?>
+<ebuCoreMain>
+  <coreMetadata>
+    <format>
+      <audioFormatExtended>
+        <audioContent audioContentID="ACO_1001" audioContentName="content">
+          <audioObjectIDRef>AO_1001</audioObjectIDRef>
+          <audioObjectIDRef>AO_1002</audioObjectIDRef>
+        </audioContent>
+        <audioObject audioObjectID="AO_1001" audioObjectName="good">
+          <audioPackFormatIDRef>AP_00031001</audioPackFormatIDRef>
+        </audioObject>
+        <audioObject audioObjectID="AO_1002" audioObjectName="bad" start="soon"/>
+        <audioObject audioObjectID="AO_1001" audioObjectName="duplicate"/>
+        <audioObject audioObjectID="AO_1003" audioObjectName="unresolved">
+          <audioPackFormatIDRef>AP_00031002</audioPackFormatIDRef>
+        </audioObject>
+        <audioPackFormat audioPackFormatID="AP_00031001" audioPackFormatName="pack" typeLabel="0003" typeDefinition="Objects">
+          <audioChannelFormatIDRef>AC_00031001</audioChannelFormatIDRef>
+        </audioPackFormat>
+        <audioChannelFormat audioChannelFormatID="AC_00031001" audioChannelFormatName="channel" typeLabel="0003" typeDefinition="Objects">
+          <audioBlockFormat audioBlockFormatID="AB_00031001_00000001">
+            <position coordinate="azimuth">30.0</position>
+            <position coordinate="elevation">0.0</position>
+            <gain gainUnit="foo">0.8</gain>
+          </audioBlockFormat>
+          <audioBlockFormat audioBlockFormatID="AB_00031001_00000002">
+            <position coordinate="azimuth">-30.0</position>
+            <position coordinate="elevation">0.0</position>
+          </audioBlockFormat>
+        </audioChannelFormat>
+      </audioFormatExtended>
+    </format>
+  </coreMetadata>
+</ebuCoreMain>
+)";
+
+  /// the message thrown by parseXml() for xml
+  std::string parseXmlError(const std::string& xml) {
+    std::istringstream stream(xml);
+    try {
+      adm::parseXml(stream);
+    } catch (const std::exception& e) {
+      return e.what();
+    }
+    return "";
+  }
+
+  /// remove the line of xml containing text
+  std::string removeLine(std::string xml, const std::string& text) {
+    auto begin = xml.rfind('\n', xml.find(text));
+    auto end = xml.find('\n', begin + 1);
+    return xml.erase(begin, end - begin);
+  }
+
+  /// replace the line number in an error message
+  std::string moveLine(std::string message, int from, int to) {
+    std::string fromText = "(:" + std::to_string(from) + ")";
+    auto position = message.find(fromText);
+    REQUIRE(position != std::string::npos);
+    return message.replace(position, fromText.size(),
+                           "(:" + std::to_string(to) + ")");
+  }
+}  // namespace
+
+TEST_CASE("collecting errors keeps the elements that can be parsed") {
+  using namespace adm;
+  std::istringstream stream(problems);
+  auto result = parseXmlCollectingErrors(stream);
+  REQUIRE(result.document);
+
+  auto good = result.document->lookup(parseAudioObjectId("AO_1001"));
+  REQUIRE(good);
+  CHECK(good->get<AudioObjectName>() == "good");
+  CHECK(good->getReferences<AudioPackFormat>().size() == 1);
+
+  CHECK_FALSE(result.document->lookup(parseAudioObjectId("AO_1002")));
+
+  auto unresolved = result.document->lookup(parseAudioObjectId("AO_1003"));
+  REQUIRE(unresolved);
+  CHECK(unresolved->getReferences<AudioPackFormat>().size() == 0);
+
+  auto content = result.document->lookup(parseAudioContentId("ACO_1001"));
+  REQUIRE(content);
+  CHECK(content->getReferences<AudioObject>().size() == 1);
+
+  auto channel =
+      result.document->lookup(parseAudioChannelFormatId("AC_00031001"));
+  REQUIRE(channel);
+  auto blocks = channel->getElements<AudioBlockFormatObjects>();
+  REQUIRE(blocks.size() == 1);
+  CHECK(formatId(blocks.begin()->get<AudioBlockFormatId>()) ==
+        "AB_00031001_00000002");
+}
+
+TEST_CASE("collecting errors keeps the audioBlockFormats after a bad one") {
+  using namespace adm;
+  std::ostringstream xml;
+  xml << "<ebuCoreMain><coreMetadata><format><audioFormatExtended>"
+         "<audioChannelFormat audioChannelFormatID=\"AC_00031001\" "
+         "audioChannelFormatName=\"channel\" typeDefinition=\"Objects\">";
+  for (int counter = 1; counter <= 4; counter++) {
+    xml << "<audioBlockFormat audioBlockFormatID=\"AB_00031001_0000000"
+        << counter << "\"><position coordinate=\"azimuth\">"
+        << (counter == 2 ? "left" : "0") << "</position>"
+        << "<position coordinate=\"elevation\">0</position>"
+        << "</audioBlockFormat>";
+  }
+  xml << "</audioChannelFormat></audioFormatExtended>"
+         "</format></coreMetadata></ebuCoreMain>";
+
+  std::istringstream stream(xml.str());
+  auto result = parseXmlCollectingErrors(stream);
+  REQUIRE(result.document);
+  CHECK(result.diagnostics.size() == 1);
+
+  auto channel =
+      result.document->lookup(parseAudioChannelFormatId("AC_00031001"));
+  REQUIRE(channel);
+  auto blocks = channel->getElements<AudioBlockFormatObjects>();
+  REQUIRE(blocks.size() == 3);
+  CHECK(formatId(blocks[0].get<AudioBlockFormatId>()) ==
+        "AB_00031001_00000001");
+  CHECK(formatId(blocks[1].get<AudioBlockFormatId>()) ==
+        "AB_00031001_00000003");
+  CHECK(formatId(blocks[2].get<AudioBlockFormatId>()) ==
+        "AB_00031001_00000004");
+
+  // blocks added later still get the next counter
+  channel->add(AudioBlockFormatObjects(SphericalPosition(Azimuth(0.f))));
+  CHECK(formatId(channel->getElements<AudioBlockFormatObjects>()
+                     .back()
+                     .get<AudioBlockFormatId>()) == "AB_00031001_00000005");
+}
+
+TEST_CASE("collecting errors reports every problem") {
+  using namespace adm;
+  std::istringstream stream(problems);
+  auto result = parseXmlCollectingErrors(stream);
+  auto& diagnostics = result.diagnostics;
+  REQUIRE(diagnostics.size() == 5);
+
+  // element errors in document order, then unresolved references
+  CHECK(diagnostics[0].line == 11);
+  CHECK(diagnostics[1].line == 12);
+  CHECK_THROWS_AS(std::rethrow_exception(diagnostics[1].error),
+                  error::XmlParsingDuplicateId);
+  CHECK(diagnostics[2].line == 23);
+  // unresolved references are on the line of the element referring to them
+  CHECK_THAT(diagnostics[3].message, Catch::Contains("AO_1002"));
+  CHECK(diagnostics[3].line == 6);
+  CHECK_THROWS_AS(std::rethrow_exception(diagnostics[3].error),
+                  error::XmlParsingUnresolvedReference);
+  CHECK_THAT(diagnostics[4].message, Catch::Contains("AP_00031002"));
+  CHECK(diagnostics[4].line == 14);
+
+  for (auto& diagnostic : diagnostics) {
+    REQUIRE(diagnostic.error);
+    CHECK_THROWS_WITH(std::rethrow_exception(diagnostic.error),
+                      diagnostic.message);
+  }
+}
+
+TEST_CASE("collected errors match the errors thrown by parseXml") {
+  using namespace adm;
+  // parseXml throws the first problem; remove each one to find the next
+  std::string xml = problems;
+  std::istringstream stream(xml);
+  auto diagnostics = parseXmlCollectingErrors(stream).diagnostics;
+  REQUIRE(diagnostics.size() == 5);
+
+  CHECK(parseXmlError(xml) == diagnostics[0].message);
+  xml = removeLine(xml, "start=\"soon\"");
+  // later lines move up by one for each line removed
+  CHECK(parseXmlError(xml) == moveLine(diagnostics[1].message, 12, 11));
+  xml = removeLine(xml, "audioObjectName=\"duplicate\"");
+  CHECK(parseXmlError(xml) == moveLine(diagnostics[2].message, 23, 21));
+}
+
+TEST_CASE("collecting errors from references which can not be set") {
+  using namespace adm;
+  SECTION("cycle") {
+    std::string xml = R"(<?xml version="1.0" encoding="utf-8"?>
+<ebuCoreMain>
+  <coreMetadata>
+    <format>
+      <audioFormatExtended>
+        <audioObject audioObjectID="AO_1001" audioObjectName="self">
+          <audioObjectIDRef>AO_1001</audioObjectIDRef>
+        </audioObject>
+      </audioFormatExtended>
+    </format>
+  </coreMetadata>
+</ebuCoreMain>
+)";
+    std::istringstream stream(xml);
+    ParseResult result;
+    REQUIRE_NOTHROW(result = parseXmlCollectingErrors(stream));
+    REQUIRE(result.document);
+    REQUIRE(result.diagnostics.size() == 1);
+    CHECK(result.diagnostics[0].message == parseXmlError(xml));
+    CHECK(result.diagnostics[0].line == 5);
+    CHECK_THROWS_AS(std::rethrow_exception(result.diagnostics[0].error),
+                    error::AudioObjectReferenceCycle);
+    auto object = result.document->lookup(parseAudioObjectId("AO_1001"));
+    REQUIRE(object);
+    CHECK(object->getReferences<AudioObject>().empty());
+  }
+  SECTION("mutually exclusive") {
+    std::string xml = R"(<?xml version="1.0" encoding="utf-8"?>
+<ebuCoreMain>
+  <coreMetadata>
+    <format>
+      <audioFormatExtended>
+        <audioTrackUID UID="ATU_00000001">
+          <audioTrackFormatIDRef>AT_00031001_01</audioTrackFormatIDRef>
+          <audioChannelFormatIDRef>AC_00031001</audioChannelFormatIDRef>
+        </audioTrackUID>
+        <audioTrackFormat audioTrackFormatID="AT_00031001_01" audioTrackFormatName="track" formatLabel="0001" formatDefinition="PCM"/>
+        <audioChannelFormat audioChannelFormatID="AC_00031001" audioChannelFormatName="channel" typeLabel="0003" typeDefinition="Objects"/>
+      </audioFormatExtended>
+    </format>
+  </coreMetadata>
+</ebuCoreMain>
+)";
+    std::istringstream stream(xml);
+    ParseResult result;
+    REQUIRE_NOTHROW(result = parseXmlCollectingErrors(stream));
+    REQUIRE(result.document);
+    REQUIRE(result.diagnostics.size() == 1);
+    CHECK(result.diagnostics[0].message == parseXmlError(xml));
+    CHECK(result.diagnostics[0].line == 6);
+    CHECK_THROWS_AS(std::rethrow_exception(result.diagnostics[0].error),
+                    error::AudioTrackUidMutuallyExclusiveReferences);
+    auto trackUid =
+        result.document->lookup(parseAudioTrackUidId("ATU_00000001"));
+    REQUIRE(trackUid);
+    CHECK(trackUid->getReference<AudioTrackFormat>());
+    CHECK_FALSE(trackUid->getReference<AudioChannelFormat>());
+  }
+}
+
+TEST_CASE("collecting errors with a document that can not be parsed") {
+  using namespace adm;
+  SECTION("malformed") {
+    std::string xml = problems;
+    xml.replace(xml.find("audioContentName=\"content\""), 26,
+                "audioContentName=content");
+    std::istringstream stream(xml);
+    auto result = parseXmlCollectingErrors(stream);
+    CHECK_FALSE(result.document);
+    REQUIRE(result.diagnostics.size() == 1);
+    CHECK(result.diagnostics[0].line == 4);
+    CHECK(result.diagnostics[0].error);
+  }
+  SECTION("no audioFormatExtended") {
+    std::istringstream stream("<ebuCoreMain/>");
+    auto result = parseXmlCollectingErrors(stream);
+    CHECK_FALSE(result.document);
+    REQUIRE(result.diagnostics.size() == 1);
+    CHECK_THAT(result.diagnostics[0].message,
+               Catch::Contains("audioFormatExtended node not found"));
+  }
+}
+
+TEST_CASE("collecting errors without problems") {
+  using namespace adm;
+  auto options = GENERATE(ParserOptions::none, ParserOptions::parallel);
+  auto result = parseXmlCollectingErrors(
+      "xml_parser/audio_block_format_objects.xml", options);
+  REQUIRE(result.document);
+  CHECK(result.diagnostics.empty());
+  CHECK(result.document->getElements<AudioChannelFormat>().size() > 0);
+}
+
+TEST_CASE("collecting errors is not supported when streaming") {
+  std::istringstream stream(problems);
+  REQUIRE_THROWS_AS(
+      adm::parseXmlCollectingErrors(stream, ParserOptions::streaming),
+      std::invalid_argument);
+}
@@ -0,0 +1,118 @@
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "adm/document.hpp"
+#include "adm/errors.hpp"
+#include "adm/parse.hpp"
+#include "adm/write.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+  using adm::xml::ParserOptions;
+
+  std::string write(std::shared_ptr<adm::Document> document) {
+    std::ostringstream result;
+    adm::writeXml(result, document);
+    return result.str();
+  }
+
+  const char* filenames[] = {"xml_parser/audio_block_format_objects.xml",
+                             "xml_parser/audio_object.xml",
+                             "xml_parser/with_common_definitions.xml",
+                             "xml_parser/audio_block_format_hoa.xml"};
+}  // namespace
+
+TEST_CASE("parser context matches parseXml") {
+  auto options = GENERATE(ParserOptions::recursive_node_search,
+                          ParserOptions::recursive_node_search |
+                              ParserOptions::parallel,
+                          ParserOptions::recursive_node_search |
+                              ParserOptions::lazy_audio_block_formats);
+  adm::ParserContext context;
+  std::vector<std::shared_ptr<adm::Document>> documents;
+  std::vector<std::string> expected;
+  // parse each file twice, so that the second time reuses memory from
+  // parsing other files
+  for (int repeat = 0; repeat < 2; repeat++) {
+    for (auto filename : filenames) {
+      INFO(filename);
+      documents.push_back(context.parseXml(filename, options));
+      expected.push_back(write(adm::parseXml(filename, options)));
+      CHECK(write(documents.back()) == expected.back());
+    }
+  }
+  // earlier documents are not affected by later parses
+  for (std::size_t i = 0; i < documents.size(); i++) {
+    CHECK(write(documents[i]) == expected[i]);
+  }
+}
+
+TEST_CASE("parser context after errors") {
+  adm::ParserContext context;
+  std::stringstream unresolved(
+      "<ituADM><audioFormatExtended>"
+      "<audioContent audioContentID=\"ACO_1001\" audioContentName=\"c\">"
+      "<audioObjectIDRef>AO_1001</audioObjectIDRef>"
+      "</audioContent>"
+      "</audioFormatExtended></ituADM>");
+  REQUIRE_THROWS_AS(
+      context.parseXml(unresolved, ParserOptions::recursive_node_search),
+      adm::error::XmlParsingUnresolvedReference);
+
+  std::stringstream bad("<ituADM><audioFormatExtended>");
+  REQUIRE_THROWS(context.parseXml(bad));
+
+  // the references and elements from the failed parses are not kept
+  std::stringstream good(
+      "<ituADM><audioFormatExtended>"
+      "<audioContent audioContentID=\"ACO_1001\" audioContentName=\"c\"/>"
+      "</audioFormatExtended></ituADM>");
+  auto document =
+      context.parseXml(good, ParserOptions::recursive_node_search);
+  auto content = document->lookup(adm::parseAudioContentId("ACO_1001"));
+  REQUIRE(content);
+  CHECK(content->getReferences<adm::AudioObject>().empty());
+}
+
+#ifndef _WIN32
+TEST_CASE("parser context with a file which can not be seeked") {
+  const std::string fifo = "xml_parser_context_tests.fifo";
+  const std::string filename = "xml_parser/audio_object.xml";
+  std::ifstream file(filename, std::ios::binary);
+  std::string xml((std::istreambuf_iterator<char>(file)),
+                  std::istreambuf_iterator<char>());
+  std::remove(fifo.c_str());
+  REQUIRE(mkfifo(fifo.c_str(), 0600) == 0);
+
+  adm::ParserContext context;
+  // fill the buffer with a larger document first, which must not show
+  // through
+  context.parseXml("xml_parser/audio_block_format_objects.xml");
+
+  std::thread writer([&]() {
+    std::ofstream stream(fifo, std::ios::binary);
+    stream << xml;
+  });
+  std::shared_ptr<adm::Document> document;
+  CHECK_NOTHROW(document = context.parseXml(fifo));
+  // if parseXml failed before opening the FIFO, the writer is still waiting
+  // for a reader; open one so that it can finish instead of hanging
+  int reader = -1;
+  if (!document) reader = open(fifo.c_str(), O_RDONLY | O_NONBLOCK);
+  writer.join();
+  if (reader != -1) close(reader);
+  std::remove(fifo.c_str());
+
+  REQUIRE(document);
+  CHECK(write(document) == write(adm::parseXml(filename)));
+}
+#endif
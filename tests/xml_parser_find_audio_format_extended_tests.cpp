@@ -1,5 +1,6 @@
 #include <catch2/catch.hpp>
 #include <sstream>
+#include "adm/document.hpp"
 #include "adm/parse.hpp"
 
 TEST_CASE("xml_parser/find_audio_format_extended_ebu") {
@@ -15,3 +16,61 @@ TEST_CASE("xml_parser/find_audio_format_extended_ebu_with_other_metadata") {
   adm::parseXml(
       "xml_parser/find_audio_format_extended_ebu_with_other_metadata.xml");
 }
+
+namespace {
+  // markup outside audioFormatExtended that could be mistaken for tags
+  const char* ebuCoreWrapper =
+      "<?xml version=\"1.0\"?>\n"
+      "<!DOCTYPE ebuCoreMain [ <!ENTITY e \"<format>\"> ]>\n"
+      "<ebuCoreMain>\n"
+      "<!-- <audioFormatExtended> -->\n"
+      "<coreMetadata>\n"
+      "<title note=\"a > b\"><![CDATA[<format>]]></title>\n"
+      "<format>\n"
+      "<audioFormatExtended>\n"
+      "<audioContent audioContentID=\"ACO_1001\" audioContentName=\"a\"/>\n"
+      "<audioContent audioContentID=\"ACO_1001\" audioContentName=\"b\"/>\n"
+      "</audioFormatExtended>\n"
+      "</format>\n"
+      "<format/>\n"
+      "</coreMetadata>\n"
+      "</ebuCoreMain>\n";
+}  // namespace
+
+TEST_CASE("find_audio_format_extended_span") {
+  using adm::xml::ParserOptions;
+  std::string xml = ebuCoreWrapper;
+
+  SECTION("line numbers count from the root element") {
+    // remove the second format element
+    xml.replace(xml.find("<format/>\n"), 10, "");
+    for (auto options : {ParserOptions::none,
+                         ParserOptions::recursive_node_search}) {
+      std::istringstream stream(xml);
+      REQUIRE_THROWS_WITH(adm::parseXml(stream, options),
+                          Catch::Contains("ACO_1001") &&
+                              Catch::Contains("(:7)"));
+    }
+  }
+
+  SECTION("elements must be unique in ebuCore documents") {
+    std::istringstream stream(xml);
+    REQUIRE_THROWS_WITH(adm::parseXml(stream),
+                        Catch::Contains("audioFormatExtended node not found"));
+  }
+
+  SECTION("markup outside audioFormatExtended is not parsed") {
+    xml.replace(xml.find("<format/>\n"), 10, "<unquoted value=1/>\n");
+    std::istringstream stream(xml);
+    REQUIRE_THROWS_WITH(adm::parseXml(stream), Catch::Contains("(:7)"));
+  }
+
+  SECTION("first match when searching recursively") {
+    xml.replace(xml.find("<ebuCoreMain>"), 13,
+                "<ebuCoreMain><x><audioFormatExtended/></x>");
+    std::istringstream stream(xml);
+    auto document =
+        adm::parseXml(stream, ParserOptions::recursive_node_search);
+    REQUIRE(document->getElements<adm::AudioContent>().empty());
+  }
+}
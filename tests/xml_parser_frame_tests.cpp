@@ -0,0 +1,175 @@
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <string>
+#include "adm/document.hpp"
+#include "adm/elements.hpp"
+#include "adm/errors.hpp"
+#include "adm/parse.hpp"
+
+using namespace adm;
+
+namespace {
+  void parseFrame(FrameParser& parser, const std::string& elements) {
+    std::istringstream frame(
+        "<frame version=\"ITU-R_BS.2125-1\">"
+        "<frameHeader/>"
+        "<audioFormatExtended>" +
+        elements +
+        "</audioFormatExtended>"
+        "</frame>");
+    parser.parseFrame(frame);
+  }
+
+  std::string objectsBlock(int counter, const std::string& rtime) {
+    std::ostringstream block;
+    block << "<audioBlockFormat audioBlockFormatID=\"AB_00031001_"
+          << std::string(8 - std::to_string(counter).size(), '0') << counter
+          << "\" rtime=\"" << rtime << "\" duration=\"00:00:00.50000\">"
+          << "<position coordinate=\"azimuth\">" << counter << "</position>"
+          << "<position coordinate=\"elevation\">0</position>"
+          << "</audioBlockFormat>";
+    return block.str();
+  }
+
+  std::string binauralBlock(int counter) {
+    std::ostringstream block;
+    block << "<audioBlockFormat audioBlockFormatID=\"AB_00051001_"
+          << std::string(8 - std::to_string(counter).size(), '0') << counter
+          << "\"><gain>0.5</gain></audioBlockFormat>";
+    return block.str();
+  }
+
+  const std::string channelStart =
+      "<audioChannelFormat audioChannelFormatID=\"AC_00031001\" "
+      "audioChannelFormatName=\"Object\" typeDefinition=\"Objects\">";
+  const std::string channelEnd = "</audioChannelFormat>";
+}  // namespace
+
+TEST_CASE("frame parser appends blocks to existing channels") {
+  FrameParser parser(Document::create());
+  parseFrame(parser, channelStart + objectsBlock(1, "00:00:00.00000") +
+                         channelEnd);
+  // block 2 is repeated in the next frame
+  parseFrame(parser, channelStart + objectsBlock(2, "00:00:00.50000") +
+                         channelEnd);
+  parseFrame(parser, channelStart + objectsBlock(2, "00:00:00.50000") +
+                         objectsBlock(3, "00:00:01.00000") + channelEnd);
+
+  auto channelFormat = parser.getDocument()->lookup(
+      parseAudioChannelFormatId("AC_00031001"));
+  REQUIRE(channelFormat);
+  REQUIRE(parser.getDocument()->getElements<AudioChannelFormat>().size() == 1);
+  auto blocks = channelFormat->getElements<AudioBlockFormatObjects>();
+  REQUIRE(blocks.size() == 3);
+  for (int i = 0; i < 3; ++i) {
+    auto id = blocks[i].get<AudioBlockFormatId>();
+    CHECK(id.get<AudioBlockFormatIdCounter>().get() == unsigned(i + 1));
+    CHECK(blocks[i].get<SphericalPosition>().get<Azimuth>().get() ==
+          Approx(float(i + 1)));
+  }
+}
+
+TEST_CASE("frame parser appends binaural blocks once") {
+  FrameParser parser(Document::create());
+  const std::string frame =
+      "<audioChannelFormat audioChannelFormatID=\"AC_00051001\" "
+      "audioChannelFormatName=\"Binaural\" typeDefinition=\"Binaural\">" +
+      binauralBlock(1) + binauralBlock(2) + channelEnd;
+  for (int repeat = 0; repeat < 3; ++repeat) {
+    parseFrame(parser, frame);
+  }
+  auto channelFormat = parser.getDocument()->lookup(
+      parseAudioChannelFormatId("AC_00051001"));
+  REQUIRE(channelFormat);
+  auto blocks = channelFormat->getElements<AudioBlockFormatBinaural>();
+  REQUIRE(blocks.size() == 2);
+  CHECK(blocks[1]
+            .get<AudioBlockFormatId>()
+            .get<AudioBlockFormatIdCounter>()
+            .get() == 2u);
+}
+
+TEST_CASE("frame parser adds new elements and resolves references") {
+  auto document = Document::create();
+  FrameParser parser(document);
+  parseFrame(parser,
+             channelStart + objectsBlock(1, "00:00:00.00000") + channelEnd +
+                 "<audioPackFormat audioPackFormatID=\"AP_00031001\" "
+                 "audioPackFormatName=\"Pack\" typeDefinition=\"Objects\">"
+                 "<audioChannelFormatIDRef>AC_00031001</audioChannelFormatIDRef>"
+                 "</audioPackFormat>");
+
+  // a new object referring to an element from an earlier frame, and an
+  // existing pack which is left alone
+  parseFrame(parser,
+             "<audioObject audioObjectID=\"AO_1001\" audioObjectName=\"Obj\">"
+             "<audioPackFormatIDRef>AP_00031001</audioPackFormatIDRef>"
+             "</audioObject>"
+             "<audioPackFormat audioPackFormatID=\"AP_00031001\" "
+             "audioPackFormatName=\"Changed\" typeDefinition=\"Objects\"/>");
+
+  REQUIRE(parser.getDocument() == document);
+  auto object = document->lookup(parseAudioObjectId("AO_1001"));
+  REQUIRE(object);
+  auto packFormat = document->lookup(parseAudioPackFormatId("AP_00031001"));
+  REQUIRE(packFormat);
+  CHECK(packFormat->get<AudioPackFormatName>() == "Pack");
+  REQUIRE(object->getReferences<AudioPackFormat>().size() == 1);
+  CHECK(object->getReferences<AudioPackFormat>()[0] == packFormat);
+  CHECK(document->getElements<AudioPackFormat>().size() == 1);
+}
+
+TEST_CASE("frame parser works on documents from parseXml") {
+  auto document = parseXml("xml_parser/audio_block_format_objects.xml");
+  auto channelFormat =
+      document->lookup(parseAudioChannelFormatId("AC_00031001"));
+  REQUIRE(channelFormat);
+  auto before = channelFormat->getElements<AudioBlockFormatObjects>().size();
+
+  FrameParser parser(document);
+  parseFrame(parser, channelStart +
+                         objectsBlock(int(before) + 1, "00:00:10.00000") +
+                         channelEnd);
+  CHECK(channelFormat->getElements<AudioBlockFormatObjects>().size() ==
+        before + 1);
+}
+
+TEST_CASE("frame parser errors") {
+  FrameParser parser(Document::create());
+  SECTION("unresolved reference") {
+    REQUIRE_THROWS_AS(
+        parseFrame(parser,
+                   "<audioObject audioObjectID=\"AO_1001\" "
+                   "audioObjectName=\"Obj\">"
+                   "<audioPackFormatIDRef>AP_00031001</audioPackFormatIDRef>"
+                   "</audioObject>"),
+        error::XmlParsingUnresolvedReference);
+  }
+  SECTION("blocks which skip ahead") {
+    parseFrame(parser, channelStart + objectsBlock(1, "00:00:00.00000") +
+                           channelEnd);
+    auto channelFormat = parser.getDocument()->lookup(
+        parseAudioChannelFormatId("AC_00031001"));
+    REQUIRE(channelFormat);
+    // nothing in the frame is added, including the new object before the
+    // channel, and the blocks before the gap
+    REQUIRE_THROWS_AS(
+        parseFrame(parser,
+                   "<audioObject audioObjectID=\"AO_1001\" "
+                   "audioObjectName=\"Obj\"/>" +
+                       channelStart + objectsBlock(2, "00:00:00.50000") +
+                       objectsBlock(4, "00:00:01.50000") + channelEnd),
+        error::XmlParsingError);
+    CHECK(channelFormat->getElements<AudioBlockFormatObjects>().size() == 1);
+    CHECK(parser.getDocument()->getElements<AudioObject>().size() == 0);
+
+    // a correct frame can still be added afterwards
+    parseFrame(parser, channelStart + objectsBlock(2, "00:00:00.50000") +
+                           channelEnd);
+    CHECK(channelFormat->getElements<AudioBlockFormatObjects>().size() == 2);
+  }
+  SECTION("no audioFormatExtended") {
+    std::istringstream frame("<frame><frameHeader/></frame>");
+    REQUIRE_THROWS_AS(parser.parseFrame(frame), error::XmlParsingError);
+  }
+}
@@ -0,0 +1,239 @@
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "adm/document.hpp"
+#include "adm/elements.hpp"
+#include "adm/errors.hpp"
+#include "adm/parse.hpp"
+#include "adm/write.hpp"
+#include "helper/temporary_directory.hpp"
+
+using namespace adm;
+using adm::xml::ParserOptions;
+
+namespace {
+  /// parse and write, or give the error message
+  std::string parseAndWrite(const std::string& filename,
+                            ParserOptions options) {
+    std::ostringstream result;
+    try {
+      adm::writeXml(result, adm::parseXml(filename, options));
+    } catch (const std::exception& e) {
+      result << "error: " << e.what();
+    }
+    return result.str();
+  }
+
+  const char* badBlock = R"(<?xml version="1.0" encoding="utf-8"?>
+<ebuCoreMain>
+  <coreMetadata>
+    <format>
+      <audioFormatExtended>
+        <audioChannelFormat audioChannelFormatID="AC_00031001" audioChannelFormatName="one" typeDefinition="Objects">
+          <audioBlockFormat audioBlockFormatID="AB_00031001_00000001">
+            <position coordinate="azimuth">0</position>
+            <position coordinate="elevation">0</position>
+          </audioBlockFormat>
+          <!-- a comment with a closing tag </audioBlockFormat> -->
+          <audioBlockFormat audioBlockFormatID="AB_00031001_00000002">
+            <position coordinate="azimuth">not a number</position>
+            <position coordinate="elevation">0</position>
+          </audioBlockFormat>
+        </audioChannelFormat>
+      </audioFormatExtended>
+    </format>
+  </coreMetadata>
+</ebuCoreMain>
+)";
+}  // namespace
+
+TEST_CASE("lazy parse matches eager parse") {
+  auto filename = GENERATE(as<std::string>{},
+                           "audio_block_format_binaural.xml",
+                           "audio_block_format_direct_speakers.xml",
+                           "audio_block_format_direct_speakers_cartesian.xml",
+                           "audio_block_format_hoa.xml",
+                           "audio_block_format_objects.xml",
+                           "audio_channel_format.xml",
+                           "audio_channel_format_duplicate_id.xml");
+  auto options = GENERATE(ParserOptions::none, ParserOptions::memory_map,
+                          ParserOptions::parallel,
+                          ParserOptions::first_audio_block_format_only);
+  auto path = "xml_parser/" + filename;
+  INFO(path);
+  CHECK(parseAndWrite(path,
+                      options | ParserOptions::lazy_audio_block_formats) ==
+        parseAndWrite(path, options));
+}
+
+TEST_CASE("lazy parse defers block errors") {
+  std::istringstream xml(badBlock);
+  auto document = parseXml(xml, ParserOptions::lazy_audio_block_formats);
+  auto channelFormat =
+      document->lookup(parseAudioChannelFormatId("AC_00031001"));
+  REQUIRE(channelFormat);
+
+  auto copy = channelFormat->copy();
+
+  REQUIRE_THROWS_AS(channelFormat->getElements<AudioBlockFormatObjects>(),
+                    std::invalid_argument);
+  // no blocks are left behind, and the error is thrown again
+  REQUIRE_THROWS_AS(channelFormat->getElements<AudioBlockFormatObjects>(),
+                    std::invalid_argument);
+  // the copy loads separately
+  REQUIRE_THROWS_AS(copy->getElements<AudioBlockFormatObjects>(),
+                    std::invalid_argument);
+
+  // clearing drops the pending blocks
+  channelFormat->clearAudioBlockFormats();
+  CHECK(channelFormat->getElements<AudioBlockFormatObjects>().empty());
+}
+
+TEST_CASE("lazy parse reports the lines of block errors") {
+  const char* xml = R"(<?xml version="1.0" encoding="utf-8"?>
+<ebuCoreMain>
+  <coreMetadata>
+    <format>
+      <audioFormatExtended>
+        <audioChannelFormat audioChannelFormatID="AC_00011001" audioChannelFormatName="one" typeDefinition="DirectSpeakers">
+          <audioBlockFormat audioBlockFormatID="AB_00011001_00000001">
+            <position coordinate="azimuth">0</position>
+            <position coordinate="sideways">0</position>
+          </audioBlockFormat>
+        </audioChannelFormat>
+      </audioFormatExtended>
+    </format>
+  </coreMetadata>
+</ebuCoreMain>
+)";
+  int expectedLine = -1;
+  try {
+    std::istringstream stream(xml);
+    parseXml(stream);
+  } catch (const error::XmlParsingError& e) {
+    expectedLine = e.line().value_or(-1);
+  }
+  REQUIRE(expectedLine != -1);
+
+  std::istringstream stream(xml);
+  auto document = parseXml(stream, ParserOptions::lazy_audio_block_formats);
+  auto channelFormat =
+      document->lookup(parseAudioChannelFormatId("AC_00011001"));
+  REQUIRE(channelFormat);
+  int line = -1;
+  try {
+    channelFormat->getElements<AudioBlockFormatDirectSpeakers>();
+  } catch (const error::XmlParsingError& e) {
+    line = e.line().value_or(-1);
+  }
+  CHECK(line == expectedLine);
+}
+
+TEST_CASE("lazy parse with first block only") {
+  std::istringstream xml(badBlock);
+  auto document =
+      parseXml(xml, ParserOptions::lazy_audio_block_formats |
+                        ParserOptions::first_audio_block_format_only);
+  auto channelFormat =
+      document->lookup(parseAudioChannelFormatId("AC_00031001"));
+  REQUIRE(channelFormat->getElements<AudioBlockFormatObjects>().size() == 1);
+  // adding after the loaded blocks
+  channelFormat->add(AudioBlockFormatObjects(SphericalPosition()));
+  auto blocks = channelFormat->getElements<AudioBlockFormatObjects>();
+  REQUIRE(blocks.size() == 2);
+  CHECK(blocks[1].get<AudioBlockFormatId>() ==
+        parseAudioBlockFormatId("AB_00031001_00000002"));
+}
+
+TEST_CASE("lazy parse then changing the channel ID") {
+  const std::string path = "xml_parser/audio_block_format_objects.xml";
+  auto expected = parseXml(path)->lookup(
+      parseAudioChannelFormatId("AC_00031001"));
+  auto document = parseXml(path, ParserOptions::lazy_audio_block_formats);
+  auto channelFormat =
+      document->lookup(parseAudioChannelFormatId("AC_00031001"));
+  REQUIRE(channelFormat);
+
+  REQUIRE_NOTHROW(
+      channelFormat->set(parseAudioChannelFormatId("AC_00031002")));
+  auto blocks = channelFormat->getElements<AudioBlockFormatObjects>();
+  auto expectedBlocks = expected->getElements<AudioBlockFormatObjects>();
+  REQUIRE(blocks.size() == expectedBlocks.size());
+  for (std::size_t i = 0; i < blocks.size(); ++i) {
+    auto id = expectedBlocks[i].get<AudioBlockFormatId>();
+    id.set(AudioBlockFormatIdValue(0x1002));
+    CHECK(blocks[i].get<AudioBlockFormatId>() == id);
+  }
+}
+
+TEST_CASE("lazy parse of a file which changes afterwards") {
+  const std::string path = "xml_parser/audio_block_format_objects.xml";
+  std::string xml;
+  {
+    std::ifstream file(path, std::ios::binary);
+    xml.assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  }
+  TemporaryDirectory directory;
+  const std::string filename = directory.file("lazy_changed.xml");
+  {
+    std::ofstream file(filename, std::ios::binary);
+    file << xml;
+  }
+  auto document =
+      parseXml(filename, ParserOptions::lazy_audio_block_formats);
+
+  // the same size, but different blocks
+  {
+    std::string changed = xml;
+    for (auto& c : changed) {
+      if (c >= '1' && c <= '8') ++c;
+    }
+    std::ofstream file(filename, std::ios::binary);
+    file << changed;
+  }
+
+  std::ostringstream expected;
+  writeXml(expected, parseXml(path));
+  std::ostringstream result;
+  writeXml(result, document);
+  CHECK(result.str() == expected.str());
+}
+
+TEST_CASE("lazy blocks can be loaded from several threads") {
+  const std::string path = "xml_parser/audio_block_format_objects.xml";
+  auto expected = parseXml(path);
+  std::shared_ptr<const Document> document =
+      parseXml(path, ParserOptions::lazy_audio_block_formats);
+
+  // every thread reads every channel, so that first accesses overlap
+  const int threadCount = 8;
+  std::vector<std::vector<std::size_t>> counts(threadCount);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < threadCount; ++i) {
+    threads.emplace_back([&document, &counts, i]() {
+      for (const auto& channelFormat :
+           document->getElements<AudioChannelFormat>()) {
+        counts[i].push_back(
+            channelFormat->getElements<AudioBlockFormatObjects>().size());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<std::size_t> expectedCounts;
+  for (const auto& channelFormat :
+       expected->getElements<AudioChannelFormat>()) {
+    expectedCounts.push_back(
+        channelFormat->getElements<AudioBlockFormatObjects>().size());
+  }
+  for (const auto& threadCounts : counts) {
+    CHECK(threadCounts == expectedCounts);
+  }
+}
@@ -0,0 +1,107 @@
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "adm/document.hpp"
+#include "adm/errors.hpp"
+#include "adm/parse.hpp"
+#include "adm/write.hpp"
+#include "helper/temporary_directory.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+  using adm::xml::ParserOptions;
+
+  std::string parseAndWrite(const std::string& filename,
+                            ParserOptions options) {
+    std::ostringstream result;
+    adm::writeXml(result, adm::parseXml(filename, options));
+    return result.str();
+  }
+}  // namespace
+
+TEST_CASE("memory mapped parse matches buffered parse") {
+  auto filename = GENERATE(as<std::string>{},
+                           "xml_parser/audio_block_format_objects.xml",
+                           "xml_parser/audio_object.xml",
+                           "xml_parser/with_common_definitions.xml");
+  INFO(filename);
+  CHECK(parseAndWrite(filename, ParserOptions::recursive_node_search |
+                                    ParserOptions::memory_map) ==
+        parseAndWrite(filename, ParserOptions::recursive_node_search));
+}
+
+TEST_CASE("memory mapped parse of page-sized file") {
+  // there are no bytes after the end of the file in the last page to act as
+  // the terminator
+  TemporaryDirectory directory;
+  const std::string filename = directory.file("memory_map_page_sized.xml");
+  for (std::size_t size : {4096u, 16384u, 65536u}) {
+    std::string xml =
+        "<ituADM><audioFormatExtended>"
+        "<audioObject audioObjectID=\"AO_1001\" audioObjectName=\"object\"/>"
+        "</audioFormatExtended></ituADM>";
+    xml.append(size - xml.size(), '\n');
+    {
+      std::ofstream file(filename, std::ios::binary);
+      file << xml;
+    }
+    auto document = adm::parseXml(
+        filename,
+        ParserOptions::recursive_node_search | ParserOptions::memory_map);
+    CHECK(document->lookup(adm::parseAudioObjectId("AO_1001")));
+  }
+}
+
+#ifndef _WIN32
+TEST_CASE("memory mapped parse of a file which can not be mapped") {
+  TemporaryDirectory directory;
+  const std::string fifo = directory.file("memory_map.fifo");
+  const std::string filename = "xml_parser/audio_object.xml";
+  std::ifstream file(filename, std::ios::binary);
+  std::string xml((std::istreambuf_iterator<char>(file)),
+                  std::istreambuf_iterator<char>());
+  REQUIRE(mkfifo(fifo.c_str(), 0600) == 0);
+
+  std::thread writer([&]() {
+    std::ofstream stream(fifo, std::ios::binary);
+    stream << xml;
+  });
+  std::shared_ptr<adm::Document> document;
+  CHECK_NOTHROW(document = adm::parseXml(fifo, ParserOptions::memory_map));
+  // if parseXml failed before opening the FIFO, the writer is still waiting
+  // for a reader; open one so that it can finish instead of hanging
+  int reader = -1;
+  if (!document) reader = open(fifo.c_str(), O_RDONLY | O_NONBLOCK);
+  writer.join();
+  if (reader != -1) close(reader);
+
+  REQUIRE(document);
+  std::ostringstream result;
+  adm::writeXml(result, document);
+  CHECK(result.str() == parseAndWrite(filename, ParserOptions::none));
+}
+#endif
+
+TEST_CASE("memory mapped parse errors") {
+  TemporaryDirectory directory;
+  SECTION("empty file") {
+    const std::string filename = directory.file("memory_map_empty.xml");
+    { std::ofstream file(filename); }
+    REQUIRE_THROWS_AS(adm::parseXml(filename, ParserOptions::memory_map),
+                      adm::error::XmlParsingError);
+  }
+  SECTION("missing file") {
+    REQUIRE_THROWS_AS(
+        adm::parseXml(directory.file("memory_map_missing.xml"),
+                      ParserOptions::memory_map),
+        std::runtime_error);
+  }
+}
@@ -0,0 +1,106 @@
+#include <catch2/catch.hpp>
+#include <clocale>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "adm/document.hpp"
+#include "adm/elements/audio_channel_format.hpp"
+#include "adm/parse.hpp"
+
+namespace {
+  /// parse a document containing one Objects audioBlockFormat with the given
+  /// children, and return the block
+  adm::AudioBlockFormatObjects parseBlock(const std::string& children) {
+    std::istringstream xml(
+        "<ituADM><audioFormatExtended>"
+        "<audioChannelFormat audioChannelFormatID=\"AC_00031001\" "
+        "audioChannelFormatName=\"c\" typeDefinition=\"Objects\">"
+        "<audioBlockFormat audioBlockFormatID=\"AB_00031001_00000001\">" +
+        children +
+        "</audioBlockFormat></audioChannelFormat>"
+        "</audioFormatExtended></ituADM>");
+    auto document =
+        adm::parseXml(xml, adm::xml::ParserOptions::recursive_node_search);
+    auto channelFormat =
+        document->lookup(adm::parseAudioChannelFormatId("AC_00031001"));
+    return channelFormat->getElements<adm::AudioBlockFormatObjects>()[0];
+  }
+
+  std::string position(const std::string& azimuth) {
+    return "<position coordinate=\"azimuth\">" + azimuth +
+           "</position><position coordinate=\"elevation\">0</position>";
+  }
+
+  float azimuth(const adm::AudioBlockFormatObjects& block) {
+    return block.get<adm::SphericalPosition>().get<adm::Azimuth>().get();
+  }
+}  // namespace
+
+TEST_CASE("xml_parser/numbers") {
+  using namespace adm;
+  CHECK(azimuth(parseBlock(position("30"))) == 30.0f);
+  CHECK(azimuth(parseBlock(position("-12.5"))) == -12.5f);
+  CHECK(azimuth(parseBlock(position("+.5"))) == 0.5f);
+  CHECK(azimuth(parseBlock(position("1.5e1"))) == 15.0f);
+  CHECK(azimuth(parseBlock(position(" \n 1.25\t"))) == 1.25f);
+  CHECK(azimuth(parseBlock(position("0.1"))) == 0.1f);
+
+  auto block = parseBlock(position("0") + "<gain>0.25</gain>" +
+                          "<importance> 7 </importance>" +
+                          "<channelLock>1</channelLock>" +
+                          "<screenRef>false</screenRef>");
+  CHECK(block.get<Gain>().asLinear() == 0.25);
+  CHECK(block.get<Importance>() == 7);
+  CHECK(block.get<ChannelLock>().get<ChannelLockFlag>() == true);
+  CHECK(block.get<ScreenRef>() == false);
+  CHECK(parseBlock(position("0") + "<gain gainUnit=\"dB\">-6</gain>")
+            .get<Gain>()
+            .asDb() == -6.0);
+}
+
+TEST_CASE("xml_parser/numbers_invalid") {
+  for (std::string value :
+       {"", " ", "abc", "1.5abc", "1,5", "0x10", "1e", ".", "--1", "1 2",
+        "inf", "nan"}) {
+    INFO("'" << value << "'");
+    CHECK_THROWS_AS(parseBlock(position(value)), std::invalid_argument);
+  }
+  CHECK_THROWS_AS(parseBlock(position("1e100")), std::out_of_range);
+  CHECK_THROWS_AS(parseBlock(position("0") + "<importance>1.0</importance>"),
+                  std::invalid_argument);
+  CHECK_THROWS_AS(
+      parseBlock(position("0") + "<importance>99999999999</importance>"),
+      std::out_of_range);
+  CHECK_THROWS_AS(parseBlock(position("0") + "<channelLock>2</channelLock>"),
+                  std::invalid_argument);
+  CHECK_THROWS_AS(parseBlock(position("0") + "<gain>1dB</gain>"),
+                  std::invalid_argument);
+}
+
+TEST_CASE("xml_parser/numbers_locale") {
+  // parsing must not depend on the decimal separator of the C locale
+  const char* locales[] = {"de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8",
+                           "fr_FR.utf8", "German"};
+  std::string previous = std::setlocale(LC_ALL, nullptr);
+  bool found = false;
+  for (const char* locale : locales) {
+    if (std::setlocale(LC_ALL, locale)) {
+      found = true;
+      break;
+    }
+  }
+  if (!found) {
+    WARN("no locale with a comma decimal separator available");
+    return;
+  }
+  float value = azimuth(parseBlock(position("12.5")));
+  bool commaThrows = false;
+  try {
+    parseBlock(position("12,5"));
+  } catch (const std::invalid_argument&) {
+    commaThrows = true;
+  }
+  std::setlocale(LC_ALL, previous.c_str());
+  CHECK(value == 12.5f);
+  CHECK(commaThrows);
+}
@@ -0,0 +1,178 @@
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "adm/document.hpp"
+#include "adm/elements.hpp"
+#include "adm/errors.hpp"
+#include "adm/parse.hpp"
+#include "adm/write.hpp"
+
+namespace {
+  using adm::xml::ParserOptions;
+
+  /// parse and write, or give the error message
+  std::string parseAndWrite(const std::string& xml, ParserOptions options) {
+    std::istringstream stream(xml);
+    std::ostringstream result;
+    try {
+      adm::writeXml(result, adm::parseXml(stream, options));
+    } catch (const std::exception& e) {
+      result << "error: " << e.what();
+    }
+    return result.str();
+  }
+
+  /// check parallel and sequential parsing give the same result, and return
+  /// it
+  std::string checkSameAsSequential(const std::string& xml,
+                                    ParserOptions options) {
+    std::string result = parseAndWrite(xml, options);
+    CHECK(parseAndWrite(xml, options | ParserOptions::parallel) == result);
+    return result;
+  }
+
+  /// a document with many elements, with enough blocks in each channel to be
+  /// split between tasks
+  std::string manyElements(std::size_t blocks) {
+    std::ostringstream xml;
+    xml << "<ituADM><audioFormatExtended>\n";
+    for (int channel = 1; channel <= 4; ++channel) {
+      xml << "<audioPackFormat audioPackFormatID=\"AP_0003100" << channel
+          << "\" audioPackFormatName=\"p\" typeDefinition=\"Objects\">"
+          << "<audioChannelFormatIDRef>AC_0003100" << channel
+          << "</audioChannelFormatIDRef></audioPackFormat>\n";
+      xml << "<audioChannelFormat audioChannelFormatID=\"AC_0003100"
+          << channel
+          << "\" audioChannelFormatName=\"c\" typeDefinition=\"Objects\">\n";
+      for (std::size_t block = 1; block <= blocks; ++block) {
+        char rtime[32];
+        std::snprintf(rtime, sizeof(rtime), "00:00:%02d.%02d000",
+                      static_cast<int>(block / 100),
+                      static_cast<int>(block % 100));
+        xml << "<audioBlockFormat rtime=\"" << rtime
+            << "\" duration=\"00:00:00.01000\">"
+            << "<position coordinate=\"azimuth\">" << static_cast<int>(block % 360) - 180
+            << "</position><position coordinate=\"elevation\">0</position>"
+            << "</audioBlockFormat>\n";
+      }
+      xml << "</audioChannelFormat>\n";
+    }
+    xml << "</audioFormatExtended></ituADM>\n";
+    return xml.str();
+  }
+}  // namespace
+
+TEST_CASE("parallel parse matches sequential parse") {
+  auto filename = GENERATE(as<std::string>{},
+                           "audio_block_format_binaural.xml",
+                           "audio_block_format_direct_speakers.xml",
+                           "audio_block_format_direct_speakers_cartesian.xml",
+                           "audio_block_format_direct_speakers_cartesian_bad_bound.xml",
+                           "audio_block_format_hoa.xml",
+                           "audio_block_format_objects.xml",
+                           "audio_block_format_objects_gain_unit_error.xml",
+                           "audio_channel_format.xml",
+                           "audio_channel_format_duplicate_id.xml",
+                           "audio_content.xml",
+                           "audio_content_duplicate_id.xml",
+                           "audio_object.xml",
+                           "audio_object_duplicate_id.xml",
+                           "audio_object_interaction.xml",
+                           "audio_object_position_offset.xml",
+                           "audio_pack_format.xml",
+                           "audio_pack_format_duplicate_id.xml",
+                           "audio_pack_format_hoa.xml",
+                           "audio_programme.xml",
+                           "audio_programme_duplicate_id.xml",
+                           "audio_stream_format.xml",
+                           "audio_stream_format_duplicate_id.xml",
+                           "audio_track_format.xml",
+                           "audio_track_format_duplicate_id.xml",
+                           "audio_track_uid.xml",
+                           "audio_track_uid_channel_format_reference.xml",
+                           "audio_track_uid_duplicate_id.xml",
+                           "audio_track_uid_track_format_reference.xml",
+                           "find_audio_format_extended_ebu.xml",
+                           "find_audio_format_extended_ebu_with_other_metadata.xml",
+                           "find_audio_format_extended_itu.xml",
+                           "labels.xml",
+                           "loudness_metadata.xml",
+                           "time_format.xml",
+                           "with_common_definitions.xml");
+  INFO(filename);
+  std::ifstream file("xml_parser/" + filename);
+  REQUIRE(file.good());
+  std::stringstream xml;
+  xml << file.rdbuf();
+  checkSameAsSequential(xml.str(), ParserOptions::none);
+  checkSameAsSequential(xml.str(), ParserOptions::recursive_node_search);
+}
+
+TEST_CASE("parallel parse of many blocks") {
+  std::string xml = manyElements(1000);
+  checkSameAsSequential(xml, ParserOptions::recursive_node_search);
+
+  auto document = adm::parseXml(
+      "xml_parser/audio_programme.xml", ParserOptions::parallel);
+  REQUIRE(document->getElements<adm::AudioProgramme>().size() == 1);
+
+  std::istringstream stream(xml);
+  document = adm::parseXml(stream, ParserOptions::recursive_node_search |
+                                       ParserOptions::parallel);
+  for (std::string id : {"AC_00031001", "AC_00031002", "AC_00031003",
+                         "AC_00031004"}) {
+    auto channelFormat =
+        document->lookup(adm::parseAudioChannelFormatId(id));
+    REQUIRE(channelFormat);
+    auto blocks = channelFormat->getElements<adm::AudioBlockFormatObjects>();
+    REQUIRE(blocks.size() == 1000);
+    // IDs are assigned in document order
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+      CHECK(blocks[i]
+                .get<adm::AudioBlockFormatId>()
+                .get<adm::AudioBlockFormatIdCounter>() == i + 1);
+    }
+  }
+  auto packFormat =
+      document->lookup(adm::parseAudioPackFormatId("AP_00031002"));
+  REQUIRE(packFormat);
+  CHECK(packFormat->getReferences<adm::AudioChannelFormat>()[0] ==
+        document->lookup(adm::parseAudioChannelFormatId("AC_00031002")));
+}
+
+TEST_CASE("parallel parse errors") {
+  // the first error in document order is reported, even when later elements
+  // fail in other ways
+  std::string xml = manyElements(600);
+
+  SECTION("duplicate before a bad block") {
+    std::string duplicate =
+        "<audioChannelFormat audioChannelFormatID=\"AC_00031001\" "
+        "audioChannelFormatName=\"c\" typeDefinition=\"Objects\"/>\n";
+    std::string badBlock =
+        "<audioBlockFormat><position coordinate=\"azimuth\">a</position>"
+        "</audioBlockFormat>\n";
+    std::string end = "</audioChannelFormat>\n</audioFormatExtended>";
+    auto lastChannelEnd = xml.rfind(end);
+    xml.insert(lastChannelEnd, badBlock);
+    xml.insert(xml.find("<audioPackFormat audioPackFormatID=\"AP_00031002\""),
+               duplicate);
+    CHECK(checkSameAsSequential(xml, ParserOptions::recursive_node_search)
+              .find("Duplicate Id AC_00031001") != std::string::npos);
+    CHECK_THROWS_AS(
+        adm::parseXml(
+            "xml_parser/audio_channel_format_duplicate_id.xml",
+            ParserOptions::parallel),
+        adm::error::XmlParsingDuplicateId);
+  }
+
+  SECTION("bad block in a later batch") {
+    auto block = xml.find("<audioBlockFormat rtime=\"00:00:05.");
+    REQUIRE(block != std::string::npos);
+    xml.insert(block, "<audioBlockFormat rtime=\"x\"/>\n");
+    CHECK(checkSameAsSequential(xml, ParserOptions::recursive_node_search) ==
+          "error: invalid timecode: x");
+  }
+}
@@ -0,0 +1,222 @@
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <string>
+#include "adm/document.hpp"
+#include "adm/elements.hpp"
+#include "adm/parse.hpp"
+#include "adm/write.hpp"
+
+namespace {
+  const char* original = R"(<?xml version="1.0" encoding="utf-8"?>
+<ebuCoreMain>
+  <coreMetadata>
+    <format>
+      <audioFormatExtended>
+        <audioProgramme audioProgrammeID="APR_1001" audioProgrammeName="programme">
+          <audioContentIDRef>ACO_1001</audioContentIDRef>
+        </audioProgramme>
+        <audioContent audioContentID="ACO_1001" audioContentName="content">
+          <audioObjectIDRef>AO_1001</audioObjectIDRef>
+        </audioContent>
+        <audioObject audioObjectID="AO_1001" audioObjectName="object">
+          <audioPackFormatIDRef>AP_00031001</audioPackFormatIDRef>
+          <audioTrackUIDRef>ATU_00000001</audioTrackUIDRef>
+        </audioObject>
+        <audioPackFormat audioPackFormatID="AP_00031001" audioPackFormatName="pack" typeLabel="0003" typeDefinition="Objects">
+          <audioChannelFormatIDRef>AC_00031001</audioChannelFormatIDRef>
+        </audioPackFormat>
+        <audioChannelFormat audioChannelFormatID="AC_00031001" audioChannelFormatName="channel" typeLabel="0003" typeDefinition="Objects">
+          <audioBlockFormat audioBlockFormatID="AB_00031001_00000001" rtime="00:00:00.00000" duration="00:00:01.00000">
+            <position coordinate="azimuth">30.0</position>
+            <position coordinate="elevation">0.0</position>
+          </audioBlockFormat>
+        </audioChannelFormat>
+        <audioStreamFormat audioStreamFormatID="AS_00031001" audioStreamFormatName="stream" formatLabel="0001" formatDefinition="PCM">
+          <audioChannelFormatIDRef>AC_00031001</audioChannelFormatIDRef>
+          <audioTrackFormatIDRef>AT_00031001_01</audioTrackFormatIDRef>
+        </audioStreamFormat>
+        <audioTrackFormat audioTrackFormatID="AT_00031001_01" audioTrackFormatName="track" formatLabel="0001" formatDefinition="PCM">
+          <audioStreamFormatIDRef>AS_00031001</audioStreamFormatIDRef>
+        </audioTrackFormat>
+        <audioTrackUID UID="ATU_00000001" sampleRate="48000" bitDepth="24">
+          <audioTrackFormatIDRef>AT_00031001_01</audioTrackFormatIDRef>
+          <audioPackFormatIDRef>AP_00031001</audioPackFormatIDRef>
+        </audioTrackUID>
+      </audioFormatExtended>
+    </format>
+  </coreMetadata>
+</ebuCoreMain>
+)";
+
+  std::string replace(std::string xml, const std::string& from,
+                      const std::string& to) {
+    auto position = xml.find(from);
+    REQUIRE(position != std::string::npos);
+    return xml.replace(position, from.size(), to);
+  }
+
+  std::shared_ptr<adm::Document> parse(const std::string& xml) {
+    std::istringstream stream(xml);
+    return adm::parseXml(stream);
+  }
+
+  adm::ReparseSummary reparse(std::shared_ptr<adm::Document> document,
+                              const std::string& xml) {
+    std::istringstream stream(xml);
+    return adm::reparseXml(document, stream);
+  }
+
+  std::string write(std::shared_ptr<const adm::Document> document) {
+    std::ostringstream result;
+    adm::writeXml(result, document);
+    return result.str();
+  }
+
+  std::size_t countElements(const adm::Document& document) {
+    using namespace adm;
+    return document.getElements<AudioProgramme>().size() +
+           document.getElements<AudioContent>().size() +
+           document.getElements<AudioObject>().size() +
+           document.getElements<AudioPackFormat>().size() +
+           document.getElements<AudioChannelFormat>().size() +
+           document.getElements<AudioStreamFormat>().size() +
+           document.getElements<AudioTrackFormat>().size() +
+           document.getElements<AudioTrackUid>().size();
+  }
+}  // namespace
+
+TEST_CASE("reparse unchanged document") {
+  using namespace adm;
+  auto document = parse(original);
+  auto object = document->lookup(parseAudioObjectId("AO_1001"));
+  auto channel = document->lookup(parseAudioChannelFormatId("AC_00031001"));
+  auto expected = write(document);
+
+  auto summary = reparse(document, original);
+  CHECK(summary.unchanged == countElements(*document));
+  CHECK(summary.updated == 0);
+  CHECK(summary.added == 0);
+  CHECK(summary.removed == 0);
+  CHECK(document->lookup(parseAudioObjectId("AO_1001")) == object);
+  CHECK(document->lookup(parseAudioChannelFormatId("AC_00031001")) ==
+        channel);
+  CHECK(write(document) == expected);
+}
+
+TEST_CASE("reparse updates changed elements in place") {
+  using namespace adm;
+  auto document = parse(original);
+  auto object = document->lookup(parseAudioObjectId("AO_1001"));
+  auto channel = document->lookup(parseAudioChannelFormatId("AC_00031001"));
+  auto trackUid = document->lookup(parseAudioTrackUidId("ATU_00000001"));
+
+  auto modified = replace(original, "30.0", "-45.0");
+  modified = replace(modified, R"(audioObjectName="object")",
+                     R"(audioObjectName="renamed" importance="5")");
+  modified = replace(modified,
+                     "<audioPackFormatIDRef>AP_00031001</audioPackFormatIDRef>"
+                     "\n        </audioTrackUID>",
+                     "</audioTrackUID>");
+
+  auto summary = reparse(document, modified);
+  CHECK(summary.updated == 3);
+  CHECK(summary.added == 0);
+  CHECK(summary.removed == 0);
+  CHECK(summary.unchanged == countElements(*document) - 3);
+
+  CHECK(document->lookup(parseAudioObjectId("AO_1001")) == object);
+  CHECK(object->get<AudioObjectName>() == "renamed");
+  CHECK(object->get<Importance>() == 5);
+
+  REQUIRE(document->lookup(parseAudioChannelFormatId("AC_00031001")) ==
+          channel);
+  auto blocks = channel->getElements<AudioBlockFormatObjects>();
+  REQUIRE(blocks.size() == 1);
+  CHECK(blocks[0].get<SphericalPosition>().get<Azimuth>() == -45.0f);
+
+  REQUIRE(document->lookup(parseAudioTrackUidId("ATU_00000001")) ==
+          trackUid);
+  CHECK_FALSE(trackUid->getReference<AudioPackFormat>());
+  CHECK(trackUid->getReference<AudioTrackFormat>());
+
+  CHECK(write(document) == write(parse(modified)));
+
+  SECTION("and back") {
+    summary = reparse(document, original);
+    CHECK(summary.updated == 3);
+    CHECK_FALSE(object->has<Importance>());
+    CHECK(trackUid->getReference<AudioPackFormat>());
+    CHECK(write(document) == write(parse(original)));
+  }
+}
+
+TEST_CASE("reparse adds and removes elements") {
+  using namespace adm;
+  auto document = parse(original);
+  auto content = document->lookup(parseAudioContentId("ACO_1001"));
+  auto object = document->lookup(parseAudioObjectId("AO_1001"));
+
+  // remove the audioTrackUID, and add a second audioObject
+  auto modified = replace(
+      original, "\n          <audioTrackUIDRef>ATU_00000001</audioTrackUIDRef>",
+      "");
+  modified = replace(modified, R"(<audioTrackUID UID="ATU_00000001")",
+                     "<!--");
+  modified = replace(modified, "</audioTrackUID>", "-->");
+  modified = replace(
+      modified, "<audioObjectIDRef>AO_1001</audioObjectIDRef>",
+      "<audioObjectIDRef>AO_1001</audioObjectIDRef>\n"
+      "          <audioObjectIDRef>AO_1002</audioObjectIDRef>");
+  modified = replace(modified, "        <audioPackFormat ",
+                     "        <audioObject audioObjectID=\"AO_1002\" "
+                     "audioObjectName=\"new\">\n"
+                     "          <audioPackFormatIDRef>AP_00031001"
+                     "</audioPackFormatIDRef>\n"
+                     "        </audioObject>\n"
+                     "        <audioPackFormat ");
+
+  auto summary = reparse(document, modified);
+  CHECK(summary.added == 1);
+  CHECK(summary.removed == 1);
+  // the content and object references changed
+  CHECK(summary.updated == 2);
+
+  CHECK(document->lookup(parseAudioContentId("ACO_1001")) == content);
+  CHECK(document->lookup(parseAudioObjectId("AO_1001")) == object);
+  CHECK_FALSE(document->lookup(parseAudioTrackUidId("ATU_00000001")));
+  CHECK(object->getReferences<AudioTrackUid>().size() == 0);
+
+  auto added = document->lookup(parseAudioObjectId("AO_1002"));
+  REQUIRE(added);
+  CHECK(added->get<AudioObjectName>() == "new");
+  REQUIRE(content->getReferences<AudioObject>().size() == 2);
+  CHECK(content->getReferences<AudioObject>()[1] == added);
+  REQUIRE(added->getReferences<AudioPackFormat>().size() == 1);
+  CHECK(added->getReferences<AudioPackFormat>()[0] ==
+        document->lookup(parseAudioPackFormatId("AP_00031001")));
+
+  CHECK(write(document) == write(parse(modified)));
+}
+
+TEST_CASE("reparse keeps HOA parameters of added audioPackFormats") {
+  using namespace adm;
+  const std::string filename = "xml_parser/audio_pack_format_hoa.xml";
+  auto document = parse(original);
+  auto summary = reparseXml(document, filename);
+  CHECK(summary.added > 0);
+  CHECK(summary.removed > 0);
+  auto packFormat = std::dynamic_pointer_cast<AudioPackFormatHoa>(
+      document->lookup(parseAudioPackFormatId("AP_00041001")));
+  REQUIRE(packFormat);
+  CHECK(packFormat->get<Normalization>() == "N3D");
+  CHECK(write(document) == write(parseXml(filename)));
+}
+
+TEST_CASE("reparse leaves the document alone if parsing fails") {
+  using namespace adm;
+  auto document = parse(original);
+  auto expected = write(document);
+  REQUIRE_THROWS(
+      reparse(document, replace(original, "30.0</position>", "30.0")));
+  CHECK(write(document) == expected);
+}
@@ -0,0 +1,155 @@
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "adm/document.hpp"
+#include "adm/elements.hpp"
+#include "adm/errors.hpp"
+#include "adm/parse.hpp"
+
+using namespace adm;
+using adm::xml::ParserOptions;
+
+namespace {
+  std::size_t blockCount(std::shared_ptr<Document> document) {
+    auto channelFormat =
+        document->lookup(parseAudioChannelFormatId("AC_00031001"));
+    REQUIRE(channelFormat);
+    return channelFormat->getElements<AudioBlockFormatObjects>().size();
+  }
+
+  /// two programmes, each with one object, pack, channel, track UID, track
+  /// format and stream format; some references use lower-case hex digits
+  const char* twoProgrammes = R"(<?xml version="1.0" encoding="utf-8"?>
+<ebuCoreMain>
+  <coreMetadata>
+    <format>
+      <audioFormatExtended>
+        <audioProgramme audioProgrammeID="APR_1001" audioProgrammeName="one">
+          <audioContentIDRef>ACO_1001</audioContentIDRef>
+        </audioProgramme>
+        <audioProgramme audioProgrammeID="APR_1002" audioProgrammeName="two">
+          <audioContentIDRef>ACO_1002</audioContentIDRef>
+        </audioProgramme>
+        <audioContent audioContentID="ACO_1001" audioContentName="one">
+          <audioObjectIDRef>AO_100a</audioObjectIDRef>
+        </audioContent>
+        <audioContent audioContentID="ACO_1002" audioContentName="two">
+          <audioObjectIDRef>AO_100B</audioObjectIDRef>
+        </audioContent>
+        <audioObject audioObjectID="AO_100A" audioObjectName="one">
+          <audioPackFormatIDRef>AP_00031001</audioPackFormatIDRef>
+          <audioTrackUIDRef>ATU_00000001</audioTrackUIDRef>
+        </audioObject>
+        <audioObject audioObjectID="AO_100B" audioObjectName="two">
+          <audioPackFormatIDRef>AP_00031002</audioPackFormatIDRef>
+          <audioTrackUIDRef>ATU_00000002</audioTrackUIDRef>
+        </audioObject>
+        <audioPackFormat audioPackFormatID="AP_00031001" audioPackFormatName="one" typeDefinition="Objects">
+          <audioChannelFormatIDRef>AC_00031001</audioChannelFormatIDRef>
+        </audioPackFormat>
+        <audioPackFormat audioPackFormatID="AP_00031002" audioPackFormatName="two" typeDefinition="Objects">
+          <audioChannelFormatIDRef>AC_00031002</audioChannelFormatIDRef>
+        </audioPackFormat>
+        <audioChannelFormat audioChannelFormatID="AC_00031001" audioChannelFormatName="one" typeDefinition="Objects">
+          <audioBlockFormat audioBlockFormatID="AB_00031001_00000001">
+            <position coordinate="azimuth">0</position>
+            <position coordinate="elevation">0</position>
+          </audioBlockFormat>
+        </audioChannelFormat>
+        <audioChannelFormat audioChannelFormatID="AC_00031002" audioChannelFormatName="two" typeDefinition="Objects">
+          <audioBlockFormat audioBlockFormatID="AB_00031002_00000001">
+            <position coordinate="azimuth">0</position>
+            <position coordinate="elevation">0</position>
+          </audioBlockFormat>
+        </audioChannelFormat>
+        <audioStreamFormat audioStreamFormatID="AS_00031001" audioStreamFormatName="one" formatDefinition="PCM">
+          <audioChannelFormatIDRef>AC_00031001</audioChannelFormatIDRef>
+          <audioTrackFormatIDRef>AT_00031001_01</audioTrackFormatIDRef>
+        </audioStreamFormat>
+        <audioStreamFormat audioStreamFormatID="AS_00031002" audioStreamFormatName="two" formatDefinition="PCM">
+          <audioChannelFormatIDRef>AC_00031002</audioChannelFormatIDRef>
+          <audioTrackFormatIDRef>AT_00031002_01</audioTrackFormatIDRef>
+        </audioStreamFormat>
+        <audioTrackFormat audioTrackFormatID="AT_00031001_01" audioTrackFormatName="one" formatDefinition="PCM">
+          <audioStreamFormatIDRef>AS_00031001</audioStreamFormatIDRef>
+        </audioTrackFormat>
+        <audioTrackFormat audioTrackFormatID="AT_00031002_01" audioTrackFormatName="two" formatDefinition="PCM">
+          <audioStreamFormatIDRef>AS_00031002</audioStreamFormatIDRef>
+        </audioTrackFormat>
+        <audioTrackUID UID="ATU_00000001">
+          <audioTrackFormatIDRef>AT_00031001_01</audioTrackFormatIDRef>
+          <audioPackFormatIDRef>AP_00031001</audioPackFormatIDRef>
+        </audioTrackUID>
+        <audioTrackUID UID="ATU_00000002">
+          <audioTrackFormatIDRef>AT_00031002_01</audioTrackFormatIDRef>
+          <audioPackFormatIDRef>AP_00031002</audioPackFormatIDRef>
+        </audioTrackUID>
+      </audioFormatExtended>
+    </format>
+  </coreMetadata>
+</ebuCoreMain>
+)";
+}  // namespace
+
+TEST_CASE("skip audioBlockFormats") {
+  auto options = GENERATE(ParserOptions::none, ParserOptions::streaming,
+                          ParserOptions::parallel);
+  const std::string filename = "xml_parser/audio_block_format_objects.xml";
+
+  auto all = blockCount(parseXml(filename, options));
+  REQUIRE(all > 1);
+  CHECK(blockCount(parseXml(
+            filename, options | ParserOptions::skip_audio_block_formats)) ==
+        0);
+  auto first = parseXml(
+      filename, options | ParserOptions::first_audio_block_format_only);
+  REQUIRE(blockCount(first) == 1);
+  auto block = *first->lookup(parseAudioChannelFormatId("AC_00031001"))
+                    ->getElements<AudioBlockFormatObjects>()
+                    .begin();
+  CHECK(block.get<AudioBlockFormatId>() ==
+        parseAudioBlockFormatId("AB_00031001_00000001"));
+}
+
+TEST_CASE("parse one programme") {
+  auto options = GENERATE(ParserOptions::none, ParserOptions::parallel);
+  std::istringstream xml(twoProgrammes);
+  auto document = parseXml(xml, parseAudioProgrammeId("APR_1001"), options);
+
+  CHECK(document->lookup(parseAudioProgrammeId("APR_1001")));
+  CHECK(document->lookup(parseAudioContentId("ACO_1001")));
+  CHECK(document->lookup(parseAudioObjectId("AO_100A")));
+  CHECK(document->lookup(parseAudioPackFormatId("AP_00031001")));
+  CHECK(document->lookup(parseAudioChannelFormatId("AC_00031001")));
+  CHECK(document->lookup(parseAudioTrackUidId("ATU_00000001")));
+  CHECK(document->lookup(parseAudioTrackFormatId("AT_00031001_01")));
+  CHECK(document->lookup(parseAudioStreamFormatId("AS_00031001")));
+
+  CHECK_FALSE(document->lookup(parseAudioProgrammeId("APR_1002")));
+  CHECK_FALSE(document->lookup(parseAudioContentId("ACO_1002")));
+  CHECK_FALSE(document->lookup(parseAudioObjectId("AO_100B")));
+  CHECK_FALSE(document->lookup(parseAudioPackFormatId("AP_00031002")));
+  CHECK_FALSE(document->lookup(parseAudioChannelFormatId("AC_00031002")));
+  CHECK_FALSE(document->lookup(parseAudioTrackUidId("ATU_00000002")));
+  CHECK_FALSE(document->lookup(parseAudioTrackFormatId("AT_00031002_01")));
+  CHECK_FALSE(document->lookup(parseAudioStreamFormatId("AS_00031002")));
+
+  auto object = document->lookup(parseAudioObjectId("AO_100A"));
+  CHECK(object->getReferences<AudioPackFormat>().size() == 1);
+  CHECK(object->getReferences<AudioTrackUid>().size() == 1);
+}
+
+TEST_CASE("parse one programme errors") {
+  SECTION("unknown programme") {
+    std::istringstream xml(twoProgrammes);
+    REQUIRE_THROWS_AS(parseXml(xml, parseAudioProgrammeId("APR_1003")),
+                      error::XmlParsingError);
+  }
+  SECTION("streaming") {
+    std::istringstream xml(twoProgrammes);
+    REQUIRE_THROWS_AS(parseXml(xml, parseAudioProgrammeId("APR_1001"),
+                               ParserOptions::streaming),
+                      std::invalid_argument);
+  }
+}
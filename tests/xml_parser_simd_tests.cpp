@@ -0,0 +1,168 @@
+#include <catch2/catch.hpp>
+#include <random>
+#include <string>
+#include <vector>
+#include "rapidxml/rapidxml.hpp"
+
+namespace {
+  using Rng = std::mt19937;
+
+  std::size_t randomSize(Rng& rng, std::size_t max) {
+    return std::uniform_int_distribution<std::size_t>(0, max)(rng);
+  }
+
+  template <typename T>
+  const T& choose(Rng& rng, const std::vector<T>& items) {
+    return items[randomSize(rng, items.size() - 1)];
+  }
+
+  /// random character data, with runs long enough to be scanned in blocks,
+  /// entity references and characters which stop some of the scans
+  std::string randomText(Rng& rng, std::size_t maxSize) {
+    static const std::vector<std::string> pieces = {
+        "a",    "b",     "0",      "1.5",   " ",     "  ",     "\t",
+        "\n",   "\r\n",  "&amp;",  "&lt;",  "&gt;",  "&quot;", "&apos;",
+        "&#65;", "&#x42;", "&#x20AC;", "&",   "&bad;", ">",      "\"",
+        "'",    "=",     "/",      "?",     "!",     "\xc3\xa9"};
+    std::string text;
+    std::size_t size = randomSize(rng, maxSize);
+    while (text.size() < size) {
+      // mostly plain characters, so that there are long pure runs
+      if (randomSize(rng, 3))
+        text += static_cast<char>('a' + randomSize(rng, 25));
+      else
+        text += choose(rng, pieces);
+    }
+    return text;
+  }
+
+  void randomElement(Rng& rng, std::string& xml, int depth) {
+    static const std::vector<std::string> names = {
+        "a", "position", "audioBlockFormat", "x:y", "n123"};
+    const std::string& name = choose(rng, names);
+    xml += "<" + name;
+    for (std::size_t i = randomSize(rng, 3); i > 0; i--) {
+      char quote = randomSize(rng, 3) ? '"' : '\'';
+      std::string value = randomText(rng, 80);
+      for (auto& c : value)
+        if (c == quote) c = '_';
+      xml += choose(rng, std::vector<std::string>{" ", "\n  ", "\t"});
+      xml += "attr" + std::to_string(i) + "=" + quote + value + quote;
+    }
+    if (depth > 3 || !randomSize(rng, 4)) {
+      xml += "/>";
+      return;
+    }
+    xml += ">";
+    for (std::size_t i = randomSize(rng, 4); i > 0; i--) {
+      if (randomSize(rng, 1)) {
+        std::string text = randomText(rng, 120);
+        for (auto& c : text)
+          if (c == '<') c = '_';
+        xml += text;
+      } else {
+        randomElement(rng, xml, depth + 1);
+      }
+    }
+    xml += "</" + name + ">";
+  }
+
+  /// a random document, sometimes damaged so that it can not be parsed
+  std::string randomXml(Rng& rng) {
+    std::string xml = "<?xml version=\"1.0\"?>\n";
+    randomElement(rng, xml, 0);
+    switch (randomSize(rng, 7)) {
+      case 0:
+        xml.resize(randomSize(rng, xml.size()));
+        break;
+      case 1:
+        xml.insert(randomSize(rng, xml.size()), "<");
+        break;
+      case 2:
+        xml.insert(randomSize(rng, xml.size()), "&#xZZ");
+        break;
+      default:
+        break;
+    }
+    return xml;
+  }
+
+  void describe(const rapidxml::xml_node<>* node, std::string& out) {
+    out += std::to_string(node->type()) + "[";
+    out.append(node->name(), node->name_size());
+    out += "|";
+    out.append(node->value(), node->value_size());
+    for (auto attribute = node->first_attribute(); attribute;
+         attribute = attribute->next_attribute()) {
+      out += " ";
+      out.append(attribute->name(), attribute->name_size());
+      out += "=";
+      out.append(attribute->value(), attribute->value_size());
+    }
+    for (auto child = node->first_node(); child; child = child->next_sibling())
+      describe(child, out);
+    out += "]";
+  }
+
+  /// parse xml at offset into a buffer, and describe the resulting DOM or
+  /// error, including where the error was found
+  template <int Flags>
+  std::string parse(const std::string& xml, std::size_t offset,
+                    rapidxml::simd_level level) {
+    rapidxml::set_simd_level(level);
+    std::vector<char> buffer(offset + xml.size() + 1);
+    std::copy(xml.begin(), xml.end(), buffer.begin() + offset);
+    char* text = buffer.data() + offset;
+    rapidxml::xml_document<> document;
+    std::string out;
+    try {
+      document.parse<Flags>(text);
+      describe(&document, out);
+    } catch (const rapidxml::parse_error& e) {
+      out = std::string("error: ") + e.what() + " at " +
+            std::to_string(e.where<char>() - text);
+    }
+    return out;
+  }
+}  // namespace
+
+TEST_CASE("simd scanning matches scalar scanning") {
+  const auto maxLevel = rapidxml::max_simd_level();
+  INFO("max_simd_level " << maxLevel);
+  REQUIRE(rapidxml::get_simd_level() == maxLevel);
+
+  Rng rng(2076);
+  for (int i = 0; i < 2000; i++) {
+    std::string xml = randomXml(rng);
+    // move the start through every alignment of the widest blocks
+    std::size_t offset = i % 32;
+    INFO(xml);
+
+    std::string expected = parse<0>(xml, offset, rapidxml::simd_none);
+    std::string expectedRaw = parse<rapidxml::parse_no_entity_translation>(
+        xml, offset, rapidxml::simd_none);
+    std::string expectedNormalized =
+        parse<rapidxml::parse_normalize_whitespace |
+              rapidxml::parse_trim_whitespace>(xml, offset,
+                                               rapidxml::simd_none);
+    for (int level = rapidxml::simd_sse2; level <= maxLevel; level++) {
+      auto simdLevel = static_cast<rapidxml::simd_level>(level);
+      CHECK(parse<0>(xml, offset, simdLevel) == expected);
+      CHECK(parse<rapidxml::parse_no_entity_translation>(
+                xml, offset, simdLevel) == expectedRaw);
+      CHECK(parse<rapidxml::parse_normalize_whitespace |
+                  rapidxml::parse_trim_whitespace>(xml, offset, simdLevel) ==
+            expectedNormalized);
+    }
+  }
+  rapidxml::set_simd_level(maxLevel);
+}
+
+TEST_CASE("simd level is limited to what is supported") {
+  const auto maxLevel = rapidxml::max_simd_level();
+  rapidxml::set_simd_level(rapidxml::simd_avx2);
+  CHECK(rapidxml::get_simd_level() == maxLevel);
+  rapidxml::set_simd_level(rapidxml::simd_none);
+  CHECK(rapidxml::get_simd_level() == rapidxml::simd_none);
+  rapidxml::set_simd_level(maxLevel);
+}
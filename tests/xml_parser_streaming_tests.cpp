@@ -0,0 +1,150 @@
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "adm/document.hpp"
+#include "adm/elements.hpp"
+#include "adm/errors.hpp"
+#include "adm/parse.hpp"
+#include "adm/write.hpp"
+
+namespace {
+  using adm::xml::ParserOptions;
+
+  /// parse and write, or give the error message
+  std::string parseAndWrite(std::istream& stream, ParserOptions options) {
+    std::ostringstream result;
+    try {
+      adm::writeXml(result, adm::parseXml(stream, options));
+    } catch (const std::exception& e) {
+      result << "error: " << e.what();
+    }
+    return result.str();
+  }
+
+  void checkSameAsDom(const std::string& xml, ParserOptions options) {
+    std::istringstream domStream(xml);
+    std::istringstream streamingStream(xml);
+    CHECK(parseAndWrite(streamingStream, options | ParserOptions::streaming) ==
+          parseAndWrite(domStream, options));
+  }
+
+  void checkFileSameAsDom(const std::string& filename) {
+    INFO(filename);
+    std::ifstream file(filename);
+    REQUIRE(file.good());
+    std::stringstream xml;
+    xml << file.rdbuf();
+    checkSameAsDom(xml.str(), ParserOptions::none);
+    checkSameAsDom(xml.str(), ParserOptions::recursive_node_search);
+  }
+}  // namespace
+
+TEST_CASE("streaming parse matches DOM parse") {
+  auto filename = GENERATE(as<std::string>{},
+                           "audio_block_format_binaural.xml",
+                           "audio_block_format_direct_speakers.xml",
+                           "audio_block_format_direct_speakers_cartesian.xml",
+                           "audio_block_format_hoa.xml",
+                           "audio_block_format_objects.xml",
+                           "audio_block_format_objects_gain_unit_error.xml",
+                           "audio_channel_format.xml",
+                           "audio_channel_format_duplicate_id.xml",
+                           "audio_content.xml",
+                           "audio_content_duplicate_id.xml",
+                           "audio_object.xml",
+                           "audio_object_duplicate_id.xml",
+                           "audio_object_interaction.xml",
+                           "audio_object_position_offset.xml",
+                           "audio_pack_format.xml",
+                           "audio_pack_format_duplicate_id.xml",
+                           "audio_pack_format_hoa.xml",
+                           "audio_programme.xml",
+                           "audio_programme_duplicate_id.xml",
+                           "audio_stream_format.xml",
+                           "audio_stream_format_duplicate_id.xml",
+                           "audio_track_format.xml",
+                           "audio_track_format_duplicate_id.xml",
+                           "audio_track_uid.xml",
+                           "audio_track_uid_channel_format_reference.xml",
+                           "audio_track_uid_duplicate_id.xml",
+                           "audio_track_uid_track_format_reference.xml",
+                           "find_audio_format_extended_ebu.xml",
+                           "find_audio_format_extended_ebu_with_other_metadata.xml",
+                           "find_audio_format_extended_itu.xml",
+                           "labels.xml",
+                           "loudness_metadata.xml",
+                           "time_format.xml",
+                           "with_common_definitions.xml");
+  checkFileSameAsDom("xml_parser/" + filename);
+}
+
+TEST_CASE("streaming parse of audioChannelFormat") {
+  // blocks are added one at a time, and the frequency after the blocks must
+  // still be found; comments and unknown elements are skipped
+  std::string xml = R"(<?xml version="1.0" encoding="utf-8"?>
+<!-- a comment with <audioChannelFormat> in it -->
+<ituADM xmlns="urn:metadata-schema:adm">
+  <coreMetadata>
+    <format>
+      <audioFormatExtended>
+        <unknown><audioBlockFormat/></unknown>
+        <audioChannelFormat audioChannelFormatID="AC_00011001" audioChannelFormatName="LFE" typeDefinition="DirectSpeakers">
+          <audioBlockFormat audioBlockFormatID="AB_00011001_00000001">
+            <speakerLabel>LFE</speakerLabel>
+            <position coordinate="azimuth">0.0</position>
+            <position coordinate="elevation">-30.0</position>
+          </audioBlockFormat>
+          <!-- <audioBlockFormat> -->
+          <audioBlockFormat audioBlockFormatID="AB_00011001_00000002"
+                            rtime="00:00:01.00000">
+            <position coordinate="azimuth" screenEdgeLock="left">10.0</position>
+            <position coordinate="elevation">0.0</position>
+          </audioBlockFormat>
+          <frequency typeDefinition="lowPass">120.0</frequency>
+          <frequency typeDefinition="highPass">20.0</frequency>
+        </audioChannelFormat>
+        <audioChannelFormat audioChannelFormatID="AC_00031001" audioChannelFormatName="empty" typeDefinition="Objects"/>
+      </audioFormatExtended>
+    </format>
+  </coreMetadata>
+</ituADM>
+)";
+  checkSameAsDom(xml, ParserOptions::recursive_node_search);
+
+  std::istringstream stream(xml);
+  auto document = adm::parseXml(stream, ParserOptions::recursive_node_search |
+                                            ParserOptions::streaming);
+  auto channelFormat = document->lookup(
+      adm::parseAudioChannelFormatId("AC_00011001"));
+  REQUIRE(channelFormat);
+  CHECK(channelFormat->getElements<adm::AudioBlockFormatDirectSpeakers>()
+            .size() == 2);
+  CHECK(channelFormat->get<adm::Frequency>().get<adm::LowPass>() == 120.0f);
+}
+
+TEST_CASE("streaming parse errors") {
+  SECTION("empty") {
+    std::istringstream stream("");
+    REQUIRE_THROWS_AS(adm::parseXml(stream, ParserOptions::streaming),
+                      adm::error::XmlParsingError);
+  }
+  SECTION("truncated") {
+    std::istringstream stream(
+        "<ituADM><audioFormatExtended><audioObject audioObjectID=");
+    REQUIRE_THROWS_AS(adm::parseXml(stream, ParserOptions::recursive_node_search |
+                                           ParserOptions::streaming),
+                      adm::error::XmlParsingError);
+  }
+  SECTION("duplicate audioFormatExtended") {
+    checkSameAsDom(
+        "<ebuCoreMain><coreMetadata><format>"
+        "<audioFormatExtended/><audioFormatExtended/>"
+        "</format></coreMetadata></ebuCoreMain>",
+        ParserOptions::none);
+  }
+  SECTION("missing audioFormatExtended") {
+    checkSameAsDom("<ituADM><format/></ituADM>",
+                   ParserOptions::recursive_node_search);
+  }
+}
@@ -1,6 +1,6 @@
 #include <catch2/catch.hpp>
 #include "adm/private/rapidxml_utils.hpp"
-#include "adm/private/rapidxml_wrapper.hpp"
+#include "rapidxml/rapidxml_utils.hpp"
 #include "adm/errors.hpp"
 #include "adm/parse.hpp"
 
@@ -0,0 +1,77 @@
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <stdexcept>
+#include "adm/private/xml_stream_writer.hpp"
+
+using adm::xml::XmlStreamWriter;
+
+TEST_CASE("xml stream writer output") {
+  std::ostringstream stream;
+  XmlStreamWriter writer(stream);
+  writer.declaration();
+  auto root = writer.startElement(0, "root");
+  writer.addAttribute(0, root, "a", "1");
+  auto child = writer.startElement(1, "child");
+  writer.setValue(1, child, "value");
+  writer.startElement(1, "empty");
+  auto parent = writer.startElement(1, "parent");
+  writer.startElement(2, "grandchild");
+  // the value of an element with children is not written
+  writer.setValue(1, parent, "ignored");
+  writer.finish();
+
+  CHECK(stream.str() ==
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root a=\"1\">\n"
+        "\t<child>value</child>\n"
+        "\t<empty/>\n"
+        "\t<parent>\n"
+        "\t\t<grandchild/>\n"
+        "\t</parent>\n"
+        "</root>\n"
+        "\n");
+}
+
+TEST_CASE("xml stream writer escaping") {
+  std::ostringstream stream;
+  XmlStreamWriter writer(stream);
+  auto root = writer.startElement(0, "root");
+  writer.addAttribute(0, root, "plain", "a<b & c>d 'e'");
+  // values with double quotes are written in single quotes
+  writer.addAttribute(0, root, "quoted", "say \"<&>\" 'x'");
+  auto child = writer.startElement(1, "child");
+  writer.setValue(1, child, "<\"&'>");
+  writer.finish();
+
+  CHECK(stream.str() ==
+        "<root plain=\"a&lt;b &amp; c&gt;d 'e'\""
+        " quoted='say \"&lt;&amp;&gt;\" &apos;x&apos;'>\n"
+        "\t<child>&lt;&quot;&amp;&apos;&gt;</child>\n"
+        "</root>\n"
+        "\n");
+}
+
+TEST_CASE("xml stream writer misuse") {
+  std::ostringstream stream;
+  XmlStreamWriter writer(stream);
+  auto root = writer.startElement(0, "root");
+  auto first = writer.startElement(1, "first");
+
+  SECTION("attribute after children") {
+    REQUIRE_THROWS_AS(writer.addAttribute(0, root, "a", "1"),
+                      std::logic_error);
+  }
+  SECTION("closed element") {
+    writer.startElement(1, "second");
+    REQUIRE_THROWS_AS(writer.setValue(1, first, "value"), std::logic_error);
+    REQUIRE_THROWS_AS(writer.addAttribute(1, first, "a", "1"),
+                      std::logic_error);
+  }
+  SECTION("wrong depth") {
+    REQUIRE_THROWS_AS(writer.setValue(2, first, "value"), std::logic_error);
+  }
+  SECTION("element below a closed element") {
+    writer.startElement(1, "second");
+    REQUIRE_THROWS_AS(writer.startElement(3, "deep"), std::logic_error);
+  }
+}
@@ -206,3 +206,24 @@ TEST_CASE("write specified Binaural block") {
   auto xml = getXml(doc);
   CHECK_THAT(xml, EqualsXmlFile("write_specified_binaural_block"));
 }
+
+TEST_CASE("write specified Matrix block") {
+  auto doc = Document::create();
+  auto channelFormat = AudioChannelFormat::create(
+      AudioChannelFormatName("Test"), TypeDefinition::MATRIX);
+  doc->add(channelFormat);
+  auto blockFormat = AudioBlockFormatMatrix{
+      Rtime{std::chrono::seconds(0)}, Duration{std::chrono::seconds(1)},
+      OutputChannelFormatId{parseAudioChannelFormatId("AC_00010001")},
+      MatrixCoefficients{
+          MatrixCoefficient{parseAudioChannelFormatId("AC_00010001")},
+          MatrixCoefficient{parseAudioChannelFormatId("AC_00010003"),
+                            Gain::fromLinear(0.5)},
+          MatrixCoefficient{parseAudioChannelFormatId("AC_00010005"),
+                            Gain::fromDb(-3.0), Phase{180.0f},
+                            Delay{2.5f}}}};
+  channelFormat->add(blockFormat);
+
+  auto xml = getXml(doc);
+  CHECK_THAT(xml, EqualsXmlFile("write_specified_matrix_block"));
+}